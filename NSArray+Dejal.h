@@ -30,6 +30,9 @@
 @import Foundation;
 
 
+@class DejalEquivalenceIndex;
+
+
 @interface NSArray (Dejal)
 
 - (BOOL)dejal_isValidIndex:(NSUInteger)i;
@@ -62,6 +65,9 @@
 
 - (id)dejal_penultimateObject;
 
+- (DejalEquivalenceIndex *)dejal_equivalenceIndexUsingKey:(NSString *)key;
+- (DejalEquivalenceIndex *)dejal_equivalenceIndexUsingSelector:(SEL)selector;
+
 - (id)dejal_deepCopy NS_RETURNS_RETAINED;
 - (id)dejal_deepMutableCopy NS_RETURNS_RETAINED;
 
@@ -81,8 +87,11 @@
 - (void)dejal_addOrMoveObjectsFromArray:(NSArray *)array;
 
 - (NSMutableArray *)dejal_arrayWithIndexEnumerator:(NSEnumerator *)enumerator;
+- (NSMutableArray *)dejal_arrayWithIndexSet:(NSIndexSet *)indexes;
 
 - (void)dejal_removeObjectsFromIndexEnumerator:(NSEnumerator *)enumerator;
+- (void)dejal_removeObjectsFromIndexSet:(NSIndexSet *)indexes;
+- (void)dejal_removeObjectsEqualToObjectsInArray:(NSArray *)array;
 - (void)dejal_removeObjectsMatching:(id)match usingKey:(NSString *)key;
 
 - (NSMutableArray *)dejal_reverseArray;
@@ -97,3 +106,70 @@
 
 @end
 
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalEquivalenceIndex : NSObject
+
+@property (nonatomic, readonly) NSUInteger count;
+
+- (instancetype)initWithArray:(NSArray *)array key:(NSString *)key;
+- (instancetype)initWithArray:(NSArray *)array selector:(SEL)selector;
+
+- (id)objectMatching:(id)match;
+- (NSUInteger)indexOfObjectMatching:(id)match;
+- (NSArray *)objectsMatching:(id)match;
+- (NSIndexSet *)indexesOfObjectsMatching:(id)match;
+
+- (void)addObject:(id)object;
+- (void)insertObject:(id)object atIndex:(NSUInteger)idx;
+- (void)removeObjectAtIndex:(NSUInteger)idx;
+- (void)replaceObjectAtIndex:(NSUInteger)idx withObject:(id)object;
+- (void)removeAllObjects;
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalQueue : NSObject
+
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) id firstObject;
+@property (nonatomic, readonly) id lastObject;
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+- (void)enqueue:(id)obj;
+- (id)dequeue;
+
+- (void)push:(id)obj;
+- (id)pop;
+
+- (void)removeAllObjects;
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalConcurrentQueue : NSObject
+
+@property (nonatomic, readonly) NSUInteger capacity;
+@property (nonatomic, readonly) NSUInteger count;
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+- (BOOL)enqueue:(id)obj;
+- (id)dequeue;
+
+@end
@@ -29,6 +29,317 @@
 
 #import "NSArray+Dejal.h"
 #import "NSObject+Dejal.h"
+#import <stdatomic.h>
+
+
+// Initial capacity of a queue, which must be a power of two:
+#define DEJAL_QUEUE_INITIAL_CAPACITY 16
+
+// Default capacity of a concurrent queue:
+#define DEJAL_CONCURRENT_QUEUE_DEFAULT_CAPACITY 1024
+
+// Size of a cache line, to keep the concurrent queue's positions from sharing one:
+#define DEJAL_CACHE_LINE_SIZE 64
+
+// Number of objects above which the sorting methods merge sort across threads:
+#define DEJAL_SORT_CONCURRENT_THRESHOLD 16384
+
+// Length of the runs the merge sort starts with, sorted by insertion:
+#define DEJAL_SORT_RUN_LENGTH 16
+
+// Finder order key weights: punctuation and symbols from 1 in Unicode collation order, then a number, then letters:
+#define DEJAL_FINDER_KEY_NUMBER 40
+#define DEJAL_FINDER_KEY_LETTER 41
+
+
+typedef NSComparisonResult (^DejalIndexComparator)(NSUInteger index1, NSUInteger index2);
+
+
+/**
+ Stable insertion sort of a short run of indexes.
+ 
+ @author DJS 2026-10.
+ */
+
+static void DejalInsertionSortIndexes(NSUInteger *indexes, NSUInteger count, DejalIndexComparator comparator)
+{
+    for (NSUInteger i = 1; i < count; i++)
+    {
+        NSUInteger value = indexes[i];
+        NSUInteger j = i;
+        
+        while (j > 0 && comparator(indexes[j - 1], value) == NSOrderedDescending)
+        {
+            indexes[j] = indexes[j - 1];
+            j--;
+        }
+        
+        indexes[j] = value;
+    }
+}
+
+/**
+ Stable merge of two adjacent sorted runs of indexes into the destination; ties are taken from the left run.
+ 
+ @author DJS 2026-10.
+ */
+
+static void DejalMergeIndexes(const NSUInteger *source, NSUInteger leftCount, NSUInteger rightCount, NSUInteger *destination, DejalIndexComparator comparator)
+{
+    const NSUInteger *left = source;
+    const NSUInteger *right = source + leftCount;
+    NSUInteger l = 0, r = 0, d = 0;
+    
+    while (l < leftCount && r < rightCount)
+    {
+        if (comparator(left[l], right[r]) != NSOrderedDescending)
+            destination[d++] = left[l++];
+        else
+            destination[d++] = right[r++];
+    }
+    
+    while (l < leftCount)
+        destination[d++] = left[l++];
+    
+    while (r < rightCount)
+        destination[d++] = right[r++];
+}
+
+/**
+ Merges adjacent sorted runs of the specified width from the source into the destination, optionally merging the pairs of runs concurrently.
+ 
+ @author DJS 2026-10.
+ */
+
+static void DejalMergeIndexRuns(const NSUInteger *source, NSUInteger *destination, NSUInteger count, NSUInteger width, BOOL concurrently, DejalIndexComparator comparator)
+{
+    NSUInteger pairs = (count + 2 * width - 1) / (2 * width);
+    void (^mergePair)(size_t) = ^(size_t pair)
+    {
+        NSUInteger start = pair * 2 * width;
+        NSUInteger leftCount = MIN(width, count - start);
+        NSUInteger rightCount = MIN(width, count - start - leftCount);
+        
+        DejalMergeIndexes(source + start, leftCount, rightCount, destination + start, comparator);
+    };
+    
+    if (concurrently)
+        dispatch_apply(pairs, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), mergePair);
+    else
+        for (NSUInteger pair = 0; pair < pairs; pair++)
+            mergePair(pair);
+}
+
+/**
+ Stable merge sort of the indexes using the comparator: runs are insertion sorted, then merged bottom-up.  Above a threshold, the array is split into a power of two parts that are sorted concurrently, then merged concurrently pair by pair.  Being stable, equal objects keep their original order, as with the NSArray sorting methods.
+ 
+ @author DJS 2026-10.
+ */
+
+static void DejalSortIndexes(NSUInteger *indexes, NSUInteger count, DejalIndexComparator comparator)
+{
+    if (count < 2)
+        return;
+    
+    NSUInteger *scratch = malloc(count * sizeof(NSUInteger));
+    BOOL concurrently = count >= DEJAL_SORT_CONCURRENT_THRESHOLD;
+    NSUInteger runLength = DEJAL_SORT_RUN_LENGTH;
+    
+    if (concurrently)
+    {
+        NSUInteger parts = 1;
+        
+        while (parts < [NSProcessInfo processInfo].activeProcessorCount * 2 && parts < 64)
+            parts *= 2;
+        
+        runLength = MAX((count + parts - 1) / parts, DEJAL_SORT_RUN_LENGTH);
+    }
+    
+    NSUInteger runs = (count + runLength - 1) / runLength;
+    void (^sortRun)(size_t) = ^(size_t run)
+    {
+        NSUInteger start = run * runLength;
+        NSUInteger runCount = MIN(runLength, count - start);
+        
+        if (runCount <= DEJAL_SORT_RUN_LENGTH)
+        {
+            DejalInsertionSortIndexes(indexes + start, runCount, comparator);
+            return;
+        }
+        
+        NSUInteger *source = indexes + start;
+        NSUInteger *destination = scratch + start;
+        
+        for (NSUInteger i = 0; i < runCount; i += DEJAL_SORT_RUN_LENGTH)
+            DejalInsertionSortIndexes(source + i, MIN(DEJAL_SORT_RUN_LENGTH, runCount - i), comparator);
+        
+        for (NSUInteger width = DEJAL_SORT_RUN_LENGTH; width < runCount; width *= 2)
+        {
+            DejalMergeIndexRuns(source, destination, runCount, width, NO, comparator);
+            
+            NSUInteger *swap = source;
+            source = destination;
+            destination = swap;
+        }
+        
+        if (source != indexes + start)
+            memcpy(indexes + start, source, runCount * sizeof(NSUInteger));
+    };
+    
+    if (concurrently)
+        dispatch_apply(runs, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), sortRun);
+    else
+        for (NSUInteger run = 0; run < runs; run++)
+            sortRun(run);
+    
+    NSUInteger *source = indexes;
+    NSUInteger *destination = scratch;
+    
+    for (NSUInteger width = runLength; width < count; width *= 2)
+    {
+        DejalMergeIndexRuns(source, destination, count, width, concurrently, comparator);
+        
+        NSUInteger *swap = source;
+        source = destination;
+        destination = swap;
+    }
+    
+    if (source != indexes)
+        memcpy(indexes, source, count * sizeof(NSUInteger));
+    
+    free(scratch);
+}
+
+/**
+ Returns the objects sorted by the comparator applied to the keys, which have an entry per object.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSArray *DejalArraySortedByKeys(NSArray *array, __unsafe_unretained id *keys, NSComparisonResult (^compareKeys)(id key1, id key2))
+{
+    NSUInteger count = array.count;
+    NSUInteger *indexes = malloc(MAX(count, 1) * sizeof(NSUInteger));
+    __unsafe_unretained id *objects = (__unsafe_unretained id *)calloc(MAX(count, 1), sizeof(id));
+    __unsafe_unretained id *sorted = (__unsafe_unretained id *)calloc(MAX(count, 1), sizeof(id));
+    
+    [array getObjects:objects range:NSMakeRange(0, count)];
+    
+    for (NSUInteger i = 0; i < count; i++)
+        indexes[i] = i;
+    
+    DejalSortIndexes(indexes, count, ^NSComparisonResult(NSUInteger index1, NSUInteger index2)
+    {
+        return compareKeys(keys[index1], keys[index2]);
+    });
+    
+    for (NSUInteger i = 0; i < count; i++)
+        sorted[i] = objects[indexes[i]];
+    
+    NSArray *result = [NSArray arrayWithObjects:sorted count:count];
+    
+    free(sorted);
+    free(objects);
+    free(indexes);
+    
+    return result;
+}
+
+
+/**
+ Returns a table of the Finder order key weight of each ASCII character, or zero for control characters, which need the full comparison.  Space, punctuation and symbols are weighted in their Unicode collation order, which puts them all before digits and letters; letters are weighted alphabetically, ignoring case.  Digits are weighted as numbers by DejalFinderOrderKey() instead.
+ 
+ @author DJS 2026-10.
+ */
+
+static const uint8_t *DejalFinderOrderWeights(void)
+{
+    static uint8_t weights[128];
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^
+                  {
+                      const char *symbols = " _-,;:!?.'\"()[]{}@*/\\&#%`^+<=>|~$";
+                      
+                      for (NSUInteger i = 0; symbols[i]; i++)
+                          weights[(uint8_t)symbols[i]] = (uint8_t)(i + 1);
+                      
+                      for (NSUInteger i = 0; i < 10; i++)
+                          weights['0' + i] = DEJAL_FINDER_KEY_NUMBER;
+                      
+                      for (NSUInteger i = 0; i < 26; i++)
+                          weights['a' + i] = weights['A' + i] = (uint8_t)(DEJAL_FINDER_KEY_LETTER + i);
+                  });
+    
+    return weights;
+}
+
+/**
+ Writes the Finder order key for the characters into the key buffer, which needs room for three times as many characters, and returns the key length; or returns NSNotFound if any character is outside printable ASCII, in which case the string needs the full comparison.  Each character is replaced by its weight from DejalFinderOrderWeights(); each run of digits becomes the number weight, the count of its digits after any leading zeros, then those digits, so comparing keys a character at a time orders numbers by value.  Keys that compare equal may still differ in case or leading zeros.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSUInteger DejalFinderOrderKey(const unichar *characters, NSUInteger length, unichar *key)
+{
+    const uint8_t *weights = DejalFinderOrderWeights();
+    NSUInteger written = 0;
+    NSUInteger i = 0;
+    
+    while (i < length)
+    {
+        unichar character = characters[i];
+        
+        if (character >= 0x80 || !weights[character])
+            return NSNotFound;
+        
+        if (weights[character] != DEJAL_FINDER_KEY_NUMBER)
+        {
+            key[written++] = weights[character];
+            i++;
+            continue;
+        }
+        
+        NSUInteger end = i;
+        
+        while (end < length && characters[end] >= '0' && characters[end] <= '9')
+            end++;
+        
+        while (i < end && characters[i] == '0')
+            i++;
+        
+        if (end - i > USHRT_MAX)
+            return NSNotFound;
+        
+        key[written++] = DEJAL_FINDER_KEY_NUMBER;
+        key[written++] = (unichar)(end - i);
+        
+        while (i < end)
+            key[written++] = characters[i++];
+    }
+    
+    return written;
+}
+
+/**
+ Compares two keys from DejalFinderOrderKey() a character at a time, with a key that is a prefix of the other ordered first.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSComparisonResult DejalCompareFinderOrderKeys(const unichar *key1, NSUInteger length1, const unichar *key2, NSUInteger length2)
+{
+    NSUInteger length = MIN(length1, length2);
+    
+    for (NSUInteger i = 0; i < length; i++)
+        if (key1[i] != key2[i])
+            return key1[i] < key2[i] ? NSOrderedAscending : NSOrderedDescending;
+    
+    if (length1 == length2)
+        return NSOrderedSame;
+    else
+        return length1 < length2 ? NSOrderedAscending : NSOrderedDescending;
+}
 
 
 @implementation NSArray (Dejal)
@@ -296,23 +607,132 @@
 /**
  Returns a copy of the receiver sorted as in the Finder.
  
+ Arrays below the concurrent sort threshold use -localizedStandardCompare:.  Larger arrays precompute a compact key per string via DejalFinderOrderKey(), and stable merge sort across threads.  Two strings that both have keys are ordered by comparing the keys as plain arrays of numbers; otherwise, or if the keys are equal, they get the full Finder comparison, as with -localizedStandardCompare:, with the locale looked up once.  The keys follow the default Unicode collation order for ASCII text, so large arrays can order differently to small ones in locales that change the order of ASCII letters, such as the Danish "aa".
+ 
  @author DJS 2008-01.
+ @version DJS 2026-10: changed to sort large arrays by precomputed numeric-aware keys, with a stable merge sort across threads.
 */
 
 - (NSArray *)dejal_sortedArrayUsingFinderOrder;
 {
-    return [self sortedArrayUsingSelector:@selector(localizedStandardCompare:)];
+    NSUInteger count = self.count;
+    
+    if (count < DEJAL_SORT_CONCURRENT_THRESHOLD)
+        return [self sortedArrayUsingSelector:@selector(localizedStandardCompare:)];
+    
+    NSUInteger *indexes = malloc(count * sizeof(NSUInteger));
+    __unsafe_unretained id *strings = (__unsafe_unretained id *)calloc(count, sizeof(id));
+    __unsafe_unretained id *sorted = (__unsafe_unretained id *)calloc(count, sizeof(id));
+    NSUInteger *keyOffsets = malloc(count * sizeof(NSUInteger));
+    NSUInteger *keyLengths = malloc(count * sizeof(NSUInteger));
+    NSLocale *locale = [NSLocale currentLocale];
+    NSStringCompareOptions options = NSCaseInsensitiveSearch | NSWidthInsensitiveSearch | NSNumericSearch | NSForcedOrderingSearch;
+    NSUInteger keysLength = 0;
+    NSUInteger bufferLength = 0;
+    unichar *buffer = NULL;
+    
+    [self getObjects:strings range:NSMakeRange(0, count)];
+    
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        keyOffsets[i] = keysLength;
+        keysLength += 3 * [strings[i] length];
+    }
+    
+    unichar *keys = malloc(MAX(keysLength, 1) * sizeof(unichar));
+    
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        NSString *string = strings[i];
+        NSUInteger length = string.length;
+        const unichar *characters = CFStringGetCharactersPtr((__bridge CFStringRef)string);
+        
+        if (!characters)
+        {
+            if (length > bufferLength)
+            {
+                bufferLength = length;
+                buffer = realloc(buffer, bufferLength * sizeof(unichar));
+            }
+            
+            [string getCharacters:buffer range:NSMakeRange(0, length)];
+            characters = buffer;
+        }
+        
+        indexes[i] = i;
+        keyLengths[i] = DejalFinderOrderKey(characters, length, keys + keyOffsets[i]);
+    }
+    
+    free(buffer);
+    
+    DejalSortIndexes(indexes, count, ^NSComparisonResult(NSUInteger index1, NSUInteger index2)
+    {
+        if (keyLengths[index1] != NSNotFound && keyLengths[index2] != NSNotFound)
+        {
+            NSComparisonResult result = DejalCompareFinderOrderKeys(keys + keyOffsets[index1], keyLengths[index1], keys + keyOffsets[index2], keyLengths[index2]);
+            
+            if (result != NSOrderedSame)
+                return result;
+        }
+        
+        NSString *string1 = strings[index1];
+        
+        return [string1 compare:strings[index2] options:options range:NSMakeRange(0, string1.length) locale:locale];
+    });
+    
+    for (NSUInteger i = 0; i < count; i++)
+        sorted[i] = strings[indexes[i]];
+    
+    NSArray *result = [NSArray arrayWithObjects:sorted count:count];
+    
+    free(keys);
+    free(keyLengths);
+    free(keyOffsets);
+    free(sorted);
+    free(strings);
+    free(indexes);
+    
+    return result;
 }
 
 /**
  Given a property key (i.e. an accessor name), returns the receiver sorted by that value.  (If the values of the key are not likely to be unique, it'd be better to do this manually, to sort on two keys, and thus avoid random ordering of same primary values.)
  
  @author DJS 2010-10.
+ @version DJS 2026-10: changed to look up each object's value once, rather than in every comparison, then stable merge sort the values (across threads for large arrays), comparing them as NSSortDescriptor does: via -compare:, with nil values first when ascending.
 */
 
 - (NSArray *)dejal_sortedArrayUsingKey:(NSString *)key ascending:(BOOL)ascending;
 {
-    return [self sortedArrayUsingDescriptors:@[[[NSSortDescriptor alloc] initWithKey:key ascending:ascending]]];
+    NSUInteger count = self.count;
+    __strong id *values = (__strong id *)calloc(MAX(count, 1), sizeof(id));
+    NSUInteger i = 0;
+    
+    for (id object in self)
+        values[i++] = [object valueForKeyPath:key];
+    
+    NSArray *result = DejalArraySortedByKeys(self, (__unsafe_unretained id *)(void *)values, ^NSComparisonResult(id value1, id value2)
+    {
+        NSComparisonResult comparison;
+        
+        if (value1 == value2)
+            comparison = NSOrderedSame;
+        else if (!value1)
+            comparison = NSOrderedAscending;
+        else if (!value2)
+            comparison = NSOrderedDescending;
+        else
+            comparison = [value1 compare:value2];
+        
+        return ascending ? comparison : (NSComparisonResult)-comparison;
+    });
+    
+    for (i = 0; i < count; i++)
+        values[i] = nil;
+    
+    free(values);
+    
+    return result;
 }
 
 /**
@@ -405,55 +825,51 @@
         return nil;
 }
 
+/**
+ Returns an index of the receiver's dictionary objects by the value for the specified key, for fast repeated lookups.  Equivalent to -objectMatching:usingKey:, -indexOfObjectMatching:usingKey: and -arrayWithObjectsMatching:usingKey:, but each lookup takes constant time on average instead of scanning the array.  See DejalEquivalenceIndex.
+ 
+ @author DJS 2026-10.
+ */
+
+- (DejalEquivalenceIndex *)dejal_equivalenceIndexUsingKey:(NSString *)key;
+{
+    return [[DejalEquivalenceIndex alloc] initWithArray:self key:key];
+}
+
+/**
+ Returns an index of the receiver's objects by the return value of the specified selector, for fast repeated lookups.  Equivalent to -objectMatching:usingSelector: and -arrayWithObjectsMatching:usingSelector:, but each lookup takes constant time on average instead of scanning the array.  See DejalEquivalenceIndex.
+ 
+ @author DJS 2026-10.
+ */
+
+- (DejalEquivalenceIndex *)dejal_equivalenceIndexUsingSelector:(SEL)selector;
+{
+    return [[DejalEquivalenceIndex alloc] initWithArray:self selector:selector];
+}
+
 /**
  Similar to -copy, but each of the objects in the array are copied too.  Note that like -copy, the array is retained.
  
  @author DJS 2004-06.
  @version DJS 2006-01: changed to fix memory leak through excessive retaining.
+ @version DJS 2026-10: changed to use -dejal_deepCopyMakingMutable:concurrently:, which copies without recursion and shares unchanged immutable contents; the copied arrays and dictionaries are now immutable.
 */
 
 - (id)dejal_deepCopy
 {
-    id array = [[NSMutableArray alloc] init];
-    id copy;
-    
-    for (id object in self)
-    {
-        if ([object respondsToSelector:@selector(dejal_deepCopy)])
-            copy = [object dejal_deepCopy];
-        else
-            copy = [object copy];
-        
-    	[array addObject:copy];
-    }
-    
-    return array;
+    return [self dejal_deepCopyMakingMutable:NO concurrently:NO];
 }
 
 /**
  Similar to -deepCopy, above, but makes all of the contents of the dictionary mutable.
  
  @author DJS 2009-01.
+ @version DJS 2026-10: changed to use -dejal_deepCopyMakingMutable:concurrently:, which copies without recursion.
  */
 
 - (id)dejal_deepMutableCopy;
 {
-    id array = [[NSMutableArray alloc] init];
-    id mutableCopy;
-    
-    for (id object in self)
-    {
-        if ([object respondsToSelector:@selector(dejal_deepMutableCopy)])
-            mutableCopy = [object dejal_deepMutableCopy];
-        else if ([object conformsToProtocol:@protocol(NSMutableCopying)])
-            mutableCopy = [object mutableCopy];
-        else
-            mutableCopy = [object copy];
-        
-    	[array addObject:mutableCopy];
-    }
-    
-    return array;
+    return [self dejal_deepCopyMakingMutable:YES concurrently:NO];
 }
 
 @end
@@ -492,40 +908,58 @@
 
 /**
  Similar to -insertObject:atIndex:, but inserts multiple objects at the index position.
+ 
+ @version DJS 2026-10: changed to insert all of the objects in one operation, instead of one at a time.
 */
 
 - (void)dejal_insertObjectsFromArray:(NSArray *)array atIndex:(NSUInteger)i
 {
-    id object;
+    if (!array.count)
+        return;
     
-    for (object in array)
-    {
-        [self insertObject:object atIndex:i++];
-    }
+    [self insertObjects:array atIndexes:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(i, array.count)]];
 }
 
 /**
  Inserts objects from the specified array at the index position, removing them from their old position if already present.  If the index is invalid, the objects are added to the array (instead of causing an exception).  The adjusted index is returned; it is adjusted if some old indexes were before the new index.
  
+ As before, each object in the array removes the first remaining equal object in the receiver, so an object that appears in the array twice removes two equal objects.  Rather than searching and removing once per object, the objects to remove are counted in a hashed set and found in a single pass, then removed together; the index is reduced by the number of removed objects that were before it.
+ 
  @author DJS 2003-11.
  @version DJS 2007-04: changed to return the adjusted index.
+ @version DJS 2026-10: changed to find and remove the existing objects in a single pass, instead of one search and removal per object.
 */
 
 - (NSUInteger)dejal_insertOrMoveObjectsFromArray:(NSArray *)array atIndex:(NSUInteger)i;
 {
-    id object;
+    NSCountedSet *pending = array.count ? [[NSCountedSet alloc] initWithArray:array] : nil;
+    NSMutableIndexSet *existingIndexes = [NSMutableIndexSet indexSet];
+    NSUInteger remaining = array.count;
+    NSUInteger idx = 0;
+    NSUInteger removedBefore = 0;
     
-    for (object in array)
+    for (id object in self)
     {
-        NSUInteger existing = [self indexOfObject:object];
+        if (!remaining)
+            break;
         
-        if (existing != NSNotFound)
+        if ([pending countForObject:object])
         {
-            if (existing < i)
-                i--;
+            [pending removeObject:object];
+            [existingIndexes addIndex:idx];
+            remaining--;
             
-            [self removeObjectAtIndex:existing];
+            if (idx < i)
+                removedBefore++;
         }
+        
+        idx++;
+    }
+    
+    if (existingIndexes.count)
+    {
+        [self removeObjectsAtIndexes:existingIndexes];
+        i -= removedBefore;
     }
     
     if ([self dejal_isValidIndex:i])
@@ -580,7 +1014,49 @@
 
 - (void)dejal_removeObjectsFromIndexEnumerator:(NSEnumerator *)enumerator
 {
-    [self removeObjectsInArray:[self dejal_arrayWithIndexEnumerator:enumerator]];
+    [self dejal_removeObjectsEqualToObjectsInArray:[self dejal_arrayWithIndexEnumerator:enumerator]];
+}
+
+/**
+ Given an index set (e.g. as returned by -[NSTableView selectedRowIndexes]), this returns a new mutable array containing the corresponding objects from the receiver.  The index set equivalent of -dejal_arrayWithIndexEnumerator:.
+ 
+ @author DJS 2026-10.
+*/
+
+- (NSMutableArray *)dejal_arrayWithIndexSet:(NSIndexSet *)indexes;
+{
+    return [[self objectsAtIndexes:indexes] mutableCopy];
+}
+
+/**
+ Given an index set (e.g. as returned by -[NSTableView selectedRowIndexes]), this removes the corresponding objects from the receiver.  The index set equivalent of -dejal_removeObjectsFromIndexEnumerator:; like that method, any other objects equal to the ones at the indexes are removed too.  Use -removeObjectsAtIndexes: to remove only the objects at the indexes.
+ 
+ @author DJS 2026-10.
+*/
+
+- (void)dejal_removeObjectsFromIndexSet:(NSIndexSet *)indexes;
+{
+    [self dejal_removeObjectsEqualToObjectsInArray:[self objectsAtIndexes:indexes]];
+}
+
+/**
+ Removes all objects equal to any of the objects in the array, like -removeObjectsInArray:, but by looking up each object of the receiver in a hashed set and removing the matches together, so the cost is linear in the sizes of the two arrays.
+ 
+ @author DJS 2026-10.
+*/
+
+- (void)dejal_removeObjectsEqualToObjectsInArray:(NSArray *)array;
+{
+    if (!array.count)
+        return;
+    
+    NSSet *objects = [NSSet setWithArray:array];
+    NSIndexSet *indexes = [self indexesOfObjectsPassingTest:^BOOL(id obj, NSUInteger idx, BOOL *stop)
+    {
+        return [objects containsObject:obj];
+    }];
+    
+    [self removeObjectsAtIndexes:indexes];
 }
 
 /**
@@ -591,7 +1067,7 @@
 
 - (void)dejal_removeObjectsMatching:(id)match usingKey:(NSString *)key
 {
-    [self removeObjectsInArray:[self dejal_arrayWithObjectsMatching:match usingKey:key]];
+    [self dejal_removeObjectsEqualToObjectsInArray:[self dejal_arrayWithObjectsMatching:match usingKey:key]];
 }
 
 /**
@@ -619,7 +1095,7 @@
 }
 
 /**
- Convenience method to use a mutable array as a queue; adds the object to the end of the queue.
+ Convenience method to use a mutable array as a queue; adds the object to the end of the queue.  Note that -dejal_dequeue removes the first object of the array, which can move all of the others, so for large or long-lived queues, use DejalQueue instead.
  
  @author DJS 2014-04.
  */
@@ -674,3 +1150,716 @@
 
 @end
 
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalEquivalenceIndex ()
+
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic) SEL selector;
+@property (nonatomic, strong) NSMutableArray *objects;
+@property (nonatomic, strong) NSMutableArray *bucketKeys;
+@property (nonatomic, strong) NSMutableDictionary *buckets;
+
+@end
+
+
+@implementation DejalEquivalenceIndex
+
+/**
+ Initializes an index of the dictionary objects in the array by the value for the specified key.  Objects that don't respond to -objectForKey:, or don't have a value for the key, are kept (so indexes correspond to the array) but never match.
+ 
+ @param array The objects to index.
+ @param key The dictionary key to match against.
+ @returns A new index.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)initWithArray:(NSArray *)array key:(NSString *)key;
+{
+    if ((self = [super init]))
+    {
+        self.key = key;
+        [self buildWithArray:array];
+    }
+    
+    return self;
+}
+
+/**
+ Initializes an index of the objects in the array by the return value of the specified selector, which must take no parameters and return an object value.
+ 
+ @param array The objects to index.
+ @param selector The accessor to match against.
+ @returns A new index.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)initWithArray:(NSArray *)array selector:(SEL)selector;
+{
+    if ((self = [super init]))
+    {
+        self.selector = selector;
+        [self buildWithArray:array];
+    }
+    
+    return self;
+}
+
+/**
+ Private method to populate the index from the array.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)buildWithArray:(NSArray *)array;
+{
+    NSUInteger count = array.count;
+    
+    self.objects = [NSMutableArray arrayWithCapacity:count];
+    self.bucketKeys = [NSMutableArray arrayWithCapacity:count];
+    self.buckets = [NSMutableDictionary dictionaryWithCapacity:count];
+    
+    for (id object in array)
+        [self addObject:object];
+}
+
+/**
+ Private method to return the value to match for the object, i.e. the value for the key or the selector return value, or nil if none.
+ 
+ @author DJS 2026-10.
+ */
+
+- (id)valueForObject:(id)object;
+{
+    if (self.key)
+        return [object respondsToSelector:@selector(objectForKey:)] ? object[self.key] : nil;
+    else
+        return [object performSelector:self.selector];
+}
+
+/**
+ Private method to add the index to the bucket for the object's value, and return the bucket key, or NSNull if the object has no value (so never matches).
+ 
+ @author DJS 2026-10.
+ */
+
+- (id)addIndex:(NSUInteger)idx forObject:(id)object;
+{
+    NSString *bucketKey = [[self valueForObject:object] dejal_equivalenceKey];
+    
+    if (!bucketKey)
+        return [NSNull null];
+    
+    NSMutableIndexSet *bucket = self.buckets[bucketKey];
+    
+    if (!bucket)
+    {
+        bucket = [NSMutableIndexSet indexSet];
+        self.buckets[bucketKey] = bucket;
+    }
+    
+    [bucket addIndex:idx];
+    
+    return bucketKey;
+}
+
+/**
+ Private method to remove the index from the bucket it was added to, removing the bucket if it is then empty.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)removeIndex:(NSUInteger)idx;
+{
+    id bucketKey = self.bucketKeys[idx];
+    NSMutableIndexSet *bucket = [bucketKey isKindOfClass:[NSString class]] ? self.buckets[bucketKey] : nil;
+    
+    [bucket removeIndex:idx];
+    
+    if (bucket && !bucket.count)
+        [self.buckets removeObjectForKey:bucketKey];
+}
+
+/**
+ Private method to shift the indexes at or after the index, when an object is inserted or removed before the end.  Must be called before the bucket keys array is changed.  Only the buckets holding those indexes are touched: found via the bucket keys of the objects after the index when those are fewer than the buckets (e.g. edits near the end), otherwise by skipping buckets whose last index is before it.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)shiftIndexesStartingAtIndex:(NSUInteger)idx by:(NSInteger)delta;
+{
+    NSUInteger count = self.bucketKeys.count;
+    
+    if (idx >= count)
+        return;
+    
+    if (count - idx < self.buckets.count)
+    {
+        NSMutableSet *shiftKeys = [NSMutableSet setWithCapacity:count - idx];
+        
+        for (NSUInteger i = idx; i < count; i++)
+        {
+            id bucketKey = self.bucketKeys[i];
+            
+            if ([bucketKey isKindOfClass:[NSString class]])
+                [shiftKeys addObject:bucketKey];
+        }
+        
+        for (NSString *bucketKey in shiftKeys)
+            [self.buckets[bucketKey] shiftIndexesStartingAtIndex:idx by:delta];
+    }
+    else
+    {
+        for (NSMutableIndexSet *bucket in self.buckets.objectEnumerator)
+        {
+            NSUInteger lastIndex = bucket.lastIndex;
+            
+            if (lastIndex != NSNotFound && lastIndex >= idx)
+                [bucket shiftIndexesStartingAtIndex:idx by:delta];
+        }
+    }
+}
+
+/**
+ Returns the number of objects in the index.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSUInteger)count;
+{
+    return self.objects.count;
+}
+
+/**
+ Returns the first object whose value is equivalent to the match value (see -isEquivalentTo:), or nil if none are.
+ 
+ @author DJS 2026-10.
+ */
+
+- (id)objectMatching:(id)match;
+{
+    NSUInteger idx = [self indexOfObjectMatching:match];
+    
+    return idx == NSNotFound ? nil : self.objects[idx];
+}
+
+/**
+ Returns the index of the first object whose value is equivalent to the match value (see -isEquivalentTo:), or NSNotFound if none are.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSUInteger)indexOfObjectMatching:(id)match;
+{
+    NSString *bucketKey = [match dejal_equivalenceKey];
+    
+    if (!bucketKey)
+        return NSNotFound;
+    
+    NSIndexSet *bucket = self.buckets[bucketKey];
+    
+    return bucket ? bucket.firstIndex : NSNotFound;
+}
+
+/**
+ Returns a new array of all objects whose value is equivalent to the match value (see -isEquivalentTo:), in index order.  If none are, an empty array is returned.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSArray *)objectsMatching:(id)match;
+{
+    return [self.objects objectsAtIndexes:[self indexesOfObjectsMatching:match]];
+}
+
+/**
+ Returns the indexes of all objects whose value is equivalent to the match value (see -isEquivalentTo:).
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSIndexSet *)indexesOfObjectsMatching:(id)match;
+{
+    NSString *bucketKey = [match dejal_equivalenceKey];
+    NSIndexSet *bucket = bucketKey ? self.buckets[bucketKey] : nil;
+    
+    return bucket ? [bucket copy] : [NSIndexSet indexSet];
+}
+
+/**
+ Adds an object to the end of the index.  Call this when adding an object to the end of the backing mutable array, to keep the index in sync.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)addObject:(id)object;
+{
+    [self.bucketKeys addObject:[self addIndex:self.objects.count forObject:object]];
+    [self.objects addObject:object];
+}
+
+/**
+ Inserts an object into the index.  Call this when inserting an object into the backing mutable array, to keep the index in sync.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)insertObject:(id)object atIndex:(NSUInteger)idx;
+{
+    if (idx == self.objects.count)
+    {
+        [self addObject:object];
+        return;
+    }
+    
+    [self shiftIndexesStartingAtIndex:idx by:1];
+    [self.bucketKeys insertObject:[self addIndex:idx forObject:object] atIndex:idx];
+    [self.objects insertObject:object atIndex:idx];
+}
+
+/**
+ Removes an object from the index.  Call this when removing an object from the backing mutable array, to keep the index in sync.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)removeObjectAtIndex:(NSUInteger)idx;
+{
+    [self removeIndex:idx];
+    [self shiftIndexesStartingAtIndex:idx + 1 by:-1];
+    [self.bucketKeys removeObjectAtIndex:idx];
+    [self.objects removeObjectAtIndex:idx];
+}
+
+/**
+ Replaces an object in the index.  Call this when replacing an object in the backing mutable array, or after changing the value of an indexed object, to keep the index in sync.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)replaceObjectAtIndex:(NSUInteger)idx withObject:(id)object;
+{
+    [self removeIndex:idx];
+    self.bucketKeys[idx] = [self addIndex:idx forObject:object];
+    self.objects[idx] = object;
+}
+
+/**
+ Empties the index.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)removeAllObjects;
+{
+    [self.objects removeAllObjects];
+    [self.bucketKeys removeAllObjects];
+    [self.buckets removeAllObjects];
+}
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+/**
+ Returns the buffer slot for the index from the head of a queue; the capacity is a power of two, so this wraps with a mask.
+ 
+ @author DJS 2026-10.
+ */
+
+static inline NSUInteger DejalQueueSlot(NSUInteger head, NSUInteger idx, NSUInteger capacity)
+{
+    return (head + idx) & (capacity - 1);
+}
+
+
+@implementation DejalQueue
+{
+    void **_buffer;
+    NSUInteger _capacity;
+    NSUInteger _head;
+    NSUInteger _count;
+}
+
+/**
+ Initializes an empty queue.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)init;
+{
+    return [self initWithCapacity:DEJAL_QUEUE_INITIAL_CAPACITY];
+}
+
+/**
+ Initializes an empty queue with room for at least the specified number of objects before it needs to grow.
+ 
+ @param capacity The initial capacity; rounded up to a power of two.
+ @returns A new queue.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+{
+    if ((self = [super init]))
+    {
+        _capacity = DEJAL_QUEUE_INITIAL_CAPACITY;
+        
+        while (_capacity < capacity)
+            _capacity *= 2;
+        
+        _buffer = calloc(_capacity, sizeof(void *));
+    }
+    
+    return self;
+}
+
+- (void)dealloc;
+{
+    [self removeAllObjects];
+    free(_buffer);
+}
+
+/**
+ Returns the number of objects in the queue.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSUInteger)count;
+{
+    return _count;
+}
+
+/**
+ Private method to double the capacity, unwrapping the objects to the start of the new buffer.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)grow;
+{
+    NSUInteger newCapacity = _capacity * 2;
+    void **newBuffer = calloc(newCapacity, sizeof(void *));
+    NSUInteger firstPart = MIN(_count, _capacity - _head);
+    
+    memcpy(newBuffer, _buffer + _head, firstPart * sizeof(void *));
+    memcpy(newBuffer + firstPart, _buffer, (_count - firstPart) * sizeof(void *));
+    
+    free(_buffer);
+    
+    _buffer = newBuffer;
+    _capacity = newCapacity;
+    _head = 0;
+}
+
+/**
+ Returns the first object of the queue, i.e. the next one -dequeue would return, without removing it; or nil if the queue is empty.
+ 
+ @author DJS 2026-10.
+ */
+
+- (id)firstObject;
+{
+    return _count ? (__bridge id)_buffer[_head] : nil;
+}
+
+/**
+ Returns the last object of the queue, i.e. the next one -pop would return, without removing it; or nil if the queue is empty.
+ 
+ @author DJS 2026-10.
+ */
+
+- (id)lastObject;
+{
+    return _count ? (__bridge id)_buffer[DejalQueueSlot(_head, _count - 1, _capacity)] : nil;
+}
+
+/**
+ Adds the object to the end of the queue.  Like -[NSMutableArray dejal_enqueue:], but in constant (amortized) time.  Nil objects are ignored.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)enqueue:(id)obj;
+{
+    if (!obj)
+        return;
+    
+    if (_count == _capacity)
+        [self grow];
+    
+    _buffer[DejalQueueSlot(_head, _count, _capacity)] = (__bridge_retained void *)obj;
+    _count++;
+}
+
+/**
+ Removes the first object from the queue and returns it, or nil if the queue is empty.  Like -[NSMutableArray dejal_dequeue], but in constant time, without moving the other objects.
+ 
+ @author DJS 2026-10.
+ */
+
+- (id)dequeue;
+{
+    if (!_count)
+        return nil;
+    
+    id first = (__bridge_transfer id)_buffer[_head];
+    
+    _buffer[_head] = NULL;
+    _head = DejalQueueSlot(_head, 1, _capacity);
+    _count--;
+    
+    return first;
+}
+
+/**
+ Adds the object to the top (end) of the stack.  The same as -enqueue:, as with the NSMutableArray methods, so one object can be used as both a queue and a stack.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)push:(id)obj;
+{
+    [self enqueue:obj];
+}
+
+/**
+ Removes the top (end) object from the stack and returns it, or nil if the stack is empty.
+ 
+ @author DJS 2026-10.
+ */
+
+- (id)pop;
+{
+    if (!_count)
+        return nil;
+    
+    NSUInteger slot = DejalQueueSlot(_head, _count - 1, _capacity);
+    id last = (__bridge_transfer id)_buffer[slot];
+    
+    _buffer[slot] = NULL;
+    _count--;
+    
+    return last;
+}
+
+/**
+ Removes all of the objects.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)removeAllObjects;
+{
+    while (_count)
+    {
+        NSUInteger slot = DejalQueueSlot(_head, --_count, _capacity);
+        
+        CFRelease(_buffer[slot]);
+        _buffer[slot] = NULL;
+    }
+    
+    _head = 0;
+}
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+typedef struct
+{
+    atomic_size_t sequence;
+    void *object;
+} DejalConcurrentQueueCell;
+
+
+@implementation DejalConcurrentQueue
+{
+    DejalConcurrentQueueCell *_cells;
+    size_t _mask;
+    char _padding1[DEJAL_CACHE_LINE_SIZE];
+    atomic_size_t _enqueuePosition;
+    char _padding2[DEJAL_CACHE_LINE_SIZE];
+    atomic_size_t _dequeuePosition;
+    char _padding3[DEJAL_CACHE_LINE_SIZE];
+}
+
+/**
+ Initializes an empty concurrent queue with the default capacity.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)init;
+{
+    return [self initWithCapacity:DEJAL_CONCURRENT_QUEUE_DEFAULT_CAPACITY];
+}
+
+/**
+ Initializes an empty concurrent queue that can hold up to the specified number of objects.  Each cell carries a sequence number that says whether it is ready to be written or read for a given position, so producers and consumers only contend on the position they claim with a compare-and-swap, and never take a lock.
+ 
+ @param capacity The maximum number of objects; rounded up to a power of two, and at least two.
+ @returns A new queue.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+{
+    if ((self = [super init]))
+    {
+        size_t size = 2;
+        
+        while (size < capacity)
+            size *= 2;
+        
+        _cells = calloc(size, sizeof(DejalConcurrentQueueCell));
+        _mask = size - 1;
+        
+        for (size_t i = 0; i < size; i++)
+            atomic_init(&_cells[i].sequence, i);
+        
+        atomic_init(&_enqueuePosition, 0);
+        atomic_init(&_dequeuePosition, 0);
+    }
+    
+    return self;
+}
+
+- (void)dealloc;
+{
+    while ([self dequeue])
+        ;
+    
+    free(_cells);
+}
+
+/**
+ Returns the maximum number of objects the queue can hold.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSUInteger)capacity;
+{
+    return _mask + 1;
+}
+
+/**
+ Returns the number of objects in the queue.  Only a snapshot when other threads are using the queue.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSUInteger)count;
+{
+    size_t dequeuePosition = atomic_load_explicit(&_dequeuePosition, memory_order_relaxed);
+    size_t enqueuePosition = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+    
+    return enqueuePosition > dequeuePosition ? MIN(enqueuePosition - dequeuePosition, _mask + 1) : 0;
+}
+
+/**
+ Adds the object to the end of the queue, if there is room.  Safe to call from any number of threads at once.  Nil objects are ignored.
+ 
+ @returns YES if the object was added, or NO if the queue was full (or the object nil).
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)enqueue:(id)obj;
+{
+    if (!obj)
+        return NO;
+    
+    DejalConcurrentQueueCell *cell;
+    size_t position = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+    
+    for (;;)
+    {
+        cell = &_cells[position & _mask];
+        
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&_enqueuePosition, &position, position + 1, memory_order_relaxed, memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+        {
+            return NO;
+        }
+        else
+        {
+            position = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+        }
+    }
+    
+    cell->object = (__bridge_retained void *)obj;
+    atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+    
+    return YES;
+}
+
+/**
+ Removes the first object from the queue and returns it, or nil if the queue is empty.  Safe to call from any number of threads at once.
+ 
+ @author DJS 2026-10.
+ */
+
+- (id)dequeue;
+{
+    DejalConcurrentQueueCell *cell;
+    size_t position = atomic_load_explicit(&_dequeuePosition, memory_order_relaxed);
+    
+    for (;;)
+    {
+        cell = &_cells[position & _mask];
+        
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+        
+        if (difference == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&_dequeuePosition, &position, position + 1, memory_order_relaxed, memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+        {
+            return nil;
+        }
+        else
+        {
+            position = atomic_load_explicit(&_dequeuePosition, memory_order_relaxed);
+        }
+    }
+    
+    id first = (__bridge_transfer id)cell->object;
+    
+    cell->object = NULL;
+    atomic_store_explicit(&cell->sequence, position + _mask + 1, memory_order_release);
+    
+    return first;
+}
+
+@end
@@ -28,11 +28,128 @@
 //
 
 
+typedef NS_OPTIONS(NSUInteger, DejalBase64Options)
+{
+    DejalBase64URLSafe = 1 << 0,
+    DejalBase64OmitPadding = 1 << 1,
+    DejalBase64Strict = 1 << 2
+};
+
+
 @interface NSData (Dejal)
 
 + (NSData *)dejal_dataWithObject:(id)rootObject;
 
 - (id)dejal_objectOfClass:(Class)class;
 
++ (NSData *)dejal_compactDataWithObject:(id)rootObject;
+- (id)dejal_compactObject;
+
++ (NSData *)dejal_dataWithBase64String:(NSString *)string options:(DejalBase64Options)options;
+- (NSData *)dejal_dataByDecodingBase64WithOptions:(DejalBase64Options)options;
+- (NSString *)dejal_base64EncodedStringWithOptions:(DejalBase64Options)options;
+- (NSData *)dejal_base64EncodedDataWithOptions:(DejalBase64Options)options;
+
+- (uint64_t)dejal_hash64;
+- (uint64_t)dejal_hash64WithSeed:(uint64_t)seed;
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalCompactDataWriter : NSObject
+
+@property (nonatomic, readonly) NSData *data;
+
+- (instancetype)init;
+- (instancetype)initWithPath:(NSString *)path;
+
+- (BOOL)writeObject:(id)object;
+
+- (BOOL)beginArray;
+- (BOOL)beginDictionary;
+- (BOOL)writeKey:(NSString *)key;
+- (BOOL)endContainer;
+
+- (BOOL)finish;
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalCompactDataReader : NSObject
+
+@property (nonatomic, readonly) id rootObject;
+
++ (instancetype)readerWithContentsOfFile:(NSString *)path;
+
+- (instancetype)initWithData:(NSData *)data;
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalBase64Coder : NSObject
+
+@property (nonatomic, readonly) DejalBase64Options options;
+@property (nonatomic, readonly) NSData *data;
+
+- (instancetype)initWithOptions:(DejalBase64Options)options;
+- (instancetype)initWithPath:(NSString *)path options:(DejalBase64Options)options;
+
+- (BOOL)appendBytes:(const void *)bytes length:(NSUInteger)length;
+- (BOOL)appendData:(NSData *)data;
+- (BOOL)appendContentsOfStream:(NSInputStream *)stream;
+- (BOOL)appendContentsOfFile:(NSString *)path;
+
+- (BOOL)finish;
+
+@end
+
+
+@interface DejalBase64Encoder : DejalBase64Coder
+
+@end
+
+
+@interface DejalBase64Decoder : DejalBase64Coder
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalHasher : NSObject
+
+@property (nonatomic, readonly) uint64_t seed;
+@property (nonatomic, readonly) unsigned long long length;
+@property (nonatomic, readonly) uint64_t hashValue;
+
+- (instancetype)init;
+- (instancetype)initWithSeed:(uint64_t)seed;
+
+- (void)appendBytes:(const void *)bytes length:(NSUInteger)length;
+- (void)appendData:(NSData *)data;
+- (void)appendString:(NSString *)string;
+- (BOOL)appendContentsOfStream:(NSInputStream *)stream;
+- (BOOL)appendContentsOfFile:(NSString *)path;
+
+- (void)reset;
+
 @end
 
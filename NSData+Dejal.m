@@ -28,33 +28,2694 @@
 //
 
 #import "NSData+Dejal.h"
+#import <stdatomic.h>
+
+#if defined(__x86_64__)
+#import <immintrin.h>
+#define DEJAL_BASE64_X86 1
+#endif
+
+
+// Magic bytes at the start and end of the compact data format, and its version:
+#define DEJAL_COMPACT_DATA_MAGIC "DJBP"
+#define DEJAL_COMPACT_DATA_VERSION 1
+
+// Length of the header (magic and version) and trailer (string table offset, root offset, and magic):
+#define DEJAL_COMPACT_DATA_HEADER_LENGTH 5
+#define DEJAL_COMPACT_DATA_TRAILER_LENGTH 20
+
+// Number of buffered bytes at which a compact data file writer writes to the file:
+#define DEJAL_COMPACT_DATA_FLUSH_LENGTH 65536
+
+// Record tags of the compact data format:
+typedef NS_ENUM(uint8_t, DejalCompactDataTag)
+{
+    DejalCompactDataTagInteger = 1,
+    DejalCompactDataTagUnsignedInteger,
+    DejalCompactDataTagDouble,
+    DejalCompactDataTagFalse,
+    DejalCompactDataTagTrue,
+    DejalCompactDataTagString,
+    DejalCompactDataTagDate,
+    DejalCompactDataTagData,
+    DejalCompactDataTagArray,
+    DejalCompactDataTagDictionary,
+    DejalCompactDataTagNull
+};
+
+
+/**
+ Appends the value as an unsigned LEB128 varint, i.e. seven bits per byte, low bits first, with the high bit set on all but the last byte.
+ 
+ @author DJS 2026-10.
+ */
+
+static void DejalAppendVarint(NSMutableData *data, uint64_t value)
+{
+    uint8_t buffer[10];
+    NSUInteger length = 0;
+    
+    do
+    {
+        buffer[length] = value & 0x7F;
+        value >>= 7;
+        
+        if (value)
+            buffer[length] |= 0x80;
+        
+        length++;
+    }
+    while (value);
+    
+    [data appendBytes:buffer length:length];
+}
+
+/**
+ Appends the low width bytes of the value, little-endian.
+ 
+ @author DJS 2026-10.
+ */
+
+static void DejalAppendLittleEndian(NSMutableData *data, uint64_t value, NSUInteger width)
+{
+    uint8_t buffer[8];
+    
+    for (NSUInteger i = 0; i < width; i++)
+        buffer[i] = (uint8_t)(value >> (8 * i));
+    
+    [data appendBytes:buffer length:width];
+}
+
+/**
+ Reads an unsigned LEB128 varint at the position, advancing it.  Returns NO if the varint runs past the length or is too long.
+ 
+ @author DJS 2026-10.
+ */
+
+static BOOL DejalReadVarint(const uint8_t *bytes, uint64_t length, uint64_t *position, uint64_t *value)
+{
+    uint64_t result = 0;
+    
+    for (unsigned shift = 0; shift < 64 && *position < length; shift += 7)
+    {
+        uint8_t byte = bytes[(*position)++];
+        
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        
+        if (!(byte & 0x80))
+        {
+            *value = result;
+            return YES;
+        }
+    }
+    
+    return NO;
+}
+
+/**
+ Reads width bytes as a little-endian unsigned value.
+ 
+ @author DJS 2026-10.
+ */
+
+static inline uint64_t DejalReadLittleEndian(const uint8_t *bytes, NSUInteger width)
+{
+    uint64_t value = 0;
+    
+    for (NSUInteger i = width; i > 0; i--)
+        value = (value << 8) | bytes[i - 1];
+    
+    return value;
+}
+
+/**
+ Returns the object cached in the slot, or if there isn't one yet, stores the object there (unless another thread got there first) and returns whichever is cached.  Lets the lazy containers cache decoded values without a lock.
+ 
+ @author DJS 2026-10.
+ */
+
+static id DejalCacheObjectInSlot(_Atomic(void *) *slot, id object)
+{
+    void *expected = NULL;
+    void *retained = (__bridge_retained void *)object;
+    
+    if (atomic_compare_exchange_strong(slot, &expected, retained))
+        return object;
+    
+    CFRelease(retained);
+    
+    return (__bridge id)expected;
+}
+
+/**
+ Releases the objects cached in the slots, and frees them.
+ 
+ @author DJS 2026-10.
+ */
+
+static void DejalFreeSlots(_Atomic(void *) *slots, NSUInteger count)
+{
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        void *object = atomic_load(&slots[i]);
+        
+        if (object)
+            CFRelease(object);
+    }
+    
+    free(slots);
+}
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+// Number of input bytes the Base64 coders process at a time; a multiple of both 3 and 4:
+#define DEJAL_BASE64_CHUNK_LENGTH 49152
+
+// Number of characters of a string the Base64 decoder converts at a time, when it can't access them directly:
+#define DEJAL_STACK_BASE64_LENGTH 4096
+
+// Entries in the Base64 decoding tables for characters outside the alphabet; both have the top bits set:
+#define DEJAL_BASE64_INVALID 0xFF
+#define DEJAL_BASE64_PADDING 0xFE
+
+static const char DejalBase64StandardAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char DejalBase64URLSafeAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+
+typedef struct
+{
+    const char *alphabet;
+    BOOL pad;
+    uint8_t pending[2];
+    NSUInteger pendingLength;
+} DejalBase64EncoderState;
+
+
+typedef struct
+{
+    const uint8_t *table;
+    char character62;
+    char character63;
+    BOOL strict;
+    BOOL requirePadding;
+    BOOL failed;
+    uint32_t bits;
+    NSUInteger sextets;
+    NSUInteger padding;
+} DejalBase64DecoderState;
+
+
+#if DEJAL_BASE64_X86
+
+/**
+ Returns the vector instruction level available for Base64 coding: 2 for AVX2, 1 for SSSE3, or 0 for the scalar code only.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSUInteger DejalBase64VectorLevel(void)
+{
+    static NSUInteger level = 0;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^
+                  {
+                      __builtin_cpu_init();
+                      
+                      if (__builtin_cpu_supports("avx2"))
+                          level = 2;
+                      else if (__builtin_cpu_supports("ssse3"))
+                          level = 1;
+                  });
+    
+    return level;
+}
+
+#endif
+
+/**
+ Returns a table mapping each byte to its Base64 value in the standard or URL-safe alphabet, or DEJAL_BASE64_PADDING for "=", or DEJAL_BASE64_INVALID.
+ 
+ @author DJS 2026-10.
+ */
+
+static const uint8_t *DejalBase64DecodingTable(BOOL urlSafe)
+{
+    static uint8_t tables[2][256];
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^
+                  {
+                      memset(tables, DEJAL_BASE64_INVALID, sizeof(tables));
+                      
+                      for (NSUInteger value = 0; value < 64; value++)
+                      {
+                          tables[0][(uint8_t)DejalBase64StandardAlphabet[value]] = (uint8_t)value;
+                          tables[1][(uint8_t)DejalBase64URLSafeAlphabet[value]] = (uint8_t)value;
+                      }
+                      
+                      for (NSUInteger table = 0; table < 2; table++)
+                          tables[table]['='] = DEJAL_BASE64_PADDING;
+                  });
+    
+    return tables[urlSafe ? 1 : 0];
+}
+
+/**
+ Encodes three bytes as four Base64 characters.
+ 
+ @author DJS 2026-10.
+ */
+
+static inline void DejalBase64EncodeTriplet(const uint8_t *input, uint8_t *output, const char *alphabet)
+{
+    uint32_t triplet = ((uint32_t)input[0] << 16) | ((uint32_t)input[1] << 8) | input[2];
+    
+    output[0] = (uint8_t)alphabet[triplet >> 18];
+    output[1] = (uint8_t)alphabet[(triplet >> 12) & 0x3F];
+    output[2] = (uint8_t)alphabet[(triplet >> 6) & 0x3F];
+    output[3] = (uint8_t)alphabet[triplet & 0x3F];
+}
+
+#if DEJAL_BASE64_X86
+
+/**
+ Splits each group of three bytes, spread over the four bytes of each 32-bit lane as (1, 0, 2, 1), into four 6-bit values, then maps them to the alphabet: values are reduced to a class index (13 for A-Z, 0 for a-z, 1-10 for digits, 11 and 12 for the last two characters), which looks up the offset to add.
+ 
+ @author DJS 2026-10.
+ */
+
+__attribute__((target("ssse3")))
+static inline __m128i DejalBase64EncodeVector128(__m128i input, __m128i offsets)
+{
+    __m128i high = _mm_mulhi_epu16(_mm_and_si128(input, _mm_set1_epi32(0x0FC0FC00)), _mm_set1_epi32(0x04000040));
+    __m128i low = _mm_mullo_epi16(_mm_and_si128(input, _mm_set1_epi32(0x003F03F0)), _mm_set1_epi32(0x01000010));
+    __m128i values = _mm_or_si128(high, low);
+    __m128i classes = _mm_subs_epu8(values, _mm_set1_epi8(51));
+    
+    classes = _mm_or_si128(classes, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), values), _mm_set1_epi8(13)));
+    
+    return _mm_add_epi8(values, _mm_shuffle_epi8(offsets, classes));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i DejalBase64EncodeVector256(__m256i input, __m256i offsets)
+{
+    __m256i high = _mm256_mulhi_epu16(_mm256_and_si256(input, _mm256_set1_epi32(0x0FC0FC00)), _mm256_set1_epi32(0x04000040));
+    __m256i low = _mm256_mullo_epi16(_mm256_and_si256(input, _mm256_set1_epi32(0x003F03F0)), _mm256_set1_epi32(0x01000010));
+    __m256i values = _mm256_or_si256(high, low);
+    __m256i classes = _mm256_subs_epu8(values, _mm256_set1_epi8(51));
+    
+    classes = _mm256_or_si256(classes, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), values), _mm256_set1_epi8(13)));
+    
+    return _mm256_add_epi8(values, _mm256_shuffle_epi8(offsets, classes));
+}
+
+/**
+ Returns the offsets to add to each class index from DejalBase64EncodeVector128() to get the character.
+ 
+ @author DJS 2026-10.
+ */
+
+__attribute__((target("ssse3")))
+static inline __m128i DejalBase64EncodingOffsets(const char *alphabet)
+{
+    return _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, (char)(alphabet[62] - 62), (char)(alphabet[63] - 63), 'A', 0, 0);
+}
+
+/**
+ Encodes 12 bytes at a time with SSSE3, or 24 with AVX2, while at least 4 more bytes can be read after each group.  Returns the number of bytes encoded.
+ 
+ @author DJS 2026-10.
+ */
+
+__attribute__((target("ssse3")))
+static NSUInteger DejalBase64EncodeSSSE3(const uint8_t *input, NSUInteger length, uint8_t *output, const char *alphabet)
+{
+    const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i offsets = DejalBase64EncodingOffsets(alphabet);
+    NSUInteger i = 0;
+    
+    for (; i + 16 <= length; i += 12, output += 16)
+    {
+        __m128i block = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(input + i)), shuffle);
+        
+        _mm_storeu_si128((__m128i *)output, DejalBase64EncodeVector128(block, offsets));
+    }
+    
+    return i;
+}
+
+__attribute__((target("avx2")))
+static NSUInteger DejalBase64EncodeAVX2(const uint8_t *input, NSUInteger length, uint8_t *output, const char *alphabet)
+{
+    const __m256i shuffle = _mm256_broadcastsi128_si256(_mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m256i offsets = _mm256_broadcastsi128_si256(DejalBase64EncodingOffsets(alphabet));
+    NSUInteger i = 0;
+    
+    for (; i + 28 <= length; i += 24, output += 32)
+    {
+        __m256i block = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(input + i))), _mm_loadu_si128((const __m128i *)(input + i + 12)), 1);
+        
+        block = _mm256_shuffle_epi8(block, shuffle);
+        _mm256_storeu_si256((__m256i *)output, DejalBase64EncodeVector256(block, offsets));
+    }
+    
+    return i;
+}
+
+#endif
+
+/**
+ Encodes the complete groups of three bytes in the input, using vector instructions where available, and returns the number of bytes encoded; the output gets four characters for every three.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSUInteger DejalBase64EncodeBlocks(const uint8_t *input, NSUInteger length, uint8_t *output, const char *alphabet)
+{
+    NSUInteger i = 0;
+    
+#if DEJAL_BASE64_X86
+    NSUInteger level = DejalBase64VectorLevel();
+    
+    if (level >= 2)
+        i = DejalBase64EncodeAVX2(input, length, output, alphabet);
+    
+    if (level >= 1)
+        i += DejalBase64EncodeSSSE3(input + i, length - i, output + i / 3 * 4, alphabet);
+#endif
+    
+    for (; i + 3 <= length; i += 3)
+        DejalBase64EncodeTriplet(input + i, output + i / 3 * 4, alphabet);
+    
+    return i;
+}
+
+/**
+ Encodes the input, carrying up to two bytes that don't complete a group over to the next call (or DejalBase64FinishEncoding()) via the state.  The output must have room for four characters for every three bytes, including those carried over, so (length / 3 + 1) * 4 is always enough.  Returns the number of characters encoded.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSUInteger DejalBase64Encode(DejalBase64EncoderState *state, const uint8_t *input, NSUInteger length, uint8_t *output)
+{
+    NSUInteger count = 0;
+    
+    if (state->pendingLength)
+    {
+        uint8_t triplet[3] = {state->pending[0], state->pending[1], 0};
+        
+        while (state->pendingLength < 3 && length)
+        {
+            triplet[state->pendingLength++] = *input++;
+            length--;
+        }
+        
+        if (state->pendingLength < 3)
+        {
+            memcpy(state->pending, triplet, state->pendingLength);
+            return 0;
+        }
+        
+        DejalBase64EncodeTriplet(triplet, output, state->alphabet);
+        state->pendingLength = 0;
+        count = 4;
+    }
+    
+    NSUInteger encoded = DejalBase64EncodeBlocks(input, length, output + count, state->alphabet);
+    
+    count += encoded / 3 * 4;
+    state->pendingLength = length - encoded;
+    memcpy(state->pending, input + encoded, state->pendingLength);
+    
+    return count;
+}
+
+/**
+ Encodes the bytes carried over in the state, with padding if wanted.  The group is encoded into a local buffer and only the characters used are copied, so the output only needs room for the result: four characters with padding, or one more than the bytes carried over without, as DejalBase64EncodedLength() allows for.  Returns the number of characters encoded.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSUInteger DejalBase64FinishEncoding(DejalBase64EncoderState *state, uint8_t *output)
+{
+    NSUInteger pendingLength = state->pendingLength;
+    
+    if (!pendingLength)
+        return 0;
+    
+    uint8_t triplet[3] = {state->pending[0], pendingLength > 1 ? state->pending[1] : 0, 0};
+    uint8_t quad[4];
+    NSUInteger count = pendingLength + 1;
+    
+    DejalBase64EncodeTriplet(triplet, quad, state->alphabet);
+    state->pendingLength = 0;
+    
+    if (state->pad)
+    {
+        for (; count < 4; count++)
+            quad[count] = '=';
+    }
+    
+    memcpy(output, quad, count);
+    
+    return count;
+}
+
+/**
+ Returns the number of characters in the Base64 encoding of length bytes.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSUInteger DejalBase64EncodedLength(NSUInteger length, BOOL pad)
+{
+    NSUInteger remainder = length % 3;
+    
+    return length / 3 * 4 + (remainder ? (pad ? 4 : remainder + 1) : 0);
+}
+
+#if DEJAL_BASE64_X86
+
+/**
+ Maps sixteen characters to their Base64 values, returning NO if any is outside the alphabet.  Characters are classified by range with signed comparisons, so bytes over 0x7F, being negative, aren't in any range.
+ 
+ @author DJS 2026-10.
+ */
+
+__attribute__((target("ssse3")))
+static inline BOOL DejalBase64DecodeVector128(__m128i input, const DejalBase64DecoderState *state, __m128i *values)
+{
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8('A' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), input));
+    __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8('a' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), input));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8('0' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), input));
+    __m128i is62 = _mm_cmpeq_epi8(input, _mm_set1_epi8(state->character62));
+    __m128i is63 = _mm_cmpeq_epi8(input, _mm_set1_epi8(state->character63));
+    __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, _mm_or_si128(is62, is63)));
+    
+    if (_mm_movemask_epi8(valid) != 0xFFFF)
+        return NO;
+    
+    __m128i offsets = _mm_or_si128(_mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')), _mm_and_si128(lower, _mm_set1_epi8(26 - 'a'))), _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+    
+    offsets = _mm_or_si128(offsets, _mm_or_si128(_mm_and_si128(is62, _mm_set1_epi8((char)(62 - state->character62))), _mm_and_si128(is63, _mm_set1_epi8((char)(63 - state->character63)))));
+    
+    *values = _mm_add_epi8(input, offsets);
+    
+    return YES;
+}
+
+/**
+ Packs the 6-bit values in each 32-bit lane into three bytes at the start of the lane, then gathers those into the first twelve bytes of the vector.
+ 
+ @author DJS 2026-10.
+ */
+
+__attribute__((target("ssse3")))
+static inline __m128i DejalBase64PackVector128(__m128i values)
+{
+    __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+    __m128i lanes = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+    
+    return _mm_shuffle_epi8(lanes, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+/**
+ Decodes 16 characters at a time with SSSE3, or 32 with AVX2, until a group includes a character outside the alphabet.  Returns the number of characters decoded; the output gets three bytes for every four.
+ 
+ @author DJS 2026-10.
+ */
+
+__attribute__((target("ssse3")))
+static NSUInteger DejalBase64DecodeSSSE3(const uint8_t *input, NSUInteger length, uint8_t *output, const DejalBase64DecoderState *state)
+{
+    uint8_t packed[16];
+    NSUInteger i = 0;
+    
+    for (; i + 16 <= length; i += 16, output += 12)
+    {
+        __m128i values;
+        
+        if (!DejalBase64DecodeVector128(_mm_loadu_si128((const __m128i *)(input + i)), state, &values))
+            break;
+        
+        _mm_storeu_si128((__m128i *)packed, DejalBase64PackVector128(values));
+        memcpy(output, packed, 12);
+    }
+    
+    return i;
+}
+
+__attribute__((target("avx2")))
+static NSUInteger DejalBase64DecodeAVX2(const uint8_t *input, NSUInteger length, uint8_t *output, const DejalBase64DecoderState *state)
+{
+    uint8_t packed[32];
+    NSUInteger i = 0;
+    
+    for (; i + 32 <= length; i += 32, output += 24)
+    {
+        __m128i low, high;
+        
+        if (!DejalBase64DecodeVector128(_mm_loadu_si128((const __m128i *)(input + i)), state, &low) || !DejalBase64DecodeVector128(_mm_loadu_si128((const __m128i *)(input + i + 16)), state, &high))
+            break;
+        
+        __m256i values = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+        __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        __m256i lanes = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+        
+        lanes = _mm256_shuffle_epi8(lanes, _mm256_broadcastsi128_si256(_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)));
+        _mm256_storeu_si256((__m256i *)packed, lanes);
+        memcpy(output, packed, 12);
+        memcpy(output + 12, packed + 16, 12);
+    }
+    
+    return i;
+}
+
+#endif
+
+/**
+ Decodes the groups of four characters at the start of the input, using vector instructions where available, until a group includes a character outside the alphabet.  Returns the number of characters decoded; the output gets three bytes for every four.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSUInteger DejalBase64DecodeBlocks(const uint8_t *input, NSUInteger length, uint8_t *output, const DejalBase64DecoderState *state)
+{
+    const uint8_t *table = state->table;
+    NSUInteger i = 0;
+    
+#if DEJAL_BASE64_X86
+    NSUInteger level = DejalBase64VectorLevel();
+    
+    if (level >= 2)
+        i = DejalBase64DecodeAVX2(input, length, output, state);
+    
+    if (level >= 1)
+        i += DejalBase64DecodeSSSE3(input + i, length - i, output + i / 4 * 3, state);
+#endif
+    
+    for (; i + 4 <= length; i += 4)
+    {
+        uint32_t a = table[input[i]], b = table[input[i + 1]], c = table[input[i + 2]], d = table[input[i + 3]];
+        
+        if ((a | b | c | d) & 0xC0)
+            break;
+        
+        uint32_t triplet = (a << 18) | (b << 12) | (c << 6) | d;
+        uint8_t *bytes = output + i / 4 * 3;
+        
+        bytes[0] = (uint8_t)(triplet >> 16);
+        bytes[1] = (uint8_t)(triplet >> 8);
+        bytes[2] = (uint8_t)triplet;
+    }
+    
+    return i;
+}
+
+/**
+ Outputs the bytes of an incomplete group of 6-bit values in the state, i.e. one byte for two values or two for three.  Fails if there's a single value, which can't make a byte, or when strict, if the unused bits aren't zero.  Returns the number of bytes output.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSUInteger DejalBase64DecodePartialGroup(DejalBase64DecoderState *state, uint8_t *output)
+{
+    NSUInteger sextets = state->sextets;
+    uint32_t bits = state->bits;
+    
+    state->sextets = 0;
+    state->bits = 0;
+    
+    if (sextets < 2)
+    {
+        if (sextets)
+            state->failed = YES;
+        
+        return 0;
+    }
+    
+    NSUInteger unusedBits = sextets == 2 ? 4 : 2;
+    
+    if (state->strict && (bits & ((1u << unusedBits) - 1)))
+        state->failed = YES;
+    
+    bits >>= unusedBits;
+    
+    if (sextets == 2)
+    {
+        output[0] = (uint8_t)bits;
+        return 1;
+    }
+    
+    output[0] = (uint8_t)(bits >> 8);
+    output[1] = (uint8_t)bits;
+    
+    return 2;
+}
+
+/**
+ Decodes the input, carrying an incomplete group of characters over to the next call (or DejalBase64FinishDecoding()) via the state.  Decoding fails on misplaced padding, or characters after it; strict decoding also fails on any character outside the alphabet, while lenient decoding ignores them, as NSDataBase64DecodingIgnoreUnknownCharacters does.  The output must have room for three bytes for every four characters, including those carried over, so (length / 4 + 2) * 3 is always enough.  Returns the number of bytes decoded; check the state for failure.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSUInteger DejalBase64Decode(DejalBase64DecoderState *state, const uint8_t *input, NSUInteger length, uint8_t *output)
+{
+    const uint8_t *table = state->table;
+    NSUInteger count = 0;
+    NSUInteger i = 0;
+    
+    while (i < length && !state->failed)
+    {
+        if (!state->sextets && !state->padding)
+        {
+            NSUInteger decoded = DejalBase64DecodeBlocks(input + i, length - i, output + count, state);
+            
+            i += decoded;
+            count += decoded / 4 * 3;
+            
+            if (i == length)
+                break;
+        }
+        
+        uint8_t value = table[input[i++]];
+        
+        if (value < 64)
+        {
+            if (state->padding)
+            {
+                state->failed = YES;
+                break;
+            }
+            
+            state->bits = (state->bits << 6) | value;
+            
+            if (++state->sextets == 4)
+            {
+                output[count++] = (uint8_t)(state->bits >> 16);
+                output[count++] = (uint8_t)(state->bits >> 8);
+                output[count++] = (uint8_t)state->bits;
+                state->sextets = 0;
+                state->bits = 0;
+            }
+        }
+        else if (value == DEJAL_BASE64_PADDING)
+        {
+            if (state->sextets + state->padding < 2 || state->sextets + state->padding >= 4 || (state->strict && !state->requirePadding))
+                state->failed = YES;
+            
+            state->padding++;
+        }
+        else if (state->strict)
+        {
+            state->failed = YES;
+        }
+    }
+    
+    return count;
+}
+
+/**
+ Decodes the incomplete group carried over in the state, checking that it was padded unless DejalBase64OmitPadding was passed.  The output must have room for two bytes.  Returns the number of bytes decoded; check the state for failure.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSUInteger DejalBase64FinishDecoding(DejalBase64DecoderState *state, uint8_t *output)
+{
+    if (state->requirePadding && state->sextets && state->sextets + state->padding != 4)
+        state->failed = YES;
+    
+    state->padding = 0;
+    
+    return DejalBase64DecodePartialGroup(state, output);
+}
+
+/**
+ Prepares the state for encoding or decoding with the options.
+ 
+ @author DJS 2026-10.
+ */
+
+static void DejalBase64SetUpEncoderState(DejalBase64EncoderState *state, DejalBase64Options options)
+{
+    memset(state, 0, sizeof(*state));
+    state->alphabet = options & DejalBase64URLSafe ? DejalBase64URLSafeAlphabet : DejalBase64StandardAlphabet;
+    state->pad = !(options & DejalBase64OmitPadding);
+}
+
+static void DejalBase64SetUpDecoderState(DejalBase64DecoderState *state, DejalBase64Options options)
+{
+    BOOL urlSafe = (options & DejalBase64URLSafe) != 0;
+    BOOL strict = (options & DejalBase64Strict) != 0;
+    
+    memset(state, 0, sizeof(*state));
+    state->table = DejalBase64DecodingTable(urlSafe);
+    state->strict = strict;
+    state->requirePadding = !(options & DejalBase64OmitPadding);
+    state->character62 = urlSafe ? '-' : '+';
+    state->character63 = urlSafe ? '_' : '/';
+}
+
+
+/**
+ Returns a malloc'd buffer of the bytes encoded as Base64, setting the encoded length.
+ 
+ @author DJS 2026-10.
+ */
+
+static uint8_t *DejalBase64EncodedBytes(const uint8_t *bytes, NSUInteger length, DejalBase64Options options, NSUInteger *encodedLength)
+{
+    DejalBase64EncoderState state;
+    uint8_t *output = malloc(MAX(DejalBase64EncodedLength(length, !(options & DejalBase64OmitPadding)), 1));
+    
+    DejalBase64SetUpEncoderState(&state, options);
+    
+    NSUInteger count = DejalBase64Encode(&state, bytes, length, output);
+    
+    *encodedLength = count + DejalBase64FinishEncoding(&state, output + count);
+    
+    return output;
+}
+
+/**
+ Returns data decoded from the Base64 bytes, or nil if decoding fails.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSData *DejalBase64DecodedData(const uint8_t *bytes, NSUInteger length, DejalBase64Options options)
+{
+    DejalBase64DecoderState state;
+    uint8_t *output = malloc((length / 4 + 2) * 3);
+    
+    DejalBase64SetUpDecoderState(&state, options);
+    
+    NSUInteger count = DejalBase64Decode(&state, bytes, length, output);
+    
+    count += DejalBase64FinishDecoding(&state, output + count);
+    
+    if (state.failed)
+    {
+        free(output);
+        return nil;
+    }
+    
+    return [NSData dataWithBytesNoCopy:output length:count freeWhenDone:YES];
+}
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+// Number of bytes the hasher reads from a stream at a time:
+#define DEJAL_HASH_READ_CHUNK_LENGTH 65536
+
+// Number of characters of a string the hasher copies at a time, when it can't access them directly:
+#define DEJAL_HASH_STRING_CHUNK_LENGTH 2048
+
+// Primes of the XXH64 hash algorithm:
+#define DEJAL_HASH_PRIME_1 0x9E3779B185EBCA87ULL
+#define DEJAL_HASH_PRIME_2 0xC2B2AE3D27D4EB4FULL
+#define DEJAL_HASH_PRIME_3 0x165667B19E3779F9ULL
+#define DEJAL_HASH_PRIME_4 0x85EBCA77C2B2AE63ULL
+#define DEJAL_HASH_PRIME_5 0x27D4EB2F165667C5ULL
+
+
+typedef struct
+{
+    uint64_t seed;
+    uint64_t lanes[4];
+    uint64_t totalLength;
+    uint8_t pending[32];
+    NSUInteger pendingLength;
+} DejalHashState;
+
+
+/**
+ Rotates the value left by the number of bits.
+ 
+ @author DJS 2026-10.
+ */
+
+static inline uint64_t DejalHashRotate(uint64_t value, unsigned bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+/**
+ Reads eight or four bytes as a little-endian value.
+ 
+ @author DJS 2026-10.
+ */
+
+static inline uint64_t DejalHashRead64(const uint8_t *bytes)
+{
+    uint64_t value;
+    
+    memcpy(&value, bytes, sizeof(value));
+    
+    return CFSwapInt64LittleToHost(value);
+}
+
+static inline uint64_t DejalHashRead32(const uint8_t *bytes)
+{
+    uint32_t value;
+    
+    memcpy(&value, bytes, sizeof(value));
+    
+    return CFSwapInt32LittleToHost(value);
+}
+
+/**
+ Mixes eight bytes of input into a lane.
+ 
+ @author DJS 2026-10.
+ */
+
+static inline uint64_t DejalHashRound(uint64_t lane, uint64_t input)
+{
+    return DejalHashRotate(lane + input * DEJAL_HASH_PRIME_2, 31) * DEJAL_HASH_PRIME_1;
+}
+
+/**
+ Prepares the state to hash with the seed.
+ 
+ @author DJS 2026-10.
+ */
+
+static void DejalHashSetUp(DejalHashState *state, uint64_t seed)
+{
+    memset(state, 0, sizeof(*state));
+    state->seed = seed;
+    state->lanes[0] = seed + DEJAL_HASH_PRIME_1 + DEJAL_HASH_PRIME_2;
+    state->lanes[1] = seed + DEJAL_HASH_PRIME_2;
+    state->lanes[2] = seed;
+    state->lanes[3] = seed - DEJAL_HASH_PRIME_1;
+}
+
+/**
+ Mixes 32-byte stripes of the input into the four lanes, which are independent, so their multiplies overlap in the pipeline.  Returns the number of bytes consumed.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSUInteger DejalHashStripes(uint64_t *lanes, const uint8_t *bytes, NSUInteger length)
+{
+    uint64_t lane0 = lanes[0], lane1 = lanes[1], lane2 = lanes[2], lane3 = lanes[3];
+    NSUInteger i = 0;
+    
+    for (; i + 32 <= length; i += 32)
+    {
+        lane0 = DejalHashRound(lane0, DejalHashRead64(bytes + i));
+        lane1 = DejalHashRound(lane1, DejalHashRead64(bytes + i + 8));
+        lane2 = DejalHashRound(lane2, DejalHashRead64(bytes + i + 16));
+        lane3 = DejalHashRound(lane3, DejalHashRead64(bytes + i + 24));
+    }
+    
+    lanes[0] = lane0;
+    lanes[1] = lane1;
+    lanes[2] = lane2;
+    lanes[3] = lane3;
+    
+    return i;
+}
+
+/**
+ Adds bytes to the hash, carrying any that don't complete a stripe over to the next call via the state.
+ 
+ @author DJS 2026-10.
+ */
+
+static void DejalHashUpdate(DejalHashState *state, const uint8_t *bytes, NSUInteger length)
+{
+    state->totalLength += length;
+    
+    if (state->pendingLength)
+    {
+        NSUInteger needed = MIN(32 - state->pendingLength, length);
+        
+        memcpy(state->pending + state->pendingLength, bytes, needed);
+        state->pendingLength += needed;
+        bytes += needed;
+        length -= needed;
+        
+        if (state->pendingLength < 32)
+            return;
+        
+        DejalHashStripes(state->lanes, state->pending, 32);
+        state->pendingLength = 0;
+    }
+    
+    NSUInteger consumed = DejalHashStripes(state->lanes, bytes, length);
+    
+    state->pendingLength = length - consumed;
+    memcpy(state->pending, bytes + consumed, state->pendingLength);
+}
+
+/**
+ Returns the hash of the bytes added so far; more can be added afterwards.  The result is the XXH64 hash of the bytes with the seed.
+ 
+ @author DJS 2026-10.
+ */
+
+static uint64_t DejalHashDigest(const DejalHashState *state)
+{
+    uint64_t hash;
+    
+    if (state->totalLength >= 32)
+    {
+        const uint64_t *lanes = state->lanes;
+        
+        hash = DejalHashRotate(lanes[0], 1) + DejalHashRotate(lanes[1], 7) + DejalHashRotate(lanes[2], 12) + DejalHashRotate(lanes[3], 18);
+        
+        for (NSUInteger i = 0; i < 4; i++)
+            hash = (hash ^ DejalHashRound(0, lanes[i])) * DEJAL_HASH_PRIME_1 + DEJAL_HASH_PRIME_4;
+    }
+    else
+    {
+        hash = state->seed + DEJAL_HASH_PRIME_5;
+    }
+    
+    hash += state->totalLength;
+    
+    const uint8_t *bytes = state->pending;
+    NSUInteger length = state->pendingLength;
+    NSUInteger i = 0;
+    
+    for (; i + 8 <= length; i += 8)
+        hash = DejalHashRotate(hash ^ DejalHashRound(0, DejalHashRead64(bytes + i)), 27) * DEJAL_HASH_PRIME_1 + DEJAL_HASH_PRIME_4;
+    
+    if (i + 4 <= length)
+    {
+        hash = DejalHashRotate(hash ^ (DejalHashRead32(bytes + i) * DEJAL_HASH_PRIME_1), 23) * DEJAL_HASH_PRIME_2 + DEJAL_HASH_PRIME_3;
+        i += 4;
+    }
+    
+    for (; i < length; i++)
+        hash = DejalHashRotate(hash ^ (bytes[i] * DEJAL_HASH_PRIME_5), 11) * DEJAL_HASH_PRIME_1;
+    
+    hash ^= hash >> 33;
+    hash *= DEJAL_HASH_PRIME_2;
+    hash ^= hash >> 29;
+    hash *= DEJAL_HASH_PRIME_3;
+    hash ^= hash >> 32;
+    
+    return hash;
+}
+
+/**
+ Returns the hash of the bytes with the seed, in one go.
+ 
+ @author DJS 2026-10.
+ */
+
+static uint64_t DejalHashBytes(const void *bytes, NSUInteger length, uint64_t seed)
+{
+    DejalHashState state;
+    
+    DejalHashSetUp(&state, seed);
+    DejalHashUpdate(&state, bytes, length);
+    
+    return DejalHashDigest(&state);
+}
 
 
 @implementation NSData (Dejal)
 
 /**
- Returns an archived rendition of the object (which can be any object that conforms to NSCoding, e.g. a dictionary or array with simple Cocoa objects).  Use -object, below, to unarchive the object.  Provided as a convenience, as this functionality seems more logical (to me anyway) as part of NSData.
-*/
+ Returns an archived rendition of the object (which can be any object that conforms to NSCoding, e.g. a dictionary or array with simple Cocoa objects).  Use -object, below, to unarchive the object.  Provided as a convenience, as this functionality seems more logical (to me anyway) as part of NSData.
+*/
+
++ (NSData *)dejal_dataWithObject:(id)rootObject;
+{
+    return [NSKeyedArchiver archivedDataWithRootObject:rootObject requiringSecureCoding:YES error:nil];
+}
+
+/**
+ Returns the object rendition of the archived data.  Use this to balance +dataWithObject:, above.  Provided as a convenience, as this functionality seems more logical (to me anyway) as part of NSData.
+*/
+
+- (id)dejal_objectOfClass:(Class)class;
+{
+    id object = [NSKeyedUnarchiver unarchivedObjectOfClass:class fromData:self error:nil];
+    
+    if (object == nil)
+    {
+        object = [NSUnarchiver unarchiveObjectWithData:self];
+    }
+    
+    return object;
+}
+
+/**
+ Returns a rendition of the object in the compact data format, which is smaller and much faster to read than an archive, but only supports property list objects (plus NSNull).  Use -dejal_compactObject to read it.  Returns nil if the object (or anything in it) isn't supported.
+ 
+ @author DJS 2026-10.
+ */
+
++ (NSData *)dejal_compactDataWithObject:(id)rootObject;
+{
+    DejalCompactDataWriter *writer = [DejalCompactDataWriter new];
+    
+    if (![writer writeObject:rootObject] || ![writer finish])
+        return nil;
+    
+    return writer.data;
+}
+
+/**
+ Returns the object rendition of data from +dejal_compactDataWithObject: or DejalCompactDataWriter.  Arrays and dictionaries are decoded lazily, as their contents are accessed.  Returns nil if the data isn't in the compact data format.
+ 
+ @author DJS 2026-10.
+ */
+
+- (id)dejal_compactObject;
+{
+    return [[DejalCompactDataReader alloc] initWithData:self].rootObject;
+}
+
+/**
+ Returns data decoded from the Base64 string, or nil if decoding fails.  The standard alphabet is used, or the URL-safe one if DejalBase64URLSafe is passed, and padding is required unless DejalBase64OmitPadding is passed.  Decoding is lenient by default, as with NSDataBase64DecodingIgnoreUnknownCharacters: characters outside the alphabet (e.g. line breaks) are ignored.  Pass DejalBase64Strict to fail on them, and on non-zero unused bits.  ASCII strings are decoded directly from their characters, without an intermediate copy.
+ 
+ @author DJS 2026-10.
+ */
+
++ (NSData *)dejal_dataWithBase64String:(NSString *)string options:(DejalBase64Options)options;
+{
+    if (!string)
+        return nil;
+    
+    const char *ascii = CFStringGetCStringPtr((__bridge CFStringRef)string, kCFStringEncodingASCII);
+    NSUInteger length = string.length;
+    
+    if (ascii)
+        return DejalBase64DecodedData((const uint8_t *)ascii, length, options);
+    
+    DejalBase64DecoderState state;
+    uint8_t *output = malloc((length / 4 + 2) * 3);
+    NSUInteger count = 0;
+    unichar characters[DEJAL_STACK_BASE64_LENGTH];
+    uint8_t bytes[DEJAL_STACK_BASE64_LENGTH];
+    
+    DejalBase64SetUpDecoderState(&state, options);
+    
+    for (NSUInteger location = 0; location < length && !state.failed; location += DEJAL_STACK_BASE64_LENGTH)
+    {
+        NSRange range = NSMakeRange(location, MIN(DEJAL_STACK_BASE64_LENGTH, length - location));
+        
+        [string getCharacters:characters range:range];
+        
+        // Characters outside ASCII aren't in the alphabet, so are all narrowed to one that isn't:
+        for (NSUInteger i = 0; i < range.length; i++)
+            bytes[i] = characters[i] < 0x80 ? (uint8_t)characters[i] : 0x80;
+        
+        count += DejalBase64Decode(&state, bytes, range.length, output + count);
+    }
+    
+    count += DejalBase64FinishDecoding(&state, output + count);
+    
+    if (state.failed)
+    {
+        free(output);
+        return nil;
+    }
+    
+    return [NSData dataWithBytesNoCopy:output length:count freeWhenDone:YES];
+}
+
+/**
+ Returns data decoded from the receiver's Base64 bytes, or nil if decoding fails.  See +dejal_dataWithBase64String:options: for the options.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSData *)dejal_dataByDecodingBase64WithOptions:(DejalBase64Options)options;
+{
+    return DejalBase64DecodedData(self.bytes, self.length, options);
+}
+
+/**
+ Returns the receiver encoded as a Base64 string, using the URL-safe alphabet ("-" and "_" instead of "+" and "/") if DejalBase64URLSafe is passed, and without padding if DejalBase64OmitPadding is passed.  The characters are encoded directly into the string's storage.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSString *)dejal_base64EncodedStringWithOptions:(DejalBase64Options)options;
+{
+    NSUInteger length;
+    uint8_t *output = DejalBase64EncodedBytes(self.bytes, self.length, options, &length);
+    
+    return [[NSString alloc] initWithBytesNoCopy:output length:length encoding:NSASCIIStringEncoding freeWhenDone:YES];
+}
+
+/**
+ Returns the receiver encoded as Base64 ASCII bytes.  See -dejal_base64EncodedStringWithOptions: for the options.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSData *)dejal_base64EncodedDataWithOptions:(DejalBase64Options)options;
+{
+    NSUInteger length;
+    uint8_t *output = DejalBase64EncodedBytes(self.bytes, self.length, options, &length);
+    
+    return [NSData dataWithBytesNoCopy:output length:length freeWhenDone:YES];
+}
+
+/**
+ Returns a 64-bit hash of the receiver's bytes, for quickly identifying duplicate data; see -dejal_hash64WithSeed:.
+ 
+ @author DJS 2026-10.
+ */
+
+- (uint64_t)dejal_hash64;
+{
+    return [self dejal_hash64WithSeed:0];
+}
+
+/**
+ Returns a 64-bit hash of the receiver's bytes with the seed.  This is the XXH64 algorithm, a fast non-cryptographic hash that is stable across launches, OS versions and architectures (unlike -hash), so it can be stored.  Use DejalHasher to hash data incrementally, e.g. a file, with the same result.
+ 
+ @author DJS 2026-10.
+ */
+
+- (uint64_t)dejal_hash64WithSeed:(uint64_t)seed;
+{
+    return DejalHashBytes(self.bytes, self.length, seed);
+}
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+/**
+ Private class representing an array or dictionary that a compact data writer has begun but not yet ended.
+ 
+ @author DJS 2026-10.
+ */
+
+@interface DejalCompactDataContainer : NSObject
+
+@property (nonatomic) BOOL isDictionary;
+@property (nonatomic) NSUInteger count;
+@property (nonatomic, strong) NSMutableData *keyIndexes;
+@property (nonatomic, strong) NSMutableData *offsets;
+@property (nonatomic) uint64_t maximumOffset;
+@property (nonatomic) BOOL hasPendingKey;
+@property (nonatomic) uint32_t pendingKeyIndex;
+
+@end
+
+
+@implementation DejalCompactDataContainer
+
+@end
+
+
+@interface DejalCompactDataWriter ()
+
+@property (nonatomic, strong) NSFileHandle *fileHandle;
+@property (nonatomic, strong) NSMutableData *buffer;
+@property (nonatomic, strong) NSMutableData *output;
+@property (nonatomic) uint64_t position;
+@property (nonatomic, strong) NSMutableArray *containers;
+@property (nonatomic, strong) NSMutableDictionary *stringIndexes;
+@property (nonatomic, strong) NSMutableDictionary *stringRecordOffsets;
+@property (nonatomic, strong) NSMutableData *stringBytes;
+@property (nonatomic, strong) NSMutableData *stringOffsets;
+@property (nonatomic) uint64_t falseOffset;
+@property (nonatomic) uint64_t trueOffset;
+@property (nonatomic) uint64_t nullOffset;
+@property (nonatomic) uint64_t rootOffset;
+@property (nonatomic) BOOL failed;
+@property (nonatomic) BOOL finished;
+
+@end
+
+
+@implementation DejalCompactDataWriter
+
+/**
+ Initializes a writer that collects the compact data in memory; get it via the data property after calling -finish.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)init;
+{
+    if ((self = [super init]))
+    {
+        self.output = [NSMutableData data];
+        [self setUp];
+    }
+    
+    return self;
+}
+
+/**
+ Initializes a writer that streams the compact data to a file, replacing any existing file at the path.  Only the string table and the offsets of the containers currently being written are kept in memory.  Returns nil if the file can't be created.
+ 
+ @param path The path of the file to write.
+ @returns A new writer, or nil.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)initWithPath:(NSString *)path;
+{
+    if ((self = [super init]))
+    {
+        if (![[NSFileManager defaultManager] createFileAtPath:path contents:nil attributes:nil])
+            return nil;
+        
+        self.fileHandle = [NSFileHandle fileHandleForWritingAtPath:path];
+        
+        if (!self.fileHandle)
+            return nil;
+        
+        [self setUp];
+    }
+    
+    return self;
+}
+
+/**
+ Private method to prepare the state shared by the initializers, and write the header.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)setUp;
+{
+    uint8_t header[DEJAL_COMPACT_DATA_HEADER_LENGTH] = {'D', 'J', 'B', 'P', DEJAL_COMPACT_DATA_VERSION};
+    
+    self.buffer = [NSMutableData dataWithCapacity:DEJAL_COMPACT_DATA_FLUSH_LENGTH];
+    self.containers = [NSMutableArray array];
+    self.stringIndexes = [NSMutableDictionary dictionary];
+    self.stringRecordOffsets = [NSMutableDictionary dictionary];
+    self.stringBytes = [NSMutableData data];
+    self.stringOffsets = [NSMutableData data];
+    
+    [self.buffer appendBytes:header length:sizeof(header)];
+    self.position = sizeof(header);
+}
+
+/**
+ Returns the compact data collected by an in-memory writer, once -finish has been called; nil otherwise.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSData *)data;
+{
+    return self.finished ? self.output : nil;
+}
+
+/**
+ Private method to pass the buffered bytes on to the file or in-memory output.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)flush;
+{
+    if (self.fileHandle)
+    {
+        if (![self.fileHandle writeData:self.buffer error:nil])
+            self.failed = YES;
+    }
+    else
+    {
+        [self.output appendData:self.buffer];
+    }
+    
+    self.buffer.length = 0;
+    
+    return !self.failed;
+}
+
+/**
+ Private method to append a record, returning its offset.
+ 
+ @author DJS 2026-10.
+ */
+
+- (uint64_t)appendRecord:(NSData *)record;
+{
+    uint64_t offset = self.position;
+    
+    [self.buffer appendData:record];
+    self.position += record.length;
+    
+    if (self.buffer.length >= DEJAL_COMPACT_DATA_FLUSH_LENGTH)
+        [self flush];
+    
+    return offset;
+}
+
+/**
+ Private method to append a record consisting of just a tag, returning its offset.
+ 
+ @author DJS 2026-10.
+ */
+
+- (uint64_t)appendTag:(DejalCompactDataTag)tag;
+{
+    return [self appendRecord:[NSData dataWithBytes:&tag length:1]];
+}
+
+/**
+ Private method to return the index of the string in the string table, adding it if it isn't already there.
+ 
+ @author DJS 2026-10.
+ */
+
+- (uint32_t)indexOfString:(NSString *)string;
+{
+    NSNumber *existing = self.stringIndexes[string];
+    
+    if (existing)
+        return existing.unsignedIntValue;
+    
+    NSUInteger count = self.stringIndexes.count;
+    NSData *utf8 = [string dataUsingEncoding:NSUTF8StringEncoding];
+    
+    if (count >= UINT32_MAX)
+    {
+        self.failed = YES;
+        return 0;
+    }
+    
+    DejalAppendLittleEndian(self.stringOffsets, self.stringBytes.length, 8);
+    DejalAppendVarint(self.stringBytes, utf8.length);
+    [self.stringBytes appendData:utf8];
+    
+    self.stringIndexes[string] = @(count);
+    
+    return (uint32_t)count;
+}
+
+/**
+ Private method to add the offset of a completed value to the current container, or make it the root if there isn't one.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)addValueAtOffset:(uint64_t)offset;
+{
+    DejalCompactDataContainer *container = self.containers.lastObject;
+    
+    if (!container)
+    {
+        if (self.rootOffset)
+            self.failed = YES;
+        else
+            self.rootOffset = offset;
+    }
+    else if (container.isDictionary)
+    {
+        if (!container.hasPendingKey)
+        {
+            self.failed = YES;
+        }
+        else
+        {
+            uint32_t keyIndex = container.pendingKeyIndex;
+            
+            [container.keyIndexes appendBytes:&keyIndex length:sizeof(keyIndex)];
+            [container.offsets appendBytes:&offset length:sizeof(offset)];
+            container.hasPendingKey = NO;
+        }
+    }
+    else
+    {
+        [container.offsets appendBytes:&offset length:sizeof(offset)];
+    }
+    
+    container.count++;
+    container.maximumOffset = MAX(container.maximumOffset, offset);
+    
+    return !self.failed;
+}
+
+/**
+ Private method to check that a value can be written now, i.e. the writer hasn't failed or finished, and if in a dictionary, a key has been written.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)canWriteValue;
+{
+    DejalCompactDataContainer *container = self.containers.lastObject;
+    
+    if (self.failed || self.finished || (!container && self.rootOffset) || (container.isDictionary && !container.hasPendingKey))
+        self.failed = YES;
+    
+    return !self.failed;
+}
+
+/**
+ Writes the object as the root object, the next object of the current array, or the value for the key most recently written to the current dictionary.  Arrays and dictionaries are written along with their contents.  Supports strings, numbers, dates, data, arrays, dictionaries with string keys, and NSNull.
+ 
+ @param object The object to write.
+ @returns YES if written, or NO if the object isn't supported or the writer is not expecting a value.  Once a method has returned NO, the writer has failed, and all further calls return NO.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)writeObject:(id)object;
+{
+    if (![self canWriteValue])
+        return NO;
+    
+    if ([object isKindOfClass:[NSArray class]])
+    {
+        if (![self beginArray])
+            return NO;
+        
+        for (id item in object)
+            if (![self writeObject:item])
+                return NO;
+        
+        return [self endContainer];
+    }
+    else if ([object isKindOfClass:[NSDictionary class]])
+    {
+        if (![self beginDictionary])
+            return NO;
+        
+        for (id key in object)
+            if (![self writeKey:key] || ![self writeObject:[object objectForKey:key]])
+                return NO;
+        
+        return [self endContainer];
+    }
+    
+    uint64_t offset = 0;
+    
+    if ([object isKindOfClass:[NSString class]])
+    {
+        NSNumber *existing = self.stringRecordOffsets[object];
+        
+        if (existing)
+        {
+            offset = existing.unsignedLongLongValue;
+        }
+        else
+        {
+            NSMutableData *record = [NSMutableData dataWithLength:1];
+            
+            ((uint8_t *)record.mutableBytes)[0] = DejalCompactDataTagString;
+            DejalAppendVarint(record, [self indexOfString:object]);
+            offset = [self appendRecord:record];
+            self.stringRecordOffsets[object] = @(offset);
+        }
+    }
+    else if ([object isKindOfClass:[NSNumber class]])
+    {
+        NSNumber *number = object;
+        const char *type = number.objCType;
+        
+        if (number == (id)kCFBooleanFalse || number == (id)kCFBooleanTrue)
+        {
+            BOOL value = number.boolValue;
+            
+            if (value && !self.trueOffset)
+                self.trueOffset = [self appendTag:DejalCompactDataTagTrue];
+            else if (!value && !self.falseOffset)
+                self.falseOffset = [self appendTag:DejalCompactDataTagFalse];
+            
+            offset = value ? self.trueOffset : self.falseOffset;
+        }
+        else
+        {
+            NSMutableData *record = [NSMutableData dataWithLength:1];
+            uint8_t *tag = record.mutableBytes;
+            
+            if (type[0] == 'f' || type[0] == 'd')
+            {
+                double value = number.doubleValue;
+                uint64_t bits;
+                
+                memcpy(&bits, &value, sizeof(bits));
+                *tag = DejalCompactDataTagDouble;
+                DejalAppendLittleEndian(record, bits, 8);
+            }
+            else if (type[0] == 'Q' && number.unsignedLongLongValue > INT64_MAX)
+            {
+                *tag = DejalCompactDataTagUnsignedInteger;
+                DejalAppendVarint(record, number.unsignedLongLongValue);
+            }
+            else
+            {
+                int64_t value = number.longLongValue;
+                
+                *tag = DejalCompactDataTagInteger;
+                DejalAppendVarint(record, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+            }
+            
+            offset = [self appendRecord:record];
+        }
+    }
+    else if ([object isKindOfClass:[NSDate class]])
+    {
+        NSMutableData *record = [NSMutableData dataWithLength:1];
+        NSTimeInterval value = [object timeIntervalSinceReferenceDate];
+        uint64_t bits;
+        
+        memcpy(&bits, &value, sizeof(bits));
+        ((uint8_t *)record.mutableBytes)[0] = DejalCompactDataTagDate;
+        DejalAppendLittleEndian(record, bits, 8);
+        offset = [self appendRecord:record];
+    }
+    else if ([object isKindOfClass:[NSData class]])
+    {
+        NSMutableData *record = [NSMutableData dataWithLength:1];
+        
+        ((uint8_t *)record.mutableBytes)[0] = DejalCompactDataTagData;
+        DejalAppendVarint(record, [object length]);
+        [record appendData:object];
+        offset = [self appendRecord:record];
+    }
+    else if (object == [NSNull null])
+    {
+        if (!self.nullOffset)
+            self.nullOffset = [self appendTag:DejalCompactDataTagNull];
+        
+        offset = self.nullOffset;
+    }
+    else
+    {
+        self.failed = YES;
+        return NO;
+    }
+    
+    return !self.failed && [self addValueAtOffset:offset];
+}
+
+/**
+ Begins writing an array, as the root object, the next object of the current array, or the value for the key most recently written to the current dictionary.  Write its contents via -writeObject: (or nested -beginArray or -beginDictionary calls), then call -endContainer.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)beginArray;
+{
+    if (![self canWriteValue])
+        return NO;
+    
+    DejalCompactDataContainer *container = [DejalCompactDataContainer new];
+    
+    container.offsets = [NSMutableData data];
+    
+    [self.containers addObject:container];
+    
+    return YES;
+}
+
+/**
+ Begins writing a dictionary, as for -beginArray.  Write each entry via -writeKey: followed by -writeObject: (or nested -beginArray or -beginDictionary calls), then call -endContainer.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)beginDictionary;
+{
+    if (![self beginArray])
+        return NO;
+    
+    DejalCompactDataContainer *container = self.containers.lastObject;
+    
+    container.isDictionary = YES;
+    container.keyIndexes = [NSMutableData data];
+    
+    return YES;
+}
+
+/**
+ Writes the key for the next value of the current dictionary.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)writeKey:(NSString *)key;
+{
+    DejalCompactDataContainer *container = self.containers.lastObject;
+    
+    if (self.failed || !container.isDictionary || container.hasPendingKey || ![key isKindOfClass:[NSString class]])
+    {
+        self.failed = YES;
+        return NO;
+    }
+    
+    container.pendingKeyIndex = [self indexOfString:key];
+    container.hasPendingKey = YES;
+    
+    return !self.failed;
+}
+
+/**
+ Ends the current array or dictionary, writing its record: the count, the width of its offsets, then (for a dictionary) the string table index of each key, and the offset of each value, so any value can be found without decoding the others.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)endContainer;
+{
+    DejalCompactDataContainer *container = self.containers.lastObject;
+    
+    if (self.failed || !container || container.hasPendingKey)
+    {
+        self.failed = YES;
+        return NO;
+    }
+    
+    [self.containers removeLastObject];
+    
+    NSUInteger count = container.count;
+    uint8_t width = container.maximumOffset <= UINT32_MAX ? 4 : 8;
+    NSMutableData *record = [NSMutableData dataWithCapacity:11 + count * (width + 4)];
+    const uint64_t *offsets = container.offsets.bytes;
+    const uint32_t *keyIndexes = container.keyIndexes.bytes;
+    uint8_t tag = container.isDictionary ? DejalCompactDataTagDictionary : DejalCompactDataTagArray;
+    
+    [record appendBytes:&tag length:1];
+    DejalAppendVarint(record, count);
+    [record appendBytes:&width length:1];
+    
+    if (container.isDictionary)
+        for (NSUInteger i = 0; i < count; i++)
+            DejalAppendLittleEndian(record, keyIndexes[i], 4);
+    
+    for (NSUInteger i = 0; i < count; i++)
+        DejalAppendLittleEndian(record, offsets[i], width);
+    
+    return [self addValueAtOffset:[self appendRecord:record]];
+}
+
+/**
+ Finishes writing, by adding the string table and trailer, and closing the file, if any.  Must be called after the root object has been completely written.
+ 
+ @returns YES if the compact data was successfully written, otherwise NO.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)finish;
+{
+    if (self.failed || self.finished || self.containers.count || !self.rootOffset)
+    {
+        self.failed = YES;
+        [self.fileHandle closeFile];
+        return NO;
+    }
+    
+    NSUInteger stringCount = self.stringIndexes.count;
+    uint64_t stringTableOffset = self.position;
+    NSMutableData *table = [NSMutableData data];
+    
+    DejalAppendVarint(table, stringCount);
+    
+    uint64_t stringBytesOffset = stringTableOffset + table.length + stringCount * 8;
+    const uint64_t *relativeOffsets = self.stringOffsets.bytes;
+    
+    for (NSUInteger i = 0; i < stringCount; i++)
+        DejalAppendLittleEndian(table, stringBytesOffset + relativeOffsets[i], 8);
+    
+    [self appendRecord:table];
+    [self appendRecord:self.stringBytes];
+    
+    NSMutableData *trailer = [NSMutableData data];
+    
+    DejalAppendLittleEndian(trailer, stringTableOffset, 8);
+    DejalAppendLittleEndian(trailer, self.rootOffset, 8);
+    [trailer appendBytes:DEJAL_COMPACT_DATA_MAGIC length:4];
+    
+    [self appendRecord:trailer];
+    [self flush];
+    
+    if (self.fileHandle)
+        [self.fileHandle closeFile];
+    
+    self.finished = !self.failed;
+    
+    return self.finished;
+}
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalCompactDataReader ()
+
+@property (nonatomic, strong) NSData *source;
+@property (nonatomic) const uint8_t *bytes;
+@property (nonatomic) uint64_t recordsLength;
+@property (nonatomic) uint64_t stringsLength;
+@property (nonatomic) uint64_t rootOffset;
+@property (nonatomic) NSUInteger stringCount;
+@property (nonatomic) const uint8_t *stringOffsets;
+
+- (id)objectAtOffset:(uint64_t)offset;
+- (NSString *)stringAtIndex:(uint64_t)idx;
+
+@end
+
+
+/**
+ Private array subclass that decodes its objects from compact data as they are accessed.  Objects that can't be decoded are returned as NSNull.
+ 
+ @author DJS 2026-10.
+ */
+
+@interface DejalCompactDataArray : NSArray
+{
+    DejalCompactDataReader *_reader;
+    uint64_t _offset;
+    NSUInteger _count;
+    NSUInteger _width;
+    const uint8_t *_valueOffsets;
+    _Atomic(void *) *_slots;
+}
+
+- (instancetype)initWithReader:(DejalCompactDataReader *)reader offset:(uint64_t)offset count:(NSUInteger)count width:(NSUInteger)width valueOffsets:(const uint8_t *)valueOffsets;
+
+@end
+
+
+@implementation DejalCompactDataArray
+
+- (instancetype)initWithReader:(DejalCompactDataReader *)reader offset:(uint64_t)offset count:(NSUInteger)count width:(NSUInteger)width valueOffsets:(const uint8_t *)valueOffsets;
+{
+    if ((self = [super init]))
+    {
+        _reader = reader;
+        _offset = offset;
+        _count = count;
+        _width = width;
+        _valueOffsets = valueOffsets;
+        _slots = calloc(MAX(count, 1), sizeof(_Atomic(void *)));
+    }
+    
+    return self;
+}
+
+- (void)dealloc;
+{
+    DejalFreeSlots(_slots, _count);
+}
+
+- (NSUInteger)count;
+{
+    return _count;
+}
+
+- (id)objectAtIndex:(NSUInteger)idx;
+{
+    if (idx >= _count)
+        [NSException raise:NSRangeException format:@"Index %@ beyond bounds [0 .. %@]", @(idx), @((NSInteger)_count - 1)];
+    
+    void *cached = atomic_load(&_slots[idx]);
+    
+    if (cached)
+        return (__bridge id)cached;
+    
+    uint64_t valueOffset = DejalReadLittleEndian(_valueOffsets + idx * _width, _width);
+    
+    // Values are always written before their container, so anything else is corrupt (and could loop):
+    id object = valueOffset < _offset ? [_reader objectAtOffset:valueOffset] : nil;
+    
+    return DejalCacheObjectInSlot(&_slots[idx], object ?: [NSNull null]);
+}
+
+@end
+
+
+/**
+ Private dictionary subclass that decodes its keys from compact data when first looked up or enumerated, and its values as they are accessed.  Values that can't be decoded are returned as NSNull.
+ 
+ @author DJS 2026-10.
+ */
+
+@interface DejalCompactDataDictionary : NSDictionary
+{
+    DejalCompactDataReader *_reader;
+    uint64_t _offset;
+    NSUInteger _count;
+    NSUInteger _width;
+    const uint8_t *_keyIndexes;
+    const uint8_t *_valueOffsets;
+    _Atomic(void *) _keyMap;
+    _Atomic(void *) *_slots;
+}
+
+- (instancetype)initWithReader:(DejalCompactDataReader *)reader offset:(uint64_t)offset count:(NSUInteger)count width:(NSUInteger)width keyIndexes:(const uint8_t *)keyIndexes valueOffsets:(const uint8_t *)valueOffsets;
+
+@end
+
+
+@implementation DejalCompactDataDictionary
+
+- (instancetype)initWithReader:(DejalCompactDataReader *)reader offset:(uint64_t)offset count:(NSUInteger)count width:(NSUInteger)width keyIndexes:(const uint8_t *)keyIndexes valueOffsets:(const uint8_t *)valueOffsets;
+{
+    if ((self = [super init]))
+    {
+        _reader = reader;
+        _offset = offset;
+        _count = count;
+        _width = width;
+        _keyIndexes = keyIndexes;
+        _valueOffsets = valueOffsets;
+        _slots = calloc(MAX(count, 1), sizeof(_Atomic(void *)));
+    }
+    
+    return self;
+}
+
+- (void)dealloc;
+{
+    DejalFreeSlots(_slots, _count);
+    
+    void *keyMap = atomic_load(&_keyMap);
+    
+    if (keyMap)
+        CFRelease(keyMap);
+}
+
+/**
+ Private method to return a dictionary mapping each key to its index, decoding the keys the first time.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSDictionary *)keyMap;
+{
+    void *cached = atomic_load(&_keyMap);
+    
+    if (cached)
+        return (__bridge NSDictionary *)cached;
+    
+    NSMutableDictionary *keyMap = [NSMutableDictionary dictionaryWithCapacity:_count];
+    
+    for (NSUInteger i = 0; i < _count; i++)
+    {
+        NSString *key = [_reader stringAtIndex:DejalReadLittleEndian(_keyIndexes + i * 4, 4)];
+        
+        if (key)
+            keyMap[key] = @(i);
+    }
+    
+    return DejalCacheObjectInSlot(&_keyMap, keyMap);
+}
+
+- (NSUInteger)count;
+{
+    return _count;
+}
+
+- (id)objectForKey:(id)key;
+{
+    NSNumber *index = [self keyMap][key];
+    
+    if (!index)
+        return nil;
+    
+    NSUInteger idx = index.unsignedIntegerValue;
+    void *cached = atomic_load(&_slots[idx]);
+    
+    if (cached)
+        return (__bridge id)cached;
+    
+    uint64_t valueOffset = DejalReadLittleEndian(_valueOffsets + idx * _width, _width);
+    id object = valueOffset < _offset ? [_reader objectAtOffset:valueOffset] : nil;
+    
+    return DejalCacheObjectInSlot(&_slots[idx], object ?: [NSNull null]);
+}
+
+- (NSEnumerator *)keyEnumerator;
+{
+    return [[self keyMap] keyEnumerator];
+}
+
+@end
+
+
+@implementation DejalCompactDataReader
+{
+    _Atomic(void *) *_strings;
+    __weak id _root;
+}
+
+/**
+ Returns a reader for the compact data file at the path, which is memory mapped where safe, so only the parts that are accessed are read from disk.  Returns nil if the file can't be read or isn't in the compact data format.
+ 
+ @author DJS 2026-10.
+ */
+
++ (instancetype)readerWithContentsOfFile:(NSString *)path;
+{
+    NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+    
+    return data ? [[self alloc] initWithData:data] : nil;
+}
+
+/**
+ Initializes a reader for compact data, checking the header, trailer and string table.  Returns nil if the data isn't in the compact data format.  Nothing else is decoded until accessed.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)initWithData:(NSData *)data;
+{
+    if ((self = [super init]))
+    {
+        uint64_t length = data.length;
+        const uint8_t *bytes = data.bytes;
+        
+        if (length < DEJAL_COMPACT_DATA_HEADER_LENGTH + DEJAL_COMPACT_DATA_TRAILER_LENGTH || memcmp(bytes, DEJAL_COMPACT_DATA_MAGIC, 4) != 0 || bytes[4] != DEJAL_COMPACT_DATA_VERSION || memcmp(bytes + length - 4, DEJAL_COMPACT_DATA_MAGIC, 4) != 0)
+            return nil;
+        
+        uint64_t trailerOffset = length - DEJAL_COMPACT_DATA_TRAILER_LENGTH;
+        uint64_t stringTableOffset = DejalReadLittleEndian(bytes + trailerOffset, 8);
+        uint64_t rootOffset = DejalReadLittleEndian(bytes + trailerOffset + 8, 8);
+        uint64_t position = stringTableOffset;
+        uint64_t stringCount;
+        
+        if (stringTableOffset < DEJAL_COMPACT_DATA_HEADER_LENGTH || stringTableOffset > trailerOffset || rootOffset < DEJAL_COMPACT_DATA_HEADER_LENGTH || rootOffset >= stringTableOffset)
+            return nil;
+        
+        if (!DejalReadVarint(bytes, trailerOffset, &position, &stringCount) || stringCount > (trailerOffset - position) / 8)
+            return nil;
+        
+        self.source = data;
+        self.bytes = bytes;
+        self.recordsLength = stringTableOffset;
+        self.stringsLength = trailerOffset;
+        self.rootOffset = rootOffset;
+        self.stringCount = (NSUInteger)stringCount;
+        self.stringOffsets = bytes + position;
+        
+        _strings = calloc(MAX(self.stringCount, 1), sizeof(_Atomic(void *)));
+    }
+    
+    return self;
+}
+
+- (void)dealloc;
+{
+    DejalFreeSlots(_strings, _stringCount);
+}
+
+/**
+ Returns the root object, decoding it the first time.  If it is an array or dictionary, its contents are decoded as they are accessed.  Returns nil if the root object is corrupt.
+ 
+ The root is cached weakly, since lazy arrays and dictionaries retain the reader; it is decoded again if it has been released.
+ 
+ @author DJS 2026-10.
+ */
 
-+ (NSData *)dejal_dataWithObject:(id)rootObject;
+- (id)rootObject;
 {
-    return [NSKeyedArchiver archivedDataWithRootObject:rootObject requiringSecureCoding:YES error:nil];
+    id root = _root;
+    
+    if (root)
+        return root;
+    
+    root = [self objectAtOffset:self.rootOffset];
+    
+    @synchronized(self)
+    {
+        id cached = _root;
+        
+        if (cached)
+            return cached;
+        
+        _root = root;
+    }
+    
+    return root;
 }
 
 /**
- Returns the object rendition of the archived data.  Use this to balance +dataWithObject:, above.  Provided as a convenience, as this functionality seems more logical (to me anyway) as part of NSData.
-*/
+ Private method to return the string at the index in the string table, decoding it the first time.  Returns nil if the index or string is invalid.
+ 
+ @author DJS 2026-10.
+ */
 
-- (id)dejal_objectOfClass:(Class)class;
+- (NSString *)stringAtIndex:(uint64_t)idx;
 {
-    id object = [NSKeyedUnarchiver unarchivedObjectOfClass:class fromData:self error:nil];
+    if (idx >= self.stringCount)
+        return nil;
     
-    if (object == nil)
+    void *cached = atomic_load(&_strings[idx]);
+    
+    if (cached)
+        return (__bridge NSString *)cached;
+    
+    uint64_t position = DejalReadLittleEndian(self.stringOffsets + idx * 8, 8);
+    uint64_t length;
+    
+    if (position < self.recordsLength || !DejalReadVarint(self.bytes, self.stringsLength, &position, &length) || length > self.stringsLength - position)
+        return nil;
+    
+    NSString *string = [[NSString alloc] initWithBytes:self.bytes + position length:(NSUInteger)length encoding:NSUTF8StringEncoding];
+    
+    return string ? DejalCacheObjectInSlot(&_strings[idx], string) : nil;
+}
+
+/**
+ Private method to decode the record at the offset.  Arrays and dictionaries are returned as lazy subclasses.  Returns nil if the record is corrupt.
+ 
+ @author DJS 2026-10.
+ */
+
+- (id)objectAtOffset:(uint64_t)offset;
+{
+    const uint8_t *bytes = self.bytes;
+    uint64_t length = self.recordsLength;
+    uint64_t position = offset;
+    uint64_t value;
+    
+    if (offset < DEJAL_COMPACT_DATA_HEADER_LENGTH || offset >= length)
+        return nil;
+    
+    switch (bytes[position++])
     {
-        object = [NSUnarchiver unarchiveObjectWithData:self];
+        case DejalCompactDataTagInteger:
+            if (!DejalReadVarint(bytes, length, &position, &value))
+                return nil;
+            
+            return @((int64_t)(value >> 1) ^ -(int64_t)(value & 1));
+            
+        case DejalCompactDataTagUnsignedInteger:
+            if (!DejalReadVarint(bytes, length, &position, &value))
+                return nil;
+            
+            return @(value);
+            
+        case DejalCompactDataTagDouble:
+        case DejalCompactDataTagDate:
+        {
+            if (length - position < 8)
+                return nil;
+            
+            double number;
+            
+            value = DejalReadLittleEndian(bytes + position, 8);
+            memcpy(&number, &value, sizeof(number));
+            
+            if (bytes[offset] == DejalCompactDataTagDate)
+                return [NSDate dateWithTimeIntervalSinceReferenceDate:number];
+            else
+                return @(number);
+        }
+            
+        case DejalCompactDataTagFalse:
+            return @NO;
+            
+        case DejalCompactDataTagTrue:
+            return @YES;
+            
+        case DejalCompactDataTagNull:
+            return [NSNull null];
+            
+        case DejalCompactDataTagString:
+            if (!DejalReadVarint(bytes, length, &position, &value))
+                return nil;
+            
+            return [self stringAtIndex:value];
+            
+        case DejalCompactDataTagData:
+            if (!DejalReadVarint(bytes, length, &position, &value) || value > length - position)
+                return nil;
+            
+            return [self.source subdataWithRange:NSMakeRange((NSUInteger)position, (NSUInteger)value)];
+            
+        case DejalCompactDataTagArray:
+        case DejalCompactDataTagDictionary:
+        {
+            BOOL isDictionary = bytes[offset] == DejalCompactDataTagDictionary;
+            uint64_t count;
+            
+            if (!DejalReadVarint(bytes, length, &position, &count) || position >= length)
+                return nil;
+            
+            NSUInteger width = bytes[position++];
+            NSUInteger entryLength = width + (isDictionary ? 4 : 0);
+            
+            if ((width != 4 && width != 8) || count > (length - position) / entryLength)
+                return nil;
+            
+            if (isDictionary)
+                return [[DejalCompactDataDictionary alloc] initWithReader:self offset:offset count:(NSUInteger)count width:width keyIndexes:bytes + position valueOffsets:bytes + position + count * 4];
+            else
+                return [[DejalCompactDataArray alloc] initWithReader:self offset:offset count:(NSUInteger)count width:width valueOffsets:bytes + position];
+        }
+            
+        default:
+            return nil;
+    }
+}
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalBase64Coder ()
+
+@property (nonatomic, readwrite) DejalBase64Options options;
+@property (nonatomic, strong) NSFileHandle *fileHandle;
+@property (nonatomic, strong) NSMutableData *output;
+@property (nonatomic, strong) NSMutableData *buffer;
+@property (nonatomic) BOOL failed;
+@property (nonatomic) BOOL finished;
+
+- (void)setUp;
+- (NSUInteger)codeBytes:(const uint8_t *)bytes length:(NSUInteger)length output:(uint8_t *)output;
+- (NSUInteger)finishCodingWithOutput:(uint8_t *)output;
+
+@end
+
+
+@implementation DejalBase64Coder
+
+/**
+ Initializes a coder that collects the output in memory; get it via the data property after calling -finish.  Use DejalBase64Encoder or DejalBase64Decoder, not this abstract class.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)initWithOptions:(DejalBase64Options)options;
+{
+    if ((self = [super init]))
+    {
+        self.options = options;
+        self.output = [NSMutableData data];
+        [self setUp];
     }
     
-    return object;
+    return self;
+}
+
+/**
+ Initializes a coder that streams the output to a file, replacing any existing file at the path, so memory use is bounded by the chunk size however much is appended.  Returns nil if the file can't be created.
+ 
+ @param path The path of the file to write.
+ @param options The Base64 options; see the NSData methods.
+ @returns A new coder, or nil.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)initWithPath:(NSString *)path options:(DejalBase64Options)options;
+{
+    if ((self = [super init]))
+    {
+        if (![[NSFileManager defaultManager] createFileAtPath:path contents:nil attributes:nil])
+            return nil;
+        
+        self.fileHandle = [NSFileHandle fileHandleForWritingAtPath:path];
+        
+        if (!self.fileHandle)
+            return nil;
+        
+        self.options = options;
+        [self setUp];
+    }
+    
+    return self;
+}
+
+/**
+ Private method to prepare the state shared by the initializers.  Subclasses extend this to set up their coding state.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)setUp;
+{
+    self.buffer = [NSMutableData dataWithLength:(DEJAL_BASE64_CHUNK_LENGTH / 3 + 2) * 4];
+}
+
+/**
+ Private method for subclasses to code the bytes into the output, returning the output length.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSUInteger)codeBytes:(const uint8_t *)bytes length:(NSUInteger)length output:(uint8_t *)output;
+{
+    return 0;
+}
+
+/**
+ Private method for subclasses to code the bytes carried over from the last call to -codeBytes:length:output:, returning the output length.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSUInteger)finishCodingWithOutput:(uint8_t *)output;
+{
+    return 0;
+}
+
+/**
+ Private method to pass the coded bytes in the buffer on to the file or in-memory output.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)writeBufferLength:(NSUInteger)length;
+{
+    if (!length)
+        return;
+    
+    if (self.fileHandle)
+    {
+        NSData *data = [NSData dataWithBytesNoCopy:self.buffer.mutableBytes length:length freeWhenDone:NO];
+        
+        if (![self.fileHandle writeData:data error:nil])
+            self.failed = YES;
+    }
+    else
+    {
+        [self.output appendBytes:self.buffer.mutableBytes length:length];
+    }
+}
+
+/**
+ Appends bytes to encode or decode, a chunk at a time.  The bytes can be split anywhere.
+ 
+ @returns YES if successful, or NO if the bytes couldn't be decoded or written.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)appendBytes:(const void *)bytes length:(NSUInteger)length;
+{
+    if (self.finished)
+        self.failed = YES;
+    
+    for (NSUInteger location = 0; location < length && !self.failed; location += DEJAL_BASE64_CHUNK_LENGTH)
+    {
+        NSUInteger chunkLength = MIN(DEJAL_BASE64_CHUNK_LENGTH, length - location);
+        
+        [self writeBufferLength:[self codeBytes:(const uint8_t *)bytes + location length:chunkLength output:self.buffer.mutableBytes]];
+    }
+    
+    return !self.failed;
+}
+
+/**
+ Appends data to encode or decode.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)appendData:(NSData *)data;
+{
+    return [self appendBytes:data.bytes length:data.length];
+}
+
+/**
+ Reads bytes to encode or decode from the stream in fixed-size chunks until the end, opening it if needed.
+ 
+ @returns YES if the stream was read to the end and coded, or NO if it had an error.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)appendContentsOfStream:(NSInputStream *)stream;
+{
+    uint8_t *buffer = malloc(DEJAL_BASE64_CHUNK_LENGTH);
+    NSInteger bytesRead;
+    
+    if (stream.streamStatus == NSStreamStatusNotOpen)
+        [stream open];
+    
+    while ((bytesRead = [stream read:buffer maxLength:DEJAL_BASE64_CHUNK_LENGTH]) > 0)
+    {
+        if (![self appendBytes:buffer length:(NSUInteger)bytesRead])
+            break;
+    }
+    
+    free(buffer);
+    
+    return bytesRead == 0 && !self.failed;
+}
+
+/**
+ Reads a file to encode or decode in fixed-size chunks.
+ 
+ @returns YES if the file was read and coded, or NO if it couldn't be.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)appendContentsOfFile:(NSString *)path;
+{
+    NSInputStream *stream = [NSInputStream inputStreamWithFileAtPath:path];
+    BOOL result = [self appendContentsOfStream:stream];
+    
+    [stream close];
+    
+    return stream && result;
+}
+
+/**
+ Finishes coding: codes any bytes carried over (e.g. padding the encoding), and closes the file, if any.
+ 
+ @returns YES if everything was successfully coded, otherwise NO.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)finish;
+{
+    if (!self.failed && !self.finished)
+        [self writeBufferLength:[self finishCodingWithOutput:self.buffer.mutableBytes]];
+    
+    if (self.fileHandle)
+        [self.fileHandle closeFile];
+    
+    self.finished = YES;
+    
+    return !self.failed;
+}
+
+/**
+ Returns the output collected by an in-memory coder, once -finish has been called successfully; nil otherwise.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSData *)data;
+{
+    return self.finished && !self.failed ? self.output : nil;
+}
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@implementation DejalBase64Encoder
+{
+    DejalBase64EncoderState _state;
+}
+
+/**
+ Private method to set up the encoding state.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)setUp;
+{
+    [super setUp];
+    
+    DejalBase64SetUpEncoderState(&_state, self.options);
+}
+
+/**
+ Private method to encode the bytes, carrying over any that don't complete a group.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSUInteger)codeBytes:(const uint8_t *)bytes length:(NSUInteger)length output:(uint8_t *)output;
+{
+    return DejalBase64Encode(&_state, bytes, length, output);
+}
+
+/**
+ Private method to encode the bytes carried over, with padding unless omitted.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSUInteger)finishCodingWithOutput:(uint8_t *)output;
+{
+    return DejalBase64FinishEncoding(&_state, output);
+}
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@implementation DejalBase64Decoder
+{
+    DejalBase64DecoderState _state;
+}
+
+/**
+ Private method to set up the decoding state.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)setUp;
+{
+    [super setUp];
+    
+    DejalBase64SetUpDecoderState(&_state, self.options);
+}
+
+/**
+ Private method to decode the characters, carrying over an incomplete group.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSUInteger)codeBytes:(const uint8_t *)bytes length:(NSUInteger)length output:(uint8_t *)output;
+{
+    NSUInteger count = DejalBase64Decode(&_state, bytes, length, output);
+    
+    if (_state.failed)
+        self.failed = YES;
+    
+    return count;
+}
+
+/**
+ Private method to decode the incomplete group carried over, checking its padding unless DejalBase64OmitPadding was passed.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSUInteger)finishCodingWithOutput:(uint8_t *)output;
+{
+    NSUInteger count = DejalBase64FinishDecoding(&_state, output);
+    
+    if (_state.failed)
+        self.failed = YES;
+    
+    return count;
+}
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@implementation DejalHasher
+{
+    DejalHashState _state;
+}
+
+/**
+ Initializes a hasher with a seed of zero.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)init;
+{
+    return [self initWithSeed:0];
+}
+
+/**
+ Initializes a hasher that incrementally computes the same 64-bit hash as -[NSData dejal_hash64WithSeed:] of everything appended.  Appended strings are hashed as their UTF-16 characters, as for -[NSString dejal_hash64WithSeed:].
+ 
+ @param seed The seed, to get independent hashes of the same bytes.
+ @returns A new hasher.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)initWithSeed:(uint64_t)seed;
+{
+    if ((self = [super init]))
+        DejalHashSetUp(&_state, seed);
+    
+    return self;
+}
+
+/**
+ Returns the seed the hasher was initialized with.
+ 
+ @author DJS 2026-10.
+ */
+
+- (uint64_t)seed;
+{
+    return _state.seed;
+}
+
+/**
+ Returns the number of bytes appended so far.
+ 
+ @author DJS 2026-10.
+ */
+
+- (unsigned long long)length;
+{
+    return _state.totalLength;
+}
+
+/**
+ Returns the hash of the bytes appended so far.  More can be appended afterwards.
+ 
+ @author DJS 2026-10.
+ */
+
+- (uint64_t)hashValue;
+{
+    return DejalHashDigest(&_state);
+}
+
+/**
+ Appends bytes to the hash.  The bytes can be split anywhere; the hash is the same however they are appended.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)appendBytes:(const void *)bytes length:(NSUInteger)length;
+{
+    DejalHashUpdate(&_state, bytes, length);
+}
+
+/**
+ Appends the bytes of the data to the hash.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)appendData:(NSData *)data;
+{
+    DejalHashUpdate(&_state, data.bytes, data.length);
+}
+
+/**
+ Appends the UTF-16 characters of the string to the hash, directly if they are available, otherwise a chunk at a time.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)appendString:(NSString *)string;
+{
+    NSUInteger length = string.length;
+    const unichar *characters = CFStringGetCharactersPtr((__bridge CFStringRef)string);
+    
+    if (characters)
+    {
+        DejalHashUpdate(&_state, (const uint8_t *)characters, length * sizeof(unichar));
+        return;
+    }
+    
+    unichar buffer[DEJAL_HASH_STRING_CHUNK_LENGTH];
+    
+    for (NSUInteger location = 0; location < length; location += DEJAL_HASH_STRING_CHUNK_LENGTH)
+    {
+        NSRange range = NSMakeRange(location, MIN(DEJAL_HASH_STRING_CHUNK_LENGTH, length - location));
+        
+        [string getCharacters:buffer range:range];
+        DejalHashUpdate(&_state, (const uint8_t *)buffer, range.length * sizeof(unichar));
+    }
+}
+
+/**
+ Reads bytes from the stream in fixed-size chunks until the end, opening it if needed, and appends them to the hash.
+ 
+ @returns YES if the stream was read to the end, or NO if it had an error.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)appendContentsOfStream:(NSInputStream *)stream;
+{
+    uint8_t *buffer = malloc(DEJAL_HASH_READ_CHUNK_LENGTH);
+    NSInteger bytesRead;
+    
+    if (stream.streamStatus == NSStreamStatusNotOpen)
+        [stream open];
+    
+    while ((bytesRead = [stream read:buffer maxLength:DEJAL_HASH_READ_CHUNK_LENGTH]) > 0)
+        DejalHashUpdate(&_state, buffer, (NSUInteger)bytesRead);
+    
+    free(buffer);
+    
+    return bytesRead == 0;
+}
+
+/**
+ Reads a file in fixed-size chunks and appends it to the hash.
+ 
+ @returns YES if the file was read, or NO if it couldn't be.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)appendContentsOfFile:(NSString *)path;
+{
+    NSInputStream *stream = [NSInputStream inputStreamWithFileAtPath:path];
+    BOOL result = [self appendContentsOfStream:stream];
+    
+    [stream close];
+    
+    return stream && result;
+}
+
+/**
+ Starts over, with the same seed.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)reset;
+{
+    DejalHashSetUp(&_state, _state.seed);
 }
 
 @end
@@ -30,6 +30,19 @@
 @import Foundation;
 
 
+typedef struct
+{
+    NSInteger year;
+    NSInteger month;
+    NSInteger day;
+    NSInteger hour;
+    NSInteger minute;
+    NSInteger second;
+    NSInteger weekday;
+    NSInteger dayOfYear;
+} DejalDateFields;
+
+
 @interface NSDate (Dejal)
 
 @property (nonatomic, readonly) BOOL dejal_includesTime;
@@ -54,10 +67,17 @@
 
 - (NSString *)dejal_stringWithFormat:(NSString *)format;
 
++ (NSDateFormatter *)dejal_dateFormatterWithFormat:(NSString *)format localeIdentifier:(NSString *)localeIdentifier;
++ (NSDateFormatter *)dejal_dateFormatterWithDateStyle:(NSDateFormatterStyle)dateStyle timeStyle:(NSDateFormatterStyle)timeStyle allowRelative:(BOOL)allowRelative;
++ (NSUInteger)dejal_dateFormatterCacheHits;
++ (NSUInteger)dejal_dateFormatterCacheMisses;
++ (void)dejal_resetDateFormatterCache;
+
 + (NSDateFormatter *)dejal_internetDateFormatter;
 
 + (NSDate *)dejal_dateWithJSONString:(NSString *)jsonDate;
 + (NSDate *)dejal_dateWithJSONString:(NSString *)jsonDate allowPlaceholder:(BOOL)allowPlaceholder;
++ (NSUInteger)dejal_parseJSONStrings:(NSArray *)jsonDates allowPlaceholder:(BOOL)allowPlaceholder intoTimeIntervalsSince1970:(NSTimeInterval *)intervals;
 - (NSString *)dejal_JSONStringValue;
 - (NSString *)dejal_oldStyleJSONStringValue;
 
@@ -66,6 +86,9 @@
 + (NSDate *)dejal_dateWithoutTime;
 - (NSDate *)dejal_dateAsDateWithoutTime;
 
+- (DejalDateFields)dejal_dateFields;
++ (void)dejal_getDateFields:(DejalDateFields *)fields forTimeIntervals:(const NSTimeInterval *)intervals count:(NSUInteger)count;
++ (void)dejal_getDateFields:(DejalDateFields *)fields forDates:(NSArray *)dates;
 - (NSDateComponents *)dejal_components:(NSCalendarUnit)unitFlags;
 
 - (BOOL)dejal_isBetweenDaysBefore:(NSInteger)daysBefore daysAfter:(NSInteger)daysAfter;
@@ -88,6 +111,11 @@
 - (NSInteger)dejal_differenceInMonthsTo:(NSDate *)toDate;
 - (NSInteger)dejal_differenceInYearsTo:(NSDate *)toDate;
 
++ (void)dejal_getBucketStarts:(NSTimeInterval *)starts forTimeIntervals:(const NSTimeInterval *)intervals count:(NSUInteger)count unit:(NSCalendarUnit)unit;
++ (NSArray *)dejal_bucketStartDatesForDates:(NSArray *)dates unit:(NSCalendarUnit)unit;
++ (void)dejal_getBucketIndexes:(NSInteger *)indexes forTimeIntervals:(const NSTimeInterval *)intervals count:(NSUInteger)count unit:(NSCalendarUnit)unit;
++ (void)dejal_getDifferences:(NSInteger *)differences fromTimeIntervals:(const NSTimeInterval *)fromIntervals toTimeIntervals:(const NSTimeInterval *)toIntervals count:(NSUInteger)count unit:(NSCalendarUnit)unit;
+
 - (NSString *)dejal_formattedShortDateString;
 - (NSString *)dejal_formattedDateString;
 - (NSString *)dejal_formattedStringUsingDateStyle:(NSDateFormatterStyle)dateStyle timeStyle:(NSDateFormatterStyle)timeStyle;
@@ -31,6 +31,482 @@
 
 #import "NSDate+Dejal.h"
 #import "NSString+Dejal.h"
+#import <stdatomic.h>
+
+
+// Upper bound on the number of distinct formatters kept by the shared formatter cache:
+#define DEJAL_DATE_FORMATTER_CACHE_LIMIT 64
+
+static atomic_uint_fast64_t dejal_dateFormatterCacheHits = 0;
+static atomic_uint_fast64_t dejal_dateFormatterCacheMisses = 0;
+
+// Longest JSON date string handled by the fast parser; longer ones go through the formatter:
+#define DEJAL_JSON_DATE_MAX_LENGTH 64
+
+typedef NS_ENUM(NSInteger, DejalJSONDateParseResult)
+{
+    DejalJSONDateParseResultUnhandled = 0,
+    DejalJSONDateParseResultDate,
+    DejalJSONDateParseResultLocalDate,
+    DejalJSONDateParseResultNil
+};
+
+
+/**
+ Returns the number of days since 1970-01-01 for the specified proleptic Gregorian year, month and day.  Based on Howard Hinnant's days_from_civil algorithm.
+ 
+ @author DJS 2026-10.
+ */
+
+static inline int64_t DejalDaysFromCivil(int64_t year, int64_t month, int64_t day)
+{
+    year -= month <= 2;
+    
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    
+    return era * 146097 + dayOfEra - 719468;
+}
+
+/**
+ Returns the number of days in the specified month of the proleptic Gregorian calendar.
+ 
+ @author DJS 2026-10.
+ */
+
+static inline int64_t DejalDaysInMonth(int64_t year, int64_t month)
+{
+    static const int8_t days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    BOOL isLeap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    
+    return month == 2 && isLeap ? 29 : days[month - 1];
+}
+
+/**
+ Reads exactly count ASCII digits from the characters at the index, advancing it.  Returns NO if there aren't enough digits.
+ 
+ @author DJS 2026-10.
+ */
+
+static inline BOOL DejalScanDigits(const unichar *chars, NSUInteger length, NSUInteger *index, NSUInteger count, int64_t *value)
+{
+    if (*index + count > length)
+        return NO;
+    
+    int64_t result = 0;
+    
+    for (NSUInteger i = *index; i < *index + count; i++)
+    {
+        unichar c = chars[i];
+        
+        if (c < '0' || c > '9')
+            return NO;
+        
+        result = result * 10 + (c - '0');
+    }
+    
+    *index += count;
+    *value = result;
+    
+    return YES;
+}
+
+/**
+ Parses the characters of a "/Date(ms)/" string, with the same semantics as -longLongValue on the text following the prefix: leading whitespace and a sign are allowed, parsing stops at the first non-digit (so any zone suffix is ignored), and overflow saturates.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSTimeInterval DejalParseOldStyleJSONDate(const unichar *chars, NSUInteger length)
+{
+    NSUInteger i = 6;  // strlen("/Date(")
+    BOOL negative = NO;
+    uint64_t value = 0;
+    BOOL overflow = NO;
+    
+    while (i < length && (chars[i] == ' ' || chars[i] == '\t' || chars[i] == '\n' || chars[i] == '\r'))
+        i++;
+    
+    if (i < length && (chars[i] == '-' || chars[i] == '+'))
+    {
+        negative = chars[i] == '-';
+        i++;
+    }
+    
+    for (; i < length && chars[i] >= '0' && chars[i] <= '9'; i++)
+    {
+        if (value > ((uint64_t)LLONG_MAX - (chars[i] - '0')) / 10)
+            overflow = YES;
+        else
+            value = value * 10 + (chars[i] - '0');
+    }
+    
+    long long milliseconds;
+    
+    if (overflow)
+        milliseconds = negative ? LLONG_MIN : LLONG_MAX;
+    else
+        milliseconds = negative ? -(long long)value : (long long)value;
+    
+    return milliseconds / 1000.0;
+}
+
+/**
+ Parses the characters of a JSON date string without allocating, computing the interval since 1970 arithmetically.  Handles "/Date(ms)/" and RFC 3339 "yyyy-MM-ddTHH:mm:ss" with optional fractional seconds and a "Z" or numeric zone offset.  Strings without a zone are reported as local dates, for the caller to adjust.  Anything else, including dates before the Gregorian changeover, is reported as unhandled, so the caller can fall back to the formatter and keep its exact behavior.
+ 
+ @author DJS 2026-10.
+ */
+
+static DejalJSONDateParseResult DejalParseJSONDateCharacters(const unichar *chars, NSUInteger length, BOOL allowPlaceholder, NSTimeInterval *interval)
+{
+    static const unichar oldStylePrefix[] = {'/', 'D', 'a', 't', 'e', '('};
+    
+    if (length >= 6 && memcmp(chars, oldStylePrefix, sizeof(oldStylePrefix)) == 0)
+    {
+        *interval = DejalParseOldStyleJSONDate(chars, length);
+        return DejalJSONDateParseResultDate;
+    }
+    
+    NSUInteger i = 0;
+    int64_t year, month, day, hour, minute, second;
+    
+    if (!DejalScanDigits(chars, length, &i, 4, &year) || i >= length || chars[i++] != '-' ||
+        !DejalScanDigits(chars, length, &i, 2, &month) || i >= length || chars[i++] != '-' ||
+        !DejalScanDigits(chars, length, &i, 2, &day))
+        return DejalJSONDateParseResultUnhandled;
+    
+    if (!allowPlaceholder && ((year == 1899 && month == 12 && day == 30) || (year == 1 && month == 1 && day == 1)))
+        return DejalJSONDateParseResultNil;
+    
+    if (i >= length || chars[i++] != 'T' ||
+        !DejalScanDigits(chars, length, &i, 2, &hour) || i >= length || chars[i++] != ':' ||
+        !DejalScanDigits(chars, length, &i, 2, &minute) || i >= length || chars[i++] != ':' ||
+        !DejalScanDigits(chars, length, &i, 2, &second))
+        return DejalJSONDateParseResultUnhandled;
+    
+    // NSDateFormatter uses the Julian calendar before the Gregorian changeover, so leave early dates to it:
+    if (year < 1583 || month < 1 || month > 12 || day < 1 || day > DejalDaysInMonth(year, month) || hour > 23 || minute > 59 || second > 59)
+        return DejalJSONDateParseResultUnhandled;
+    
+    double fraction = 0.0;
+    
+    if (i < length && chars[i] == '.')
+    {
+        double scale = 0.1;
+        NSUInteger start = ++i;
+        
+        for (; i < length && chars[i] >= '0' && chars[i] <= '9'; i++)
+        {
+            fraction += (chars[i] - '0') * scale;
+            scale /= 10.0;
+        }
+        
+        if (i == start)
+            return DejalJSONDateParseResultUnhandled;
+    }
+    
+    DejalJSONDateParseResult result = DejalJSONDateParseResultDate;
+    int64_t offset = 0;
+    
+    if (i == length)
+    {
+        result = DejalJSONDateParseResultLocalDate;
+    }
+    else if (chars[i] == 'Z' && i + 1 == length)
+    {
+        i++;
+    }
+    else if (chars[i] == '+' || chars[i] == '-')
+    {
+        int64_t sign = chars[i++] == '-' ? -1 : 1;
+        int64_t offsetHours, offsetMinutes = 0;
+        
+        if (!DejalScanDigits(chars, length, &i, 2, &offsetHours))
+            return DejalJSONDateParseResultUnhandled;
+        
+        if (i < length && chars[i] == ':')
+            i++;
+        
+        if (i < length && !DejalScanDigits(chars, length, &i, 2, &offsetMinutes))
+            return DejalJSONDateParseResultUnhandled;
+        
+        if (i != length || offsetHours > 23 || offsetMinutes > 59)
+            return DejalJSONDateParseResultUnhandled;
+        
+        offset = sign * (offsetHours * 3600 + offsetMinutes * 60);
+    }
+    else
+    {
+        return DejalJSONDateParseResultUnhandled;
+    }
+    
+    int64_t seconds = DejalDaysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offset;
+    
+    *interval = (NSTimeInterval)seconds + fraction;
+    
+    return result;
+}
+
+
+/**
+ Returns the proleptic Gregorian year, month and day for the specified number of days since 1970-01-01.  Based on Howard Hinnant's civil_from_days algorithm.
+ 
+ @author DJS 2026-10.
+ */
+
+static inline void DejalCivilFromDays(int64_t days, int64_t *year, int64_t *month, int64_t *day)
+{
+    days += 719468;
+    
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+    
+    *day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    *month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    *year = yearOfEra + era * 400 + (*month <= 2);
+}
+
+/**
+ Floor division, i.e. rounding towards negative infinity, for splitting local seconds into days.
+ 
+ @author DJS 2026-10.
+ */
+
+static inline int64_t DejalFloorDivide(int64_t value, int64_t divisor)
+{
+    int64_t quotient = value / divisor;
+    
+    return (value % divisor != 0 && (value < 0) != (divisor < 0)) ? quotient - 1 : quotient;
+}
+
+// Days since 1970 of 1583-01-01, the first whole year after the Gregorian changeover; NSCalendar uses the Julian calendar before it:
+#define DEJAL_FIRST_GREGORIAN_DAY -141349
+
+/**
+ Fills in the date fields from local (zone-adjusted) seconds since 1970, using pure arithmetic, so the compiler can vectorize loops over it.  Returns NO if the date is before the Gregorian changeover, so the caller can fall back to NSCalendar.
+ 
+ @author DJS 2026-10.
+ */
+
+static inline BOOL DejalDateFieldsFromLocalSeconds(int64_t localSeconds, DejalDateFields *fields)
+{
+    int64_t days = DejalFloorDivide(localSeconds, 86400);
+    int64_t secondOfDay = localSeconds - days * 86400;
+    int64_t year, month, day;
+    
+    if (days < DEJAL_FIRST_GREGORIAN_DAY)
+        return NO;
+    
+    DejalCivilFromDays(days, &year, &month, &day);
+    
+    fields->year = year;
+    fields->month = month;
+    fields->day = day;
+    fields->hour = secondOfDay / 3600;
+    fields->minute = secondOfDay / 60 % 60;
+    fields->second = secondOfDay % 60;
+    fields->weekday = ((days + 4) % 7 + 7) % 7 + 1;  // 1970-01-01 was a Thursday; Sunday = 1
+    fields->dayOfYear = days - DejalDaysFromCivil(year, 1, 1) + 1;
+    
+    return YES;
+}
+
+
+#pragma mark -
+
+
+// Range of the cached transition table, 1900-01-01 to 2100-01-01 UTC; dates outside it ask the time zone directly:
+#define DEJAL_OFFSET_TABLE_START -2208988800LL
+#define DEJAL_OFFSET_TABLE_END 4102444800LL
+
+/**
+ Private class that caches the UTC offset transitions of a time zone, so the offset for a date can be found by binary search instead of asking the time zone every time.
+ 
+ @author DJS 2026-10.
+ */
+
+@interface DejalTimeZoneOffsetTable : NSObject
+{
+    int64_t *_transitions;
+    int32_t *_offsets;
+    NSUInteger _count;
+}
+
+@property (nonatomic, strong, readonly) NSTimeZone *timeZone;
+
+- (instancetype)initWithTimeZone:(NSTimeZone *)timeZone;
+
+- (int64_t)secondsFromGMTForSecondsSince1970:(int64_t)seconds;
+- (int64_t)secondsSince1970ForLocalSeconds:(int64_t)localSeconds;
+
+@end
+
+
+@implementation DejalTimeZoneOffsetTable
+
+/**
+ Builds the transition table for the specified time zone.  The first entry is the offset at the start of the table range; each further entry is the offset from that transition on.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)initWithTimeZone:(NSTimeZone *)timeZone;
+{
+    if ((self = [super init]))
+    {
+        NSUInteger capacity = 512;
+        NSDate *date = [NSDate dateWithTimeIntervalSince1970:DEJAL_OFFSET_TABLE_START];
+        
+        _timeZone = timeZone;
+        _transitions = malloc(capacity * sizeof(int64_t));
+        _offsets = malloc(capacity * sizeof(int32_t));
+        _transitions[0] = DEJAL_OFFSET_TABLE_START;
+        _offsets[0] = (int32_t)[timeZone secondsFromGMTForDate:date];
+        _count = 1;
+        
+        NSDate *transition = [timeZone nextDaylightSavingTimeTransitionAfterDate:date];
+        
+        while (transition && [transition timeIntervalSince1970] < DEJAL_OFFSET_TABLE_END && [transition compare:date] == NSOrderedDescending)
+        {
+            if (_count == capacity)
+            {
+                capacity *= 2;
+                _transitions = realloc(_transitions, capacity * sizeof(int64_t));
+                _offsets = realloc(_offsets, capacity * sizeof(int32_t));
+            }
+            
+            _transitions[_count] = (int64_t)floor([transition timeIntervalSince1970]);
+            _offsets[_count] = (int32_t)[timeZone secondsFromGMTForDate:transition];
+            _count++;
+            
+            date = transition;
+            transition = [timeZone nextDaylightSavingTimeTransitionAfterDate:date];
+        }
+    }
+    
+    return self;
+}
+
+- (void)dealloc;
+{
+    free(_transitions);
+    free(_offsets);
+}
+
+/**
+ Returns the UTC offset in effect at the specified number of seconds since 1970.
+ 
+ @author DJS 2026-10.
+ */
+
+- (int64_t)secondsFromGMTForSecondsSince1970:(int64_t)seconds;
+{
+    if (seconds < DEJAL_OFFSET_TABLE_START || seconds >= DEJAL_OFFSET_TABLE_END)
+        return [self.timeZone secondsFromGMTForDate:[NSDate dateWithTimeIntervalSince1970:seconds]];
+    
+    NSUInteger low = 0;
+    NSUInteger high = _count;
+    
+    while (high - low > 1)
+    {
+        NSUInteger middle = (low + high) / 2;
+        
+        if (_transitions[middle] <= seconds)
+            low = middle;
+        else
+            high = middle;
+    }
+    
+    return _offsets[low];
+}
+
+/**
+ Returns the seconds since 1970 for the specified local (wall clock) seconds since 1970.  Follows NSCalendar for wall times affected by a transition: a time skipped by a transition is moved forward by the transition amount, and a time that occurs twice resolves to the later occurrence.
+ 
+ @author DJS 2026-10.
+ */
+
+- (int64_t)secondsSince1970ForLocalSeconds:(int64_t)localSeconds;
+{
+    int64_t guess = localSeconds - [self secondsFromGMTForSecondsSince1970:localSeconds];
+    int64_t offsetBefore = [self secondsFromGMTForSecondsSince1970:guess - 86400];
+    int64_t offsetAfter = [self secondsFromGMTForSecondsSince1970:guess + 86400];
+    int64_t candidateBefore = localSeconds - offsetBefore;
+    int64_t candidateAfter = localSeconds - offsetAfter;
+    BOOL validBefore = [self secondsFromGMTForSecondsSince1970:candidateBefore] == offsetBefore;
+    BOOL validAfter = [self secondsFromGMTForSecondsSince1970:candidateAfter] == offsetAfter;
+    
+    if (validBefore && validAfter)
+        return MAX(candidateBefore, candidateAfter);
+    else if (validBefore)
+        return candidateBefore;
+    else if (validAfter)
+        return candidateAfter;
+    else
+        return localSeconds - MIN(offsetBefore, offsetAfter);
+}
+
+@end
+
+
+/**
+ Returns the seconds since 1970 of adding whole days, months or years to local (wall clock) date fields, keeping the time of day and clamping the day to the length of the month, like NSCalendar.
+ 
+ @author DJS 2026-10.
+ */
+
+static int64_t DejalSecondsByAddingUnits(DejalTimeZoneOffsetTable *table, NSCalendarUnit unit, int64_t amount, int64_t year, int64_t month, int64_t day, int64_t secondOfDay)
+{
+    if (unit == NSCalendarUnitDay)
+        return [table secondsSince1970ForLocalSeconds:(DejalDaysFromCivil(year, month, day) + amount) * 86400 + secondOfDay];
+    
+    int64_t monthIndex = year * 12 + month - 1 + (unit == NSCalendarUnitYear ? amount * 12 : amount);
+    int64_t newYear = DejalFloorDivide(monthIndex, 12);
+    int64_t newMonth = monthIndex - newYear * 12 + 1;
+    int64_t newDay = MIN(day, DejalDaysInMonth(newYear, newMonth));
+    
+    return [table secondsSince1970ForLocalSeconds:DejalDaysFromCivil(newYear, newMonth, newDay) * 86400 + secondOfDay];
+}
+
+
+// Batch date operations with at least this many elements are split into chunks processed concurrently:
+#define DEJAL_DATE_BATCH_PARALLEL_THRESHOLD 16384
+#define DEJAL_DATE_BATCH_CHUNK_SIZE 4096
+
+/**
+ Calls the block for ranges of indexes covering the count, concurrently in chunks if the count is large enough to be worth it, otherwise in a single call on the current thread.
+ 
+ @author DJS 2026-10.
+ */
+
+static void DejalApplyInChunks(NSUInteger count, void (^block)(NSUInteger start, NSUInteger end))
+{
+    if (count < DEJAL_DATE_BATCH_PARALLEL_THRESHOLD)
+    {
+        block(0, count);
+        return;
+    }
+    
+    NSUInteger chunks = (count + DEJAL_DATE_BATCH_CHUNK_SIZE - 1) / DEJAL_DATE_BATCH_CHUNK_SIZE;
+    
+    dispatch_apply(chunks, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t chunk)
+                   {
+                       @autoreleasepool
+                       {
+                           NSUInteger start = chunk * DEJAL_DATE_BATCH_CHUNK_SIZE;
+                           
+                           block(start, MIN(start + DEJAL_DATE_BATCH_CHUNK_SIZE, count));
+                       }
+                   });
+}
+
+
+#pragma mark -
 
 
 @implementation NSDate (Dejal)
@@ -101,6 +577,7 @@
  Given a date as a string, returns a new date representation, or nil if the string is nil or empty.
  
  @author DJS 2009-09.
+ @version DJS 2026-10: changed to use the shared formatter cache.
 */
 
 + (NSDate *)dejal_dateWithString:(NSString *)string;
@@ -108,7 +585,7 @@
     if (!string.length)
         return nil;
 
-    NSDateFormatter *formatter = [NSDateFormatter new];
+    NSDateFormatter *formatter = [self dejal_dateFormatterWithDateStyle:NSDateFormatterNoStyle timeStyle:NSDateFormatterNoStyle allowRelative:NO];
     NSDate *date = [formatter dateFromString:string];
     
     return date;
@@ -119,6 +596,7 @@
  
  @author DJS 2009-09.
  @version DJS 2010-02: changed to set the locale too.
+ @version DJS 2026-10: changed to use the shared formatter cache.
 */
 
 + (NSDate *)dejal_dateWithString:(NSString *)string format:(NSString *)format;
@@ -126,13 +604,7 @@
     if (!string.length)
         return nil;
     
-    NSDateFormatter *formatter = [NSDateFormatter new];
-
-    [formatter setLocale:[[NSLocale alloc] initWithLocaleIdentifier:@"en"]];
-	
-    if (format)
-        [formatter setDateFormat:format];
-
+    NSDateFormatter *formatter = [self dejal_dateFormatterWithFormat:format localeIdentifier:@"en"];
     NSDate *date = [formatter dateFromString:string];
     
     return date;
@@ -142,41 +614,192 @@
  Returns the receiver as a string in the specified format.
  
  @author DJS 2012-05.
+ @version DJS 2026-10: changed to use the shared formatter cache.
 */
 
 - (NSString *)dejal_stringWithFormat:(NSString *)format;
 {
-    NSDateFormatter *formatter = [NSDateFormatter new];
-
-    [formatter setLocale:[[NSLocale alloc] initWithLocaleIdentifier:@"en"]];
-	
-    if (format)
-        [formatter setDateFormat:format];
+    NSDateFormatter *formatter = [NSDate dejal_dateFormatterWithFormat:format localeIdentifier:@"en"];
 
     return [formatter stringFromDate:self];
 }
 
+/**
+ Private singleton method to return the cache used by the shared date formatter methods, creating it if necessary.  The cache is emptied whenever the current locale or system time zone changes.
+ 
+ @author DJS 2026-10.
+ */
+
++ (NSCache *)dejal_dateFormatterCache;
+{
+    static NSCache *dejal_dateFormatterCache = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^
+                  {
+                      dejal_dateFormatterCache = [NSCache new];
+                      dejal_dateFormatterCache.name = @"com.dejal.date-formatter-cache";
+                      dejal_dateFormatterCache.countLimit = DEJAL_DATE_FORMATTER_CACHE_LIMIT;
+                      
+                      NSNotificationCenter *center = [NSNotificationCenter defaultCenter];
+                      void (^invalidate)(NSNotification *) = ^(NSNotification *note)
+                      {
+                          [dejal_dateFormatterCache removeAllObjects];
+                      };
+                      
+                      [center addObserverForName:NSCurrentLocaleDidChangeNotification object:nil queue:nil usingBlock:invalidate];
+                      [center addObserverForName:NSSystemTimeZoneDidChangeNotification object:nil queue:nil usingBlock:invalidate];
+                  });
+    
+    return dejal_dateFormatterCache;
+}
+
+/**
+ Private method to return the formatter in the shared cache for the specified key, creating it via the block and caching it if there isn't one yet.  Updates the hit and miss counters.
+ 
+ @author DJS 2026-10.
+ */
+
++ (NSDateFormatter *)dejal_cachedDateFormatterForKey:(NSString *)key creator:(NSDateFormatter *(^)(void))creator;
+{
+    NSCache *cache = [self dejal_dateFormatterCache];
+    NSDateFormatter *formatter = [cache objectForKey:key];
+    
+    if (formatter)
+    {
+        atomic_fetch_add_explicit(&dejal_dateFormatterCacheHits, 1, memory_order_relaxed);
+    }
+    else
+    {
+        atomic_fetch_add_explicit(&dejal_dateFormatterCacheMisses, 1, memory_order_relaxed);
+        
+        formatter = creator();
+        
+        [cache setObject:formatter forKey:key];
+    }
+    
+    return formatter;
+}
+
+/**
+ Returns a shared date formatter using the specified format and locale, in the current default time zone.  Formatters are cached by format, locale and time zone, and are safe to use from multiple threads, but must not be modified by the caller.
+ 
+ @param format The date format string, e.g. @"yyyy-MM-dd", or nil for no format.
+ @param localeIdentifier The locale identifier, e.g. @"en", or nil to use the current locale.
+ @returns A cached date formatter.
+ 
+ @author DJS 2026-10.
+ */
+
++ (NSDateFormatter *)dejal_dateFormatterWithFormat:(NSString *)format localeIdentifier:(NSString *)localeIdentifier;
+{
+    NSTimeZone *timeZone = [NSTimeZone defaultTimeZone];
+    NSString *resolvedLocaleIdentifier = localeIdentifier ?: [[NSLocale currentLocale] localeIdentifier];
+    NSString *key = [NSString stringWithFormat:@"F|%@|%@|%@", format ?: @"", resolvedLocaleIdentifier, timeZone.name];
+    
+    return [self dejal_cachedDateFormatterForKey:key creator:^NSDateFormatter *
+    {
+        NSDateFormatter *formatter = [NSDateFormatter new];
+        
+        formatter.locale = localeIdentifier ? [[NSLocale alloc] initWithLocaleIdentifier:localeIdentifier] : [NSLocale currentLocale];
+        formatter.timeZone = timeZone;
+        
+        if (format)
+            formatter.dateFormat = format;
+        
+        return formatter;
+    }];
+}
+
+/**
+ Returns a shared date formatter using the specified date and time styles, in the current locale and default time zone.  Formatters are cached by style, locale and time zone, and are safe to use from multiple threads, but must not be modified by the caller.
+ 
+ @param dateStyle The date style to use.
+ @param timeStyle The time style to use.
+ @param allowRelative YES to use a relative representation (e.g. "tomorrow"), or NO to always use absolute date.
+ @returns A cached date formatter.
+ 
+ @author DJS 2026-10.
+ */
+
++ (NSDateFormatter *)dejal_dateFormatterWithDateStyle:(NSDateFormatterStyle)dateStyle timeStyle:(NSDateFormatterStyle)timeStyle allowRelative:(BOOL)allowRelative;
+{
+    NSTimeZone *timeZone = [NSTimeZone defaultTimeZone];
+    NSLocale *locale = [NSLocale currentLocale];
+    NSString *key = [NSString stringWithFormat:@"S|%lu|%lu|%d|%@|%@", (unsigned long)dateStyle, (unsigned long)timeStyle, allowRelative, locale.localeIdentifier, timeZone.name];
+    
+    return [self dejal_cachedDateFormatterForKey:key creator:^NSDateFormatter *
+    {
+        NSDateFormatter *formatter = [NSDateFormatter new];
+        
+        formatter.locale = locale;
+        formatter.timeZone = timeZone;
+        formatter.dateStyle = dateStyle;
+        formatter.timeStyle = timeStyle;
+        formatter.doesRelativeDateFormatting = allowRelative;
+        
+        return formatter;
+    }];
+}
+
+/**
+ Returns the number of times a shared date formatter was found in the cache.
+ 
+ @author DJS 2026-10.
+ */
+
++ (NSUInteger)dejal_dateFormatterCacheHits;
+{
+    return (NSUInteger)atomic_load_explicit(&dejal_dateFormatterCacheHits, memory_order_relaxed);
+}
+
+/**
+ Returns the number of times a shared date formatter had to be created, i.e. wasn't found in the cache.
+ 
+ @author DJS 2026-10.
+ */
+
++ (NSUInteger)dejal_dateFormatterCacheMisses;
+{
+    return (NSUInteger)atomic_load_explicit(&dejal_dateFormatterCacheMisses, memory_order_relaxed);
+}
+
+/**
+ Empties the shared date formatter cache and resets the hit and miss counters.
+ 
+ @author DJS 2026-10.
+ */
+
++ (void)dejal_resetDateFormatterCache;
+{
+    [[self dejal_dateFormatterCache] removeAllObjects];
+    
+    atomic_store_explicit(&dejal_dateFormatterCacheHits, 0, memory_order_relaxed);
+    atomic_store_explicit(&dejal_dateFormatterCacheMisses, 0, memory_order_relaxed);
+}
+
 /**
  Singleton to return a date formatter for the RFC3339 standard internet date format.
  
  @author DJS 2012-04.
+ @version DJS 2026-10: changed to use dispatch_once, so it's safe to call from multiple threads.
 */
 
 + (NSDateFormatter *)dejal_internetDateFormatter;
 {
     static NSDateFormatter *sRFC3339DateFormatter = nil;
+    static dispatch_once_t onceToken;
     
-    if (!sRFC3339DateFormatter)
-    {
-        NSLocale *enUSPOSIXLocale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
-        
-        sRFC3339DateFormatter = [NSDateFormatter new];
-        
-        [sRFC3339DateFormatter setLocale:enUSPOSIXLocale];
-        [sRFC3339DateFormatter setDateFormat:@"yyyy-MM-dd'T'HH:mm:ss'Z'"];  //@"yyyy'-'MM'-'dd'T'HH':'mm':'ss'Z'"];
-        [sRFC3339DateFormatter setTimeZone:[NSTimeZone defaultTimeZone]];
-        [sRFC3339DateFormatter setTimeZone:[NSTimeZone timeZoneForSecondsFromGMT:0]];
-    }
+    dispatch_once(&onceToken, ^
+                  {
+                      NSLocale *enUSPOSIXLocale = [[NSLocale alloc] initWithLocaleIdentifier:@"en_US_POSIX"];
+                      
+                      sRFC3339DateFormatter = [NSDateFormatter new];
+                      
+                      [sRFC3339DateFormatter setLocale:enUSPOSIXLocale];
+                      [sRFC3339DateFormatter setDateFormat:@"yyyy-MM-dd'T'HH:mm:ss'Z'"];  //@"yyyy'-'MM'-'dd'T'HH':'mm':'ss'Z'"];
+                      [sRFC3339DateFormatter setTimeZone:[NSTimeZone timeZoneForSecondsFromGMT:0]];
+                  });
     
     return sRFC3339DateFormatter;
 }
@@ -201,13 +824,114 @@
  @version DJS 2012-06: changed to optionally return nil if it's the 1899 placeholder date.
  @version DJS 2013-01: changed to avoid accidentially removing the "Z".
  @version DJS 2013-05: changed to add support for the 0001 placeholder date.
+ @version DJS 2026-10: changed to use an allocation-free parser, which keeps fractional seconds and handles numeric zone offsets, falling back to the formatter for other forms.
 */
 
 + (NSDate *)dejal_dateWithJSONString:(NSString *)jsonDate allowPlaceholder:(BOOL)allowPlaceholder;
 {
     if (![jsonDate isKindOfClass:[NSString class]] || !jsonDate.length)
         return nil;
-    else if (!allowPlaceholder && ([jsonDate hasPrefix:@"1899-12-30"] || [jsonDate hasPrefix:@"0001-01-01"]))
+    
+    NSTimeInterval interval = 0.0;
+    DejalJSONDateParseResult parsed = [self dejal_parseJSONString:jsonDate allowPlaceholder:allowPlaceholder timeIntervalSince1970:&interval];
+    
+    if (parsed == DejalJSONDateParseResultNil)
+        return nil;
+    else if (parsed == DejalJSONDateParseResultDate)
+        return [NSDate dateWithTimeIntervalSince1970:interval];
+    else if (parsed == DejalJSONDateParseResultLocalDate)
+        return [NSDate dateWithTimeIntervalSince1970:interval + [self dejal_localTimeOffset]];
+    else
+        return [self dejal_formatterDateWithJSONString:jsonDate allowPlaceholder:allowPlaceholder];
+}
+
+/**
+ Private method to parse a JSON date string via the fast parser, copying its characters into a stack buffer.  Returns DejalJSONDateParseResultUnhandled if the string is too long or not in a recognized form.
+ 
+ @author DJS 2026-10.
+ */
+
++ (DejalJSONDateParseResult)dejal_parseJSONString:(NSString *)jsonDate allowPlaceholder:(BOOL)allowPlaceholder timeIntervalSince1970:(NSTimeInterval *)interval;
+{
+    NSUInteger length = jsonDate.length;
+    
+    if (length > DEJAL_JSON_DATE_MAX_LENGTH)
+        return DejalJSONDateParseResultUnhandled;
+    
+    unichar chars[DEJAL_JSON_DATE_MAX_LENGTH];
+    
+    [jsonDate getCharacters:chars range:NSMakeRange(0, length)];
+    
+    return DejalParseJSONDateCharacters(chars, length, allowPlaceholder, interval);
+}
+
+/**
+ Parses an array of JSON date strings (see +dejal_dateWithJSONString:allowPlaceholder:) into a C array of intervals since 1970, which must have room for the number of strings.  Values that aren't strings, are empty, or can't be parsed result in NAN.  The local time offset is only looked up once for the whole array.
+ 
+ @param jsonDates An array of JSON date strings.
+ @param allowPlaceholder If NO, the 1899 and 0001 placeholder dates result in NAN.
+ @param intervals A C array to receive the intervals since 1970.
+ @returns The number of strings successfully parsed.
+ 
+ @author DJS 2026-10.
+ */
+
++ (NSUInteger)dejal_parseJSONStrings:(NSArray *)jsonDates allowPlaceholder:(BOOL)allowPlaceholder intoTimeIntervalsSince1970:(NSTimeInterval *)intervals;
+{
+    NSTimeInterval localTimeOffset = 0.0;
+    BOOL haveLocalTimeOffset = NO;
+    NSUInteger parsedCount = 0;
+    NSUInteger i = 0;
+    
+    for (NSString *jsonDate in jsonDates)
+    {
+        NSTimeInterval interval = NAN;
+        
+        if ([jsonDate isKindOfClass:[NSString class]] && jsonDate.length)
+        {
+            DejalJSONDateParseResult parsed = [self dejal_parseJSONString:jsonDate allowPlaceholder:allowPlaceholder timeIntervalSince1970:&interval];
+            
+            if (parsed == DejalJSONDateParseResultNil)
+            {
+                interval = NAN;
+            }
+            else if (parsed == DejalJSONDateParseResultLocalDate)
+            {
+                if (!haveLocalTimeOffset)
+                {
+                    localTimeOffset = [self dejal_localTimeOffset];
+                    haveLocalTimeOffset = YES;
+                }
+                
+                interval += localTimeOffset;
+            }
+            else if (parsed == DejalJSONDateParseResultUnhandled)
+            {
+                NSDate *date = [self dejal_formatterDateWithJSONString:jsonDate allowPlaceholder:allowPlaceholder];
+                
+                interval = date ? [date timeIntervalSince1970] : NAN;
+            }
+        }
+        
+        if (!isnan(interval))
+            parsedCount++;
+        
+        intervals[i++] = interval;
+    }
+    
+    return parsedCount;
+}
+
+/**
+ Private method to parse a JSON date string via the RFC3339 date formatter.  This was the implementation of +dejal_dateWithJSONString:allowPlaceholder: before the fast parser; it is now only used for strings the fast parser doesn't handle.
+ 
+ @author DJS 2012-01.
+ @version DJS 2026-10: moved from +dejal_dateWithJSONString:allowPlaceholder:.
+ */
+
++ (NSDate *)dejal_formatterDateWithJSONString:(NSString *)jsonDate allowPlaceholder:(BOOL)allowPlaceholder;
+{
+    if (!allowPlaceholder && ([jsonDate hasPrefix:@"1899-12-30"] || [jsonDate hasPrefix:@"0001-01-01"]))
         return nil;
     else if ([jsonDate hasPrefix:@"/Date("])
     {
@@ -361,91 +1085,276 @@
  Returns the second of the receiver.
  
  @author DJS 2014-08.
+ @version DJS 2026-10: changed to use -dejal_dateFields.
  */
 
 - (NSInteger)dejal_second;
 {
-    return [self dejal_components:NSCalendarUnitSecond].second;
+    return [self dejal_dateFields].second;
 }
 
 /**
  Returns the minute of the receiver.
  
  @author DJS 2014-08.
+ @version DJS 2026-10: changed to use -dejal_dateFields.
  */
 
 - (NSInteger)dejal_minute;
 {
-    return [self dejal_components:NSCalendarUnitMinute].minute;
+    return [self dejal_dateFields].minute;
 }
 
 /**
  Returns the hour of the receiver.
  
  @author DJS 2014-08.
+ @version DJS 2026-10: changed to use -dejal_dateFields.
  */
 
 - (NSInteger)dejal_hour;
 {
-    return [self dejal_components:NSCalendarUnitHour].hour;
+    return [self dejal_dateFields].hour;
 }
 
 /**
  Returns the day of the week for the receiver.  If the current calendar is Gregorian, Sunday = 1, Monday = 2, etc.
  
  @author DJS 2013-02.
+ @version DJS 2026-10: changed to use -dejal_dateFields.
 */
 
 - (NSInteger)dejal_weekday;
 {
-    return [self dejal_components:NSCalendarUnitWeekday].weekday;
+    return [self dejal_dateFields].weekday;
 }
 
 /**
  Returns the day of the year for the receiver.  Note that this is different from the day of month.
  
  @author DJS 2014-08.
+ @version DJS 2026-10: changed to use -dejal_dateFields.
  */
 
 - (NSInteger)dejal_dayOfYear;
 {
-    NSCalendar *calendar = [NSCalendar currentCalendar];
-    NSUInteger dayOfYear = [calendar ordinalityOfUnit:NSCalendarUnitDay inUnit:NSCalendarUnitYear forDate:self];
-    
-    return dayOfYear;
+    return [self dejal_dateFields].dayOfYear;
 }
 
 /**
  Returns the day of the receiver.
  
  @author DJS 2014-08.
+ @version DJS 2026-10: changed to use -dejal_dateFields.
  */
 
 - (NSInteger)dejal_day;
 {
-    return [self dejal_components:NSCalendarUnitDay].day;
+    return [self dejal_dateFields].day;
 }
 
 /**
  Returns the month of the receiver.
  
  @author DJS 2014-08.
+ @version DJS 2026-10: changed to use -dejal_dateFields.
  */
 
 - (NSInteger)dejal_month;
 {
-    return [self dejal_components:NSCalendarUnitMonth].month;
+    return [self dejal_dateFields].month;
 }
 
 /**
  Returns the year of the receiver.
  
  @author DJS 2014-08.
+ @version DJS 2026-10: changed to use -dejal_dateFields.
 */
 
 - (NSInteger)dejal_year;
 {
-    return [self dejal_components:NSCalendarUnitYear].year;
+    return [self dejal_dateFields].year;
+}
+
+/**
+ Private method to return the offset table for the current calendar's time zone, or nil if the current calendar isn't Gregorian, so the caller needs to use NSCalendar instead.  The table is rebuilt when the default time zone changes, and the calendar check is redone when the current locale changes.
+ 
+ @author DJS 2026-10.
+ */
+
++ (DejalTimeZoneOffsetTable *)dejal_gregorianOffsetTable;
+{
+    static DejalTimeZoneOffsetTable *sOffsetTable = nil;
+    static BOOL sNeedsCalendarCheck = YES;
+    static BOOL sIsGregorian = NO;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^
+                  {
+                      NSNotificationCenter *center = [NSNotificationCenter defaultCenter];
+                      void (^invalidate)(NSNotification *) = ^(NSNotification *note)
+                      {
+                          @synchronized([DejalTimeZoneOffsetTable class])
+                          {
+                              sOffsetTable = nil;
+                              sNeedsCalendarCheck = YES;
+                          }
+                      };
+                      
+                      [center addObserverForName:NSCurrentLocaleDidChangeNotification object:nil queue:nil usingBlock:invalidate];
+                      [center addObserverForName:NSSystemTimeZoneDidChangeNotification object:nil queue:nil usingBlock:invalidate];
+                  });
+    
+    NSTimeZone *timeZone = [NSTimeZone defaultTimeZone];
+    
+    @synchronized([DejalTimeZoneOffsetTable class])
+    {
+        if (sNeedsCalendarCheck)
+        {
+            sIsGregorian = [[[NSCalendar currentCalendar] calendarIdentifier] isEqualToString:NSCalendarIdentifierGregorian];
+            sNeedsCalendarCheck = NO;
+        }
+        
+        if (!sIsGregorian)
+            return nil;
+        
+        if (!sOffsetTable || (sOffsetTable.timeZone != timeZone && ![sOffsetTable.timeZone isEqualToTimeZone:timeZone]))
+            sOffsetTable = [[DejalTimeZoneOffsetTable alloc] initWithTimeZone:timeZone];
+        
+        return sOffsetTable;
+    }
+}
+
+/**
+ Private method to return the offset table for the time zone of the dejal_gregorianCalendar singleton, as used by the difference methods.  That calendar's time zone is fixed when it is created, so the table only needs to be built once.
+ 
+ @author DJS 2026-10.
+ */
+
++ (DejalTimeZoneOffsetTable *)dejal_gregorianCalendarOffsetTable;
+{
+    static DejalTimeZoneOffsetTable *sOffsetTable = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^
+                  {
+                      sOffsetTable = [[DejalTimeZoneOffsetTable alloc] initWithTimeZone:[self dejal_gregorianCalendar].timeZone];
+                  });
+    
+    return sOffsetTable;
+}
+
+/**
+ Private method to return the date fields for the receiver via NSCalendar, for calendars other than Gregorian, and dates before the Gregorian changeover.
+ 
+ @author DJS 2026-10.
+ */
+
+- (DejalDateFields)dejal_calendarDateFields;
+{
+    NSCalendar *calendar = [NSCalendar currentCalendar];
+    NSCalendarUnit units = NSCalendarUnitYear | NSCalendarUnitMonth | NSCalendarUnitDay | NSCalendarUnitHour | NSCalendarUnitMinute | NSCalendarUnitSecond | NSCalendarUnitWeekday;
+    NSDateComponents *components = [calendar components:units fromDate:self];
+    DejalDateFields fields;
+    
+    fields.year = components.year;
+    fields.month = components.month;
+    fields.day = components.day;
+    fields.hour = components.hour;
+    fields.minute = components.minute;
+    fields.second = components.second;
+    fields.weekday = components.weekday;
+    fields.dayOfYear = [calendar ordinalityOfUnit:NSCalendarUnitDay inUnit:NSCalendarUnitYear forDate:self];
+    
+    return fields;
+}
+
+/**
+ Returns all of the commonly used date fields of the receiver at once, in the current calendar and time zone.  For the Gregorian calendar they are calculated arithmetically from a cached table of the time zone's UTC offsets, without any NSCalendar or NSDateComponents overhead; other calendars use NSCalendar.
+ 
+ @returns A struct with the year, month, day, hour, minute, second, weekday and day of year.
+ 
+ @author DJS 2026-10.
+ */
+
+- (DejalDateFields)dejal_dateFields;
+{
+    DejalTimeZoneOffsetTable *table = [NSDate dejal_gregorianOffsetTable];
+    DejalDateFields fields;
+    
+    if (table)
+    {
+        int64_t seconds = (int64_t)floor([self timeIntervalSince1970]);
+        
+        if (DejalDateFieldsFromLocalSeconds(seconds + [table secondsFromGMTForSecondsSince1970:seconds], &fields))
+            return fields;
+    }
+    
+    return [self dejal_calendarDateFields];
+}
+
+/**
+ Calculates the date fields (see -dejal_dateFields) for a C array of time intervals since the reference date, in the current calendar and time zone.  The offsets are looked up first, then the fields are calculated in a separate pure arithmetic loop, which the compiler can vectorize.
+ 
+ @param fields A C array to receive the date fields, with room for count entries.
+ @param intervals A C array of time intervals since the reference date.
+ @param count The number of intervals.
+ 
+ @author DJS 2026-10.
+ */
+
++ (void)dejal_getDateFields:(DejalDateFields *)fields forTimeIntervals:(const NSTimeInterval *)intervals count:(NSUInteger)count;
+{
+    DejalTimeZoneOffsetTable *table = [self dejal_gregorianOffsetTable];
+    
+    if (!table)
+    {
+        for (NSUInteger i = 0; i < count; i++)
+            fields[i] = [[NSDate dateWithTimeIntervalSinceReferenceDate:intervals[i]] dejal_calendarDateFields];
+        
+        return;
+    }
+    
+    int64_t *localSeconds = malloc(count * sizeof(int64_t));
+    
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        int64_t seconds = (int64_t)floor(intervals[i] + NSTimeIntervalSince1970);
+        
+        localSeconds[i] = seconds + [table secondsFromGMTForSecondsSince1970:seconds];
+    }
+    
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        if (!DejalDateFieldsFromLocalSeconds(localSeconds[i], &fields[i]))
+            fields[i] = [[NSDate dateWithTimeIntervalSinceReferenceDate:intervals[i]] dejal_calendarDateFields];
+    }
+    
+    free(localSeconds);
+}
+
+/**
+ Calculates the date fields (see -dejal_dateFields) for an array of dates, in the current calendar and time zone.
+ 
+ @param fields A C array to receive the date fields, with room for an entry per date.
+ @param dates An array of NSDate objects.
+ 
+ @author DJS 2026-10.
+ */
+
++ (void)dejal_getDateFields:(DejalDateFields *)fields forDates:(NSArray *)dates;
+{
+    NSUInteger count = dates.count;
+    NSTimeInterval *intervals = malloc(count * sizeof(NSTimeInterval));
+    NSUInteger i = 0;
+    
+    for (NSDate *date in dates)
+        intervals[i++] = [date timeIntervalSinceReferenceDate];
+    
+    [self dejal_getDateFields:fields forTimeIntervals:intervals count:count];
+    
+    free(intervals);
 }
 
 /**
@@ -725,6 +1634,275 @@
     return years;
 }
 
+/**
+ Private method to return the start of the bucket containing the date, via the per-date methods and NSCalendar.  Used for calendars other than Gregorian, and dates before the Gregorian changeover.
+ 
+ @author DJS 2026-10.
+ */
+
++ (NSTimeInterval)dejal_calendarBucketStartForTimeInterval:(NSTimeInterval)interval unit:(NSCalendarUnit)unit;
+{
+    NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:interval];
+    NSDate *start = nil;
+    
+    if (unit == NSCalendarUnitDay)
+        start = [date dejal_dateAsDateWithoutTime];
+    else
+        [[NSCalendar currentCalendar] rangeOfUnit:unit startDate:&start interval:NULL forDate:date];
+    
+    return [start timeIntervalSinceReferenceDate];
+}
+
+/**
+ Calculates the start of the bucket containing each of a C array of time intervals since the reference date, in the current calendar and time zone.  Day buckets start at noon, exactly matching -dejal_dateAsDateWithoutTime; week buckets start at the beginning of the week per the calendar's first weekday; month buckets match -dejal_dateOfMonthStartWithOffset: with no offset; year buckets start at the beginning of the year.  For the Gregorian calendar the starts are calculated arithmetically from a cached table of the time zone's UTC offsets, so are DST-correct; large inputs are processed concurrently in chunks.
+ 
+ @param starts A C array to receive the bucket starts, as time intervals since the reference date, with room for count entries.
+ @param intervals A C array of time intervals since the reference date.
+ @param count The number of intervals.
+ @param unit One of NSCalendarUnitDay, NSCalendarUnitWeekOfYear, NSCalendarUnitMonth or NSCalendarUnitYear.
+ 
+ @author DJS 2026-10.
+ */
+
++ (void)dejal_getBucketStarts:(NSTimeInterval *)starts forTimeIntervals:(const NSTimeInterval *)intervals count:(NSUInteger)count unit:(NSCalendarUnit)unit;
+{
+    DejalTimeZoneOffsetTable *table = [self dejal_gregorianOffsetTable];
+    int64_t firstWeekday = [[NSCalendar currentCalendar] firstWeekday];
+    
+    DejalApplyInChunks(count, ^(NSUInteger start, NSUInteger end)
+    {
+        for (NSUInteger i = start; i < end; i++)
+        {
+            int64_t seconds = (int64_t)floor(intervals[i] + NSTimeIntervalSince1970);
+            int64_t days = table ? DejalFloorDivide(seconds + [table secondsFromGMTForSecondsSince1970:seconds], 86400) : 0;
+            int64_t year, month, day;
+            int64_t localStart;
+            
+            if (!table || days < DEJAL_FIRST_GREGORIAN_DAY + 7)
+            {
+                starts[i] = [self dejal_calendarBucketStartForTimeInterval:intervals[i] unit:unit];
+                continue;
+            }
+            
+            switch (unit)
+            {
+                case NSCalendarUnitDay:
+                    localStart = days * 86400;
+                    break;
+                    
+                case NSCalendarUnitWeekOfYear:
+                {
+                    int64_t weekday = ((days + 4) % 7 + 7) % 7 + 1;
+                    
+                    localStart = (days - (weekday - firstWeekday + 7) % 7) * 86400;
+                    break;
+                }
+                    
+                case NSCalendarUnitMonth:
+                    DejalCivilFromDays(days, &year, &month, &day);
+                    localStart = DejalDaysFromCivil(year, month, 1) * 86400;
+                    break;
+                    
+                case NSCalendarUnitYear:
+                    DejalCivilFromDays(days, &year, &month, &day);
+                    localStart = DejalDaysFromCivil(year, 1, 1) * 86400;
+                    break;
+                    
+                default:
+                    starts[i] = [self dejal_calendarBucketStartForTimeInterval:intervals[i] unit:unit];
+                    continue;
+            }
+            
+            NSTimeInterval bucketStart = [table secondsSince1970ForLocalSeconds:localStart] - NSTimeIntervalSince1970;
+            
+            // -dejal_dateAsDateWithoutTime uses noon, twelve elapsed hours after the start of the day:
+            if (unit == NSCalendarUnitDay)
+                bucketStart += 12 * 60 * 60;
+            
+            starts[i] = bucketStart;
+        }
+    });
+}
+
+/**
+ Returns an array of the start of the bucket containing each of an array of dates.  See +dejal_getBucketStarts:forTimeIntervals:count:unit: for details.
+ 
+ @param dates An array of NSDate objects.
+ @param unit One of NSCalendarUnitDay, NSCalendarUnitWeekOfYear, NSCalendarUnitMonth or NSCalendarUnitYear.
+ @returns An array of NSDate objects, in the same order as the dates.
+ 
+ @author DJS 2026-10.
+ */
+
++ (NSArray *)dejal_bucketStartDatesForDates:(NSArray *)dates unit:(NSCalendarUnit)unit;
+{
+    NSUInteger count = dates.count;
+    NSTimeInterval *intervals = malloc(count * sizeof(NSTimeInterval));
+    NSMutableArray *result = [NSMutableArray arrayWithCapacity:count];
+    NSUInteger i = 0;
+    
+    for (NSDate *date in dates)
+        intervals[i++] = [date timeIntervalSinceReferenceDate];
+    
+    [self dejal_getBucketStarts:intervals forTimeIntervals:intervals count:count unit:unit];
+    
+    for (i = 0; i < count; i++)
+        [result addObject:[NSDate dateWithTimeIntervalSinceReferenceDate:intervals[i]]];
+    
+    free(intervals);
+    
+    return result;
+}
+
+/**
+ Calculates the index of the bucket containing each of a C array of time intervals since the reference date, in the current calendar and time zone, as the number of whole buckets since the bucket containing 1970-01-01 local time.  So dates in the same day, week, month or year share the same index, and consecutive buckets have consecutive indexes.  Weeks begin on the calendar's first weekday.  For calendars other than Gregorian, the indexes are calculated via NSCalendar from the bucket starts.
+ 
+ @param indexes A C array to receive the bucket indexes, with room for count entries.
+ @param intervals A C array of time intervals since the reference date.
+ @param count The number of intervals.
+ @param unit One of NSCalendarUnitDay, NSCalendarUnitWeekOfYear, NSCalendarUnitMonth or NSCalendarUnitYear.
+ 
+ @author DJS 2026-10.
+ */
+
++ (void)dejal_getBucketIndexes:(NSInteger *)indexes forTimeIntervals:(const NSTimeInterval *)intervals count:(NSUInteger)count unit:(NSCalendarUnit)unit;
+{
+    DejalTimeZoneOffsetTable *table = [self dejal_gregorianOffsetTable];
+    int64_t firstWeekday = [[NSCalendar currentCalendar] firstWeekday];
+    
+    if (!table)
+    {
+        NSCalendar *calendar = [NSCalendar currentCalendar];
+        NSDate *referenceStart = [NSDate dateWithTimeIntervalSinceReferenceDate:[self dejal_calendarBucketStartForTimeInterval:-NSTimeIntervalSince1970 unit:unit]];
+        
+        for (NSUInteger i = 0; i < count; i++)
+        {
+            NSDate *bucketStart = [NSDate dateWithTimeIntervalSinceReferenceDate:[self dejal_calendarBucketStartForTimeInterval:intervals[i] unit:unit]];
+            
+            indexes[i] = [[calendar components:unit fromDate:referenceStart toDate:bucketStart options:0] valueForComponent:unit];
+        }
+        
+        return;
+    }
+    
+    DejalApplyInChunks(count, ^(NSUInteger start, NSUInteger end)
+    {
+        for (NSUInteger i = start; i < end; i++)
+        {
+            int64_t seconds = (int64_t)floor(intervals[i] + NSTimeIntervalSince1970);
+            int64_t days = DejalFloorDivide(seconds + [table secondsFromGMTForSecondsSince1970:seconds], 86400);
+            int64_t year, month, day;
+            
+            switch (unit)
+            {
+                case NSCalendarUnitWeekOfYear:
+                    indexes[i] = DejalFloorDivide(days + 5 - firstWeekday, 7);
+                    break;
+                    
+                case NSCalendarUnitMonth:
+                    DejalCivilFromDays(days, &year, &month, &day);
+                    indexes[i] = (year - 1970) * 12 + month - 1;
+                    break;
+                    
+                case NSCalendarUnitYear:
+                    DejalCivilFromDays(days, &year, &month, &day);
+                    indexes[i] = year - 1970;
+                    break;
+                    
+                default:
+                    indexes[i] = days;
+                    break;
+            }
+        }
+    });
+}
+
+/**
+ Private method to return the difference between two dates in whole units via the per-date methods, for dates before the Gregorian changeover.
+ 
+ @author DJS 2026-10.
+ */
+
++ (NSInteger)dejal_calendarDifferenceFromTimeInterval:(NSTimeInterval)fromInterval toTimeInterval:(NSTimeInterval)toInterval unit:(NSCalendarUnit)unit;
+{
+    NSDate *fromDate = [NSDate dateWithTimeIntervalSinceReferenceDate:fromInterval];
+    NSDate *toDate = [NSDate dateWithTimeIntervalSinceReferenceDate:toInterval];
+    NSDateComponents *components = [[self dejal_gregorianCalendar] components:unit fromDate:fromDate toDate:toDate options:0];
+    
+    return [components valueForComponent:unit];
+}
+
+/**
+ Calculates the difference in whole units between pairs of time intervals since the reference date, exactly matching -dejal_differenceInMinutesTo:, -dejal_differenceInHoursTo:, -dejal_differenceInDaysTo:, -dejal_differenceInWeeksTo:, -dejal_differenceInMonthsTo: and -dejal_differenceInYearsTo:, i.e. the number of whole units that can be added to the from date without passing the to date, using the Gregorian calendar.  Calculated arithmetically from a cached table of the time zone's UTC offsets, so DST-correct without any NSCalendar overhead; large inputs are processed concurrently in chunks.
+ 
+ @param differences A C array to receive the differences, with room for count entries.
+ @param fromIntervals A C array of time intervals since the reference date to measure from.
+ @param toIntervals A C array of time intervals since the reference date to measure to.
+ @param count The number of pairs.
+ @param unit One of NSCalendarUnitMinute, NSCalendarUnitHour, NSCalendarUnitDay, NSCalendarUnitWeekOfYear, NSCalendarUnitMonth or NSCalendarUnitYear.
+ 
+ @author DJS 2026-10.
+ */
+
++ (void)dejal_getDifferences:(NSInteger *)differences fromTimeIntervals:(const NSTimeInterval *)fromIntervals toTimeIntervals:(const NSTimeInterval *)toIntervals count:(NSUInteger)count unit:(NSCalendarUnit)unit;
+{
+    DejalTimeZoneOffsetTable *table = [self dejal_gregorianCalendarOffsetTable];
+    
+    DejalApplyInChunks(count, ^(NSUInteger start, NSUInteger end)
+    {
+        for (NSUInteger i = start; i < end; i++)
+        {
+            NSTimeInterval from = fromIntervals[i] + NSTimeIntervalSince1970;
+            NSTimeInterval to = toIntervals[i] + NSTimeIntervalSince1970;
+            
+            // Minutes and hours are fixed durations, so are just the elapsed time truncated towards zero:
+            if (unit == NSCalendarUnitMinute || unit == NSCalendarUnitHour)
+            {
+                differences[i] = (NSInteger)((to - from) / (unit == NSCalendarUnitMinute ? 60 : 60 * 60));
+                continue;
+            }
+            
+            int64_t fromSeconds = (int64_t)floor(from);
+            int64_t toSeconds = (int64_t)floor(to);
+            NSTimeInterval fromFraction = from - fromSeconds;
+            int64_t fromLocal = fromSeconds + [table secondsFromGMTForSecondsSince1970:fromSeconds];
+            int64_t toLocal = toSeconds + [table secondsFromGMTForSecondsSince1970:toSeconds];
+            int64_t fromDays = DejalFloorDivide(fromLocal, 86400);
+            int64_t toDays = DejalFloorDivide(toLocal, 86400);
+            
+            if (fromDays < DEJAL_FIRST_GREGORIAN_DAY || toDays < DEJAL_FIRST_GREGORIAN_DAY)
+            {
+                differences[i] = [self dejal_calendarDifferenceFromTimeInterval:fromIntervals[i] toTimeInterval:toIntervals[i] unit:unit];
+                continue;
+            }
+            
+            NSCalendarUnit stepUnit = unit == NSCalendarUnitWeekOfYear ? NSCalendarUnitDay : unit;
+            int64_t fromYear, fromMonth, fromDay, toYear, toMonth, toDay;
+            int64_t secondOfDay = fromLocal - fromDays * 86400;
+            int64_t amount;
+            
+            DejalCivilFromDays(fromDays, &fromYear, &fromMonth, &fromDay);
+            DejalCivilFromDays(toDays, &toYear, &toMonth, &toDay);
+            
+            if (stepUnit == NSCalendarUnitDay)
+                amount = toDays - fromDays;
+            else if (stepUnit == NSCalendarUnitMonth)
+                amount = (toYear * 12 + toMonth) - (fromYear * 12 + fromMonth);
+            else
+                amount = toYear - fromYear;
+            
+            // Step back towards zero until adding the amount doesn't pass the to date:
+            while (amount > 0 && DejalSecondsByAddingUnits(table, stepUnit, amount, fromYear, fromMonth, fromDay, secondOfDay) + fromFraction > to)
+                amount--;
+            
+            while (amount < 0 && DejalSecondsByAddingUnits(table, stepUnit, amount, fromYear, fromMonth, fromDay, secondOfDay) + fromFraction < to)
+                amount++;
+            
+            differences[i] = unit == NSCalendarUnitWeekOfYear ? amount / 7 : amount;
+        }
+    });
+}
+
 /**
  Returns the receiver as a string in short format.
  
@@ -768,15 +1946,12 @@
  @returns A string representation of the receiver.
  
  @author DJS 2014-08.
+ @version DJS 2026-10: changed to use the shared formatter cache.
  */
 
 - (NSString *)dejal_formattedStringUsingDateStyle:(NSDateFormatterStyle)dateStyle timeStyle:(NSDateFormatterStyle)timeStyle allowRelative:(BOOL)allowRelative;
 {
-    NSDateFormatter *formatter = [NSDateFormatter new];
-    
-    formatter.dateStyle = dateStyle;
-    formatter.timeStyle = timeStyle;
-    formatter.doesRelativeDateFormatting = allowRelative;
+    NSDateFormatter *formatter = [NSDate dejal_dateFormatterWithDateStyle:dateStyle timeStyle:timeStyle allowRelative:allowRelative];
     
     return [formatter stringFromDate:self];
 }
@@ -938,14 +2113,12 @@
  
  @author DJS 2003-11.
  @version DJS 2007-10: changed to avoid deprecated NSShortDateFormatString etc.
+ @version DJS 2026-10: changed to use the shared formatter cache.
 */
 
 - (NSString *)dejal_descriptionWithShortDateTime;
 {
-    NSDateFormatter *dateFormatter = [[NSDateFormatter alloc] init];
-    
-    [dateFormatter setDateStyle:NSDateFormatterShortStyle];
-    [dateFormatter setTimeStyle:NSDateFormatterShortStyle];
+    NSDateFormatter *dateFormatter = [NSDate dejal_dateFormatterWithDateStyle:NSDateFormatterShortStyle timeStyle:NSDateFormatterShortStyle allowRelative:NO];
     
     return [dateFormatter stringFromDate:self];
 }
@@ -955,14 +2128,12 @@
  
  @author DJS 2003-11.
  @version DJS 2007-10: changed to avoid deprecated NSShortDateFormatString etc.
+ @version DJS 2026-10: changed to use the shared formatter cache.
 */
 
 - (NSString *)dejal_descriptionWithShortDate
 {
-    NSDateFormatter *dateFormatter = [[NSDateFormatter alloc] init];
-    
-    [dateFormatter setDateStyle:NSDateFormatterShortStyle];
-    [dateFormatter setTimeStyle:NSDateFormatterNoStyle];
+    NSDateFormatter *dateFormatter = [NSDate dejal_dateFormatterWithDateStyle:NSDateFormatterShortStyle timeStyle:NSDateFormatterNoStyle allowRelative:NO];
     
     return [dateFormatter stringFromDate:self];
 }
@@ -972,14 +2143,12 @@
  
  @author DJS 2003-11.
  @version DJS 2007-10: changed to avoid deprecated NSShortDateFormatString etc.
+ @version DJS 2026-10: changed to use the shared formatter cache.
 */
 
 - (NSString *)dejal_descriptionWithTime
 {
-    NSDateFormatter *dateFormatter = [[NSDateFormatter alloc] init];
-    
-    [dateFormatter setDateStyle:NSDateFormatterNoStyle];
-    [dateFormatter setTimeStyle:NSDateFormatterShortStyle];
+    NSDateFormatter *dateFormatter = [NSDate dejal_dateFormatterWithDateStyle:NSDateFormatterNoStyle timeStyle:NSDateFormatterShortStyle allowRelative:NO];
     
     return [dateFormatter stringFromDate:self];
 }
@@ -28,6 +28,7 @@
 //
 
 #import "NSDictionary+Dejal.h"
+#import "NSObject+Dejal.h"
 #import "NSString+Dejal.h"
 #import "NSDate+Dejal.h"
 
@@ -65,54 +66,24 @@
  @author DJS 2004-06.
  @version DJS 2006-01: changed to fix memory leak through excessive retaining.
  @version DJS 2009-01: changed to use fast enumeration.
+ @version DJS 2026-10: changed to use -dejal_deepCopyMakingMutable:concurrently:, which copies without recursion and shares unchanged immutable contents; the copied arrays and dictionaries are now immutable.
 */
 
 - (id)dejal_deepCopy;
 {
-    id dict = [NSMutableDictionary new];
-    id copy;
-    
-    for (id key in self)
-    {
-        id object = self[key];
-        
-        if ([object respondsToSelector:@selector(dejal_deepCopy)])
-            copy = [object dejal_deepCopy];
-        else
-            copy = [object copy];
-        
-    	dict[key] = copy;
-    }
-    
-    return dict;
+    return [self dejal_deepCopyMakingMutable:NO concurrently:NO];
 }
 
 /**
  Similar to -dejal_deepCopy, above, but makes all of the contents of the dictionary mutable.
  
  @author DJS 2009-01.
+ @version DJS 2026-10: changed to use -dejal_deepCopyMakingMutable:concurrently:, which copies without recursion.
 */
 
 - (id)dejal_deepMutableCopy;
 {
-    id dict = [NSMutableDictionary new];
-    id mutableCopy;
-    
-    for (id key in self)
-    {
-        id object = self[key];
-        
-        if ([object respondsToSelector:@selector(dejal_deepMutableCopy)])
-            mutableCopy = [object dejal_deepMutableCopy];
-        else if ([object conformsToProtocol:@protocol(NSMutableCopying)])
-            mutableCopy = [object mutableCopy];
-        else
-            mutableCopy = [object copy];
-        
-    	dict[key] = mutableCopy;
-    }
-    
-    return dict;
+    return [self dejal_deepCopyMakingMutable:YES concurrently:NO];
 }
 
 /**
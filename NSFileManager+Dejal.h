@@ -28,12 +28,37 @@
 //
 
 
+typedef struct
+{
+    BOOL exists;
+    BOOL isDirectory;
+    BOOL isSymbolicLink;
+    unsigned long long size;
+    NSTimeInterval creationDate;        // Since the reference date; NAN if not available
+    NSTimeInterval modificationDate;    // Since the reference date
+} DejalFileInfo;
+
+
+typedef struct
+{
+    unsigned long long bytesWritten;    // Written from data
+    unsigned long long bytesCopied;     // Copied from other files, including by cloning
+    NSUInteger fileCount;               // Files moved into place
+    NSUInteger syncCount;               // Files and directories flushed to storage
+    NSTimeInterval syncDuration;        // Total time spent flushing
+    NSTimeInterval maximumSyncDuration; // Longest single flush
+} DejalFileSaveStatistics;
+
+
 @interface NSFileManager (Dejal)
 
 - (NSInteger)dejal_fileSizeAtPath:(NSString *)path;
 - (NSDate *)dejal_fileCreationDateAtPath:(NSString *)path;
 - (NSDate *)dejal_fileModificationDateAtPath:(NSString *)path;
 
+- (DejalFileInfo)dejal_fileInfoAtPath:(NSString *)path;
+- (void)dejal_getFileInfo:(DejalFileInfo *)infos forPaths:(NSArray *)paths;
+
 - (BOOL)dejal_isDirectoryAtURL:(NSURL *)url;
 - (BOOL)dejal_isDirectoryAtPath:(NSString *)path;
 
@@ -42,12 +67,17 @@
 
 - (BOOL)dejal_renameWorkingFile:(NSString *)workingPath forSuccess:(BOOL)success error:(NSError **)error;
 
+- (BOOL)dejal_saveData:(NSData *)data toPath:(NSString *)path error:(NSError **)error;
+
+- (NSString *)dejal_uniquePathForPath:(NSString *)path prefix:(NSString *)prefix;
+- (NSString *)dejal_claimUniquePathForPath:(NSString *)path prefix:(NSString *)prefix directory:(BOOL)directory error:(NSError **)error;
 
 - (BOOL)dejal_removeFileIfExistsAtPath:(NSString *)path;
 
 + (BOOL)dejal_backupPath:(NSString *)path;
 - (BOOL)dejal_copyPath:(NSString *)path withSuffix:(NSString *)suffix replaceExisting:(BOOL)replace error:(NSError **)error;
 
+- (BOOL)dejal_enumeratePathsWithFragments:(NSArray *)fragments isExtension:(BOOL)isExtension atPath:(NSString *)basePath deepScan:(BOOL)deep sorted:(BOOL)sorted batchSize:(NSUInteger)batchSize usingBlock:(void (^)(NSArray *paths, BOOL *stop))block;
 - (NSArray *)dejal_pathsWithFragments:(NSArray *)fragments isExtension:(BOOL)isExtension
                          atPath:(NSString *)basePath deepScan:(BOOL)deep;
 - (NSArray *)dejal_pathsAtPath:(NSString *)basePath deepScan:(BOOL)deep;
@@ -58,3 +88,53 @@
 
 @end
 
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalFileInfoCache : NSObject
+
+@property (nonatomic) NSTimeInterval maximumAge;
+
+@property (atomic, readonly) NSUInteger hits;
+@property (atomic, readonly) NSUInteger misses;
+
++ (instancetype)sharedCache;
+
+- (DejalFileInfo)fileInfoAtPath:(NSString *)path;
+- (BOOL)isDirectoryAtPath:(NSString *)path;
+- (void)getFileInfo:(DejalFileInfo *)infos forPaths:(NSArray *)paths;
+
+- (void)invalidatePath:(NSString *)path;
+- (NSUInteger)invalidateModifiedPaths;
+- (void)invalidateAllPaths;
+
+- (void)resetStatistics;
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalFileTransaction : NSObject
+
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) DejalFileSaveStatistics statistics;
+
++ (DejalFileSaveStatistics)totalStatistics;
++ (void)resetTotalStatistics;
+
+- (BOOL)writeData:(NSData *)data toPath:(NSString *)path error:(NSError **)error;
+- (BOOL)copyFileAtPath:(NSString *)sourcePath toPath:(NSString *)path replaceExisting:(BOOL)replace error:(NSError **)error;
+
+- (BOOL)commit:(NSError **)error;
+- (void)rollback;
+
+- (void)resetStatistics;
+
+@end
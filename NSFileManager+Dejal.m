@@ -31,337 +31,1973 @@
 #import "NSObject+Dejal.h"
 #import "NSArray+Dejal.h"
 #import "NSString+Dejal.h"
+#import <dirent.h>
+#import <fcntl.h>
+#import <unistd.h>
+#import <sys/stat.h>
+#import <stdatomic.h>
 
+#if defined(__APPLE__)
+#import <copyfile.h>
+#elif defined(__linux__)
+#import <linux/fs.h>
+#import <sys/ioctl.h>
+#import <sys/syscall.h>
+#endif
+
+
+// Default number of paths delivered per batch by the streaming path enumerator:
+#define DEJAL_PATH_ENUMERATION_BATCH_SIZE 1024
+
+// Number of paths each concurrent task stats in the batch file info methods:
+#define DEJAL_FILE_INFO_CHUNK_SIZE 256
+
+// Default maximum age in seconds of entries in a file info cache:
+#define DEJAL_FILE_INFO_CACHE_MAXIMUM_AGE 2.0
+
+// Number of consecutive collisions while claiming a unique path before the directory is read again to skip ahead:
+#define DEJAL_UNIQUE_PATH_RESCAN_COLLISIONS 8
+
+// Size of the buffer used to copy files by hand, when the platform can't copy them more cheaply:
+#define DEJAL_FILE_COPY_BUFFER_LENGTH (1024 * 1024)
+
+// Maximum length copied by each copy_file_range() call on Linux:
+#define DEJAL_FILE_COPY_RANGE_LENGTH (1024 * 1024 * 1024)
+
+#if defined(__APPLE__)
+#define DEJAL_STAT_MODIFICATION_TIME(info) (info).st_mtimespec
+#else
+#define DEJAL_STAT_MODIFICATION_TIME(info) (info).st_mtim
+#endif
 
-@implementation NSFileManager (Dejal)
 
 /**
- Convenience method to return the size of the file specified in the path.
+ Converts a stat timespec into a time interval since the reference date.
  
- @author DJS 2004-05.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSInteger)dejal_fileSizeAtPath:(NSString *)path
+static inline NSTimeInterval DejalTimeIntervalFromTimespec(struct timespec time)
 {
-    NSDictionary *attributes = [self attributesOfItemAtPath:path error:nil];
-    
-    return [attributes[NSFileSize] integerValue];
+    return (NSTimeInterval)time.tv_sec + time.tv_nsec / 1e9 - NSTimeIntervalSince1970;
 }
 
 /**
- Convenience method to return the creation date of the file specified in the path.
+ Fills in the file info for the path with a single lstat() call, plus a stat() call for symbolic links to see whether they point to a directory.  Like -attributesOfItemAtPath:error:, the size and dates are those of a link itself; like -fileExistsAtPath:isDirectory:, isDirectory follows links.
  
- @author DJS 2006-11.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSDate *)dejal_fileCreationDateAtPath:(NSString *)path;
+static DejalFileInfo DejalFileInfoForFileSystemPath(const char *path)
 {
-    NSDictionary *attributes = [self attributesOfItemAtPath:path error:nil];
+    DejalFileInfo info = {NO, NO, NO, 0, NAN, NAN};
+    struct stat status;
+    
+    if (!path || lstat(path, &status) != 0)
+        return info;
+    
+    info.exists = YES;
+    info.size = (unsigned long long)status.st_size;
+    info.modificationDate = DejalTimeIntervalFromTimespec(DEJAL_STAT_MODIFICATION_TIME(status));
+    
+#if defined(__APPLE__)
+    info.creationDate = DejalTimeIntervalFromTimespec(status.st_birthtimespec);
+#endif
+    
+    if (S_ISLNK(status.st_mode))
+    {
+        struct stat target;
+        
+        info.isSymbolicLink = YES;
+        info.isDirectory = stat(path, &target) == 0 && S_ISDIR(target.st_mode);
+    }
+    else
+    {
+        info.isDirectory = S_ISDIR(status.st_mode);
+    }
     
-    return attributes[NSFileCreationDate];
+    return info;
 }
 
 /**
- Convenience method to return the modification date of the file specified in the path.
+ Fills in the file info for each path in the array, concurrently in chunks for large arrays.
  
- @author DJS 2005-11.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSDate *)dejal_fileModificationDateAtPath:(NSString *)path;
+static void DejalGetFileInfoForPaths(DejalFileInfo *infos, NSArray *paths)
 {
-    NSDictionary *attributes = [self attributesOfItemAtPath:path error:nil];
+    NSUInteger count = paths.count;
+    NSUInteger chunks = (count + DEJAL_FILE_INFO_CHUNK_SIZE - 1) / DEJAL_FILE_INFO_CHUNK_SIZE;
     
-    return attributes[NSFileModificationDate];
+    dispatch_apply(chunks, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t chunk)
+                   {
+                       @autoreleasepool
+                       {
+                           NSUInteger start = chunk * DEJAL_FILE_INFO_CHUNK_SIZE;
+                           NSUInteger end = MIN(start + DEJAL_FILE_INFO_CHUNK_SIZE, count);
+                           
+                           for (NSUInteger i = start; i < end; i++)
+                           {
+                               NSString *path = paths[i];
+                               
+                               infos[i] = DejalFileInfoForFileSystemPath(path.length ? path.fileSystemRepresentation : NULL);
+                           }
+                       }
+                   });
 }
 
 /**
- Convenience method to return YES if the specified path is a directory, otherwise NO.
+ Sets the error, if wanted, to a POSIX error with the errno value and path.  Returns NO, for convenience.
  
- @author DJS 2013-02.
-*/
+ @author DJS 2026-10.
+ */
 
-- (BOOL)dejal_isDirectoryAtURL:(NSURL *)url;
+static BOOL DejalSetPOSIXError(NSError **error, int code, NSString *path)
 {
-    BOOL isDirectory = NO;
+    if (error)
+        *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:code userInfo:@{NSFilePathErrorKey : path}];
     
-    return ([self fileExistsAtPath:url.path isDirectory:&isDirectory]) && isDirectory;
+    return NO;
 }
 
 /**
- Convenience method to return YES if the specified path is a directory, otherwise NO.
+ Tries to take the file system path for a new item.  If claim is NO, only checks that nothing (not even a dangling symbolic link) can be seen there; otherwise atomically creates an empty file or directory there, which fails if anything already exists.  Returns zero on success, EEXIST if the path is taken, or another errno value if it can't be used.
  
- @author DJS 2005-10.
-*/
+ @author DJS 2026-10.
+ */
 
-- (BOOL)dejal_isDirectoryAtPath:(NSString *)path;
+static int DejalTakeFileSystemPath(const char *path, BOOL claim, BOOL directory)
 {
-    BOOL isDirectory = NO;
+    if (!claim)
+    {
+        struct stat info;
+        
+        return lstat(path, &info) == 0 ? EEXIST : 0;
+    }
+    
+    if (directory)
+        return mkdir(path, 0777) == 0 ? 0 : errno;
+    
+    int file = open(path, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
     
-    return ([self fileExistsAtPath:path isDirectory:&isDirectory]) && isDirectory;
+    if (file < 0)
+        return errno;
+    
+    close(file);
+    
+    return 0;
 }
 
 /**
- Renames the file or directory specified in the URL to have the specified filename, in the same location.  If deleteExisting is YES and the destination already exists, it is first deleted; otherwise an error will occur.  See the standard -movePath:toPath:handler: method description for details of the handler parameter and other relevant information.
+ Returns the unique path candidate with the specified number: the path with the insertion (i.e. a space and the prefix, if any) and the number (if more than one) inserted before the extension.
  
- @author DJS 2004-03.
- @version DJS 2005-12: changed to handle a special case when just changing the case of the name.
- @version DJS 2011-05: changed to avoid using a deprecated method.
-*/
+ @author DJS 2026-10.
+ */
 
-- (BOOL)dejal_renameItemAtURL:(NSURL *)url toFilename:(NSString *)filename deleteExisting:(BOOL)deleteExisting error:(NSError **)error;
+static NSString *DejalUniquePathCandidate(NSString *path, NSString *insertion, NSUInteger number)
 {
-    NSURL *destination = [[url URLByDeletingLastPathComponent] URLByAppendingPathComponent:filename];
-    
-    // Special case: if the current name and the filename are equivalent, i.e. only differing in case, removing would be wrong and moving would fail, so we need to change the name:
-    NSString *oldName = [url lastPathComponent];
+    if (number > 1)
+        insertion = [insertion stringByAppendingFormat:@" %lu", (unsigned long)number];
     
-    if ([oldName dejal_isEquivalentTo:filename])
-    {
-        NSURL *oldURL = url;
-        NSString *tempName = [oldName stringByAppendingFormat:@"%.2f", [NSDate timeIntervalSinceReferenceDate]];
-        
-        url = [[url URLByDeletingLastPathComponent] URLByAppendingPathComponent:tempName];
-        
-        [self moveItemAtURL:oldURL toURL:url error:error];
-    }
-    
-    if (deleteExisting)
-        [self removeItemAtURL:destination error:nil];
-    
-    return [self moveItemAtURL:url toURL:destination error:error];
+    return [path dejal_stringByInsertingBeforePathExtension:insertion];
 }
 
 /**
- Renames the file or directory specified in the path to have the specified filename, in the same location.  If deleteExisting is YES and the destination already exists, it is first deleted; otherwise an error will occur.  See the standard -movePath:toPath:handler: method description for details of the handler parameter and other relevant information.
+ Reads the directory containing the path once, and returns the highest number among its unique path candidates (see DejalUniquePathCandidate()) that already exist, compared case-insensitively; zero if there are none, or NSNotFound if the directory can't be read.
  
- @author DJS 2004-03.
- @version DJS 2005-12: changed to handle a special case when just changing the case of the name.
- @version DJS 2011-05: changed to avoid using a deprecated method.
-*/
+ @author DJS 2026-10.
+ */
 
-- (BOOL)dejal_renameItemAtPath:(NSString *)path toFilename:(NSString *)filename deleteExisting:(BOOL)deleteExisting error:(NSError **)error;
+static NSUInteger DejalHighestUniquePathNumber(NSString *path, NSString *insertion)
 {
-    NSString *destination = [[path stringByDeletingLastPathComponent] stringByAppendingPathComponent:filename];
+    NSString *directoryPath = [path stringByDeletingLastPathComponent];
+    DIR *directory = opendir(directoryPath.length ? directoryPath.fileSystemRepresentation : ".");
     
-    // Special case: if the current name and the filename are equivalent, i.e. only differing in case, removing would be wrong and moving would fail, so we need to change the name:
-    if ([[path lastPathComponent] dejal_isEquivalentTo:filename])
+    if (!directory)
+        return NSNotFound;
+    
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSString *extension = [path pathExtension];
+    NSString *stemKey = [[[[path lastPathComponent] stringByDeletingPathExtension] stringByAppendingString:insertion] dejal_equivalenceKey];
+    NSString *extensionKey = extension.length ? [[@"." stringByAppendingString:extension] dejal_equivalenceKey] : @"";
+    NSUInteger highest = 0;
+    struct dirent *entry;
+    
+    while ((entry = readdir(directory)))
     {
-        NSString *oldPath = path;
-        
-        path = [path stringByAppendingFormat:@"%.2f", [NSDate timeIntervalSinceReferenceDate]];
-        
-        [self moveItemAtPath:oldPath toPath:path error:error];
+        @autoreleasepool
+        {
+            NSString *key = [[fileManager stringWithFileSystemRepresentation:entry->d_name length:strlen(entry->d_name)] dejal_equivalenceKey];
+            NSUInteger length = key.length;
+            
+            if (length < stemKey.length + extensionKey.length || ![key hasPrefix:stemKey] || ![key hasSuffix:extensionKey])
+                continue;
+            
+            // Between the stem and extension there must be nothing (the first candidate), or a space and a number without leading zeros:
+            NSUInteger start = stemKey.length;
+            NSUInteger end = length - extensionKey.length;
+            NSUInteger number = 1;
+            
+            if (end > start)
+            {
+                if (end - start < 2 || end - start > 19 || [key characterAtIndex:start] != ' ' || [key characterAtIndex:start + 1] == '0')
+                    continue;
+                
+                number = 0;
+                
+                for (NSUInteger i = start + 1; i < end && number != NSNotFound; i++)
+                {
+                    unichar character = [key characterAtIndex:i];
+                    
+                    number = (character >= '0' && character <= '9') ? number * 10 + (character - '0') : NSNotFound;
+                }
+                
+                if (number == NSNotFound)
+                    continue;
+            }
+            
+            highest = MAX(highest, number);
+        }
     }
     
-    if (deleteExisting && [self fileExistsAtPath:destination])
-        [self removeItemAtPath:destination error:error];
+    closedir(directory);
     
-    return [self moveItemAtPath:path toPath:destination error:error];
+    return highest;
 }
 
 /**
- Given a working file, i.e. one named with a tilde before the extension (see -[NSString backupFilePath]), swaps the working file and the previous final file (if any).
+ For a directory that can't be read, finds the first free unique path candidate number after the known taken one, by doubling the number until a candidate is free, then binary searching back to the first free one.  This assumes the taken numbers are contiguous, which they are when they were all allocated this way; if not, the caller will collide and move on.
  
- @author DJS 2004-03.
- @version DJS 2011-05: changed to avoid using a deprecated method.
-*/
+ @author DJS 2026-10.
+ */
 
-- (BOOL)dejal_renameWorkingFile:(NSString *)workingPath forSuccess:(BOOL)success error:(NSError **)error;
+static NSUInteger DejalProbeUniquePathNumber(NSString *path, NSString *insertion, NSUInteger taken)
 {
-    BOOL okay = YES;
+    NSUInteger low = taken;
+    NSUInteger high = taken + 1;
     
-    if (success)
+    while (high < NSUIntegerMax / 2 && DejalTakeFileSystemPath(DejalUniquePathCandidate(path, insertion, high).fileSystemRepresentation, NO, NO) == EEXIST)
     {
-        NSString *basePath = [workingPath stringByDeletingLastPathComponent];
-        NSString *extension = [workingPath pathExtension];
-        NSString *workingFilename = [workingPath lastPathComponent];
-        NSString *workingBase = [workingFilename stringByDeletingPathExtension];
-        NSString *finalFilename = [workingBase substringToIndex:[workingBase length] - 1];
-        NSString *tempFilename = [workingBase stringByAppendingString:@"~"];
-        
-        if ([extension length])
-        {
-            finalFilename = [finalFilename stringByAppendingPathExtension:extension];
-            tempFilename = [tempFilename stringByAppendingPathExtension:extension];
-        }
-        
-        NSString *finalPath = [basePath stringByAppendingPathComponent:finalFilename];
-        NSString *tempPath = [basePath stringByAppendingPathComponent:tempFilename];
-        
-        // Rename the working file with an extra tilde on the end:
-        okay = [self dejal_renameItemAtPath:workingPath toFilename:tempFilename deleteExisting:YES error:error];
-        
-        // Rename the previous file the same as the working file was:
-        if ([self fileExistsAtPath:finalPath])
-            okay = okay && [self dejal_renameItemAtPath:finalPath toFilename:workingFilename deleteExisting:NO error:error];
-        
-        // Rename the working file the same as the previous file was:
-        okay = okay && [self dejal_renameItemAtPath:tempPath toFilename:finalFilename deleteExisting:NO error:error];
+        low = high;
+        high *= 2;
     }
-    else
+    
+    while (high - low > 1)
     {
-        // Failed, so just delete the working file:
-        okay = [self removeItemAtPath:workingPath error:error];
+        NSUInteger middle = low + (high - low) / 2;
+        
+        if (DejalTakeFileSystemPath(DejalUniquePathCandidate(path, insertion, middle).fileSystemRepresentation, NO, NO) == EEXIST)
+            low = middle;
+        else
+            high = middle;
     }
     
-    return okay;
+    return high;
 }
 
-
 /**
- If a file or folder exists at the path, it is blindly removed.  As with -removeFileAtPath:handler:, use caution with this method.  Returns YES if the file didn't exist, or was successsfully removed, or NO if it couldn't be removed.
+ Returns the next unique path candidate number to try: one more than the highest existing one, found by reading the directory once, or by probing if it can't be read.  Without a prefix, the path itself counts as the first candidate, so numbering starts at two.
  
- @author DJS 2004-06.
-*/
+ @author DJS 2026-10.
+ */
 
-- (BOOL)dejal_removeFileIfExistsAtPath:(NSString *)path
+static NSUInteger DejalNextUniquePathNumber(NSString *path, NSString *insertion)
 {
-    if ([self fileExistsAtPath:path])
-        return [self removeItemAtPath:path error:nil];
+    NSUInteger taken = insertion.length ? 0 : 1;
+    NSUInteger highest = DejalHighestUniquePathNumber(path, insertion);
+    
+    if (highest == NSNotFound)
+        return DejalProbeUniquePathNumber(path, insertion, taken);
     else
-        return YES;
+        return MAX(highest, taken) + 1;
 }
 
 /**
- Convenience class method to duplicate the path with a " backup" suffix, replacing any old backup.
+ Shared logic for the unique path methods.  Returns the path if it can be taken (see DejalTakeFileSystemPath()), otherwise the next candidate with the prefix and/or a number inserted before the extension.  When claiming, collisions with concurrent writers just move on to the next number, reading the directory again after several in a row to skip ahead.  Returns nil and sets the error if a path can't be taken for any other reason.
  
- @author DJS 2007-04.
-*/
+ @author DJS 2026-10.
+ */
 
-+ (BOOL)dejal_backupPath:(NSString *)path;
+static NSString *DejalUniquePath(NSString *path, NSString *prefix, BOOL claim, BOOL directory, NSError **error)
 {
-    return [[self defaultManager] dejal_copyPath:path withSuffix:@" backup" replaceExisting:YES error:nil];
+    NSString *candidate = path;
+    int result = DejalTakeFileSystemPath(candidate.fileSystemRepresentation, claim, directory);
+    
+    if (result == EEXIST)
+    {
+        NSString *insertion = prefix.length ? [@" " stringByAppendingString:prefix] : @"";
+        NSUInteger number = DejalNextUniquePathNumber(path, insertion);
+        NSUInteger collisions = 0;
+        
+        while (YES)
+        {
+            candidate = DejalUniquePathCandidate(path, insertion, number);
+            result = DejalTakeFileSystemPath(candidate.fileSystemRepresentation, claim, directory);
+            
+            if (result != EEXIST)
+                break;
+            
+            if (++collisions % DEJAL_UNIQUE_PATH_RESCAN_COLLISIONS)
+                number++;
+            else
+                number = MAX(number + 1, DejalNextUniquePathNumber(path, insertion));
+        }
+    }
+    
+    if (!result)
+        return candidate;
+    
+    DejalSetPOSIXError(error, result, candidate);
+    
+    return nil;
 }
 
 /**
- Like -copyFile:toPath:handler:, but simply uses the same path as the destination with the suffix appended.  Does nothing if no file exists at the specified path, or the suffix is empty.  Optionally deletes any old file at the new path first.  This is particularly useful for doing duplicate operations or backups of files or folders.
+ Returns the path to base a staging file or directory for the path on: a hidden item beside it with a ".dejal-staging" extension (e.g. ".name.txt.dejal-staging"), so one left behind by a crash can't be mistaken for a backup or working file (see -[NSString dejal_backupFilePath]).  Pass it to DejalUniquePath() to get a free one.
  
- @author DJS 2007-04.
- @version DJS 2011-05 changed to avoid using a deprecated method.
-*/
+ @author DJS 2026-10.
+ */
 
-- (BOOL)dejal_copyPath:(NSString *)path withSuffix:(NSString *)suffix replaceExisting:(BOOL)replace error:(NSError **)error;
+static NSString *DejalStagingPathForPath(NSString *path)
 {
-    if ([self fileExistsAtPath:path] && [suffix length])
-    {
-        NSString *destPath = [[path stringByDeletingPathExtension] stringByAppendingString:suffix];
-        destPath = [destPath stringByAppendingPathExtension:[path pathExtension]];
-        
-        if (replace)
-            [self dejal_removeFileIfExistsAtPath:destPath];
-        
-        return [self copyItemAtPath:path toPath:destPath error:error];
-    }
-    else
-        return NO;
+    NSString *filename = [NSString stringWithFormat:@".%@.dejal-staging", [path lastPathComponent]];
+    
+    return [[path stringByDeletingLastPathComponent] stringByAppendingPathComponent:filename];
 }
 
 /**
- Given an array of filenames or extensions (which may be nil or empty) and a directory path, returns an array of full paths that have those filenames or extensions (or all files if no fragments provided) within that directory.  If deep is YES, all subdirectories are scanned, otherwise only the base one is scanned.  If the base path isn't present, or isn't a directory, nil is returned.  The base path may include a tilde.  See also the following more specific methods.
+ Adds the second set of save statistics to the first.
  
- @author DJS 2005-05.
- @version DJS 2005-10: changed to add support for filenames.
- @version DJS 2008-01: changed to sort in Finder order.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSArray *)dejal_pathsWithFragments:(NSArray *)fragments isExtension:(BOOL)isExtension
-                         atPath:(NSString *)basePath deepScan:(BOOL)deep;
+static void DejalAddFileSaveStatistics(DejalFileSaveStatistics *total, DejalFileSaveStatistics statistics)
 {
-    basePath = [basePath dejal_expandedPath];
-    BOOL isDirectory = NO;
-    
-    if (![self fileExistsAtPath:basePath isDirectory:&isDirectory] || !isDirectory)
-        return nil;
-    
-    NSMutableArray *paths = [NSMutableArray array];
-    NSArray *subpaths;
-    
-    if (deep)
-        subpaths = [self subpathsAtPath:basePath];
-    else
-        subpaths = [self contentsOfDirectoryAtPath:basePath error:nil];
-    
-    subpaths = [subpaths dejal_sortedArrayUsingFinderOrder];
-    
-    for (NSString *subpath in subpaths)
-    {
-        NSString *want = isExtension ? [subpath pathExtension] : [subpath dejal_lastPathComponentWithoutExtension];
-        
-        if (!fragments || [fragments dejal_containsObjectEquivalentTo:want])
-            [paths addObject:[basePath stringByAppendingPathComponent:subpath]];
-    }
-    
-    return paths;
+    total->bytesWritten += statistics.bytesWritten;
+    total->bytesCopied += statistics.bytesCopied;
+    total->fileCount += statistics.fileCount;
+    total->syncCount += statistics.syncCount;
+    total->syncDuration += statistics.syncDuration;
+    total->maximumSyncDuration = MAX(total->maximumSyncDuration, statistics.maximumSyncDuration);
 }
 
 /**
- Given a directory path, returns an array of full paths within that directory.  If deep is YES, all subdirectories are scanned, otherwise only the base one is scanned.  If the base path isn't present, or isn't a directory, nil is returned.  The base path may include a tilde.
+ Returns the lock protecting the running save statistics of all transactions and file manager helpers (see +[DejalFileTransaction totalStatistics]).
  
- @author DJS 2007-02.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSArray *)dejal_pathsAtPath:(NSString *)basePath deepScan:(BOOL)deep;
+static NSLock *DejalTotalFileSaveStatisticsLock(void)
 {
-    return [self dejal_pathsWithFragments:nil isExtension:NO atPath:basePath deepScan:deep];
+    static NSLock *lock = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^
+                  {
+                      lock = [NSLock new];
+                  });
+    
+    return lock;
 }
 
+static DejalFileSaveStatistics DejalTotalFileSaveStatistics;
+
 /**
- Given an array of extensions (which may be nil or empty) and a directory path, returns an array of full paths that have those extensions (or all files if no extensions provided) within that directory.  If deep is YES, all subdirectories are scanned, otherwise only the base one is scanned.  If the base path isn't present, or isn't a directory, nil is returned.  The base path may include a tilde.  See also -pathsWithExtension:atPath:deepScan:.
+ Adds the save statistics to the running totals.
  
- @author DJS 2005-05.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSArray *)dejal_pathsWithExtensions:(NSArray *)extensions atPath:(NSString *)basePath deepScan:(BOOL)deep
+static void DejalAddTotalFileSaveStatistics(DejalFileSaveStatistics statistics)
 {
-    return [self dejal_pathsWithFragments:extensions isExtension:YES atPath:basePath deepScan:deep];
+    NSLock *lock = DejalTotalFileSaveStatisticsLock();
+    
+    [lock lock];
+    DejalAddFileSaveStatistics(&DejalTotalFileSaveStatistics, statistics);
+    [lock unlock];
 }
 
 /**
- Given an extension (which may be nil or blank) and a directory path, returns an array of full paths that have that extension (or all files if no extension provided) within that directory.  If deep is YES, all subdirectories are scanned, otherwise only the base one is scanned.  If the base path isn't present, or isn't a directory, nil is returned.  The base path may include a tilde.  See also -pathsWithExtensions:atPath:deepScan:.
+ Flushes the file or directory at the file system path to stable storage, recording the time taken in the statistics.  On Apple platforms this uses F_FULLFSYNC, since fsync() there doesn't flush the drive's own cache.  Returns zero on success, or an errno value.
  
- @author DJS 2005-05.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSArray *)dejal_pathsWithExtension:(NSString *)extension atPath:(NSString *)basePath deepScan:(BOOL)deep
+static int DejalSyncFileSystemPath(const char *path, BOOL directory, DejalFileSaveStatistics *statistics)
 {
-    NSArray *paths;
+    int descriptor = open(path, O_RDONLY | O_CLOEXEC | (directory ? O_DIRECTORY : 0));
     
-    if (![extension length])
-        paths = [self dejal_pathsWithExtensions:nil atPath:basePath deepScan:deep];
-    else
-        paths = [self dejal_pathsWithExtensions:@[extension] atPath:basePath deepScan:deep];
+    if (descriptor < 0)
+        return errno;
     
-    return paths;
+    NSTimeInterval start = [NSDate timeIntervalSinceReferenceDate];
+    int result = 0;
+    
+#if defined(F_FULLFSYNC)
+    if (fcntl(descriptor, F_FULLFSYNC) != 0)
+#endif
+        result = fsync(descriptor) == 0 ? 0 : errno;
+    
+    NSTimeInterval duration = [NSDate timeIntervalSinceReferenceDate] - start;
+    
+    close(descriptor);
+    
+    statistics->syncCount++;
+    statistics->syncDuration += duration;
+    statistics->maximumSyncDuration = MAX(statistics->maximumSyncDuration, duration);
+    
+    return result;
 }
 
 /**
- Given an array of filenames without extensions (which may be nil or empty) and a directory path, returns an array of full paths that have those filenames (or all files if no filenames provided) within that directory.  If deep is YES, all subdirectories are scanned, otherwise only the base one is scanned.  If the base path isn't present, or isn't a directory, nil is returned.  The base path may include a tilde.  See also -pathsWithFilename:atPath:deepScan:.
+ Writes all of the bytes to the file descriptor, continuing after partial writes and interruptions.  Returns zero on success, or an errno value.
  
- @author DJS 2005-10.
+ @author DJS 2026-10.
  */
 
-- (NSArray *)dejal_pathsWithFilenames:(NSArray *)filenames atPath:(NSString *)basePath deepScan:(BOOL)deep
+static int DejalWriteBytes(int descriptor, const uint8_t *bytes, NSUInteger length)
 {
-    return [self dejal_pathsWithFragments:filenames isExtension:NO atPath:basePath deepScan:deep];
+    while (length)
+    {
+        ssize_t written = write(descriptor, bytes, MIN(length, (NSUInteger)SSIZE_MAX));
+        
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            
+            return errno;
+        }
+        
+        bytes += written;
+        length -= written;
+    }
+    
+    return 0;
 }
 
 /**
- Given a filename without an extension (which may be nil or blank) and a directory path, returns an array of full paths that have that filename (or all files if no filename provided) within that directory.  If deep is YES, all subdirectories are scanned, otherwise only the base one is scanned.  If the base path isn't present, or isn't a directory, nil is returned.  The base path may include a tilde.  See also -pathsWithFilenames:atPath:deepScan:.
+ Copies the contents of the source file descriptor, from its start, to the destination one, which should be empty, adding the length to the copied count.  Uses the cheapest way the platform offers: on Linux a reflink (sharing the blocks, on file systems like Btrfs and XFS) or else copy_file_range(), which copies within the kernel; falling back to reading and writing through a buffer.  Not used on Apple platforms, which clone the whole file with copyfile() instead, keeping its metadata (see -[DejalFileTransaction copyFileAtPath:toPath:replaceExisting:error:]).  Returns zero on success, or an errno value.
  
- @author DJS 2005-10.
+ @author DJS 2026-10.
  */
 
-- (NSArray *)dejal_pathsWithFilename:(NSString *)filename atPath:(NSString *)basePath deepScan:(BOOL)deep
+#if !defined(__APPLE__)
+
+static int DejalCopyFileContents(int source, int destination, unsigned long long *copied)
 {
-    NSArray *paths;
+    struct stat info;
     
-    if (![filename length])
-        paths = [self dejal_pathsWithFilenames:nil atPath:basePath deepScan:deep];
-    else
-        paths = [self dejal_pathsWithFilenames:@[filename] atPath:basePath deepScan:deep];
+    if (fstat(source, &info) != 0)
+        return errno;
     
-    return paths;
-}
-
-@end
-
+#if defined(__linux__) && defined(FICLONE)
+    if (ioctl(destination, FICLONE, source) == 0)
+    {
+        *copied += info.st_size;
+        return 0;
+    }
+#endif
+    
+    off_t offset = 0;
+    
+#if defined(__linux__) && defined(SYS_copy_file_range)
+    while (YES)
+    {
+        ssize_t length = syscall(SYS_copy_file_range, source, NULL, destination, NULL, DEJAL_FILE_COPY_RANGE_LENGTH, 0);
+        
+        if (length < 0 && errno == EINTR)
+            continue;
+        
+        if (length <= 0)
+        {
+            // Not supported between these files (or by this kernel), so continue by hand from wherever it got to:
+            if (length < 0 && errno != ENOSYS && errno != EXDEV && errno != EINVAL && errno != EOPNOTSUPP)
+                return errno;
+            
+            break;
+        }
+        
+        offset += length;
+        *copied += length;
+    }
+    
+    if (offset && offset >= info.st_size)
+        return 0;
+#endif
+    
+    uint8_t *buffer = malloc(DEJAL_FILE_COPY_BUFFER_LENGTH);
+    int result = 0;
+    
+    if (!buffer)
+        return ENOMEM;
+    
+    while (!result)
+    {
+        ssize_t length = pread(source, buffer, DEJAL_FILE_COPY_BUFFER_LENGTH, offset);
+        
+        if (length < 0 && errno == EINTR)
+            continue;
+        
+        if (length < 0)
+            result = errno;
+        else if (!length)
+            break;
+        else if (!(result = DejalWriteBytes(destination, buffer, length)))
+        {
+            offset += length;
+            *copied += length;
+        }
+    }
+    
+    free(buffer);
+    
+    return result;
+}
+
+#endif
+
+
+typedef NS_ENUM(NSInteger, DejalRenameMode)
+{
+    DejalRenameModeReplace = 0,
+    DejalRenameModeExclusive,
+    DejalRenameModeSwap
+};
+
+
+/**
+ Renames the item at the first file system path to the second, in one atomic step.  Replace mode replaces any existing item, like rename().  Exclusive mode fails with EEXIST if there is one, falling back to link() then unlink() where there is no native support; swap mode exchanges the two items, both of which must exist, failing with ENOTSUP where there is no native support.  Returns zero on success, or an errno value.
+ 
+ @author DJS 2026-10.
+ */
+
+static int DejalRenameFileSystemPath(const char *fromPath, const char *toPath, DejalRenameMode mode)
+{
+    if (mode == DejalRenameModeReplace)
+        return rename(fromPath, toPath) == 0 ? 0 : errno;
+    
+    int result = ENOTSUP;
+    
+#if defined(__APPLE__)
+    if (renamex_np(fromPath, toPath, mode == DejalRenameModeSwap ? RENAME_SWAP : RENAME_EXCL) == 0)
+        return 0;
+    
+    result = errno;
+#elif defined(__linux__) && defined(SYS_renameat2) && defined(RENAME_NOREPLACE)
+    if (syscall(SYS_renameat2, AT_FDCWD, fromPath, AT_FDCWD, toPath, mode == DejalRenameModeSwap ? RENAME_EXCHANGE : RENAME_NOREPLACE) == 0)
+        return 0;
+    
+    result = errno;
+#endif
+    
+    if (mode == DejalRenameModeSwap || (result != ENOTSUP && result != EOPNOTSUPP && result != ENOSYS && result != EINVAL))
+        return result;
+    
+    if (link(fromPath, toPath) != 0)
+        return errno;
+    
+    return unlink(fromPath) == 0 ? 0 : errno;
+}
+
+
+@implementation NSFileManager (Dejal)
+
+/**
+ Convenience method to return the size of the file specified in the path.
+ 
+ @author DJS 2004-05.
+ @version DJS 2026-10: changed to use -dejal_fileInfoAtPath:, to avoid building an attributes dictionary.
+*/
+
+- (NSInteger)dejal_fileSizeAtPath:(NSString *)path
+{
+    return (NSInteger)[self dejal_fileInfoAtPath:path].size;
+}
+
+/**
+ Convenience method to return the creation date of the file specified in the path.
+ 
+ @author DJS 2006-11.
+ @version DJS 2026-10: changed to use -dejal_fileInfoAtPath:, to avoid building an attributes dictionary where the platform reports creation dates.
+*/
+
+- (NSDate *)dejal_fileCreationDateAtPath:(NSString *)path;
+{
+    DejalFileInfo info = [self dejal_fileInfoAtPath:path];
+    
+    if (!info.exists)
+        return nil;
+    else if (isnan(info.creationDate))
+        return [self attributesOfItemAtPath:path error:nil][NSFileCreationDate];
+    else
+        return [NSDate dateWithTimeIntervalSinceReferenceDate:info.creationDate];
+}
+
+/**
+ Convenience method to return the modification date of the file specified in the path.
+ 
+ @author DJS 2005-11.
+ @version DJS 2026-10: changed to use -dejal_fileInfoAtPath:, to avoid building an attributes dictionary.
+*/
+
+- (NSDate *)dejal_fileModificationDateAtPath:(NSString *)path;
+{
+    DejalFileInfo info = [self dejal_fileInfoAtPath:path];
+    
+    return info.exists ? [NSDate dateWithTimeIntervalSinceReferenceDate:info.modificationDate] : nil;
+}
+
+/**
+ Returns the size, dates and type of the file or directory at the path, via a single system call, without building an attributes dictionary.  If nothing exists at the path, the exists field is NO.
+ 
+ @param path The path of the file or directory.
+ @returns The file info.
+ 
+ @author DJS 2026-10.
+ */
+
+- (DejalFileInfo)dejal_fileInfoAtPath:(NSString *)path;
+{
+    return DejalFileInfoForFileSystemPath(path.length ? path.fileSystemRepresentation : NULL);
+}
+
+/**
+ Fills in the size, dates and type of the file or directory at each of the paths, concurrently across threads for large arrays.  See -dejal_fileInfoAtPath:.
+ 
+ @param infos A C array to receive the file info, with room for an entry per path.
+ @param paths An array of paths.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)dejal_getFileInfo:(DejalFileInfo *)infos forPaths:(NSArray *)paths;
+{
+    DejalGetFileInfoForPaths(infos, paths);
+}
+
+/**
+ Convenience method to return YES if the specified path is a directory, otherwise NO.
+ 
+ @author DJS 2013-02.
+ @version DJS 2026-10: changed to use -dejal_isDirectoryAtPath:.
+*/
+
+- (BOOL)dejal_isDirectoryAtURL:(NSURL *)url;
+{
+    return [self dejal_isDirectoryAtPath:url.path];
+}
+
+/**
+ Convenience method to return YES if the specified path is a directory, otherwise NO.  Like -fileExistsAtPath:isDirectory:, a symbolic link to a directory counts as a directory.  See DejalFileInfoCache for a cached equivalent.
+ 
+ @author DJS 2005-10.
+ @version DJS 2026-10: changed to use -dejal_fileInfoAtPath:, to make a lstat() call directly.
+*/
+
+- (BOOL)dejal_isDirectoryAtPath:(NSString *)path;
+{
+    return [self dejal_fileInfoAtPath:path].isDirectory;
+}
+
+/**
+ Renames the file or directory specified in the URL to have the specified filename, in the same location.  If deleteExisting is YES and the destination already exists, it is replaced; otherwise an error will occur.  See -dejal_renameItemAtPath:toFilename:deleteExisting:error: for details.
+ 
+ @author DJS 2004-03.
+ @version DJS 2005-12: changed to handle a special case when just changing the case of the name.
+ @version DJS 2011-05: changed to avoid using a deprecated method.
+ @version DJS 2026-10: changed to use the path edition for file URLs, to replace the destination atomically.
+*/
+
+- (BOOL)dejal_renameItemAtURL:(NSURL *)url toFilename:(NSString *)filename deleteExisting:(BOOL)deleteExisting error:(NSError **)error;
+{
+    if ([url isFileURL])
+        return [self dejal_renameItemAtPath:[url path] toFilename:filename deleteExisting:deleteExisting error:error];
+    
+    NSURL *destination = [[url URLByDeletingLastPathComponent] URLByAppendingPathComponent:filename];
+    
+    // Special case: if the current name and the filename are equivalent, i.e. only differing in case, removing would be wrong and moving would fail, so we need to change the name:
+    NSString *oldName = [url lastPathComponent];
+    
+    if ([oldName dejal_isEquivalentTo:filename])
+    {
+        NSURL *oldURL = url;
+        NSString *tempName = [oldName stringByAppendingFormat:@"%.2f", [NSDate timeIntervalSinceReferenceDate]];
+        
+        url = [[url URLByDeletingLastPathComponent] URLByAppendingPathComponent:tempName];
+        
+        [self moveItemAtURL:oldURL toURL:url error:error];
+    }
+    
+    if (deleteExisting)
+        [self removeItemAtURL:destination error:nil];
+    
+    return [self moveItemAtURL:url toURL:destination error:error];
+}
+
+/**
+ Renames the file or directory specified in the path to have the specified filename, in the same location.  If deleteExisting is YES and the destination already exists, it is replaced in one atomic step where possible, so there is never a moment with neither item present; only an existing folder, which rename() can't replace unless empty, is first deleted.  Otherwise an error will occur if the destination exists.  See the standard -movePath:toPath:handler: method description for details of the handler parameter and other relevant information.
+ 
+ @author DJS 2004-03.
+ @version DJS 2005-12: changed to handle a special case when just changing the case of the name.
+ @version DJS 2011-05: changed to avoid using a deprecated method.
+ @version DJS 2026-10: changed to replace the destination atomically via rename(), instead of deleting it first.
+*/
+
+- (BOOL)dejal_renameItemAtPath:(NSString *)path toFilename:(NSString *)filename deleteExisting:(BOOL)deleteExisting error:(NSError **)error;
+{
+    NSString *destination = [[path stringByDeletingLastPathComponent] stringByAppendingPathComponent:filename];
+    
+    // Special case: if the current name and the filename are equivalent, i.e. only differing in case, removing would be wrong and moving would fail, so we need to change the name:
+    if ([[path lastPathComponent] dejal_isEquivalentTo:filename])
+    {
+        NSString *oldPath = path;
+        
+        path = [path stringByAppendingFormat:@"%.2f", [NSDate timeIntervalSinceReferenceDate]];
+        
+        [self moveItemAtPath:oldPath toPath:path error:error];
+    }
+    
+    if (deleteExisting && DejalRenameFileSystemPath(path.fileSystemRepresentation, destination.fileSystemRepresentation, DejalRenameModeReplace) == 0)
+        return YES;
+    
+    if (deleteExisting && [self fileExistsAtPath:destination])
+        [self removeItemAtPath:destination error:error];
+    
+    return [self moveItemAtPath:path toPath:destination error:error];
+}
+
+/**
+ Given a working file, i.e. one named with a tilde before the extension (see -[NSString backupFilePath]), swaps the working file and the previous final file (if any).  On success the working file is first flushed to storage, then the two are exchanged in one atomic step where the platform supports it (renamex_np() on Apple platforms, renameat2() on Linux), falling back to three renames, and finally the directory is flushed, so the new final file survives a crash or power loss.  The time spent flushing is included in +[DejalFileTransaction totalStatistics].
+ 
+ @author DJS 2004-03.
+ @version DJS 2011-05: changed to avoid using a deprecated method.
+ @version DJS 2026-10: changed to flush the file and directory, and to swap the files atomically where possible.
+*/
+
+- (BOOL)dejal_renameWorkingFile:(NSString *)workingPath forSuccess:(BOOL)success error:(NSError **)error;
+{
+    BOOL okay = YES;
+    
+    if (success)
+    {
+        NSString *basePath = [workingPath stringByDeletingLastPathComponent];
+        NSString *extension = [workingPath pathExtension];
+        NSString *workingFilename = [workingPath lastPathComponent];
+        NSString *workingBase = [workingFilename stringByDeletingPathExtension];
+        NSString *finalFilename = [workingBase substringToIndex:[workingBase length] - 1];
+        NSString *tempFilename = [workingBase stringByAppendingString:@"~"];
+        
+        if ([extension length])
+        {
+            finalFilename = [finalFilename stringByAppendingPathExtension:extension];
+            tempFilename = [tempFilename stringByAppendingPathExtension:extension];
+        }
+        
+        NSString *finalPath = [basePath stringByAppendingPathComponent:finalFilename];
+        NSString *tempPath = [basePath stringByAppendingPathComponent:tempFilename];
+        DejalFileSaveStatistics statistics = {0};
+        BOOL isDirectory = NO;
+        int result = 0;
+        
+        if ([self fileExistsAtPath:workingPath isDirectory:&isDirectory] && !isDirectory)
+            result = DejalSyncFileSystemPath(workingPath.fileSystemRepresentation, NO, &statistics);
+        
+        if (result)
+            okay = DejalSetPOSIXError(error, result, workingPath);
+        else if (![self fileExistsAtPath:finalPath])
+            okay = [self dejal_renameItemAtPath:workingPath toFilename:finalFilename deleteExisting:NO error:error];
+        else if (DejalRenameFileSystemPath(workingPath.fileSystemRepresentation, finalPath.fileSystemRepresentation, DejalRenameModeSwap) != 0)
+        {
+            // Rename the working file with an extra tilde on the end:
+            okay = [self dejal_renameItemAtPath:workingPath toFilename:tempFilename deleteExisting:YES error:error];
+            
+            // Rename the previous file the same as the working file was:
+            okay = okay && [self dejal_renameItemAtPath:finalPath toFilename:workingFilename deleteExisting:NO error:error];
+            
+            // Rename the working file the same as the previous file was:
+            okay = okay && [self dejal_renameItemAtPath:tempPath toFilename:finalFilename deleteExisting:NO error:error];
+        }
+        
+        if (okay)
+        {
+            result = DejalSyncFileSystemPath(basePath.length ? basePath.fileSystemRepresentation : ".", YES, &statistics);
+            
+            if (result)
+                okay = DejalSetPOSIXError(error, result, basePath);
+            else
+                statistics.fileCount++;
+        }
+        
+        DejalAddTotalFileSaveStatistics(statistics);
+    }
+    else
+    {
+        // Failed, so just delete the working file:
+        okay = [self removeItemAtPath:workingPath error:error];
+    }
+    
+    return okay;
+}
+
+/**
+ Saves the data to the path, durably and atomically: it is written to a new file beside the path, which is flushed to storage then renamed over any existing file, then the directory is flushed.  So after a crash or power loss the path has either the old contents or all of the new ones.  Any existing file's permissions are kept.  This is a one-file DejalFileTransaction; use one of those directly to save several files together, which is faster.
+ 
+ @param data The data to save.
+ @param path The file to save to.
+ @param error Set to the error if the save fails.
+ @returns YES if saved, otherwise NO.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)dejal_saveData:(NSData *)data toPath:(NSString *)path error:(NSError **)error;
+{
+    DejalFileTransaction *transaction = [DejalFileTransaction new];
+    
+    return [transaction writeData:data toPath:path error:error] && [transaction commit:error];
+}
+
+
+/**
+ Given a file or directory path, returns the same path if nothing exists there, or returns that path with the prefix and/or a number inserted before the extension to make it unique (e.g. "filename copy.txt", "filename copy 2.txt", "filename copy 3.txt", etc).  Without a prefix, numbering starts at two (e.g. "filename 2.txt").  Rather than checking each candidate in turn, the directory is read once to find the highest existing number, and the next one is used; if the directory can't be read, the number is found by probing exponentially then binary searching.  Nothing is created, so another thread or process could take the path before the caller does; use -dejal_claimUniquePathForPath:prefix:directory:error: to avoid that.
+ 
+ @param path The desired path.
+ @param prefix Text to insert before the number, e.g. "copy", or nil for none.
+ @returns The unique path.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSString *)dejal_uniquePathForPath:(NSString *)path prefix:(NSString *)prefix;
+{
+    return DejalUniquePath(path, prefix, NO, NO, nil);
+}
+
+/**
+ Like -dejal_uniquePathForPath:prefix:, but atomically claims the unique path by creating an empty file or directory there, which fails if anything already exists.  If another thread or process takes a candidate first, the next one is tried, so concurrent callers always get different paths.  The caller can then replace or fill in the claimed item.
+ 
+ @param path The desired path.
+ @param prefix Text to insert before the number, e.g. "copy", or nil for none.
+ @param directory YES to create a directory, NO to create an empty file.
+ @param error Set to a POSIX error if the item couldn't be created for a reason other than the path being taken.
+ @returns The claimed path, or nil on error.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSString *)dejal_claimUniquePathForPath:(NSString *)path prefix:(NSString *)prefix directory:(BOOL)directory error:(NSError **)error;
+{
+    return DejalUniquePath(path, prefix, YES, directory, error);
+}
+
+/**
+ If a file or folder exists at the path, it is blindly removed.  As with -removeFileAtPath:handler:, use caution with this method.  Returns YES if the file didn't exist, or was successsfully removed, or NO if it couldn't be removed.
+ 
+ @author DJS 2004-06.
+*/
+
+- (BOOL)dejal_removeFileIfExistsAtPath:(NSString *)path
+{
+    if ([self fileExistsAtPath:path])
+        return [self removeItemAtPath:path error:nil];
+    else
+        return YES;
+}
+
+/**
+ Convenience class method to duplicate the path with a " backup" suffix, replacing any old backup.  The new backup is moved into place in one step, so it is safe for several threads or processes to back up the same path at once.
+ 
+ @author DJS 2007-04.
+ @version DJS 2026-10: changed to replace the old backup atomically (see -dejal_copyPath:withSuffix:replaceExisting:error:).
+*/
+
++ (BOOL)dejal_backupPath:(NSString *)path;
+{
+    return [[self defaultManager] dejal_copyPath:path withSuffix:@" backup" replaceExisting:YES error:nil];
+}
+
+/**
+ Like -copyFile:toPath:handler:, but simply uses the same path as the destination with the suffix appended.  Does nothing if no file exists at the specified path, or the suffix is empty.  Optionally replaces any old file at the new path.  This is particularly useful for doing duplicate operations or backups of files or folders.  A file is copied via a DejalFileTransaction, so the copy is made as cheaply as the platform allows (a clone with all of its metadata on Apple platforms, or a reflink or copy_file_range() on Linux), flushed to storage, and moved into place atomically.  A folder is copied into a freshly claimed hidden staging directory beside the destination, then renamed over the old one, so concurrent copies neither collide nor leave a partial copy at the destination.
+ 
+ @author DJS 2007-04.
+ @version DJS 2011-05 changed to avoid using a deprecated method.
+ @version DJS 2026-10: changed to replace the old file atomically via a staging directory.
+ @version DJS 2026-10: changed to copy files durably and without reading them into user space where possible, via DejalFileTransaction.
+*/
+
+- (BOOL)dejal_copyPath:(NSString *)path withSuffix:(NSString *)suffix replaceExisting:(BOOL)replace error:(NSError **)error;
+{
+    BOOL isDirectory = NO;
+    
+    if (![self fileExistsAtPath:path isDirectory:&isDirectory] || ![suffix length])
+        return NO;
+    
+    NSString *destPath = [path dejal_stringByInsertingBeforePathExtension:suffix];
+    
+    if (!isDirectory)
+    {
+        DejalFileTransaction *transaction = [DejalFileTransaction new];
+        
+        return [transaction copyFileAtPath:path toPath:destPath replaceExisting:replace error:error] && [transaction commit:error];
+    }
+    
+    if (!replace)
+        return [self copyItemAtPath:path toPath:destPath error:error];
+    
+    NSString *stagingPath = DejalUniquePath(DejalStagingPathForPath(destPath), nil, YES, YES, error);
+    
+    if (!stagingPath)
+        return NO;
+    
+    NSString *stagedPath = [stagingPath stringByAppendingPathComponent:[destPath lastPathComponent]];
+    BOOL okay = [self copyItemAtPath:path toPath:stagedPath error:error];
+    
+    // rename() atomically replaces a file, but can only replace an empty directory, so an old folder needs to be removed first:
+    if (okay && rename(stagedPath.fileSystemRepresentation, destPath.fileSystemRepresentation) != 0)
+    {
+        [self dejal_removeFileIfExistsAtPath:destPath];
+        
+        okay = [self moveItemAtPath:stagedPath toPath:destPath error:error];
+    }
+    
+    [self removeItemAtPath:stagingPath error:nil];
+    
+    return okay;
+}
+
+/**
+ Private method that scans the directory at the base path, and its subdirectories if deep is YES, calling the block with batches of matching subpaths relative to the base path, in no particular order.  Subdirectories are scanned concurrently on the global queue, which GCD balances across cores; each directory is read once with readdir(), without building the whole tree in memory.  Matches are tested against a hashed set of the fragments' equivalence keys (see -dejal_equivalenceKey).  Symbolic links are reported but not traversed, like -subpathsAtPath:.  Unreadable directories are skipped.  Calls to the block are serialized; setting its stop parameter to YES stops the scan.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)dejal_scanSubpathsWithFragments:(NSArray *)fragments isExtension:(BOOL)isExtension atPath:(NSString *)basePath deepScan:(BOOL)deep batchSize:(NSUInteger)batchSize usingBlock:(void (^)(NSArray *subpaths, BOOL *stop))block;
+{
+    NSMutableSet *fragmentKeys = nil;
+    
+    if (fragments)
+    {
+        fragmentKeys = [NSMutableSet setWithCapacity:fragments.count];
+        
+        for (id fragment in fragments)
+            [fragmentKeys addObject:[fragment dejal_equivalenceKey]];
+    }
+    
+    if (!batchSize)
+        batchSize = DEJAL_PATH_ENUMERATION_BATCH_SIZE;
+    
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    dispatch_group_t group = dispatch_group_create();
+    NSLock *pendingLock = [NSLock new];
+    NSLock *deliveryLock = [NSLock new];
+    NSMutableArray *pending = [NSMutableArray arrayWithCapacity:MIN(batchSize, DEJAL_PATH_ENUMERATION_BATCH_SIZE)];
+    atomic_bool *stopped = malloc(sizeof(atomic_bool));
+    
+    atomic_init(stopped, NO);
+    
+    void (^deliver)(NSArray *) = ^(NSArray *batch)
+    {
+        [deliveryLock lock];
+        
+        if (!atomic_load(stopped))
+        {
+            BOOL stop = NO;
+            
+            block(batch, &stop);
+            
+            if (stop)
+                atomic_store(stopped, YES);
+        }
+        
+        [deliveryLock unlock];
+    };
+    
+    void (^addMatches)(NSMutableArray *, BOOL) = ^(NSMutableArray *matches, BOOL force)
+    {
+        NSArray *batch = nil;
+        
+        [pendingLock lock];
+        [pending addObjectsFromArray:matches];
+        
+        if (pending.count >= batchSize || (force && pending.count))
+        {
+            batch = [pending copy];
+            [pending removeAllObjects];
+        }
+        
+        [pendingLock unlock];
+        [matches removeAllObjects];
+        
+        if (batch)
+            deliver(batch);
+    };
+    
+    __block void (^scanDirectory)(NSString *);
+    
+    scanDirectory = ^(NSString *relativePath)
+    {
+        @autoreleasepool
+        {
+            NSString *directoryPath = relativePath ? [basePath stringByAppendingPathComponent:relativePath] : basePath;
+            DIR *directory = opendir(directoryPath.fileSystemRepresentation);
+            
+            if (!directory)
+                return;
+            
+            NSMutableArray *matches = [NSMutableArray array];
+            struct dirent *entry;
+            
+            while (!atomic_load(stopped) && (entry = readdir(directory)))
+            {
+                if (entry->d_name[0] == '.' && (entry->d_name[1] == '\0' || (entry->d_name[1] == '.' && entry->d_name[2] == '\0')))
+                    continue;
+                
+                NSString *name = [self stringWithFileSystemRepresentation:entry->d_name length:strlen(entry->d_name)];
+                NSString *subpath = relativePath ? [relativePath stringByAppendingPathComponent:name] : name;
+                
+                if (fragmentKeys)
+                {
+                    NSString *want = isExtension ? [name pathExtension] : [name stringByDeletingPathExtension];
+                    
+                    if ([fragmentKeys containsObject:[want dejal_equivalenceKey]])
+                        [matches addObject:subpath];
+                }
+                else
+                {
+                    [matches addObject:subpath];
+                }
+                
+                if (matches.count >= batchSize)
+                    addMatches(matches, NO);
+                
+                if (deep)
+                {
+                    BOOL isDirectory = entry->d_type == DT_DIR;
+                    
+                    if (entry->d_type == DT_UNKNOWN)
+                    {
+                        struct stat info;
+                        NSString *entryPath = [directoryPath stringByAppendingPathComponent:name];
+                        
+                        isDirectory = lstat(entryPath.fileSystemRepresentation, &info) == 0 && S_ISDIR(info.st_mode);
+                    }
+                    
+                    if (isDirectory)
+                        dispatch_group_async(group, queue, ^{ scanDirectory(subpath); });
+                }
+            }
+            
+            closedir(directory);
+            
+            if (matches.count)
+                addMatches(matches, NO);
+        }
+    };
+    
+    dispatch_group_async(group, queue, ^{ scanDirectory(nil); });
+    dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+    
+    // Break the retain cycle of the recursive block:
+    scanDirectory = nil;
+    
+    addMatches([NSMutableArray array], YES);
+    
+    free(stopped);
+}
+
+/**
+ Streaming edition of -pathsWithFragments:isExtension:atPath:deepScan:.  Given an array of filenames or extensions (which may be nil, for all files) and a directory path, calls the block with batches of full paths that have those filenames or extensions within that directory, as they are found.  If deep is YES, all subdirectories are scanned, concurrently; otherwise only the base one is scanned.  If sorted is YES, all of the paths are gathered and sorted in Finder order first, otherwise they are delivered unsorted as soon as each batch is full, keeping memory use bounded.  Calls to the block are serialized, though may be on any thread; set its stop parameter to YES to stop early.  The base path may include a tilde.
+ 
+ @param fragments Filenames without extensions or extensions to match (case-insensitive), or nil for all.
+ @param isExtension YES if the fragments are extensions, NO if filenames.
+ @param basePath The directory to scan.
+ @param deep YES to scan subdirectories too.
+ @param sorted YES to deliver the paths in Finder order, NO to deliver them as found.
+ @param batchSize The maximum number of paths per batch, or zero for a default.
+ @param block The block to call with each batch of full paths.
+ @returns YES if the scan was done, or NO if the base path isn't present, or isn't a directory.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)dejal_enumeratePathsWithFragments:(NSArray *)fragments isExtension:(BOOL)isExtension atPath:(NSString *)basePath deepScan:(BOOL)deep sorted:(BOOL)sorted batchSize:(NSUInteger)batchSize usingBlock:(void (^)(NSArray *paths, BOOL *stop))block;
+{
+    basePath = [basePath dejal_expandedPath];
+    BOOL isDirectory = NO;
+    
+    if (![self fileExistsAtPath:basePath isDirectory:&isDirectory] || !isDirectory)
+        return NO;
+    
+    if (!batchSize)
+        batchSize = DEJAL_PATH_ENUMERATION_BATCH_SIZE;
+    
+    NSArray *(^fullPaths)(NSArray *) = ^NSArray *(NSArray *subpaths)
+    {
+        NSMutableArray *paths = [NSMutableArray arrayWithCapacity:subpaths.count];
+        
+        for (NSString *subpath in subpaths)
+            [paths addObject:[basePath stringByAppendingPathComponent:subpath]];
+        
+        return paths;
+    };
+    
+    if (!sorted)
+    {
+        [self dejal_scanSubpathsWithFragments:fragments isExtension:isExtension atPath:basePath deepScan:deep batchSize:batchSize usingBlock:^(NSArray *subpaths, BOOL *stop)
+        {
+            block(fullPaths(subpaths), stop);
+        }];
+        
+        return YES;
+    }
+    
+    NSMutableArray *allSubpaths = [NSMutableArray array];
+    
+    [self dejal_scanSubpathsWithFragments:fragments isExtension:isExtension atPath:basePath deepScan:deep batchSize:batchSize usingBlock:^(NSArray *subpaths, BOOL *stop)
+    {
+        [allSubpaths addObjectsFromArray:subpaths];
+    }];
+    
+    NSArray *sortedSubpaths = [allSubpaths dejal_sortedArrayUsingFinderOrder];
+    NSUInteger count = sortedSubpaths.count;
+    BOOL stop = NO;
+    
+    for (NSUInteger start = 0; start < count && !stop; start += batchSize)
+    {
+        @autoreleasepool
+        {
+            block(fullPaths([sortedSubpaths subarrayWithRange:NSMakeRange(start, MIN(batchSize, count - start))]), &stop);
+        }
+    }
+    
+    return YES;
+}
+
+/**
+ Given an array of filenames or extensions (which may be nil or empty) and a directory path, returns an array of full paths that have those filenames or extensions (or all files if no fragments provided) within that directory.  If deep is YES, all subdirectories are scanned, otherwise only the base one is scanned.  If the base path isn't present, or isn't a directory, nil is returned.  The base path may include a tilde.  See also the following more specific methods.
+ 
+ @author DJS 2005-05.
+ @version DJS 2005-10: changed to add support for filenames.
+ @version DJS 2008-01: changed to sort in Finder order.
+ @version DJS 2026-10: changed to use the concurrent streaming scanner, with a hashed fragment set.
+*/
+
+- (NSArray *)dejal_pathsWithFragments:(NSArray *)fragments isExtension:(BOOL)isExtension
+                         atPath:(NSString *)basePath deepScan:(BOOL)deep;
+{
+    NSMutableArray *paths = [NSMutableArray array];
+    
+    BOOL okay = [self dejal_enumeratePathsWithFragments:fragments isExtension:isExtension atPath:basePath deepScan:deep sorted:YES batchSize:NSUIntegerMax usingBlock:^(NSArray *batch, BOOL *stop)
+    {
+        [paths addObjectsFromArray:batch];
+    }];
+    
+    return okay ? paths : nil;
+}
+
+/**
+ Given a directory path, returns an array of full paths within that directory.  If deep is YES, all subdirectories are scanned, otherwise only the base one is scanned.  If the base path isn't present, or isn't a directory, nil is returned.  The base path may include a tilde.
+ 
+ @author DJS 2007-02.
+*/
+
+- (NSArray *)dejal_pathsAtPath:(NSString *)basePath deepScan:(BOOL)deep;
+{
+    return [self dejal_pathsWithFragments:nil isExtension:NO atPath:basePath deepScan:deep];
+}
+
+/**
+ Given an array of extensions (which may be nil or empty) and a directory path, returns an array of full paths that have those extensions (or all files if no extensions provided) within that directory.  If deep is YES, all subdirectories are scanned, otherwise only the base one is scanned.  If the base path isn't present, or isn't a directory, nil is returned.  The base path may include a tilde.  See also -pathsWithExtension:atPath:deepScan:.
+ 
+ @author DJS 2005-05.
+*/
+
+- (NSArray *)dejal_pathsWithExtensions:(NSArray *)extensions atPath:(NSString *)basePath deepScan:(BOOL)deep
+{
+    return [self dejal_pathsWithFragments:extensions isExtension:YES atPath:basePath deepScan:deep];
+}
+
+/**
+ Given an extension (which may be nil or blank) and a directory path, returns an array of full paths that have that extension (or all files if no extension provided) within that directory.  If deep is YES, all subdirectories are scanned, otherwise only the base one is scanned.  If the base path isn't present, or isn't a directory, nil is returned.  The base path may include a tilde.  See also -pathsWithExtensions:atPath:deepScan:.
+ 
+ @author DJS 2005-05.
+*/
+
+- (NSArray *)dejal_pathsWithExtension:(NSString *)extension atPath:(NSString *)basePath deepScan:(BOOL)deep
+{
+    NSArray *paths;
+    
+    if (![extension length])
+        paths = [self dejal_pathsWithExtensions:nil atPath:basePath deepScan:deep];
+    else
+        paths = [self dejal_pathsWithExtensions:@[extension] atPath:basePath deepScan:deep];
+    
+    return paths;
+}
+
+/**
+ Given an array of filenames without extensions (which may be nil or empty) and a directory path, returns an array of full paths that have those filenames (or all files if no filenames provided) within that directory.  If deep is YES, all subdirectories are scanned, otherwise only the base one is scanned.  If the base path isn't present, or isn't a directory, nil is returned.  The base path may include a tilde.  See also -pathsWithFilename:atPath:deepScan:.
+ 
+ @author DJS 2005-10.
+ */
+
+- (NSArray *)dejal_pathsWithFilenames:(NSArray *)filenames atPath:(NSString *)basePath deepScan:(BOOL)deep
+{
+    return [self dejal_pathsWithFragments:filenames isExtension:NO atPath:basePath deepScan:deep];
+}
+
+/**
+ Given a filename without an extension (which may be nil or blank) and a directory path, returns an array of full paths that have that filename (or all files if no filename provided) within that directory.  If deep is YES, all subdirectories are scanned, otherwise only the base one is scanned.  If the base path isn't present, or isn't a directory, nil is returned.  The base path may include a tilde.  See also -pathsWithFilenames:atPath:deepScan:.
+ 
+ @author DJS 2005-10.
+ */
+
+- (NSArray *)dejal_pathsWithFilename:(NSString *)filename atPath:(NSString *)basePath deepScan:(BOOL)deep
+{
+    NSArray *paths;
+    
+    if (![filename length])
+        paths = [self dejal_pathsWithFilenames:nil atPath:basePath deepScan:deep];
+    else
+        paths = [self dejal_pathsWithFilenames:@[filename] atPath:basePath deepScan:deep];
+    
+    return paths;
+}
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalFileInfoCacheEntry : NSObject
+{
+@public
+    DejalFileInfo info;
+    NSTimeInterval fetched;     // Since the reference date
+}
+
+@end
+
+
+@implementation DejalFileInfoCacheEntry
+
+@end
+
+
+@interface DejalFileInfoCache ()
+
+@property (nonatomic, strong) NSMutableDictionary *entries;
+@property (nonatomic, strong) NSLock *lock;
+
+@end
+
+
+@implementation DejalFileInfoCache
+{
+    atomic_ulong _hits;
+    atomic_ulong _misses;
+}
+
+/**
+ Singleton method to return a shared file info cache, creating it if necessary.
+ 
+ @author DJS 2026-10.
+ */
+
++ (instancetype)sharedCache;
+{
+    static DejalFileInfoCache *sharedCache = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^
+                  {
+                      sharedCache = [self new];
+                  });
+    
+    return sharedCache;
+}
+
+/**
+ Initializes a new file info cache with the default maximum age.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)init;
+{
+    if ((self = [super init]))
+    {
+        self.entries = [NSMutableDictionary dictionary];
+        self.lock = [NSLock new];
+        self.maximumAge = DEJAL_FILE_INFO_CACHE_MAXIMUM_AGE;
+    }
+    
+    return self;
+}
+
+/**
+ Private method to look up the cached info for the path, returning NO if there isn't any, or it is older than the maximum age.  Must be called with the lock held.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)getCachedInfo:(DejalFileInfo *)info forPath:(NSString *)path now:(NSTimeInterval)now;
+{
+    DejalFileInfoCacheEntry *entry = self.entries[path];
+    
+    if (!entry)
+        return NO;
+    
+    *info = entry->info;
+    
+    return now - entry->fetched <= self.maximumAge;
+}
+
+/**
+ Private method to store the info for the path.  Must be called with the lock held.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)setCachedInfo:(DejalFileInfo)info forPath:(NSString *)path now:(NSTimeInterval)now;
+{
+    DejalFileInfoCacheEntry *entry = [DejalFileInfoCacheEntry new];
+    
+    entry->info = info;
+    entry->fetched = now;
+    
+    self.entries[path] = entry;
+}
+
+/**
+ Private method to check whether a cached entry is still current: only the modification date and size are compared, via a fresh lstat(), which avoids the stat() for links and the dictionary of attributes.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)isCachedInfo:(DejalFileInfo)cached currentForPath:(NSString *)path fresh:(DejalFileInfo *)fresh;
+{
+    *fresh = DejalFileInfoForFileSystemPath(path.fileSystemRepresentation);
+    
+    return fresh->exists == cached.exists && fresh->size == cached.size && (fresh->modificationDate == cached.modificationDate || (isnan(fresh->modificationDate) && isnan(cached.modificationDate)));
+}
+
+/**
+ Returns the info for the path, from the cache if it was fetched within the maximum age, otherwise via a system call, caching the result.  Updates the hit and miss counts.  A nil or empty path gets the info for a missing file, without being cached or counted.
+ 
+ @param path The path of the file or directory.
+ @returns The file info.
+ 
+ @author DJS 2026-10.
+ */
+
+- (DejalFileInfo)fileInfoAtPath:(NSString *)path;
+{
+    if (!path.length)
+        return DejalFileInfoForFileSystemPath(NULL);
+    
+    NSTimeInterval now = [NSDate timeIntervalSinceReferenceDate];
+    DejalFileInfo info;
+    BOOL found;
+    
+    [self.lock lock];
+    found = [self getCachedInfo:&info forPath:path now:now];
+    [self.lock unlock];
+    
+    if (found)
+    {
+        atomic_fetch_add(&_hits, 1);
+        return info;
+    }
+    
+    atomic_fetch_add(&_misses, 1);
+    info = DejalFileInfoForFileSystemPath(path.fileSystemRepresentation);
+    
+    [self.lock lock];
+    [self setCachedInfo:info forPath:path now:now];
+    [self.lock unlock];
+    
+    return info;
+}
+
+/**
+ Returns YES if the path is a directory, or a symbolic link to one, otherwise NO, from the cache if it was fetched within the maximum age.  See -fileInfoAtPath:.
+ 
+ @param path The path of the file or directory.
+ @returns YES if the path is a directory.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)isDirectoryAtPath:(NSString *)path;
+{
+    return [self fileInfoAtPath:path].isDirectory;
+}
+
+/**
+ Fills in the info for each of the paths, from the cache where current, and fetching the rest concurrently across threads.  Updates the hit and miss counts.  Empty paths get the info for a missing file, without being cached or counted.
+ 
+ @param infos A C array to receive the file info, with room for an entry per path.
+ @param paths An array of paths.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)getFileInfo:(DejalFileInfo *)infos forPaths:(NSArray *)paths;
+{
+    NSTimeInterval now = [NSDate timeIntervalSinceReferenceDate];
+    NSMutableArray *missingPaths = [NSMutableArray array];
+    NSMutableIndexSet *missingIndexes = [NSMutableIndexSet indexSet];
+    NSUInteger emptyCount = 0;
+    NSUInteger i = 0;
+    
+    [self.lock lock];
+    
+    for (NSString *path in paths)
+    {
+        if (!path.length)
+        {
+            infos[i] = DejalFileInfoForFileSystemPath(NULL);
+            emptyCount++;
+        }
+        else if (![self getCachedInfo:&infos[i] forPath:path now:now])
+        {
+            [missingPaths addObject:path];
+            [missingIndexes addIndex:i];
+        }
+        
+        i++;
+    }
+    
+    [self.lock unlock];
+    
+    NSUInteger missingCount = missingPaths.count;
+    
+    atomic_fetch_add(&_hits, paths.count - missingCount - emptyCount);
+    atomic_fetch_add(&_misses, missingCount);
+    
+    if (!missingCount)
+        return;
+    
+    DejalFileInfo *fetched = malloc(missingCount * sizeof(DejalFileInfo));
+    __block NSUInteger j = 0;
+    
+    DejalGetFileInfoForPaths(fetched, missingPaths);
+    
+    [self.lock lock];
+    
+    [missingIndexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop)
+    {
+        infos[idx] = fetched[j];
+        [self setCachedInfo:fetched[j] forPath:missingPaths[j] now:now];
+        j++;
+    }];
+    
+    [self.lock unlock];
+    
+    free(fetched);
+}
+
+/**
+ Removes any cached info for the path, e.g. after writing to the file.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)invalidatePath:(NSString *)path;
+{
+    [self.lock lock];
+    [self.entries removeObjectForKey:path];
+    [self.lock unlock];
+}
+
+/**
+ Removes any cached info for paths that have changed since they were cached, per their modification date and size.  This costs a lstat() per cached path, but avoids the stat() for links and lets unchanged entries keep being hits.  Returns the number of paths invalidated.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSUInteger)invalidateModifiedPaths;
+{
+    NSDictionary *entries;
+    NSMutableArray *changedPaths = [NSMutableArray array];
+    
+    [self.lock lock];
+    entries = [self.entries copy];
+    [self.lock unlock];
+    
+    [entries enumerateKeysAndObjectsUsingBlock:^(NSString *path, DejalFileInfoCacheEntry *entry, BOOL *stop)
+    {
+        DejalFileInfo fresh;
+        
+        if (![self isCachedInfo:entry->info currentForPath:path fresh:&fresh])
+            [changedPaths addObject:path];
+    }];
+    
+    [self.lock lock];
+    [self.entries removeObjectsForKeys:changedPaths];
+    [self.lock unlock];
+    
+    return changedPaths.count;
+}
+
+/**
+ Removes all cached info.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)invalidateAllPaths;
+{
+    [self.lock lock];
+    [self.entries removeAllObjects];
+    [self.lock unlock];
+}
+
+/**
+ Returns the number of paths whose info came from the cache.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSUInteger)hits;
+{
+    return atomic_load(&_hits);
+}
+
+/**
+ Returns the number of paths whose info needed a system call.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSUInteger)misses;
+{
+    return atomic_load(&_misses);
+}
+
+/**
+ Resets the hit and miss counts to zero.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)resetStatistics;
+{
+    atomic_store(&_hits, 0);
+    atomic_store(&_misses, 0);
+}
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalFileTransactionItem : NSObject
+
+@property (nonatomic, copy) NSString *path;
+@property (nonatomic, copy) NSString *stagingPath;
+@property (nonatomic) BOOL replace;
+
+@end
+
+
+@implementation DejalFileTransactionItem
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalFileTransaction ()
+
+@property (nonatomic, strong) NSMutableArray *items;
+@property (nonatomic, strong) NSLock *lock;
+
+@end
+
+
+@implementation DejalFileTransaction
+{
+    DejalFileSaveStatistics _statistics;
+}
+
+/**
+ Returns the running save statistics of all transactions, and of the file manager helpers that flush files, such as -[NSFileManager dejal_renameWorkingFile:forSuccess:error:].  Useful to tune save throughput, e.g. how many files to commit together on a busy disk.
+ 
+ @author DJS 2026-10.
+ */
+
++ (DejalFileSaveStatistics)totalStatistics;
+{
+    NSLock *lock = DejalTotalFileSaveStatisticsLock();
+    
+    [lock lock];
+    DejalFileSaveStatistics statistics = DejalTotalFileSaveStatistics;
+    [lock unlock];
+    
+    return statistics;
+}
+
+/**
+ Resets the running save statistics of all transactions to zero.
+ 
+ @author DJS 2026-10.
+ */
+
++ (void)resetTotalStatistics;
+{
+    NSLock *lock = DejalTotalFileSaveStatisticsLock();
+    
+    [lock lock];
+    DejalTotalFileSaveStatistics = (DejalFileSaveStatistics){0};
+    [lock unlock];
+}
+
+/**
+ Initializer for a transaction that saves a group of files together: each file is first written to a new file beside its path, then -commit: flushes them all to storage, moves each into place atomically, and flushes their directories once each.  Flushing the files together lets the file system combine them into fewer journal commits, so this is much faster than saving each file durably on its own.  Files can be added from several threads at once.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)init;
+{
+    if ((self = [super init]))
+    {
+        self.items = [NSMutableArray array];
+        self.lock = [NSLock new];
+    }
+    
+    return self;
+}
+
+/**
+ Removes any files that were written but not committed.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)dealloc;
+{
+    [self rollback];
+}
+
+/**
+ Returns the number of files written but not yet committed.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSUInteger)count;
+{
+    [self.lock lock];
+    NSUInteger count = self.items.count;
+    [self.lock unlock];
+    
+    return count;
+}
+
+/**
+ Returns the save statistics of this transaction, since it was created or -resetStatistics was last called.
+ 
+ @author DJS 2026-10.
+ */
+
+- (DejalFileSaveStatistics)statistics;
+{
+    [self.lock lock];
+    DejalFileSaveStatistics statistics = _statistics;
+    [self.lock unlock];
+    
+    return statistics;
+}
+
+/**
+ Resets the save statistics of this transaction to zero.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)resetStatistics;
+{
+    [self.lock lock];
+    _statistics = (DejalFileSaveStatistics){0};
+    [self.lock unlock];
+}
+
+/**
+ Private method that records the staged file for the next commit, and the bytes written or copied to it.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)addStagingPath:(NSString *)stagingPath forPath:(NSString *)path replaceExisting:(BOOL)replace statistics:(DejalFileSaveStatistics)statistics;
+{
+    DejalFileTransactionItem *item = [DejalFileTransactionItem new];
+    
+    item.path = path;
+    item.stagingPath = stagingPath;
+    item.replace = replace;
+    
+    [self.lock lock];
+    [self.items addObject:item];
+    DejalAddFileSaveStatistics(&_statistics, statistics);
+    [self.lock unlock];
+    
+    DejalAddTotalFileSaveStatistics(statistics);
+}
+
+/**
+ Writes the data to a new file beside the path, to replace any existing file there when committed.  The new file gets the existing file's permissions, if any.
+ 
+ @param data The data to save.
+ @param path The file to save to.
+ @param error Set to the error if the data can't be written.
+ @returns YES if written, otherwise NO.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)writeData:(NSData *)data toPath:(NSString *)path error:(NSError **)error;
+{
+    NSString *stagingPath = DejalUniquePath(DejalStagingPathForPath(path), nil, YES, NO, error);
+    
+    if (!stagingPath)
+        return NO;
+    
+    int descriptor = open(stagingPath.fileSystemRepresentation, O_WRONLY | O_CLOEXEC);
+    int result = descriptor < 0 ? errno : DejalWriteBytes(descriptor, data.bytes, data.length);
+    struct stat info;
+    
+    if (!result && stat(path.fileSystemRepresentation, &info) == 0 && fchmod(descriptor, info.st_mode & 07777) != 0)
+        result = errno;
+    
+    if (descriptor >= 0)
+        close(descriptor);
+    
+    if (result)
+    {
+        unlink(stagingPath.fileSystemRepresentation);
+        
+        return DejalSetPOSIXError(error, result, path);
+    }
+    
+    [self addStagingPath:stagingPath forPath:path replaceExisting:YES statistics:(DejalFileSaveStatistics){.bytesWritten = data.length}];
+    
+    return YES;
+}
+
+/**
+ Copies the file at the source path to a new file beside the destination path, to be moved there when committed.  The copy is made as cheaply as the platform allows: on Apple platforms copyfile() clones it (on APFS) and keeps all of its metadata, i.e. extended attributes, ACLs, dates and Finder tags, as -copyItemAtPath:toPath:error: does; on Linux a reflink or copy_file_range() is used, keeping the source file's permissions; falling back to reading and writing.  Only regular files (or symbolic links to them) can be copied.
+ 
+ @param sourcePath The file to copy.
+ @param path The destination of the copy.
+ @param replace YES to replace any existing file at the destination when committed, NO to make the commit fail if there is one.
+ @param error Set to the error if the file can't be copied.
+ @returns YES if copied, otherwise NO.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)copyFileAtPath:(NSString *)sourcePath toPath:(NSString *)path replaceExisting:(BOOL)replace error:(NSError **)error;
+{
+    struct stat info;
+    struct stat existing;
+    int source = open(sourcePath.fileSystemRepresentation, O_RDONLY | O_CLOEXEC);
+    
+    if (source < 0)
+        return DejalSetPOSIXError(error, errno, sourcePath);
+    
+    int result = fstat(source, &info) != 0 ? errno : S_ISREG(info.st_mode) ? 0 : EISDIR;
+    
+    // Fail early if the destination is taken; the commit makes sure it still isn't:
+    if (!result && !replace && lstat(path.fileSystemRepresentation, &existing) == 0)
+        result = EEXIST;
+    
+    if (result)
+    {
+        close(source);
+        
+        return DejalSetPOSIXError(error, result, result == EEXIST ? path : sourcePath);
+    }
+    
+    DejalFileSaveStatistics statistics = {0};
+    NSString *stagingPath = nil;
+    
+#if defined(__APPLE__)
+    close(source);
+    
+    // A clone has to create its file, so the staging path is found but not claimed; if another thread or process takes it first, try the next one:
+    do
+    {
+        stagingPath = DejalUniquePath(DejalStagingPathForPath(path), nil, NO, NO, error);
+        
+        if (!stagingPath)
+            return NO;
+        
+        result = copyfile(sourcePath.fileSystemRepresentation, stagingPath.fileSystemRepresentation, NULL, COPYFILE_CLONE | COPYFILE_ALL | COPYFILE_EXCL) == 0 ? 0 : errno;
+    }
+    while (result == EEXIST);
+    
+    if (!result)
+        statistics.bytesCopied = info.st_size;
+#else
+    stagingPath = DejalUniquePath(DejalStagingPathForPath(path), nil, YES, NO, error);
+    
+    if (!stagingPath)
+    {
+        close(source);
+        
+        return NO;
+    }
+    
+    int destination = open(stagingPath.fileSystemRepresentation, O_WRONLY | O_CLOEXEC);
+    
+    if (destination < 0)
+        result = errno;
+    else
+    {
+        result = DejalCopyFileContents(source, destination, &statistics.bytesCopied);
+        
+        if (!result && fchmod(destination, info.st_mode & 07777) != 0)
+            result = errno;
+        
+        close(destination);
+    }
+    
+    close(source);
+#endif
+    
+    if (result)
+    {
+        unlink(stagingPath.fileSystemRepresentation);
+        
+        return DejalSetPOSIXError(error, result, path);
+    }
+    
+    [self addStagingPath:stagingPath forPath:path replaceExisting:replace statistics:statistics];
+    
+    return YES;
+}
+
+/**
+ Commits the files written or copied since the last commit: flushes them all to storage concurrently, then moves each into place atomically, then flushes each of their directories once.  If any file can't be flushed, none are moved and all are removed.  If a file can't be moved into place, e.g. because it isn't replacing and its destination now exists, those already moved stay, and the rest are removed.
+ 
+ @param error Set to the first error, if any.
+ @returns YES if all of the files were committed, otherwise NO.
+ 
+ @author DJS 2026-10.
+ */
+
+- (BOOL)commit:(NSError **)error;
+{
+    [self.lock lock];
+    
+    NSArray *items = [self.items copy];
+    NSUInteger count = items.count;
+    DejalFileSaveStatistics *itemStatistics = calloc(MAX(count, 1), sizeof(DejalFileSaveStatistics));
+    int *results = calloc(MAX(count, 1), sizeof(int));
+    DejalFileSaveStatistics statistics = {0};
+    NSString *failedPath = nil;
+    int result = 0;
+    
+    [self.items removeAllObjects];
+    
+    // Flush all of the files at once, so the file system can combine them into fewer journal commits:
+    dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i)
+                   {
+                       DejalFileTransactionItem *item = items[i];
+                       
+                       results[i] = DejalSyncFileSystemPath(item.stagingPath.fileSystemRepresentation, NO, &itemStatistics[i]);
+                   });
+    
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        DejalAddFileSaveStatistics(&statistics, itemStatistics[i]);
+        
+        if (results[i] && !result)
+        {
+            result = results[i];
+            failedPath = [items[i] path];
+        }
+    }
+    
+    free(itemStatistics);
+    free(results);
+    
+    NSMutableSet *directoryPaths = [NSMutableSet set];
+    
+    for (DejalFileTransactionItem *item in items)
+    {
+        if (!result)
+        {
+            result = DejalRenameFileSystemPath(item.stagingPath.fileSystemRepresentation, item.path.fileSystemRepresentation, item.replace ? DejalRenameModeReplace : DejalRenameModeExclusive);
+            
+            if (!result)
+            {
+                NSString *directoryPath = [item.path stringByDeletingLastPathComponent];
+                
+                [directoryPaths addObject:directoryPath.length ? directoryPath : @"."];
+                statistics.fileCount++;
+                continue;
+            }
+            
+            failedPath = item.path;
+        }
+        
+        unlink(item.stagingPath.fileSystemRepresentation);
+    }
+    
+    for (NSString *directoryPath in directoryPaths)
+    {
+        int directoryResult = DejalSyncFileSystemPath(directoryPath.fileSystemRepresentation, YES, &statistics);
+        
+        if (directoryResult && !result)
+        {
+            result = directoryResult;
+            failedPath = directoryPath;
+        }
+    }
+    
+    DejalAddFileSaveStatistics(&_statistics, statistics);
+    
+    [self.lock unlock];
+    
+    DejalAddTotalFileSaveStatistics(statistics);
+    
+    if (result)
+        return DejalSetPOSIXError(error, result, failedPath);
+    
+    return YES;
+}
+
+/**
+ Discards the files written or copied since the last commit, leaving their destinations untouched.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)rollback;
+{
+    [self.lock lock];
+    
+    for (DejalFileTransactionItem *item in self.items)
+        unlink(item.stagingPath.fileSystemRepresentation);
+    
+    [self.items removeAllObjects];
+    
+    [self.lock unlock];
+}
+
+@end
@@ -43,6 +43,10 @@
 
 - (BOOL)dejal_isEquivalent:(id)anObject;
 - (BOOL)dejal_isEquivalentTo:(id)anObject;
+- (NSString *)dejal_equivalenceKey;
+- (NSUInteger)dejal_equivalenceHash;
+
+- (id)dejal_deepCopyMakingMutable:(BOOL)mutable concurrently:(BOOL)concurrently;
 
 - (BOOL)dejal_performBoolSelector:(SEL)selector;
 - (BOOL)dejal_performBoolSelector:(SEL)selector withObject:(__unsafe_unretained id)object;
@@ -58,5 +62,33 @@
 - (void)dejal_performSelector:(SEL)selector withEachObjectInDictionary:(NSDictionary *)dict;
 - (void)dejal_performSelector:(SEL)selector withEachObjectInSet:(NSSet *)set;
 
+- (void)dejal_performSelector:(SEL)selector withEachObjectInArray:(NSArray *)array concurrently:(BOOL)concurrently;
+- (void)dejal_performSelector:(SEL)selector withEachObjectInDictionary:(NSDictionary *)dict concurrently:(BOOL)concurrently;
+- (void)dejal_performSelector:(SEL)selector withEachObjectInSet:(NSSet *)set concurrently:(BOOL)concurrently;
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalKeyMapping : NSObject
+
+@property (nonatomic, readonly) Class targetClass;
+@property (nonatomic, readonly) NSArray *keys;
+
++ (instancetype)mappingForClass:(Class)cls keys:(NSArray *)keys dictKeys:(NSDictionary *)dictKeys;
+
+- (instancetype)initWithClass:(Class)cls keys:(NSArray *)keys dictKeys:(NSDictionary *)dictKeys;
+
+- (void)setValuesOfObject:(id)object withDictionary:(NSDictionary *)dict;
+- (void)setValuesInDictionary:(NSMutableDictionary *)dict withObject:(id)object removeIfNil:(BOOL)removeIfNil;
+
+- (void)setValuesOfObjects:(NSArray *)objects withDictionaries:(NSArray *)dicts;
+- (NSArray *)objectsWithDictionaries:(NSArray *)dicts;
+- (NSArray *)dictionariesWithObjects:(NSArray *)objects;
+
 @end
 
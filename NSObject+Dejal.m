@@ -28,333 +28,1760 @@
 //
 
 #import "NSObject+Dejal.h"
-
-
-@implementation NSObject (Dejal)
-
-
-// ----------------------------------------------------------------------------------------
-#pragma mark - KEY VALUE CODING METHODS
-// ----------------------------------------------------------------------------------------
+#import "NSArray+Dejal.h"
+#import <objc/runtime.h>
+#import <stdatomic.h>
 
 
 /**
- Returns the value for the key path, or the default value if that key path is invalid (instead of throwing an exception).
- 
- @param keyPath Path to the value.
- @param defaultValue Value to use if the path is invalid or the value is NSNull; may be nil.
- @return The value from the path, or the defaultValue.
+ Returns the ASCII characters of the string if it is stored internally as a pure ASCII C string, or NULL otherwise.
  
- @author DJS 2013-12.
- @version DJS 2014-01: to return the default value if NSNull.
+ @author DJS 2026-10.
  */
 
-- (id)dejal_valueForKeyPath:(NSString *)keyPath defaultValue:(id)defaultValue;
+static const char *DejalASCIICharacters(NSString *string)
 {
-    id result = nil;
+    const char *chars = CFStringGetCStringPtr((__bridge CFStringRef)string, kCFStringEncodingASCII);
     
-    @try
-    {
-        result = [self valueForKeyPath:keyPath];
-        
-        if (!result || [result isEqual:[NSNull null]])
-            result = defaultValue;
-    }
+    if (!chars)
+        return NULL;
     
-    @catch (NSException *exception)
-    {
-        result = defaultValue;
-    }
+    NSUInteger length = string.length;
     
-    return result;
+    for (NSUInteger i = 0; i < length; i++)
+        if (chars[i] & 0x80)
+            return NULL;
+    
+    return chars;
 }
 
 /**
- Tries to get a value from the dictionary via the key.  If a value is found, it is set in the receiver, using the same key, otherwise no change is made.  Useful for setting properties from a dictionary.
+ Returns YES if the two strings are equal ignoring case, exactly as -caseInsensitiveCompare: would, but comparing pure ASCII strings directly.
  
- @author DJS 2011-02.
-*/
+ @author DJS 2026-10.
+ */
 
-- (void)dejal_setValueForKey:(NSString *)key withDictionary:(NSDictionary *)dict;
+static BOOL DejalStringsAreEquivalent(NSString *string1, NSString *string2)
 {
-    id value = dict[key];
+    if (string1 == string2)
+        return YES;
     
-    if (value)
-        [self setValue:value forKey:key];
+    const char *chars1 = DejalASCIICharacters(string1);
+    const char *chars2 = chars1 ? DejalASCIICharacters(string2) : NULL;
+    
+    if (chars1 && chars2)
+    {
+        NSUInteger length = string1.length;
+        
+        if (string2.length != length)
+            return NO;
+        
+        for (NSUInteger i = 0; i < length; i++)
+        {
+            char c1 = chars1[i];
+            char c2 = chars2[i];
+            
+            if (c1 != c2)
+            {
+                if (c1 >= 'A' && c1 <= 'Z')
+                    c1 += 'a' - 'A';
+                
+                if (c2 >= 'A' && c2 <= 'Z')
+                    c2 += 'a' - 'A';
+                
+                if (c1 != c2)
+                    return NO;
+            }
+        }
+        
+        return YES;
+    }
+    
+    return [string1 caseInsensitiveCompare:string2] == NSOrderedSame;
 }
 
 /**
- Tries to get a value from the dictionary via the first key.  If there isn't one, tries the alternative key.  If a value is found, it is set in the receiver, using the first key, otherwise no change is made.  Useful for setting properties from a dictionary.
+ Returns YES if the number holds an integer type, whose description is always its plain decimal value.
  
- @author DJS 2011-02.
-*/
+ @author DJS 2026-10.
+ */
 
-- (void)dejal_setValueForKey:(NSString *)key orDictKey:(NSString *)altKey withDictionary:(NSDictionary *)dict;
+static BOOL DejalNumberIsInteger(NSNumber *number, BOOL *isUnsigned)
 {
-    id value = dict[key];
+    char type = number.objCType[0];
     
-    if (!value && altKey)
-        value = dict[altKey];
+    *isUnsigned = type == 'C' || type == 'S' || type == 'I' || type == 'L' || type == 'Q';
     
-    if (value)
-        [self setValue:value forKey:key];
+    return *isUnsigned || type == 'c' || type == 's' || type == 'i' || type == 'l' || type == 'q';
 }
 
 /**
- Tries to get a value from the dictionary via the first key.  If there isn't one, tries the alternative keys until a value is found.  If a value is found, it is set in the receiver, using the first key, otherwise no change is made.  Useful for setting properties from a dictionary.
+ Writes the decimal description of an integer number into the buffer, returning its length.
  
- @author DJS 2011-02.
-*/
+ @author DJS 2026-10.
+ */
 
-- (void)dejal_setValueForKey:(NSString *)key orDictKeys:(NSArray *)altKeys withDictionary:(NSDictionary *)dict;
+static NSUInteger DejalIntegerNumberDescription(NSNumber *number, BOOL isUnsigned, char *buffer, size_t size)
 {
-    id value = dict[key];
-    
-    if (!value && altKeys)
-    {
-        for (NSString *altKey in altKeys)
-            if (!value)
-	            value = dict[altKey];
-    }
-    
-    if (value)
-        [self setValue:value forKey:key];
+    if (isUnsigned)
+        return (NSUInteger)snprintf(buffer, size, "%llu", number.unsignedLongLongValue);
+    else
+        return (NSUInteger)snprintf(buffer, size, "%lld", number.longLongValue);
 }
 
 /**
- If there is a value for the specified key in the receiver, it is set in the dictionary, otherwise this does nothing.
+ Returns YES if the description of the integer number is equal to the string.
  
- @author DJS 2011-02.
-*/
+ @author DJS 2026-10.
+ */
 
-- (void)dejal_setValueInDictionary:(NSMutableDictionary *)dict forKey:(NSString *)key;
+static BOOL DejalIntegerNumberIsEquivalentToString(NSNumber *number, BOOL isUnsigned, NSString *string)
 {
-    [self dejal_setValueInDictionary:dict forKey:key removeIfNil:NO];
+    char buffer[24];
+    NSUInteger length = DejalIntegerNumberDescription(number, isUnsigned, buffer, sizeof(buffer));
+    
+    if (string.length != length)
+        return NO;
+    
+    unichar chars[24];
+    
+    [string getCharacters:chars range:NSMakeRange(0, length)];
+    
+    for (NSUInteger i = 0; i < length; i++)
+        if (chars[i] != (unichar)buffer[i])
+            return NO;
+    
+    return YES;
 }
 
 /**
- If there is a value for the specified key in the receiver, it is set in the dictionary.  If there isn't a value, the key is optionally removed from the dictionary.  Passing YES is equivalent to calling [dict setValue:[self valueForKey:key] forKey:key].
+ Implements -dejal_isEquivalentTo:, giving exactly the same result as comparing the descriptions case-insensitively, but with fast paths for common types that avoid building the descriptions.
  
- @author DJS 2011-02.
-*/
+ @author DJS 2026-10.
+ */
 
-- (void)dejal_setValueInDictionary:(NSMutableDictionary *)dict forKey:(NSString *)key removeIfNil:(BOOL)removeIfNil;
+static BOOL DejalObjectsAreEquivalent(id object1, id object2)
 {
-    id value = [self valueForKey:key];
+    if (!object2)
+        return NO;
     
-    if (value)
-        dict[key] = value;
-    else if (removeIfNil)
-        [dict removeObjectForKey:key];
+    if (object1 == object2)
+        return YES;
+    
+    BOOL isString1 = [object1 isKindOfClass:[NSString class]];
+    BOOL isString2 = [object2 isKindOfClass:[NSString class]];
+    
+    // A string's description is itself:
+    if (isString1 && isString2)
+        return DejalStringsAreEquivalent(object1, object2);
+    
+    BOOL isNumber1 = [object1 isKindOfClass:[NSNumber class]];
+    BOOL isNumber2 = [object2 isKindOfClass:[NSNumber class]];
+    BOOL isUnsigned1 = NO, isUnsigned2 = NO;
+    BOOL isInteger1 = isNumber1 && DejalNumberIsInteger(object1, &isUnsigned1);
+    BOOL isInteger2 = isNumber2 && DejalNumberIsInteger(object2, &isUnsigned2);
+    
+    if (isInteger1 && isInteger2)
+    {
+        if (isUnsigned1 && isUnsigned2)
+            return [object1 unsignedLongLongValue] == [object2 unsignedLongLongValue];
+        else if (!isUnsigned1 && !isUnsigned2)
+            return [object1 longLongValue] == [object2 longLongValue];
+        
+        NSNumber *signedNumber = isUnsigned1 ? object2 : object1;
+        NSNumber *unsignedNumber = isUnsigned1 ? object1 : object2;
+        
+        return signedNumber.longLongValue >= 0 && (unsigned long long)signedNumber.longLongValue == unsignedNumber.unsignedLongLongValue;
+    }
+    else if (isInteger1 && isString2)
+    {
+        return DejalIntegerNumberIsEquivalentToString(object1, isUnsigned1, object2);
+    }
+    else if (isString1 && isInteger2)
+    {
+        return DejalIntegerNumberIsEquivalentToString(object2, isUnsigned2, object1);
+    }
+    else if ([object1 isKindOfClass:[NSDate class]] && [object2 isKindOfClass:[NSDate class]])
+    {
+        // Dates are described to the whole second, so ones at least a second apart can't be equivalent:
+        NSTimeInterval difference = fabs([object1 timeIntervalSinceDate:object2]);
+        
+        if (difference == 0.0)
+            return YES;
+        else if (difference >= 1.0)
+            return NO;
+    }
+    
+    return DejalStringsAreEquivalent([object1 description], [object2 description]);
 }
 
 
-// ----------------------------------------------------------------------------------------
-#pragma mark - IDENTITY METHODS
-// ----------------------------------------------------------------------------------------
+// Number of top-level objects above which a concurrent deep copy splits the work across threads:
+#define DEJAL_DEEP_COPY_CONCURRENT_THRESHOLD 1024
+
+// Number of top-level objects each concurrent deep copy task handles:
+#define DEJAL_DEEP_COPY_CHUNK_SIZE 256
 
 
 /**
- Returns YES if the receiver is an instance of a subclass of aClass, but not an instance of aClass itself.
+ Private class representing an array or dictionary part-way through being deep copied: the source container, a snapshot of its keys and values, and the copies made so far.
  
- @author DJS 2004-01.
-*/
+ @author DJS 2026-10.
+ */
 
-- (BOOL)dejal_isReallySubclassOfClass:(Class)aClass
+@interface DejalDeepCopyFrame : NSObject
 {
-    return [self isKindOfClass:aClass] && ![self isMemberOfClass:aClass];
+@public
+    id source;
+    BOOL isDictionary;
+    NSUInteger count;
+    NSUInteger index;
+    __unsafe_unretained id *keys;
+    __unsafe_unretained id *values;
+    __strong id *copies;
 }
 
+- (instancetype)initWithContainer:(id)container;
+- (id)resultMakingMutable:(BOOL)mutable;
 
-/**
- Like -isEqual, but returns YES if the receiver and the other object are equal when both interpreted as case-insensitive strings.  So, for example, @"THIS" and @"This" are equivalent, and @"123" and [NSNumber numberWithInteger:123] are equivalent.  If the other object is nil, returns NO; i.e. a non-nil receiver is not equivalent to a nil value (but, of course, sending this to a nil object will result in 0, which would be incorrect if the other object were also nil).
- 
- @author DJS 2005-03.
-*/
+@end
 
-- (BOOL)dejal_isEquivalent:(id)anObject
+
+@implementation DejalDeepCopyFrame
+
+- (instancetype)initWithContainer:(id)container;
 {
-    if (anObject)
-        return ([[self description] caseInsensitiveCompare:[anObject description]] == NSOrderedSame);
-    else
-        return NO;
+    if ((self = [super init]))
+    {
+        source = container;
+        isDictionary = [container isKindOfClass:[NSDictionary class]];
+        count = [container count];
+        values = (__unsafe_unretained id *)calloc(MAX(count, 1), sizeof(id));
+        copies = (__strong id *)calloc(MAX(count, 1), sizeof(id));
+        
+        if (isDictionary)
+        {
+            keys = (__unsafe_unretained id *)calloc(MAX(count, 1), sizeof(id));
+            [container getObjects:values andKeys:keys count:count];
+        }
+        else
+        {
+            [container getObjects:values range:NSMakeRange(0, count)];
+        }
+    }
+    
+    return self;
+}
+
+- (void)dealloc;
+{
+    for (NSUInteger i = 0; i < count; i++)
+        copies[i] = nil;
+    
+    free(copies);
+    free(values);
+    free(keys);
 }
 
 /**
- An alias of -isEquivalent:, for when the "To" makes more sense.  For efficiency, the logic is duplicated.
+ Returns the copy of the source container, presized from the copies of its contents.  For an immutable copy of an immutable container whose contents all copied to themselves, that's the source container itself, so unchanged subtrees are shared rather than duplicated.
  
- @author DJS 2005-05.
-*/
+ @author DJS 2026-10.
+ */
 
-- (BOOL)dejal_isEquivalentTo:(id)anObject
+- (id)resultMakingMutable:(BOOL)mutable;
 {
-    if (anObject)
-        return ([[self description] caseInsensitiveCompare:[anObject description]] == NSOrderedSame);
+    if (!mutable && ![source isKindOfClass:isDictionary ? [NSMutableDictionary class] : [NSMutableArray class]])
+    {
+        BOOL shared = YES;
+        
+        for (NSUInteger i = 0; shared && i < count; i++)
+            shared = copies[i] == values[i];
+        
+        if (shared)
+            return source;
+    }
+    
+    if (isDictionary)
+        return [mutable ? [NSMutableDictionary class] : [NSDictionary class] dictionaryWithObjects:copies forKeys:(id<NSCopying> __unsafe_unretained *)keys count:count];
     else
-        return NO;
+        return [mutable ? [NSMutableArray class] : [NSArray class] arrayWithObjects:copies count:count];
 }
 
-
-// ----------------------------------------------------------------------------------------
-#pragma mark - PERFORM SELECTOR METHODS
-// ----------------------------------------------------------------------------------------
+@end
 
 
 /**
- Similar to -performSelector:, but calls a method that returns a boolean value.  Returns NO if the receiever doesn't respond to that selector.
+ Returns YES if the object is an array or dictionary, which the deep copy engine descends into.
  
- @author DJS 2006-06.
+ @author DJS 2026-10.
  */
 
-- (BOOL)dejal_performBoolSelector:(SEL)selector;
+static inline BOOL DejalDeepCopyIsContainer(id object)
 {
-    return [self dejal_performIntegerSelector:selector withObject:[NSNull null] withObject:[NSNull null]];
+    return [object isKindOfClass:[NSArray class]] || [object isKindOfClass:[NSDictionary class]];
 }
 
 /**
- Similar to -performSelector:withObject:, but calls a method that returns a boolean value.  Returns NO if the receiever doesn't respond to that selector.
+ Returns a copy of an object other than an array or dictionary, as the deep copy methods always have: via -dejal_deepCopy or -dejal_deepMutableCopy if implemented, otherwise -mutableCopy (for mutable copies, where supported) or -copy.  Numbers, dates and null are always immutable, so are shared without a message for immutable copies.
  
- @author DJS 2006-06.
+ @author DJS 2026-10.
  */
 
-- (BOOL)dejal_performBoolSelector:(SEL)selector withObject:(__unsafe_unretained id)object;
+static id DejalDeepCopyLeaf(id object, BOOL mutable)
 {
-    return [self dejal_performIntegerSelector:selector withObject:object withObject:[NSNull null]];
+    if (mutable)
+    {
+        if ([object respondsToSelector:@selector(dejal_deepMutableCopy)])
+            return [object dejal_deepMutableCopy];
+        else if ([object conformsToProtocol:@protocol(NSMutableCopying)])
+            return [object mutableCopy];
+        else
+            return [object copy];
+    }
+    else
+    {
+        if ([object isKindOfClass:[NSNumber class]] || [object isKindOfClass:[NSDate class]] || object == [NSNull null])
+            return object;
+        else if ([object respondsToSelector:@selector(dejal_deepCopy)])
+            return [object dejal_deepCopy];
+        else
+            return [object copy];
+    }
 }
 
 /**
- Similar to -performSelector:withObject:withObject:, but calls a method that returns a boolean value.  Returns NO if the receiever doesn't respond to that selector.
+ Deep copies the object without recursion, using an explicit stack of frames, so there is no limit on the nesting depth.
  
- @author DJS 2006-06.
+ @author DJS 2026-10.
  */
 
-- (BOOL)dejal_performBoolSelector:(SEL)selector withObject:(__unsafe_unretained id)object1 withObject:(__unsafe_unretained id)object2;
+static id DejalDeepCopyObject(id root, BOOL mutable)
 {
-    return [self dejal_performIntegerSelector:selector withObject:object1 withObject:object2];
+    if (!DejalDeepCopyIsContainer(root))
+        return DejalDeepCopyLeaf(root, mutable);
+    
+    NSMutableArray *stack = [NSMutableArray arrayWithObject:[[DejalDeepCopyFrame alloc] initWithContainer:root]];
+    id result = nil;
+    
+    while (stack.count)
+    {
+        DejalDeepCopyFrame *frame = stack.lastObject;
+        
+        if (frame->index < frame->count)
+        {
+            id child = frame->values[frame->index];
+            
+            if (DejalDeepCopyIsContainer(child))
+            {
+                [stack addObject:[[DejalDeepCopyFrame alloc] initWithContainer:child]];
+            }
+            else
+            {
+                frame->copies[frame->index] = DejalDeepCopyLeaf(child, mutable);
+                frame->index++;
+            }
+            
+            continue;
+        }
+        
+        id copy = [frame resultMakingMutable:mutable];
+        
+        [stack removeLastObject];
+        
+        DejalDeepCopyFrame *parent = stack.lastObject;
+        
+        if (parent)
+        {
+            parent->copies[parent->index] = copy;
+            parent->index++;
+        }
+        else
+        {
+            result = copy;
+        }
+    }
+    
+    return result;
 }
 
+
+// Number of slots in the cache of resolved methods used by the perform selector methods; must be a power of two:
+#define DEJAL_PERFORM_CACHE_SIZE 512
+
+// Maximum number of object arguments for which -dejal_performSelector:withArguments: calls the method directly:
+#define DEJAL_PERFORM_DIRECT_ARGUMENTS 4
+
+
 /**
- Similar to -performSelector:, but calls a method that returns an integer value.  Returns zero if the receiever doesn't respond to that selector.
+ Private class representing a method resolved for a class and selector by the perform selector methods: its implementation, signature and a summary of its types, so repeat calls can skip building a method signature, and usually skip NSInvocation altogether by calling the implementation directly.
  
- @author DJS 2004-04.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSInteger)dejal_performIntegerSelector:(SEL)selector
+@interface DejalPerformEntry : NSObject
 {
-    return [self dejal_performIntegerSelector:selector withObject:[NSNull null] withObject:[NSNull null]];
+@public
+    Class cls;
+    SEL selector;
+    IMP imp;
+    NSMethodSignature *signature;
+    NSUInteger argumentCount;   // Excluding self and _cmd
+    char returnType;            // Type encoding, without qualifiers
+    BOOL direct;                // YES if implemented by the class and all arguments are objects, so can be called directly
 }
 
+@end
+
+
+@implementation DejalPerformEntry
+
+@end
+
+
 /**
- Similar to -performSelector:withObject:, but calls a method that returns an integer value.  Returns zero if the receiever doesn't respond to that selector.
+ Returns the type encoding character, skipping any qualifiers such as const or oneway.
  
- @author DJS 2004-04.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSInteger)dejal_performIntegerSelector:(SEL)selector withObject:(__unsafe_unretained id)object
+static inline char DejalTypeEncoding(const char *type)
 {
-    return [self dejal_performIntegerSelector:selector withObject:object withObject:[NSNull null]];
+    while (*type && strchr("rnNoORV", *type))
+        type++;
+    
+    return *type;
 }
 
 /**
- Similar to -performSelector:withObject:withObject:, but calls a method that returns an integer value.  Does nothing (and returns zero) if selector is nil or the receiver doesn't respond to that selector.
+ Returns the cached entry for the target's class and the selector, resolving and caching it if needed.  An entry is only used while the class's implementation of the selector is still the one it was resolved for, so swizzling or adding methods replaces it.  Methods the class doesn't implement itself, e.g. ones a proxy forwards, get a new uncached entry each time, since their signature can vary by instance.  Returns nil if the target has no signature for the selector.
  
- @author DJS 2004-04.
-*/
+ Looking up a cached entry takes no lock: the slots hold unretained pointers to entries that are never freed, so a slot can be replaced while another thread is using its old entry.  Entries are kept in a table by class and selector, so classes that share a slot reuse their entries rather than making new ones; only the rare entries replaced by swizzling are retired.  The lock is only taken to add an entry.
+ 
+ Since entries are never freed, memory use grows with the number of distinct class and selector pairs performed, plus one retired entry each time the implementation of a method that has been performed changes, e.g. by swizzling or by a class adding its own override.  Each entry is a few dozen bytes, plus its method signature, which Foundation generally shares.  That is bounded for apps that swizzle at launch, but code that keeps exchanging the implementation of a method while also performing it via these methods will grow the retired entries without limit, so such methods should be called directly.
+ 
+ @author DJS 2026-10.
+ */
 
-- (NSInteger)dejal_performIntegerSelector:(SEL)selector withObject:(__unsafe_unretained id)object1 withObject:(__unsafe_unretained id)object2
+static DejalPerformEntry *DejalPerformEntryForTarget(id target, SEL selector)
 {
-    if (!selector || ![self respondsToSelector:selector])
-        return 0;
+    static _Atomic(void *) cache[DEJAL_PERFORM_CACHE_SIZE];
+    static NSMutableDictionary *entries = nil;
+    static NSMutableArray *retiredEntries = nil;
+    static NSLock *lock = nil;
+    static dispatch_once_t onceToken;
     
-    NSMethodSignature *signature = [self methodSignatureForSelector:selector];
-    NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:signature];
-    NSInteger result = 0;
+    dispatch_once(&onceToken, ^
+                  {
+                      entries = [NSMutableDictionary dictionary];
+                      retiredEntries = [NSMutableArray array];
+                      lock = [NSLock new];
+                  });
     
-    [invocation setSelector:selector];
+    Class cls = object_getClass(target);
+    IMP imp = class_getMethodImplementation(cls, selector);
+    NSUInteger slot = (((uintptr_t)cls >> 4) ^ ((uintptr_t)selector >> 3)) & (DEJAL_PERFORM_CACHE_SIZE - 1);
+    DejalPerformEntry *entry = (__bridge DejalPerformEntry *)atomic_load_explicit(&cache[slot], memory_order_acquire);
     
-    if (![object1 isKindOfClass:[NSNull class]])
-        [invocation setArgument:&object1 atIndex:2];
+    if (entry && entry->cls == cls && entry->selector == selector && entry->imp == imp)
+        return entry;
     
-    if (![object2 isKindOfClass:[NSNull class]])
-        [invocation setArgument:&object2 atIndex:3];
+    NSMethodSignature *signature = [target methodSignatureForSelector:selector];
     
-    [invocation invokeWithTarget:self];
-    [invocation getReturnValue:&result];
+    if (!signature)
+        return nil;
     
-    return result;
-}
-
-/**
- Similar to -performSelector:withObject:, but allows any number of arguments.  The arguments are taken from the array, in order.  The selector should expect the same number of arguments.  It's okay for arguments to be nil, if the selector doesn't take any.  Does nothing if selector is nil, or the number of arguments of the selector and array are different.
- 
- @author DJS 2007-03.
-*/
-
-- (void)dejal_performSelector:(SEL)selector withArguments:(NSArray *)arguments;
-{
-    if (!selector)
-        return;
+    BOOL implemented = class_respondsToSelector(cls, selector);
     
-    NSMethodSignature *signature = [self methodSignatureForSelector:selector];
-    NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:signature];
+    entry = [DejalPerformEntry new];
+    entry->cls = cls;
+    entry->selector = selector;
+    entry->imp = imp;
+    entry->signature = signature;
+    entry->argumentCount = [signature numberOfArguments] - 2;
+    entry->returnType = DejalTypeEncoding([signature methodReturnType]);
     
-    // Exclude the hidden self and _cmd arguments:
-    if (([signature numberOfArguments] - 2) != [arguments count])
-    {
-        NSLog(@"performSelector:%@ withObjects:%@ has different number of arguments", NSStringFromSelector(selector), arguments);         // log
-        
-        return;
-    }
+    // Methods only reached via forwarding, and ones returning structures (which may be returned via a hidden argument), have to go via NSInvocation:
+    entry->direct = implemented && entry->returnType != _C_STRUCT_B && entry->returnType != _C_UNION_B && entry->returnType != _C_ARY_B;
     
-    [invocation setSelector:selector];
+    for (NSUInteger i = 0; entry->direct && i < entry->argumentCount; i++)
+        entry->direct = DejalTypeEncoding([signature getArgumentTypeAtIndex:i + 2]) == _C_ID;
+    
+    if (!implemented)
+        return entry;
     
-    for (NSUInteger i = 0; i < [arguments count]; i++)
+    // The signature is resolved outside the lock, as -methodSignatureForSelector: could call back into here:
+    NSString *key = [NSString stringWithFormat:@"%p %s", (__bridge void *)cls, sel_getName(selector)];
+    
+    [lock lock];
+    
+    DejalPerformEntry *existing = entries[key];
+    
+    if (existing && existing->imp == imp)
+        entry = existing;
+    else
     {
-        __unsafe_unretained id object = arguments[i];
+        if (existing)
+            [retiredEntries addObject:existing];
         
-        [invocation setArgument:&object atIndex:i + 2];
+        entries[key] = entry;
     }
     
-    [invocation invokeWithTarget:self];
+    atomic_store_explicit(&cache[slot], (__bridge void *)entry, memory_order_release);
+    
+    [lock unlock];
+    
+    return entry;
 }
 
 /**
- Invokes the selector, passing each object in the array as a parameter.  Not the same as -[NSArray makeObjectsPerformSelector:], as that makes the objects in the array perform the selector, instead of making the receiver object perform the selector.  The selector must take a single argument.
+ Returns the integer return value of the specified type, sign-extended for signed types, or the address for pointer types; zero for void or other types.
  
- @author DJS 2004-10.
- @version DJS 2014-12: changed to add a workaround for a compiler warning.
-*/
+ @author DJS 2026-10.
+ */
 
-- (void)dejal_performSelector:(SEL)selector withEachObjectInArray:(NSArray *)array
+static NSInteger DejalIntegerReturnValue(const void *value, char type)
 {
-    id object;
-    
-    for (object in array)
+    switch (type)
     {
-        [self performSelector:selector withObject:object];
+        case _C_CHR:
+            return *(const signed char *)value;
+        case _C_UCHR:
+            return *(const unsigned char *)value;
+        case _C_SHT:
+            return *(const short *)value;
+        case _C_USHT:
+            return *(const unsigned short *)value;
+        case _C_INT:
+            return *(const int *)value;
+        case _C_UINT:
+            return *(const unsigned int *)value;
+        case _C_LNG:
+            return *(const long *)value;
+        case _C_ULNG:
+            return (NSInteger)*(const unsigned long *)value;
+        case _C_LNG_LNG:
+            return (NSInteger)*(const long long *)value;
+        case _C_ULNG_LNG:
+            return (NSInteger)*(const unsigned long long *)value;
+        case _C_BOOL:
+            return *(const _Bool *)value;
+        case _C_ID:
+        case _C_CLASS:
+        case _C_SEL:
+        case _C_CHARPTR:
+        case _C_PTR:
+            return (NSInteger)*(const uintptr_t *)value;
+        default:
+            return 0;
     }
 }
 
+// Calls the entry's implementation directly with up to two object arguments, as a function returning the type:
+#define DEJAL_PERFORM_CALL(type, entry, target, objects) \
+    ((entry)->argumentCount == 0 ? ((type (*)(id, SEL))(entry)->imp)((target), (entry)->selector) : \
+     (entry)->argumentCount == 1 ? ((type (*)(id, SEL, id))(entry)->imp)((target), (entry)->selector, (objects)[0]) : \
+     ((type (*)(id, SEL, id, id))(entry)->imp)((target), (entry)->selector, (objects)[0], (objects)[1]))
+
 /**
- Invokes the selector, passing each object in the dictionary as a parameter.  The order invoked is not defined.  See -performSelector:withEachObjectInArray: for more information.
+ Performs the entry's method on the target with up to two object arguments, where NSNull means no argument, and returns its integer result, via a direct call if possible, otherwise NSInvocation.  An argument the method doesn't take raises an exception, as before.
  
- @author DJS 2004-10.
-*/
+ @author DJS 2026-10.
+ */
 
-- (void)dejal_performSelector:(SEL)selector withEachObjectInDictionary:(NSDictionary *)dict
+static NSInteger DejalPerformIntegerEntry(DejalPerformEntry *entry, id target, __unsafe_unretained id object1, __unsafe_unretained id object2)
 {
-    [self dejal_performSelector:selector withEachObjectInArray:[dict allValues]];
+    NSNull *null = [NSNull null];
+    __unsafe_unretained id objects[2] = {object1 == null ? nil : object1, object2 == null ? nil : object2};
+    BOOL direct = entry->direct && entry->argumentCount <= 2 && (!objects[1] || entry->argumentCount > 1) && (!objects[0] || entry->argumentCount > 0);
+    
+    if (direct)
+    {
+        switch (entry->returnType)
+        {
+            case _C_VOID:
+                DEJAL_PERFORM_CALL(void, entry, target, objects);
+                return 0;
+            case _C_CHR:
+                return DEJAL_PERFORM_CALL(signed char, entry, target, objects);
+            case _C_UCHR:
+                return DEJAL_PERFORM_CALL(unsigned char, entry, target, objects);
+            case _C_SHT:
+                return DEJAL_PERFORM_CALL(short, entry, target, objects);
+            case _C_USHT:
+                return DEJAL_PERFORM_CALL(unsigned short, entry, target, objects);
+            case _C_INT:
+                return DEJAL_PERFORM_CALL(int, entry, target, objects);
+            case _C_UINT:
+                return DEJAL_PERFORM_CALL(unsigned int, entry, target, objects);
+            case _C_LNG:
+                return DEJAL_PERFORM_CALL(long, entry, target, objects);
+            case _C_ULNG:
+                return (NSInteger)DEJAL_PERFORM_CALL(unsigned long, entry, target, objects);
+            case _C_LNG_LNG:
+                return (NSInteger)DEJAL_PERFORM_CALL(long long, entry, target, objects);
+            case _C_ULNG_LNG:
+                return (NSInteger)DEJAL_PERFORM_CALL(unsigned long long, entry, target, objects);
+            case _C_BOOL:
+                return DEJAL_PERFORM_CALL(_Bool, entry, target, objects);
+            case _C_ID:
+            case _C_CLASS:
+            case _C_SEL:
+            case _C_CHARPTR:
+            case _C_PTR:
+                return (NSInteger)DEJAL_PERFORM_CALL(uintptr_t, entry, target, objects);
+        }
+    }
+    
+    NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:entry->signature];
+    NSUInteger length = [entry->signature methodReturnLength];
+    uint64_t value[4] = {0};
+    
+    [invocation setSelector:entry->selector];
+    
+    if (object1 != null)
+        [invocation setArgument:&object1 atIndex:2];
+    
+    if (object2 != null)
+        [invocation setArgument:&object2 atIndex:3];
+    
+    [invocation invokeWithTarget:target];
+    
+    if (length && length <= sizeof(value))
+    {
+        [invocation getReturnValue:value];
+        
+        return DejalIntegerReturnValue(value, entry->returnType);
+    }
+    
+    return 0;
 }
 
 /**
- Invokes the selector, passing each object in the set as a parameter.  The order invoked is not defined.  See -performSelector:withEachObjectInArray: for more information.
+ Performs the selector on the target with each object in the array, set or dictionary values, resolving the method once and calling it directly where possible, otherwise via -performSelector:withObject:.  The values of a dictionary or set are copied to an array first, as before, so the method can mutate the collection.  If concurrently is YES, the objects are enumerated concurrently, so the target's method must be thread-safe.
  
- @author DJS 2004-10.
+ @author DJS 2026-10.
+ */
+
+static void DejalPerformSelectorWithEachObject(id target, SEL selector, id collection, BOOL concurrently)
+{
+    DejalPerformEntry *entry = selector && [target respondsToSelector:selector] ? DejalPerformEntryForTarget(target, selector) : nil;
+    void (*function)(id, SEL, id) = entry && entry->direct && entry->argumentCount == 1 ? (void (*)(id, SEL, id))entry->imp : NULL;
+    
+    void (^perform)(id) = ^(id object)
+    {
+        if (function)
+            function(target, selector, object);
+        else
+            [target performSelector:selector withObject:object];
+    };
+    
+    NSArray *objects = collection;
+    
+    if ([collection isKindOfClass:[NSDictionary class]])
+        objects = [collection allValues];
+    else if ([collection isKindOfClass:[NSSet class]])
+        objects = [collection allObjects];
+    
+    if (!concurrently)
+    {
+        for (id object in objects)
+            perform(object);
+    }
+    else
+    {
+        [objects enumerateObjectsWithOptions:NSEnumerationConcurrent usingBlock:^(id object, NSUInteger idx, BOOL *stop)
+         {
+             perform(object);
+         }];
+    }
+}
+
+
+@implementation NSObject (Dejal)
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark - KEY VALUE CODING METHODS
+// ----------------------------------------------------------------------------------------
+
+
+/**
+ Returns the value for the key path, or the default value if that key path is invalid (instead of throwing an exception).
+ 
+ @param keyPath Path to the value.
+ @param defaultValue Value to use if the path is invalid or the value is NSNull; may be nil.
+ @return The value from the path, or the defaultValue.
+ 
+ @author DJS 2013-12.
+ @version DJS 2014-01: to return the default value if NSNull.
+ */
+
+- (id)dejal_valueForKeyPath:(NSString *)keyPath defaultValue:(id)defaultValue;
+{
+    id result = nil;
+    
+    @try
+    {
+        result = [self valueForKeyPath:keyPath];
+        
+        if (!result || [result isEqual:[NSNull null]])
+            result = defaultValue;
+    }
+    
+    @catch (NSException *exception)
+    {
+        result = defaultValue;
+    }
+    
+    return result;
+}
+
+/**
+ Tries to get a value from the dictionary via the key.  If a value is found, it is set in the receiver, using the same key, otherwise no change is made.  Useful for setting properties from a dictionary.
+ 
+ @author DJS 2011-02.
 */
 
-- (void)dejal_performSelector:(SEL)selector withEachObjectInSet:(NSSet *)set
+- (void)dejal_setValueForKey:(NSString *)key withDictionary:(NSDictionary *)dict;
+{
+    id value = dict[key];
+    
+    if (value)
+        [self setValue:value forKey:key];
+}
+
+/**
+ Tries to get a value from the dictionary via the first key.  If there isn't one, tries the alternative key.  If a value is found, it is set in the receiver, using the first key, otherwise no change is made.  Useful for setting properties from a dictionary.
+ 
+ @author DJS 2011-02.
+*/
+
+- (void)dejal_setValueForKey:(NSString *)key orDictKey:(NSString *)altKey withDictionary:(NSDictionary *)dict;
+{
+    id value = dict[key];
+    
+    if (!value && altKey)
+        value = dict[altKey];
+    
+    if (value)
+        [self setValue:value forKey:key];
+}
+
+/**
+ Tries to get a value from the dictionary via the first key.  If there isn't one, tries the alternative keys until a value is found.  If a value is found, it is set in the receiver, using the first key, otherwise no change is made.  Useful for setting properties from a dictionary.  To set many properties of many objects, use a DejalKeyMapping instead, which resolves the keys once.
+ 
+ @author DJS 2011-02.
+ @version DJS 2026-10: changed to stop looking at the alternative keys once a value is found.
+*/
+
+- (void)dejal_setValueForKey:(NSString *)key orDictKeys:(NSArray *)altKeys withDictionary:(NSDictionary *)dict;
+{
+    id value = dict[key];
+    
+    if (!value && altKeys)
+    {
+        for (NSString *altKey in altKeys)
+            if ((value = dict[altKey]))
+                break;
+    }
+    
+    if (value)
+        [self setValue:value forKey:key];
+}
+
+/**
+ If there is a value for the specified key in the receiver, it is set in the dictionary, otherwise this does nothing.
+ 
+ @author DJS 2011-02.
+*/
+
+- (void)dejal_setValueInDictionary:(NSMutableDictionary *)dict forKey:(NSString *)key;
+{
+    [self dejal_setValueInDictionary:dict forKey:key removeIfNil:NO];
+}
+
+/**
+ If there is a value for the specified key in the receiver, it is set in the dictionary.  If there isn't a value, the key is optionally removed from the dictionary.  Passing YES is equivalent to calling [dict setValue:[self valueForKey:key] forKey:key].  To do this for many keys of many objects, use a DejalKeyMapping instead, which resolves the keys once.
+ 
+ @author DJS 2011-02.
+*/
+
+- (void)dejal_setValueInDictionary:(NSMutableDictionary *)dict forKey:(NSString *)key removeIfNil:(BOOL)removeIfNil;
+{
+    id value = [self valueForKey:key];
+    
+    if (value)
+        dict[key] = value;
+    else if (removeIfNil)
+        [dict removeObjectForKey:key];
+}
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark - IDENTITY METHODS
+// ----------------------------------------------------------------------------------------
+
+
+/**
+ Returns YES if the receiver is an instance of a subclass of aClass, but not an instance of aClass itself.
+ 
+ @author DJS 2004-01.
+*/
+
+- (BOOL)dejal_isReallySubclassOfClass:(Class)aClass
+{
+    return [self isKindOfClass:aClass] && ![self isMemberOfClass:aClass];
+}
+
+
+/**
+ Like -isEqual, but returns YES if the receiver and the other object are equal when both interpreted as case-insensitive strings.  So, for example, @"THIS" and @"This" are equivalent, and @"123" and [NSNumber numberWithInteger:123] are equivalent.  If the other object is nil, returns NO; i.e. a non-nil receiver is not equivalent to a nil value (but, of course, sending this to a nil object will result in 0, which would be incorrect if the other object were also nil).
+ 
+ @author DJS 2005-03.
+ @version DJS 2026-10: changed to use fast paths for strings, integer numbers and dates, that avoid building descriptions.
+*/
+
+- (BOOL)dejal_isEquivalent:(id)anObject
+{
+    return DejalObjectsAreEquivalent(self, anObject);
+}
+
+/**
+ An alias of -isEquivalent:, for when the "To" makes more sense.  For efficiency, the logic is shared via a function.
+ 
+ @author DJS 2005-05.
+ @version DJS 2026-10: changed to use fast paths for strings, integer numbers and dates, that avoid building descriptions.
+*/
+
+- (BOOL)dejal_isEquivalentTo:(id)anObject
+{
+    return DejalObjectsAreEquivalent(self, anObject);
+}
+
+/**
+ Returns a key that is equal for any two objects that are equivalent (see -isEquivalentTo:), so equivalent objects can be found via sets and dictionaries.  The key is the description, case-folded and canonically decomposed; pure ASCII strings are just lowercased.  Compute it once and reuse it, rather than calling this repeatedly for the same object.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSString *)dejal_equivalenceKey;
+{
+    NSString *description = [self description];
+    
+    if (DejalASCIICharacters(description))
+        return [description lowercaseString];
+    else
+        return [[description stringByFoldingWithOptions:NSCaseInsensitiveSearch locale:nil] decomposedStringWithCanonicalMapping];
+}
+
+/**
+ Returns a hash value that is equal for any two objects that are equivalent (see -isEquivalentTo:), i.e. the hash of -dejal_equivalenceKey.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSUInteger)dejal_equivalenceHash;
+{
+    return [[self dejal_equivalenceKey] hash];
+}
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark - COPYING METHODS
+// ----------------------------------------------------------------------------------------
+
+
+/**
+ Returns a deep copy of the receiver: arrays and dictionaries are copied along with their contents, to any depth, while other objects are copied via -dejal_deepCopy or -copy (or -dejal_deepMutableCopy or -mutableCopy if making mutable).  Used by the array and dictionary -dejal_deepCopy and -dejal_deepMutableCopy methods.
+ 
+ The copy is made without recursion, with each new container presized.  For immutable copies, immutable containers whose contents are unchanged are shared rather than copied, as are numbers, dates and (via -copy) immutable strings, so the copy costs little more than the mutable parts of the source.
+ 
+ @param mutable If YES, the arrays and dictionaries (and other contents, where supported) are mutable; if NO, they are immutable.
+ @param concurrently If YES and the receiver is a large array or dictionary, its top-level contents are copied across multiple threads.
+ @returns A deep copy of the receiver.
+ 
+ @author DJS 2026-10.
+ */
+
+- (id)dejal_deepCopyMakingMutable:(BOOL)mutable concurrently:(BOOL)concurrently;
+{
+    if (!concurrently || !DejalDeepCopyIsContainer(self) || [(id)self count] < DEJAL_DEEP_COPY_CONCURRENT_THRESHOLD)
+        return DejalDeepCopyObject(self, mutable);
+    
+    DejalDeepCopyFrame *frame = [[DejalDeepCopyFrame alloc] initWithContainer:self];
+    NSUInteger count = frame->count;
+    NSUInteger chunks = (count + DEJAL_DEEP_COPY_CHUNK_SIZE - 1) / DEJAL_DEEP_COPY_CHUNK_SIZE;
+    
+    dispatch_apply(chunks, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t chunk)
+                   {
+                       @autoreleasepool
+                       {
+                           NSUInteger start = chunk * DEJAL_DEEP_COPY_CHUNK_SIZE;
+                           NSUInteger end = MIN(start + DEJAL_DEEP_COPY_CHUNK_SIZE, count);
+                           
+                           for (NSUInteger i = start; i < end; i++)
+                               frame->copies[i] = DejalDeepCopyObject(frame->values[i], mutable);
+                       }
+                   });
+    
+    frame->index = count;
+    
+    return [frame resultMakingMutable:mutable];
+}
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark - PERFORM SELECTOR METHODS
+// ----------------------------------------------------------------------------------------
+
+
+/**
+ Similar to -performSelector:, but calls a method that returns a boolean value.  Returns NO if the receiever doesn't respond to that selector.
+ 
+ @author DJS 2006-06.
+ */
+
+- (BOOL)dejal_performBoolSelector:(SEL)selector;
+{
+    return [self dejal_performIntegerSelector:selector withObject:[NSNull null] withObject:[NSNull null]];
+}
+
+/**
+ Similar to -performSelector:withObject:, but calls a method that returns a boolean value.  Returns NO if the receiever doesn't respond to that selector.
+ 
+ @author DJS 2006-06.
+ */
+
+- (BOOL)dejal_performBoolSelector:(SEL)selector withObject:(__unsafe_unretained id)object;
+{
+    return [self dejal_performIntegerSelector:selector withObject:object withObject:[NSNull null]];
+}
+
+/**
+ Similar to -performSelector:withObject:withObject:, but calls a method that returns a boolean value.  Returns NO if the receiever doesn't respond to that selector.
+ 
+ @author DJS 2006-06.
+ */
+
+- (BOOL)dejal_performBoolSelector:(SEL)selector withObject:(__unsafe_unretained id)object1 withObject:(__unsafe_unretained id)object2;
 {
-    [self dejal_performSelector:selector withEachObjectInArray:[set allObjects]];
+    return [self dejal_performIntegerSelector:selector withObject:object1 withObject:object2];
+}
+
+/**
+ Similar to -performSelector:, but calls a method that returns an integer value.  Returns zero if the receiever doesn't respond to that selector.
+ 
+ @author DJS 2004-04.
+*/
+
+- (NSInteger)dejal_performIntegerSelector:(SEL)selector
+{
+    return [self dejal_performIntegerSelector:selector withObject:[NSNull null] withObject:[NSNull null]];
+}
+
+/**
+ Similar to -performSelector:withObject:, but calls a method that returns an integer value.  Returns zero if the receiever doesn't respond to that selector.
+ 
+ @author DJS 2004-04.
+*/
+
+- (NSInteger)dejal_performIntegerSelector:(SEL)selector withObject:(__unsafe_unretained id)object
+{
+    return [self dejal_performIntegerSelector:selector withObject:object withObject:[NSNull null]];
+}
+
+/**
+ Similar to -performSelector:withObject:withObject:, but calls a method that returns an integer value.  Does nothing (and returns zero) if selector is nil or the receiver doesn't respond to that selector.  Pass NSNull for arguments the method doesn't take.  The method is resolved once per class and cached (see DejalPerformEntryForTarget()), and called directly when its arguments are objects, rather than building a method signature and invocation each time.
+ 
+ @author DJS 2004-04.
+ @version DJS 2026-10: changed to use a cache of resolved methods and call them directly where possible; values of narrower signed types are now sign-extended.
+*/
+
+- (NSInteger)dejal_performIntegerSelector:(SEL)selector withObject:(__unsafe_unretained id)object1 withObject:(__unsafe_unretained id)object2
+{
+    if (!selector || ![self respondsToSelector:selector])
+        return 0;
+    
+    DejalPerformEntry *entry = DejalPerformEntryForTarget(self, selector);
+    
+    if (!entry)
+        return 0;
+    
+    return DejalPerformIntegerEntry(entry, self, object1, object2);
+}
+
+/**
+ Similar to -performSelector:withObject:, but allows any number of arguments.  The arguments are taken from the array, in order.  The selector should expect the same number of arguments.  It's okay for arguments to be nil, if the selector doesn't take any.  Does nothing if selector is nil, or the number of arguments of the selector and array are different.  The method is resolved once per class and cached, and called directly when it takes up to four objects, otherwise via an invocation built from the cached signature.
+ 
+ @author DJS 2007-03.
+ @version DJS 2026-10: changed to use a cache of resolved methods and call them directly where possible.
+*/
+
+- (void)dejal_performSelector:(SEL)selector withArguments:(NSArray *)arguments;
+{
+    if (!selector)
+        return;
+    
+    DejalPerformEntry *entry = DejalPerformEntryForTarget(self, selector);
+    NSUInteger count = [arguments count];
+    
+    // Exclude the hidden self and _cmd arguments:
+    if (!entry || entry->argumentCount != count)
+    {
+        NSLog(@"performSelector:%@ withObjects:%@ has different number of arguments", NSStringFromSelector(selector), arguments);         // log
+        
+        return;
+    }
+    
+    if (entry->direct && count <= DEJAL_PERFORM_DIRECT_ARGUMENTS)
+    {
+        __unsafe_unretained id objects[DEJAL_PERFORM_DIRECT_ARGUMENTS] = {nil};
+        
+        [arguments getObjects:objects range:NSMakeRange(0, count)];
+        
+        switch (count)
+        {
+            case 0:
+                ((void (*)(id, SEL))entry->imp)(self, selector);
+                break;
+            case 1:
+                ((void (*)(id, SEL, id))entry->imp)(self, selector, objects[0]);
+                break;
+            case 2:
+                ((void (*)(id, SEL, id, id))entry->imp)(self, selector, objects[0], objects[1]);
+                break;
+            case 3:
+                ((void (*)(id, SEL, id, id, id))entry->imp)(self, selector, objects[0], objects[1], objects[2]);
+                break;
+            default:
+                ((void (*)(id, SEL, id, id, id, id))entry->imp)(self, selector, objects[0], objects[1], objects[2], objects[3]);
+                break;
+        }
+        
+        return;
+    }
+    
+    NSInvocation *invocation = [NSInvocation invocationWithMethodSignature:entry->signature];
+    
+    [invocation setSelector:selector];
+    
+    for (NSUInteger i = 0; i < count; i++)
+    {
+        __unsafe_unretained id object = arguments[i];
+        
+        [invocation setArgument:&object atIndex:i + 2];
+    }
+    
+    [invocation invokeWithTarget:self];
+}
+
+/**
+ Invokes the selector, passing each object in the array as a parameter.  Not the same as -[NSArray makeObjectsPerformSelector:], as that makes the objects in the array perform the selector, instead of making the receiver object perform the selector.  The selector must take a single argument.
+ 
+ @author DJS 2004-10.
+ @version DJS 2014-12: changed to add a workaround for a compiler warning.
+ @version DJS 2026-10: changed to resolve the method once, and call it directly for each object.
+*/
+
+- (void)dejal_performSelector:(SEL)selector withEachObjectInArray:(NSArray *)array
+{
+    DejalPerformSelectorWithEachObject(self, selector, array, NO);
+}
+
+/**
+ Invokes the selector, passing each object in the dictionary as a parameter.  The order invoked is not defined.  See -performSelector:withEachObjectInArray: for more information.
+ 
+ @author DJS 2004-10.
+ @version DJS 2026-10: changed to resolve the method once.
+*/
+
+- (void)dejal_performSelector:(SEL)selector withEachObjectInDictionary:(NSDictionary *)dict
+{
+    DejalPerformSelectorWithEachObject(self, selector, dict, NO);
+}
+
+/**
+ Invokes the selector, passing each object in the set as a parameter.  The order invoked is not defined.  See -performSelector:withEachObjectInArray: for more information.
+ 
+ @author DJS 2004-10.
+ @version DJS 2026-10: changed to resolve the method once.
+*/
+
+- (void)dejal_performSelector:(SEL)selector withEachObjectInSet:(NSSet *)set
+{
+    DejalPerformSelectorWithEachObject(self, selector, set, NO);
+}
+
+/**
+ Like -dejal_performSelector:withEachObjectInArray:, but if concurrently is YES, the objects are passed concurrently from multiple threads, in no particular order, returning when all are done.  Only use that if the receiver's method is thread-safe.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)dejal_performSelector:(SEL)selector withEachObjectInArray:(NSArray *)array concurrently:(BOOL)concurrently;
+{
+    DejalPerformSelectorWithEachObject(self, selector, array, concurrently);
+}
+
+/**
+ Like -dejal_performSelector:withEachObjectInDictionary:, but if concurrently is YES, the objects are passed concurrently from multiple threads, returning when all are done.  Only use that if the receiver's method is thread-safe.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)dejal_performSelector:(SEL)selector withEachObjectInDictionary:(NSDictionary *)dict concurrently:(BOOL)concurrently;
+{
+    DejalPerformSelectorWithEachObject(self, selector, dict, concurrently);
+}
+
+/**
+ Like -dejal_performSelector:withEachObjectInSet:, but if concurrently is YES, the objects are passed concurrently from multiple threads, returning when all are done.  Only use that if the receiver's method is thread-safe.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)dejal_performSelector:(SEL)selector withEachObjectInSet:(NSSet *)set concurrently:(BOOL)concurrently;
+{
+    DejalPerformSelectorWithEachObject(self, selector, set, concurrently);
+}
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+// Number of objects or dictionaries above which a key mapping splits the work across threads:
+#define DEJAL_KEY_MAPPING_CONCURRENT_THRESHOLD 1024
+
+// Number of objects or dictionaries each concurrent key mapping task handles:
+#define DEJAL_KEY_MAPPING_CHUNK_SIZE 256
+
+
+/**
+ Returns YES if the type encoding is one that the key mapping can get and set directly: an object, or a number that key-value coding would box as an NSNumber.
+ 
+ @author DJS 2026-10.
+ */
+
+static inline BOOL DejalKeyMappingTypeIsSupported(char type)
+{
+    return type && strchr("@#cCsSiIlLqQfdB", type);
+}
+
+
+/**
+ Private class representing one key of a key mapping: the dictionary keys to look for, and the accessors key-value coding would use for it, resolved in advance.
+ 
+ @author DJS 2026-10.
+ */
+
+@interface DejalKeyMappingProperty : NSObject
+{
+@public
+    NSString *key;
+    NSArray *dictKeys;  // The key, then any alternatives
+    SEL getter;         // NULL if key-value coding needs to be used
+    SEL setter;         // NULL if key-value coding needs to be used
+    char getterType;    // Type encoding of the getter's result, without qualifiers
+    char setterType;    // Type encoding of the setter's argument, without qualifiers
+}
+
+- (instancetype)initWithClass:(Class)cls key:(NSString *)aKey dictKeys:(NSArray *)someDictKeys;
+
+@end
+
+
+@implementation DejalKeyMappingProperty
+
+/**
+ Initializer that looks for the accessor methods in the same order as -valueForKey: and -setValue:forKey: do, i.e. get<Key>, <key>, is<Key> or _<key> for the getter, and set<Key>: or _set<Key>: for the setter.  If there isn't one, or it takes or returns a type other than an object or number, the mapping falls back to key-value coding for that key, so instance variables, collection accessors and so on work as before.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)initWithClass:(Class)cls key:(NSString *)aKey dictKeys:(NSArray *)someDictKeys;
+{
+    if ((self = [super init]))
+    {
+        key = [aKey copy];
+        dictKeys = [someDictKeys copy];
+        
+        NSString *capitalized = key.length ? [[[key substringToIndex:1] uppercaseString] stringByAppendingString:[key substringFromIndex:1]] : key;
+        NSArray *getters = @[[@"get" stringByAppendingString:capitalized], key, [@"is" stringByAppendingString:capitalized], [@"_" stringByAppendingString:key]];
+        NSArray *setters = @[[NSString stringWithFormat:@"set%@:", capitalized], [NSString stringWithFormat:@"_set%@:", capitalized]];
+        
+        for (NSString *name in getters)
+        {
+            SEL selector = NSSelectorFromString(name);
+            
+            if ([cls instancesRespondToSelector:selector])
+            {
+                NSMethodSignature *signature = [cls instanceMethodSignatureForSelector:selector];
+                
+                getterType = DejalTypeEncoding([signature methodReturnType]);
+                getter = [signature numberOfArguments] == 2 && DejalKeyMappingTypeIsSupported(getterType) ? selector : NULL;
+                break;
+            }
+        }
+        
+        for (NSString *name in setters)
+        {
+            SEL selector = NSSelectorFromString(name);
+            
+            if ([cls instancesRespondToSelector:selector])
+            {
+                NSMethodSignature *signature = [cls instanceMethodSignatureForSelector:selector];
+                
+                setterType = [signature numberOfArguments] == 3 ? DejalTypeEncoding([signature getArgumentTypeAtIndex:2]) : 0;
+                setter = DejalKeyMappingTypeIsSupported(setterType) ? selector : NULL;
+                break;
+            }
+        }
+    }
+    
+    return self;
+}
+
+@end
+
+
+/**
+ Sets the value in the object via the property's setter implementation, converting numbers as -setValue:forKey: would, or via -setValue:forKey: itself if there is no implementation, or the value is one it would convert differently (e.g. a string for a type NSString has no accessor for).
+ 
+ @author DJS 2026-10.
+ */
+
+static void DejalKeyMappingSetValue(DejalKeyMappingProperty *property, IMP imp, id object, id value)
+{
+    SEL setter = property->setter;
+    char type = property->setterType;
+    
+    if (imp && (type == _C_ID || type == _C_CLASS))
+    {
+        ((void (*)(id, SEL, id))imp)(object, setter, value);
+        return;
+    }
+    
+    BOOL isNumber = [value isKindOfClass:[NSNumber class]];
+    
+    if (!imp || !(isNumber || ([value isKindOfClass:[NSString class]] && strchr("iqfdB", type))))
+    {
+        [object setValue:value forKey:property->key];
+        return;
+    }
+    
+    switch (type)
+    {
+        case _C_CHR:
+            ((void (*)(id, SEL, char))imp)(object, setter, [value charValue]);
+            break;
+        case _C_UCHR:
+            ((void (*)(id, SEL, unsigned char))imp)(object, setter, [value unsignedCharValue]);
+            break;
+        case _C_SHT:
+            ((void (*)(id, SEL, short))imp)(object, setter, [value shortValue]);
+            break;
+        case _C_USHT:
+            ((void (*)(id, SEL, unsigned short))imp)(object, setter, [value unsignedShortValue]);
+            break;
+        case _C_INT:
+            ((void (*)(id, SEL, int))imp)(object, setter, [value intValue]);
+            break;
+        case _C_UINT:
+            ((void (*)(id, SEL, unsigned int))imp)(object, setter, [value unsignedIntValue]);
+            break;
+        case _C_LNG:
+            ((void (*)(id, SEL, long))imp)(object, setter, [value longValue]);
+            break;
+        case _C_ULNG:
+            ((void (*)(id, SEL, unsigned long))imp)(object, setter, [value unsignedLongValue]);
+            break;
+        case _C_LNG_LNG:
+            ((void (*)(id, SEL, long long))imp)(object, setter, [value longLongValue]);
+            break;
+        case _C_ULNG_LNG:
+            ((void (*)(id, SEL, unsigned long long))imp)(object, setter, [value unsignedLongLongValue]);
+            break;
+        case _C_FLT:
+            ((void (*)(id, SEL, float))imp)(object, setter, [value floatValue]);
+            break;
+        case _C_DBL:
+            ((void (*)(id, SEL, double))imp)(object, setter, [value doubleValue]);
+            break;
+        case _C_BOOL:
+            ((void (*)(id, SEL, _Bool))imp)(object, setter, [value boolValue]);
+            break;
+    }
+}
+
+/**
+ Returns the value from the object via the property's getter implementation, boxing numbers as -valueForKey: would, or via -valueForKey: itself if there is no implementation.
+ 
+ @author DJS 2026-10.
+ */
+
+static id DejalKeyMappingValue(DejalKeyMappingProperty *property, IMP imp, id object)
+{
+    SEL getter = property->getter;
+    
+    if (!imp)
+        return [object valueForKey:property->key];
+    
+    switch (property->getterType)
+    {
+        case _C_ID:
+        case _C_CLASS:
+            return ((id (*)(id, SEL))imp)(object, getter);
+        case _C_CHR:
+            return [NSNumber numberWithChar:((char (*)(id, SEL))imp)(object, getter)];
+        case _C_UCHR:
+            return [NSNumber numberWithUnsignedChar:((unsigned char (*)(id, SEL))imp)(object, getter)];
+        case _C_SHT:
+            return [NSNumber numberWithShort:((short (*)(id, SEL))imp)(object, getter)];
+        case _C_USHT:
+            return [NSNumber numberWithUnsignedShort:((unsigned short (*)(id, SEL))imp)(object, getter)];
+        case _C_INT:
+            return [NSNumber numberWithInt:((int (*)(id, SEL))imp)(object, getter)];
+        case _C_UINT:
+            return [NSNumber numberWithUnsignedInt:((unsigned int (*)(id, SEL))imp)(object, getter)];
+        case _C_LNG:
+            return [NSNumber numberWithLong:((long (*)(id, SEL))imp)(object, getter)];
+        case _C_ULNG:
+            return [NSNumber numberWithUnsignedLong:((unsigned long (*)(id, SEL))imp)(object, getter)];
+        case _C_LNG_LNG:
+            return [NSNumber numberWithLongLong:((long long (*)(id, SEL))imp)(object, getter)];
+        case _C_ULNG_LNG:
+            return [NSNumber numberWithUnsignedLongLong:((unsigned long long (*)(id, SEL))imp)(object, getter)];
+        case _C_FLT:
+            return [NSNumber numberWithFloat:((float (*)(id, SEL))imp)(object, getter)];
+        case _C_DBL:
+            return [NSNumber numberWithDouble:((double (*)(id, SEL))imp)(object, getter)];
+        case _C_BOOL:
+            return [NSNumber numberWithBool:((_Bool (*)(id, SEL))imp)(object, getter)];
+        default:
+            return [object valueForKey:property->key];
+    }
+}
+
+
+/**
+ Private structure holding the accessor implementations of a key mapping's properties for one class, so a run of objects of the same class resolves them just once.  Resolved afresh for each class and each bulk call, so subclasses, key-value observed objects and swizzled methods are all honored.
+ 
+ @author DJS 2026-10.
+ */
+
+typedef struct
+{
+    Class cls;
+    IMP *getters;
+    IMP *setters;
+} DejalKeyMappingIMPs;
+
+
+/**
+ Private class for the keys of the shared key mapping cache: the class, keys and dictionary keys, copied so later changes to mutable ones can't affect the cache.  Its hash combines the hashes of all of them, since an array's hash is only its count.
+ 
+ @author DJS 2026-10.
+ */
+
+@interface DejalKeyMappingCacheKey : NSObject <NSCopying>
+{
+@public
+    Class cls;
+    NSArray *keys;
+    NSDictionary *dictKeys;
+    NSUInteger hash;
+}
+
+- (instancetype)initWithClass:(Class)aClass keys:(NSArray *)someKeys dictKeys:(NSDictionary *)someDictKeys;
+
+@end
+
+
+@implementation DejalKeyMappingCacheKey
+
+- (instancetype)initWithClass:(Class)aClass keys:(NSArray *)someKeys dictKeys:(NSDictionary *)someDictKeys;
+{
+    if ((self = [super init]))
+    {
+        cls = aClass;
+        keys = [someKeys copy] ?: @[];
+        dictKeys = [someDictKeys copy] ?: @{};
+        hash = (NSUInteger)(__bridge void *)cls;
+        
+        for (NSString *key in keys)
+            hash = hash * 31 + key.hash;
+        
+        // The dictionary keys are unordered, so their entries are combined in a way that doesn't depend on order; alternatives may be arrays, so their elements are hashed:
+        for (NSString *key in dictKeys)
+        {
+            id alternatives = dictKeys[key];
+            NSUInteger entryHash = key.hash;
+            
+            for (id alternative in [alternatives isKindOfClass:[NSArray class]] ? alternatives : @[alternatives])
+                entryHash = entryHash * 31 + [alternative hash];
+            
+            hash += entryHash * 17;
+        }
+    }
+    
+    return self;
+}
+
+- (NSUInteger)hash;
+{
+    return hash;
+}
+
+- (BOOL)isEqual:(id)object;
+{
+    if (object == self)
+        return YES;
+    
+    if (![object isKindOfClass:[DejalKeyMappingCacheKey class]])
+        return NO;
+    
+    DejalKeyMappingCacheKey *other = object;
+    
+    return other->cls == cls && other->hash == hash && [other->keys isEqualToArray:keys] && [other->dictKeys isEqualToDictionary:dictKeys];
+}
+
+- (id)copyWithZone:(NSZone *)zone;
+{
+    return self;
+}
+
+@end
+
+
+@interface DejalKeyMapping ()
+{
+    NSArray *_propertyArray;
+    __unsafe_unretained id *_properties;
+    NSUInteger _count;
+}
+
+@end
+
+
+@implementation DejalKeyMapping
+
+/**
+ Returns a shared mapping for the class and keys, compiling and caching it if needed.  The keys and dictionary keys are copied, so mutable ones can be changed afterwards without affecting the cache.  See -initWithClass:keys:dictKeys:.
+ 
+ @author DJS 2026-10.
+ */
+
++ (instancetype)mappingForClass:(Class)cls keys:(NSArray *)keys dictKeys:(NSDictionary *)dictKeys;
+{
+    static NSCache *cache = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^
+                  {
+                      cache = [NSCache new];
+                  });
+    
+    DejalKeyMappingCacheKey *cacheKey = [[DejalKeyMappingCacheKey alloc] initWithClass:cls keys:keys dictKeys:dictKeys];
+    DejalKeyMapping *mapping = [cache objectForKey:cacheKey];
+    
+    if (!mapping)
+    {
+        mapping = [[self alloc] initWithClass:cls keys:cacheKey->keys dictKeys:cacheKey->dictKeys];
+        
+        [cache setObject:mapping forKey:cacheKey];
+    }
+    
+    return mapping;
+}
+
+/**
+ Initializer that compiles a mapping between objects of the class and dictionaries, for the keys.  The dictionary keys are the same keys, optionally with alternatives to look for when hydrating, as with -dejal_setValueForKey:orDictKeys:withDictionary:.  The accessors key-value coding would use for each key, and their types, are resolved once here, so applying the mapping to many objects only costs direct method calls.
+ 
+ @param cls The class of the objects.
+ @param keys The keys of the properties to map.
+ @param dictKeys A dictionary mapping some of the keys to an alternative dictionary key, or an array of them, to try in turn if there is no value for the key itself; may be nil.
+ @returns A new mapping.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)initWithClass:(Class)cls keys:(NSArray *)keys dictKeys:(NSDictionary *)dictKeys;
+{
+    if ((self = [super init]))
+    {
+        NSMutableArray *properties = [NSMutableArray arrayWithCapacity:keys.count];
+        
+        for (NSString *key in keys)
+        {
+            id alternatives = dictKeys[key];
+            NSMutableArray *keyDictKeys = [NSMutableArray arrayWithObject:key];
+            
+            if ([alternatives isKindOfClass:[NSArray class]])
+                [keyDictKeys addObjectsFromArray:alternatives];
+            else if (alternatives)
+                [keyDictKeys addObject:alternatives];
+            
+            [properties addObject:[[DejalKeyMappingProperty alloc] initWithClass:cls key:key dictKeys:keyDictKeys]];
+        }
+        
+        _targetClass = cls;
+        _keys = [keys copy];
+        _propertyArray = [properties copy];
+        _count = properties.count;
+        _properties = (__unsafe_unretained id *)calloc(MAX(_count, 1), sizeof(id));
+        
+        [_propertyArray getObjects:_properties range:NSMakeRange(0, _count)];
+    }
+    
+    return self;
+}
+
+- (void)dealloc;
+{
+    free(_properties);
+}
+
+/**
+ Private method that makes sure the implementations are resolved for the object's class.  An object whose class doesn't implement an accessor itself (e.g. a different class than the mapping's, or a proxy that forwards it) gets NULL for it, so key-value coding is used instead of calling the forwarding implementation directly.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)resolveIMPs:(DejalKeyMappingIMPs *)imps forObject:(id)object;
+{
+    Class cls = object_getClass(object);
+    
+    if (cls == imps->cls)
+        return;
+    
+    for (NSUInteger i = 0; i < _count; i++)
+    {
+        DejalKeyMappingProperty *property = _properties[i];
+        
+        imps->getters[i] = property->getter && class_respondsToSelector(cls, property->getter) ? class_getMethodImplementation(cls, property->getter) : NULL;
+        imps->setters[i] = property->setter && class_respondsToSelector(cls, property->setter) ? class_getMethodImplementation(cls, property->setter) : NULL;
+    }
+    
+    imps->cls = cls;
+}
+
+/**
+ Private method that sets the object's properties from the dictionary.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)hydrateObject:(id)object withDictionary:(NSDictionary *)dict imps:(DejalKeyMappingIMPs *)imps;
+{
+    if (![dict isKindOfClass:[NSDictionary class]])
+        return;
+    
+    [self resolveIMPs:imps forObject:object];
+    
+    for (NSUInteger i = 0; i < _count; i++)
+    {
+        DejalKeyMappingProperty *property = _properties[i];
+        id value = nil;
+        
+        for (NSString *dictKey in property->dictKeys)
+            if ((value = dict[dictKey]))
+                break;
+        
+        if (value)
+            DejalKeyMappingSetValue(property, imps->setters[i], object, value);
+    }
+}
+
+/**
+ Private method that sets the dictionary's values from the object's properties.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)dehydrateObject:(id)object intoDictionary:(NSMutableDictionary *)dict removeIfNil:(BOOL)removeIfNil imps:(DejalKeyMappingIMPs *)imps;
+{
+    [self resolveIMPs:imps forObject:object];
+    
+    for (NSUInteger i = 0; i < _count; i++)
+    {
+        DejalKeyMappingProperty *property = _properties[i];
+        id value = DejalKeyMappingValue(property, imps->getters[i], object);
+        
+        if (value)
+            dict[property->key] = value;
+        else if (removeIfNil)
+            [dict removeObjectForKey:property->key];
+    }
+}
+
+/**
+ Private method that calls the block with each index up to the count, in chunks across multiple threads if there are many, passing the implementations for that chunk.  An exception raised in a chunk, e.g. by key-value coding for an unknown key, would terminate the process if it escaped a worker thread, so it is caught, that chunk stops, and the first one is raised again on the calling thread once all of the chunks are done.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)applyWithCount:(NSUInteger)count block:(void (^)(NSUInteger idx, DejalKeyMappingIMPs *imps))block;
+{
+    NSUInteger chunks = count > DEJAL_KEY_MAPPING_CONCURRENT_THRESHOLD ? (count + DEJAL_KEY_MAPPING_CHUNK_SIZE - 1) / DEJAL_KEY_MAPPING_CHUNK_SIZE : 1;
+    NSUInteger chunkSize = chunks > 1 ? DEJAL_KEY_MAPPING_CHUNK_SIZE : count;
+    NSLock *lock = [NSLock new];
+    __block NSException *exception = nil;
+    
+    dispatch_apply(chunks, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t chunk)
+                   {
+                       @autoreleasepool
+                       {
+                           IMP *buffer = calloc(MAX(self->_count, 1) * 2, sizeof(IMP));
+                           DejalKeyMappingIMPs imps = {Nil, buffer, buffer + self->_count};
+                           NSUInteger start = chunk * chunkSize;
+                           NSUInteger end = MIN(start + chunkSize, count);
+                           
+                           @try
+                           {
+                               for (NSUInteger i = start; i < end; i++)
+                                   block(i, &imps);
+                           }
+                           @catch (NSException *chunkException)
+                           {
+                               [lock lock];
+                               
+                               if (!exception)
+                                   exception = chunkException;
+                               
+                               [lock unlock];
+                           }
+                           
+                           free(buffer);
+                       }
+                   });
+    
+    if (exception)
+        @throw exception;
+}
+
+/**
+ Hydrates the object from the dictionary: for each key, sets the value from the dictionary for the key, or the first of its alternative dictionary keys that has a value, otherwise leaves it unchanged.  Equivalent to calling -dejal_setValueForKey:orDictKeys:withDictionary: for each key, without resolving the keys each time.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)setValuesOfObject:(id)object withDictionary:(NSDictionary *)dict;
+{
+    IMP buffer[MAX(_count, 1) * 2];
+    DejalKeyMappingIMPs imps = {Nil, buffer, buffer + _count};
+    
+    [self hydrateObject:object withDictionary:dict imps:&imps];
+}
+
+/**
+ Dehydrates the object into the dictionary: for each key, sets the object's value for it in the dictionary; if there isn't a value, the key is optionally removed.  Equivalent to calling -dejal_setValueInDictionary:forKey:removeIfNil: for each key, without resolving the keys each time.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)setValuesInDictionary:(NSMutableDictionary *)dict withObject:(id)object removeIfNil:(BOOL)removeIfNil;
+{
+    IMP buffer[MAX(_count, 1) * 2];
+    DejalKeyMappingIMPs imps = {Nil, buffer, buffer + _count};
+    
+    [self dehydrateObject:object intoDictionary:dict removeIfNil:removeIfNil imps:&imps];
+}
+
+/**
+ Hydrates each object in the array from the dictionary at the same index in the other array (see -setValuesOfObject:withDictionary:), which must be at least as long.  Elements that aren't dictionaries are skipped.  Large arrays are split into chunks handled concurrently, so the objects' setters need to be safe to call on different objects at once.  If any raise an exception, it is raised again on the calling thread once the rest are done.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)setValuesOfObjects:(NSArray *)objects withDictionaries:(NSArray *)dicts;
+{
+    [self applyWithCount:objects.count block:^(NSUInteger idx, DejalKeyMappingIMPs *imps)
+     {
+         [self hydrateObject:objects[idx] withDictionary:dicts[idx] imps:imps];
+     }];
+}
+
+/**
+ Returns an array of new objects of the mapping's class, each hydrated from the dictionary at the same index (see -setValuesOfObjects:withDictionaries:).
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSArray *)objectsWithDictionaries:(NSArray *)dicts;
+{
+    NSUInteger count = dicts.count;
+    __strong id *objects = (__strong id *)calloc(MAX(count, 1), sizeof(id));
+    Class cls = self.targetClass;
+    
+    NSArray *result = nil;
+    
+    // Release the objects made so far even if a hydration raises an exception:
+    @try
+    {
+        [self applyWithCount:count block:^(NSUInteger idx, DejalKeyMappingIMPs *imps)
+         {
+             id object = [cls new];
+             
+             [self hydrateObject:object withDictionary:dicts[idx] imps:imps];
+             
+             objects[idx] = object;
+         }];
+        
+        result = [NSArray arrayWithObjects:objects count:count];
+    }
+    @finally
+    {
+        for (NSUInteger i = 0; i < count; i++)
+            objects[i] = nil;
+        
+        free(objects);
+    }
+    
+    return result;
+}
+
+/**
+ Returns an array of new mutable dictionaries, each dehydrated from the object at the same index (see -setValuesInDictionary:withObject:removeIfNil:).  Large arrays are split into chunks handled concurrently, so the objects' getters need to be safe to call on different objects at once.  If any raise an exception, it is raised again on the calling thread once the rest are done.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSArray *)dictionariesWithObjects:(NSArray *)objects;
+{
+    NSUInteger count = objects.count;
+    __strong id *dicts = (__strong id *)calloc(MAX(count, 1), sizeof(id));
+    NSUInteger capacity = _count;
+    
+    NSArray *result = nil;
+    
+    // Release the dictionaries made so far even if a dehydration raises an exception:
+    @try
+    {
+        [self applyWithCount:count block:^(NSUInteger idx, DejalKeyMappingIMPs *imps)
+         {
+             NSMutableDictionary *dict = [NSMutableDictionary dictionaryWithCapacity:capacity];
+             
+             [self dehydrateObject:objects[idx] intoDictionary:dict removeIfNil:NO imps:imps];
+             
+             dicts[idx] = dict;
+         }];
+        
+        result = [NSArray arrayWithObjects:dicts count:count];
+    }
+    @finally
+    {
+        for (NSUInteger i = 0; i < count; i++)
+            dicts[i] = nil;
+        
+        free(dicts);
+    }
+    
+    return result;
 }
 
 @end
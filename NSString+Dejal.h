@@ -30,6 +30,18 @@
 
 @import Foundation;
 
+#import "NSData+Dejal.h"
+
+
+typedef NS_OPTIONS(NSUInteger, DejalStringFoldingOptions)
+{
+    DejalStringFoldingCase = 1 << 0,
+    DejalStringFoldingDiacritics = 1 << 1,
+    DejalStringFoldingSpaces = 1 << 2,
+    DejalStringFoldingNonLetters = 1 << 3,
+    DejalStringFoldingNonAlphanumerics = 1 << 4
+};
+
 
 @interface NSString (Dejal)
 
@@ -74,6 +86,8 @@
 
 - (NSString *)dejal_stringByRemovingCharactersInSet:(NSCharacterSet *)set;
 - (NSString *)dejal_stringByRemovingDiacriticalMarks;
+- (NSString *)dejal_stringByFoldingWithOptions:(DejalStringFoldingOptions)options;
++ (NSArray *)dejal_stringsByFoldingStrings:(NSArray *)strings withOptions:(DejalStringFoldingOptions)options;
 - (NSString *)dejal_stringByRemovingQuotesAndSpaces;
 
 - (NSString *)dejal_stringByRemovingPrefix:(NSString *)prefix;
@@ -109,12 +123,16 @@
 - (NSString *)dejal_reverse;
 
 - (NSUInteger)dejal_checksum;
+- (uint64_t)dejal_hash64;
+- (uint64_t)dejal_hash64WithSeed:(uint64_t)seed;
 
 - (NSString *)dejal_mask;
 - (NSString *)dejal_unmask;
 
 - (NSString *)dejal_encodeAsBase64UsingEncoding:(NSStringEncoding)encoding;
+- (NSString *)dejal_encodeAsBase64UsingEncoding:(NSStringEncoding)encoding options:(DejalBase64Options)options;
 - (NSString *)dejal_decodeFromBase64UsingEncoding:(NSStringEncoding)encoding;
+- (NSString *)dejal_decodeFromBase64UsingEncoding:(NSStringEncoding)encoding options:(DejalBase64Options)options;
 
 - (NSString *)dejal_rotate13;
 
@@ -132,6 +150,15 @@
 // ----------------------------------------------------------------------------------------
 
 
+typedef NS_ENUM(NSInteger, DejalURLOperation)
+{
+    DejalURLOperationAddPercentEscapes = 0,
+    DejalURLOperationReplacePercentEscapes,
+    DejalURLOperationMakeURLSafe,
+    DejalURLOperationClean
+};
+
+
 @interface NSString (DejalInternet)
 
 - (NSString *)dejal_stringByReplacingPercentEscapes;
@@ -139,6 +166,8 @@
 
 - (NSString *)dejal_stringByMakingURLSafe;
 
++ (NSArray *)dejal_stringsByApplyingURLOperation:(DejalURLOperation)operation toStrings:(NSArray *)strings defaultScheme:(NSString *)scheme;
+
 - (NSString *)dejal_stringByStrippingHTML;
 
 - (NSString *)dejal_stringByCleaningURL;
@@ -161,6 +190,7 @@
 
 - (NSString *)dejal_lastPathComponentWithoutExtension;
 
+- (NSString *)dejal_stringByInsertingBeforePathExtension:(NSString *)insertion;
 - (NSString *)dejal_backupFilePath;
 
 - (NSString *)dejal_uniquePath;
@@ -208,3 +238,54 @@
 
 @end
 
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalHTMLTextExtractor : NSObject
+
+@property (nonatomic, copy, readonly) void (^textHandler)(NSString *text);
+
+- (instancetype)init;
+- (instancetype)initWithTextHandler:(void (^)(NSString *text))textHandler;
+
+- (void)appendCharacters:(const unichar *)characters length:(NSUInteger)length;
+- (void)appendString:(NSString *)string;
+- (void)appendUTF8Bytes:(const uint8_t *)bytes length:(NSUInteger)length;
+- (BOOL)appendContentsOfStream:(NSInputStream *)stream;
+- (BOOL)appendContentsOfFile:(NSString *)path;
+
+- (NSString *)finish;
+
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@interface DejalTextScanner : NSObject
+
+@property (nonatomic, readonly) NSUInteger wrapLength;
+@property (nonatomic, copy, readonly) void (^lineHandler)(NSString *line);
+
+@property (nonatomic, readonly) NSUInteger characterCount;
+@property (nonatomic, readonly) NSUInteger wordCount;
+@property (nonatomic, readonly) NSUInteger paragraphCount;
+
+- (instancetype)init;
+- (instancetype)initWithWrapLength:(NSUInteger)wrapLength lineHandler:(void (^)(NSString *line))lineHandler;
+
+- (void)appendCharacters:(const unichar *)characters length:(NSUInteger)length;
+- (void)appendString:(NSString *)string;
+- (void)appendUTF8Bytes:(const uint8_t *)bytes length:(NSUInteger)length;
+- (BOOL)appendContentsOfStream:(NSInputStream *)stream;
+- (BOOL)appendContentsOfFile:(NSString *)path;
+
+- (void)finish;
+
+@end
+
@@ -30,1193 +30,3048 @@
 #import "NSString+Dejal.h"
 #import "NSArray+Dejal.h"
 #import "NSDictionary+Dejal.h"
+#import "NSFileManager+Dejal.h"
+#import <stdatomic.h>
+
+#if defined(__x86_64__)
+#import <immintrin.h>
+#define DEJAL_CHARACTER_SET_SSSE3 1
+#elif defined(__aarch64__) || defined(__arm64__)
+#import <arm_neon.h>
+#define DEJAL_CHARACTER_SET_NEON 1
+#endif
 
 
-@implementation NSString (Dejal)
+// Maximum number of character set bitmaps kept by the character filtering methods:
+#define DEJAL_CHARACTER_SET_BITMAP_CACHE_LIMIT 32
 
-/**
- Given an integer value, returns the corresponding string.
- 
- @author DJS 2008-07.
-*/
+// Number of bytes in the Basic Multilingual Plane portion of a character set bitmap representation:
+#define DEJAL_CHARACTER_SET_BMP_BITMAP_LENGTH 8192
 
-+ (NSString *)dejal_stringWithIntegerValue:(NSInteger)value;
-{
-#if TARGET_OS_IPHONE
-    return [self stringWithFormat:@"%ld", (long)value];
-#else
-    return [self stringWithFormat:@"%ld", value];
-#endif
-}
+// Strings up to this length are filtered in a buffer on the stack:
+#define DEJAL_STACK_CHARACTER_BUFFER_LENGTH 256
 
-/**
- Given a CGFloat value and the number of decimal places to represent it as, returns the corresponding string.
- 
- @author DJS 2005-04.
-*/
+// Number of characters screened at a time by the vector scan of a character set bitmap:
+#define DEJAL_CHARACTER_SET_VECTOR_LENGTH 16
 
-+ (NSString *)dejal_stringWithFloatValue:(CGFloat)value places:(NSInteger)places
+
+@interface DejalCharacterSetBitmapEntry : NSObject
 {
-#if TARGET_OS_IPHONE
-    NSString *format = [self stringWithFormat:@"%%.%ldf", (long)places];
-#else
-    NSString *format = [self stringWithFormat:@"%%.%ldf", places];
-#endif
-    
-    return [self stringWithFormat:format, value];
+@public
+    NSData *bitmap;
+    NSUInteger hash;    // Hash of the set when the bitmap was built
 }
 
+@end
+
+
+@implementation DejalCharacterSetBitmapEntry
+
+@end
+
+
 /**
- Given a CGFloat value, returns the corresponding string, with as many non-zero digits in the decimal portion as appropriate.
+ Returns the bitmap of the Basic Multilingual Plane portion of the character set, i.e. a bit for each unichar value, which is exactly what -characterIsMember: tests.  Bitmaps are cached per character set, since building them is relatively expensive; the returned data keeps the bitmap alive.  The cache is keyed by the identity of the set, so a lookup doesn't copy or compare sets.  A mutable set that has changed since its bitmap was built is caught via its hash, which character sets derive from their contents, and gets a new bitmap.  The cache retains its sets, so they can't be replaced by new sets at the same address, and is emptied when full.
  
- @author DJS 2013-01.
-*/
+ @author DJS 2026-10.
+ */
 
-+ (NSString *)dejal_stringWithTruncatedFloatValue:(CGFloat)value;
+static NSData *DejalCharacterSetBitmap(NSCharacterSet *set)
 {
-    NSMutableString *mutie = [[self stringWithFormat:@"%f", value] mutableCopy];
+    static NSMapTable *cache = nil;
+    static NSLock *lock = nil;
+    static dispatch_once_t onceToken;
     
-    while ([mutie hasSuffix:@"0"])
-        [mutie deleteCharactersInRange:NSMakeRange([mutie length] - 1, 1)];
+    dispatch_once(&onceToken, ^
+                  {
+                      cache = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory capacity:DEJAL_CHARACTER_SET_BITMAP_CACHE_LIMIT];
+                      lock = [NSLock new];
+                  });
     
-    if ([mutie hasSuffix:@"."])
-        [mutie deleteCharactersInRange:NSMakeRange([mutie length] - 1, 1)];
+    NSUInteger hash = set.hash;
+    DejalCharacterSetBitmapEntry *entry;
     
-    return mutie;
+    [lock lock];
+    entry = [cache objectForKey:set];
+    [lock unlock];
+    
+    if (entry && entry->hash == hash)
+        return entry->bitmap;
+    
+    NSData *representation = set.bitmapRepresentation;
+    NSData *bitmap;
+    
+    if (representation.length >= DEJAL_CHARACTER_SET_BMP_BITMAP_LENGTH)
+        bitmap = [representation subdataWithRange:NSMakeRange(0, DEJAL_CHARACTER_SET_BMP_BITMAP_LENGTH)];
+    else
+    {
+        NSMutableData *padded = [NSMutableData dataWithLength:DEJAL_CHARACTER_SET_BMP_BITMAP_LENGTH];
+        
+        [padded replaceBytesInRange:NSMakeRange(0, representation.length) withBytes:representation.bytes];
+        bitmap = padded;
+    }
+    
+    entry = [DejalCharacterSetBitmapEntry new];
+    entry->bitmap = bitmap;
+    entry->hash = hash;
+    
+    [lock lock];
+    
+    if (cache.count >= DEJAL_CHARACTER_SET_BITMAP_CACHE_LIMIT && ![cache objectForKey:set])
+        [cache removeAllObjects];
+    
+    [cache setObject:entry forKey:set];
+    
+    [lock unlock];
+    
+    return bitmap;
 }
 
 /**
- Given an NSInteger value, if it is zero, the zero string is returned; if one, the singular string is returned; otherwise the plural string is returned.
-*/
+ Returns YES if the character is set in the bitmap from DejalCharacterSetBitmap().
+ 
+ @author DJS 2026-10.
+ */
 
-+ (NSString *)dejal_stringWithIntegerValue:(NSInteger)value
-                                zero:(NSString *)zero
-                            singular:(NSString *)singular
-                              plural:(NSString *)plural;
+static inline BOOL DejalBitmapContainsCharacter(const uint8_t *bitmap, unichar character)
 {
-    if (!value && zero)
-        return zero;
-    else if ((value == 1 || value == -1) && singular)
-        return singular;
-    else
-        return plural;
+    return (bitmap[character >> 3] >> (character & 7)) & 1;
 }
 
+#if DEJAL_CHARACTER_SET_SSSE3 || DEJAL_CHARACTER_SET_NEON
+
 /**
- Given a CGFloat value, if it is zero, the zero string is returned; if exactly one, the singular string is returned; otherwise the plural string is returned.
+ Fills in the nibble tables used by the vector scan for the ASCII portion of the bitmap: entry n of the low table has bit h set if the character h * 16 + n is in the set, and entry h of the high table is the bit for h, or zero beyond the ASCII range.  ANDing the low table entry for a character's low nibble with the high table entry for its high nibble is then non-zero exactly when the character is in the set.
  
- @author DJS 2008-04.
- @version DJS 2014-01: changed to treat -1.0 as singular too.
-*/
+ @author DJS 2026-10.
+ */
 
-+ (NSString *)dejal_stringWithFloatValue:(CGFloat)value
-                              zero:(NSString *)zero
-                          singular:(NSString *)singular
-                            plural:(NSString *)plural;
+static void DejalGetBitmapNibbleTables(const uint8_t *bitmap, uint8_t lowTable[16], uint8_t highTable[16])
 {
-    if (!value && zero)
-        return zero;
-    else if ((value == 1.0 || value == -1.0) && singular)
-        return singular;
-    else
-        return plural;
+    for (NSUInteger low = 0; low < 16; low++)
+    {
+        uint8_t bits = 0;
+        
+        for (NSUInteger high = 0; high < 8; high++)
+            bits |= DejalBitmapContainsCharacter(bitmap, (unichar)(high * 16 + low)) << high;
+        
+        lowTable[low] = bits;
+        highTable[low] = low < 8 ? (uint8_t)(1 << low) : 0;
+    }
 }
 
-/**
- Given a time interval, returns a string with that interval and appropriate time units.  This might be better as a NSFormatter subclass for time intervals?
-
- @author DJS 2009-09.
-*/
+#endif
 
-+ (NSString *)dejal_stringWithTimeInterval:(NSTimeInterval)seconds;
-{
-    return [self dejal_stringWithTimeInterval:seconds suffix:nil];
-}
+#if DEJAL_CHARACTER_SET_SSSE3
 
 /**
- Given a time interval and suffix (e.g. "ago"), returns a string with that interval, appropriate time units, and the suffix, e.g. "3.2 minutes ago".  This might be better as a NSFormatter subclass for time intervals?
+ Returns YES if the processor supports SSSE3, which the x86 vector scan needs for its byte shuffles.
  
- @author DJS 2009-09.
-*/
+ @author DJS 2026-10.
+ */
 
-+ (NSString *)dejal_stringWithTimeInterval:(NSTimeInterval)seconds suffix:(NSString *)suffix;
+static BOOL DejalCharacterSetHasSSSE3(void)
 {
-    NSString *value;
-    CGFloat minutes = seconds / 60.0;
-    CGFloat hours = minutes / 60.0;
-    CGFloat days = hours / 24.0;
-    CGFloat weeks = days / 7.0;
-    CGFloat months = days / 31.0;
-    CGFloat years = months / 12.0;
-
-    if (years >= 1.0)
-        value = [NSString stringWithFormat:@"%.1f %@", years, [NSString dejal_stringWithFloatValue:years zero:nil singular:@"year" plural:@"years"]];
-    else if (months >= 1.0)
-        value = [NSString stringWithFormat:@"%.1f %@", months, [NSString dejal_stringWithFloatValue:months zero:nil singular:@"month" plural:@"months"]];
-    else if (weeks >= 1.0)
-        value = [NSString stringWithFormat:@"%.1f %@", weeks, [NSString dejal_stringWithFloatValue:weeks zero:nil singular:@"week" plural:@"weeks"]];
-    else if (days >= 1.0)
-        value = [NSString stringWithFormat:@"%.1f %@", days, [NSString dejal_stringWithFloatValue:days zero:nil singular:@"day" plural:@"days"]];
-    else if (hours >= 1.0)
-        value = [NSString stringWithFormat:@"%.1f %@", hours, [NSString dejal_stringWithFloatValue:hours zero:nil singular:@"hour" plural:@"hours"]];
-    else if (minutes >= 1.0)
-        value = [NSString stringWithFormat:@"%.1f %@", minutes, [NSString dejal_stringWithFloatValue:minutes zero:nil singular:@"minute" plural:@"minutes"]];
-    else
-        value = [NSString stringWithFormat:@"%.1f %@", seconds, [NSString dejal_stringWithFloatValue:seconds zero:nil singular:@"second" plural:@"seconds"]];
+    static BOOL supported = NO;
+    static dispatch_once_t onceToken;
     
-    if (suffix.length)
-        value = [value stringByAppendingFormat:@" %@", suffix];
+    dispatch_once(&onceToken, ^
+                  {
+                      __builtin_cpu_init();
+                      supported = __builtin_cpu_supports("ssse3") != 0;
+                  });
     
-    return value;
+    return supported;
 }
 
 /**
- Given a time interval and suffix (e.g. "ago"), returns a string with that interval (rounded to the nearest whole number), appropriate time units, and the suffix, e.g. "3 minutes ago".  This might be better as a NSFormatter subclass for time intervals?
+ Returns the offset of the first of the 16 characters that is in the set per the nibble tables, or 16 if none are, or -1 if any of the characters are outside ASCII, so the caller needs to test them one at a time.
  
- @author DJS 2009-09.
-*/
+ @author DJS 2026-10.
+ */
 
-+ (NSString *)dejal_stringWithRoundedTimeInterval:(NSTimeInterval)seconds suffix:(NSString *)suffix;
+__attribute__((target("ssse3")))
+static inline NSInteger DejalScanVectorOfCharacters(const unichar *characters, __m128i lowTable, __m128i highTable)
 {
-    NSString *value;
-    CGFloat minutes = seconds / 60.0;
-    CGFloat hours = minutes / 60.0;
-    CGFloat days = hours / 24.0;
-    CGFloat weeks = days / 7.0;
-    CGFloat months = days / 31.0;
-    CGFloat years = months / 12.0;
+    __m128i first = _mm_loadu_si128((const __m128i *)characters);
+    __m128i second = _mm_loadu_si128((const __m128i *)(characters + 8));
+    __m128i nonASCII = _mm_and_si128(_mm_or_si128(first, second), _mm_set1_epi16((short)0xFF80));
     
-    if (years >= 1.0)
-        value = [NSString stringWithFormat:@"%.0f %@", rintf(years), [NSString dejal_stringWithIntegerValue:rintf(years) zero:nil singular:@"year" plural:@"years"]];
-    else if (months >= 1.0)
-        value = [NSString stringWithFormat:@"%.0f %@", rintf(months), [NSString dejal_stringWithIntegerValue:rintf(months) zero:nil singular:@"month" plural:@"months"]];
-    else if (weeks >= 1.0)
-        value = [NSString stringWithFormat:@"%.0f %@", rintf(weeks), [NSString dejal_stringWithIntegerValue:rintf(weeks) zero:nil singular:@"week" plural:@"weeks"]];
-    else if (days >= 1.0)
-        value = [NSString stringWithFormat:@"%.0f %@", rintf(days), [NSString dejal_stringWithIntegerValue:rintf(days) zero:nil singular:@"day" plural:@"days"]];
-    else if (hours >= 1.0)
-        value = [NSString stringWithFormat:@"%.0f %@", rintf(hours), [NSString dejal_stringWithIntegerValue:rintf(hours) zero:nil singular:@"hour" plural:@"hours"]];
-    else if (minutes >= 1.0)
-        value = [NSString stringWithFormat:@"%.0f %@", rintf(minutes), [NSString dejal_stringWithIntegerValue:rintf(minutes) zero:nil singular:@"minute" plural:@"minutes"]];
-    else
-        value = [NSString stringWithFormat:@"%.0f %@", rintf(seconds), [NSString dejal_stringWithIntegerValue:rintf(seconds) zero:nil singular:@"second" plural:@"seconds"]];
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(nonASCII, _mm_setzero_si128())) != 0xFFFF)
+        return -1;
     
-    if (suffix.length)
-        value = [value stringByAppendingFormat:@" %@", suffix];
+    __m128i bytes = _mm_packus_epi16(first, second);
+    __m128i nibbleMask = _mm_set1_epi8(0x0F);
+    __m128i lowBits = _mm_shuffle_epi8(lowTable, _mm_and_si128(bytes, nibbleMask));
+    __m128i highBits = _mm_shuffle_epi8(highTable, _mm_and_si128(_mm_srli_epi16(bytes, 4), nibbleMask));
+    __m128i misses = _mm_cmpeq_epi8(_mm_and_si128(lowBits, highBits), _mm_setzero_si128());
+    unsigned int hits = ~(unsigned int)_mm_movemask_epi8(misses) & 0xFFFF;
     
-    return value;
+    return hits ? __builtin_ctz(hits) : DEJAL_CHARACTER_SET_VECTOR_LENGTH;
 }
 
 /**
- Given an integer value representing a time in seconds, and the appropriate words for minutes and seconds in singular and plural, this returns a string expressing this time interval, e.g. @"1 minute 37 seconds".  Pass nil for the minutes or seconds parameter pairs to exclude those units, e.g. passing nil for secondSingular and secondsPlural will result in just "1 minute".  If both are wanted, and one is zero, it is omitted [if different behavor is desired in the future, add a parameter to indicate that; don't change that functionality].  Similar methods can be added to include the option of hours, etc, as needed.
+ Screens the characters 16 at a time via DejalScanVectorOfCharacters(), testing any blocks that include non-ASCII characters one at a time.  Returns the index of the first character in the set, or the index where fewer than 16 characters remain.
  
- @author DJS 2003-07.
-*/
+ @author DJS 2026-10.
+ */
 
-+ (NSString *)dejal_stringWithSeconds:(NSInteger)seconds
-                 minuteSingular:(NSString *)minuteSingular
-                  minutesPlural:(NSString *)minutesPlural
-                 secondSingular:(NSString *)secondSingular
-                  secondsPlural:(NSString *)secondsPlural
+__attribute__((target("ssse3")))
+static NSUInteger DejalScanCharactersInBitmap(const unichar *characters, NSUInteger length, const uint8_t *bitmap)
 {
-    NSString *minutesString = nil;
-    NSString *secondsString = nil;
-    NSString *timeString = nil;
-    NSInteger minutes = seconds / 60;
-
-    BOOL wantSeconds = (secondSingular && secondsPlural);
-    BOOL wantMinutes = (minuteSingular && minutesPlural);
+    uint8_t lowBytes[16], highBytes[16];
+    NSUInteger i = 0;
     
-    if (wantMinutes)
+    DejalGetBitmapNibbleTables(bitmap, lowBytes, highBytes);
+    
+    __m128i lowTable = _mm_loadu_si128((const __m128i *)lowBytes);
+    __m128i highTable = _mm_loadu_si128((const __m128i *)highBytes);
+    
+    for (; i + DEJAL_CHARACTER_SET_VECTOR_LENGTH <= length; i += DEJAL_CHARACTER_SET_VECTOR_LENGTH)
     {
-        seconds = seconds % 60;
+        NSInteger offset = DejalScanVectorOfCharacters(characters + i, lowTable, highTable);
         
-#if TARGET_OS_IPHONE
-        minutesString = [self stringWithFormat:@"%ld %@", (long)minutes,
-            [self dejal_stringWithIntegerValue:minutes zero:nil singular:minuteSingular plural:minutesPlural]];
-#else
-        minutesString = [self stringWithFormat:@"%ld %@", minutes,
-                         [self dejal_stringWithIntegerValue:minutes zero:nil singular:minuteSingular plural:minutesPlural]];
-#endif
+        if (offset < 0)
+        {
+            for (NSUInteger j = i; j < i + DEJAL_CHARACTER_SET_VECTOR_LENGTH; j++)
+                if (DejalBitmapContainsCharacter(bitmap, characters[j]))
+                    return j;
+        }
+        else if (offset < DEJAL_CHARACTER_SET_VECTOR_LENGTH)
+        {
+            return i + offset;
+        }
     }
+    
+    return i;
+}
 
-    if (wantSeconds)
-        secondsString = [self stringWithFormat:NSLocalizedString(@"%ld %@", @"Seconds remaining"), (long)seconds,
-            [self dejal_stringWithIntegerValue:seconds zero:nil singular:secondSingular plural:secondsPlural]];
+#elif DEJAL_CHARACTER_SET_NEON
 
-    if (minutes && seconds && wantSeconds && wantMinutes)
-        timeString = [NSString stringWithFormat:@"%@ %@", minutesString, secondsString];
-    else if (minutes || !wantSeconds)
-        timeString = minutesString;
-    else
-        timeString = secondsString;
+/**
+ Returns the offset of the first of the 16 characters that is in the set per the nibble tables, or 16 if none are, or -1 if any of the characters are outside ASCII, so the caller needs to test them one at a time.
+ 
+ @author DJS 2026-10.
+ */
+
+static inline NSInteger DejalScanVectorOfCharacters(const unichar *characters, uint8x16_t lowTable, uint8x16_t highTable)
+{
+    uint16x8_t first = vld1q_u16(characters);
+    uint16x8_t second = vld1q_u16(characters + 8);
     
-    return timeString;
+    if (vmaxvq_u16(vorrq_u16(first, second)) >= 0x80)
+        return -1;
+    
+    uint8x16_t bytes = vcombine_u8(vmovn_u16(first), vmovn_u16(second));
+    uint8x16_t lowBits = vqtbl1q_u8(lowTable, vandq_u8(bytes, vdupq_n_u8(0x0F)));
+    uint8x16_t highBits = vqtbl1q_u8(highTable, vshrq_n_u8(bytes, 4));
+    uint8x16_t hits = vtstq_u8(lowBits, highBits);
+    uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hits), 4)), 0);
+    
+    return mask ? __builtin_ctzll(mask) >> 2 : DEJAL_CHARACTER_SET_VECTOR_LENGTH;
 }
 
 /**
- Given an NSInteger value, returns it as a string.  If the length of the resulting string is less than minLength, it is padded with the specified padding characters, on the left or right as requested.  [Note: currently the padding is assumed to be a single character, but support for multi-characters could be added in the future.]
-*/
+ Screens the characters 16 at a time via DejalScanVectorOfCharacters(), testing any blocks that include non-ASCII characters one at a time.  Returns the index of the first character in the set, or the index where fewer than 16 characters remain.
+ 
+ @author DJS 2026-10.
+ */
 
-+ (NSString *)dejal_stringWithIntegerValue:(NSInteger)value minimumLength:(NSUInteger)minLength paddedWith:(NSString *)padding padLeft:(BOOL)padLeft;
+static NSUInteger DejalScanCharactersInBitmap(const unichar *characters, NSUInteger length, const uint8_t *bitmap)
 {
-#if TARGET_OS_IPHONE
-    return [[self stringWithFormat:@"%ld", (long)value] dejal_stringWithMinimumLength:minLength paddedWith:padding padLeft:padLeft];
-#else
-    return [[self stringWithFormat:@"%ld", value] dejal_stringWithMinimumLength:minLength paddedWith:padding padLeft:padLeft];
-#endif
+    uint8_t lowBytes[16], highBytes[16];
+    NSUInteger i = 0;
+    
+    DejalGetBitmapNibbleTables(bitmap, lowBytes, highBytes);
+    
+    uint8x16_t lowTable = vld1q_u8(lowBytes);
+    uint8x16_t highTable = vld1q_u8(highBytes);
+    
+    for (; i + DEJAL_CHARACTER_SET_VECTOR_LENGTH <= length; i += DEJAL_CHARACTER_SET_VECTOR_LENGTH)
+    {
+        NSInteger offset = DejalScanVectorOfCharacters(characters + i, lowTable, highTable);
+        
+        if (offset < 0)
+        {
+            for (NSUInteger j = i; j < i + DEJAL_CHARACTER_SET_VECTOR_LENGTH; j++)
+                if (DejalBitmapContainsCharacter(bitmap, characters[j]))
+                    return j;
+        }
+        else if (offset < DEJAL_CHARACTER_SET_VECTOR_LENGTH)
+        {
+            return i + offset;
+        }
+    }
+    
+    return i;
 }
 
+#endif
+
 /**
- Given an NSInteger value, returns it as a string with the specified number of digits.  If there are less digits in the number, it is padded with leading zeroes.  If there are more, it is truncated to that number of digits.  Note that this is equivalent to the somewhat shorter, but less intuitive, +[NSString stringWithFormat:@"%0.4d", value], where the 4 is replaced by the number of digits, except that that approach won't truncate a longer number.
+ Returns the index of the first character in the buffer that is in the bitmap, or the length if none are.  On x86-64 with SSSE3 and on ARM64, strings of at least 16 characters are screened 16 characters per step with vector byte shuffles against the ASCII portion of the bitmap, via DejalScanCharactersInBitmap(); elsewhere, and for the remainder, each character is tested in turn.
  
- @author DJS 2004-03.
-*/
+ @author DJS 2026-10.
+ */
 
-+ (NSString *)dejal_stringWithLeadingZeroesForIntegerValue:(NSInteger)value digits:(NSInteger)digits;
+static NSUInteger DejalIndexOfFirstCharacterInBitmap(const unichar *characters, NSUInteger length, const uint8_t *bitmap)
 {
-#if TARGET_OS_IPHONE
-    return [[self stringWithFormat:@"%0.10ld", (long)value] dejal_right:digits];
-#else
-    return [[self stringWithFormat:@"%0.10ld", value] dejal_right:digits];
+    NSUInteger i = 0;
+    
+#if DEJAL_CHARACTER_SET_SSSE3
+    if (length >= DEJAL_CHARACTER_SET_VECTOR_LENGTH && DejalCharacterSetHasSSSE3())
+        i = DejalScanCharactersInBitmap(characters, length, bitmap);
+#elif DEJAL_CHARACTER_SET_NEON
+    if (length >= DEJAL_CHARACTER_SET_VECTOR_LENGTH)
+        i = DejalScanCharactersInBitmap(characters, length, bitmap);
 #endif
+    
+    for (; i < length; i++)
+        if (DejalBitmapContainsCharacter(bitmap, characters[i]))
+            return i;
+    
+    return length;
 }
 
 /**
- Given a value in bytes, returns it as a string with the suffix " bytes", " KB", " MB", or " GB", as appropriate.
-*/
+ Returns the string with all characters in the set removed, in a single pass over a buffer of its characters; or nil if no characters are in the set, so the caller can use the original string without copying it.
+ 
+ @author DJS 2026-10.
+ */
 
-+ (NSString *)dejal_stringAsBytesWithInteger:(NSInteger)bytes;
+static NSString *DejalStringByRemovingCharactersInSet(NSString *string, NSCharacterSet *set)
 {
-    NSString *temp;
-    CGFloat kilobyte = 1024.0;
-    CGFloat megabyte = kilobyte * kilobyte;
-    CGFloat gigabyte = megabyte * kilobyte;
+    NSUInteger length = string.length;
     
-    if (bytes == 0)
-        temp = NSLocalizedStringFromTable(@"Zero KB", @"DejalOpen", @"Zero Kilobytes");
-    else if (bytes >= gigabyte)
-        temp = [self stringWithFormat:NSLocalizedStringFromTable(@"%.1f GB", @"DejalOpen", @"Gigabytes"), bytes / gigabyte];
-    else if (bytes >= megabyte)
-        temp = [self stringWithFormat:NSLocalizedStringFromTable(@"%.1f MB", @"DejalOpen", @"Megabytes"), bytes / megabyte];
-    else if (bytes >= kilobyte)
-        temp = [self stringWithFormat:NSLocalizedStringFromTable(@"%.1f KB", @"DejalOpen", @"Kilobytes"), bytes / kilobyte];
-    else
-        temp = [self stringWithFormat:NSLocalizedStringFromTable(@"%ld bytes", @"DejalOpen", @"Bytes"), (long)bytes];
-
-    return temp;
-}
-
-/**
- If the keyword is a valid non-empty string, returns a string containing the prefix, keyword, and suffix (the prefix and/or suffix may be nil if desired).  Otherwise, if the alternative is a valid non-empty string, returns that instead.  If both the keyword and alternative are nil, nil is returned, so if you want a valid string, pass @"" for at least the alternative.
- 
- @author DJS 2004-03.
-*/
-
-+ (NSString *)dejal_stringWithPrefix:(NSString *)prefix keyword:(NSString *)keyword suffix:(NSString *)suffix or:(NSString *)alternative;
-{
-    if (!keyword && !alternative)
+    if (!length || !set)
         return nil;
     
-    NSMutableString *retString = [NSMutableString string];
+    NSData *bitmapData = DejalCharacterSetBitmap(set);
+    const uint8_t *bitmap = bitmapData.bytes;
+    unichar stackBuffer[DEJAL_STACK_CHARACTER_BUFFER_LENGTH];
+    unichar *characters = length <= DEJAL_STACK_CHARACTER_BUFFER_LENGTH ? stackBuffer : malloc(length * sizeof(unichar));
+    NSString *result = nil;
     
-    [retString dejal_appendPrefix:prefix keyword:keyword suffix:suffix or:alternative];
+    [string getCharacters:characters range:NSMakeRange(0, length)];
     
-    return retString;
+    NSUInteger written = DejalIndexOfFirstCharacterInBitmap(characters, length, bitmap);
+    
+    if (written < length)
+    {
+        for (NSUInteger i = written + 1; i < length; i++)
+        {
+            unichar character = characters[i];
+            
+            if (!DejalBitmapContainsCharacter(bitmap, character))
+                characters[written++] = character;
+        }
+        
+        result = [[NSString alloc] initWithCharacters:characters length:written];
+    }
+    
+    if (characters != stackBuffer)
+        free(characters);
+    
+    return result;
 }
 
-/**
- Gotta be one of the shortest method names!  If preferred is not nil, that object is returned, otherwise self is returned.  Useful to provide an optional string, e.g. [@"never" or:someDateObject].
- 
- @author DJS 2002.
-*/
 
-- (id)dejal_or:(id)preferred;
-{
-    if (preferred)
-        return preferred;
-    else
-        return self;
-}
+// Folding table entries: zero means not yet computed, otherwise one of these, or the folded character plus one:
+#define DEJAL_FOLDING_TABLE_REMOVED 0x10001
+#define DEJAL_FOLDING_TABLE_EXPANDED 0x10002
+
+// Number of strings above which the batch folding method folds across threads:
+#define DEJAL_FOLDING_CONCURRENT_THRESHOLD 1024
+
 
 /**
- Given a string with two or more alternatives separated by " | ", returns the string at the specified index.  Can be used as a horribly inefficient variation on bool ? str1 : str2, or to get one of several values based on an integer.  Particularly useful with localized strings, since several can be combined into one string.  If the index is greater than the number of alternatives, an empty string is returned.
+ Returns the string with all characters in the set removed, like DejalStringByRemovingCharactersInSet(), but treating surrogate pairs as single characters, as -rangeOfCharacterFromSet: does.  Always returns a string.
  
- @author DJS 2010-10.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_indexedBy:(NSUInteger)idx;
+static NSString *DejalStringByRemovingLongCharactersInSet(NSString *string, NSCharacterSet *set)
 {
-    NSArray *alternatives = [self componentsSeparatedByString:@" | "];
+    NSUInteger length = string.length;
+    NSRange range = [string rangeOfCharacterFromSet:set];
     
-    if (idx < [alternatives count])
-	    return alternatives[idx];
-    else
-        return @"";
+    if (range.location == NSNotFound)
+        return string;
+    
+    NSMutableString *result = [NSMutableString stringWithCapacity:length];
+    NSUInteger location = 0;
+    
+    while (range.location != NSNotFound)
+    {
+        [result appendString:[string substringWithRange:NSMakeRange(location, range.location - location)]];
+        location = NSMaxRange(range);
+        range = [string rangeOfCharacterFromSet:set options:0 range:NSMakeRange(location, length - location)];
+    }
+    
+    [result appendString:[string substringFromIndex:location]];
+    
+    return result;
 }
 
 /**
- Returns YES if the string is non-empty, i.e. not nil and not @"".
+ Returns the string with the case and/or diacritic folding in the options applied using Foundation, i.e. lowercased, and/or canonically decomposed with the non-base (combining) characters removed.  This is the reference behavior that the folding table reproduces a character at a time.
  
- @author DJS 2005-03.
-*/
+ @author DJS 2026-10.
+ */
 
-- (BOOL)dejal_containsSomething
+static NSString *DejalFoundationFoldedString(NSString *string, DejalStringFoldingOptions options)
 {
-    return ([self length] > 0);
+    if (options & DejalStringFoldingCase)
+        string = string.lowercaseString;
+    
+    if (options & DejalStringFoldingDiacritics)
+        string = DejalStringByRemovingLongCharactersInSet(string.decomposedStringWithCanonicalMapping, [NSCharacterSet nonBaseCharacterSet]);
+    
+    return string;
 }
 
 /**
- Returns YES if the subString is within the receiver, otherwise NO.  [Note: can easily extend this to take options, and to take a range; see -rangeOfString:options:range:]
+ Returns the folding table entry for the character, for the case and/or diacritic folding options, computing it the first time.  There is a table per combination of those options, each with an entry per Basic Multilingual Plane character.
  
- This method has been removed, as NSString has -containsString: on 10.10 and later.
-*/
+ @author DJS 2026-10.
+ */
 
-/*
-- (BOOL)dejal_containsString:(NSString *)subString;
+static uint32_t DejalFoldingTableEntry(unichar character, DejalStringFoldingOptions options)
 {
-    NSRange range = [self rangeOfString:subString];
-
-    return range.location != NSNotFound;
+    static _Atomic(atomic_uint *) tables[4];
+    NSUInteger tableIndex = options & (DejalStringFoldingCase | DejalStringFoldingDiacritics);
+    atomic_uint *table = atomic_load(&tables[tableIndex]);
+    
+    if (!table)
+    {
+        atomic_uint *newTable = calloc(65536, sizeof(atomic_uint));
+        atomic_uint *expected = NULL;
+        
+        if (atomic_compare_exchange_strong(&tables[tableIndex], &expected, newTable))
+            table = newTable;
+        else
+        {
+            free(newTable);
+            table = expected;
+        }
+    }
+    
+    uint32_t entry = atomic_load_explicit(&table[character], memory_order_relaxed);
+    
+    if (!entry)
+    {
+        NSString *folded = DejalFoundationFoldedString([NSString stringWithCharacters:&character length:1], options);
+        
+        if (!folded.length)
+            entry = DEJAL_FOLDING_TABLE_REMOVED;
+        else if (folded.length == 1)
+            entry = (uint32_t)[folded characterAtIndex:0] + 1;
+        else
+            entry = DEJAL_FOLDING_TABLE_EXPANDED;
+        
+        atomic_store_explicit(&table[character], entry, memory_order_relaxed);
+    }
+    
+    return entry;
 }
-*/
 
 /**
- Returns YES if the subString is within the receiver, otherwise NO.  The case of both strings is ignored.
+ Returns the string folded per the options (see -dejal_stringByFoldingWithOptions:), or nil if folding doesn't change it.
  
- @author DJS 2004-12.
- @version DJS 2015-01: This method has been removed, as NSString has -localizedCaseInsensitiveContainsString: on 10.10 and later..
-*/
+ Case and diacritic folding is done a character at a time: ASCII directly, and other characters via the cached folding table.  Foundation is used for the whole string instead if it contains surrogate pairs, or a capital sigma when folding case, since lowercasing that depends on the following character.  The removal options are then applied in the same buffer.
+ 
+ @author DJS 2026-10.
+ */
 
-/*
-- (BOOL)dejal_containsStringCaseInsensitive:(NSString *)subString;
+static NSString *DejalFoldedString(NSString *string, DejalStringFoldingOptions options)
 {
-    NSRange range = [self rangeOfString:subString options:NSCaseInsensitiveSearch];
+    NSUInteger length = string.length;
     
-    return range.location != NSNotFound;
+    if (!length)
+        return nil;
+    
+    BOOL foldCase = (options & DejalStringFoldingCase) != 0;
+    BOOL foldCharacters = (options & (DejalStringFoldingCase | DejalStringFoldingDiacritics)) != 0;
+    NSUInteger capacity = length;
+    unichar *characters = malloc(capacity * sizeof(unichar));
+    NSUInteger count = length;
+    BOOL changed = NO;
+    
+    [string getCharacters:characters range:NSMakeRange(0, length)];
+    
+    if (foldCharacters)
+    {
+        NSUInteger i = 0;
+        
+        for (; i < length; i++)
+        {
+            unichar character = characters[i];
+            
+            if (character < 0x80)
+            {
+                if (foldCase && character >= 'A' && character <= 'Z')
+                {
+                    characters[i] = character + ('a' - 'A');
+                    changed = YES;
+                }
+            }
+            else if (CFStringIsSurrogateHighCharacter(character) || CFStringIsSurrogateLowCharacter(character) || (foldCase && character == 0x03A3))
+            {
+                break;
+            }
+            else if (DejalFoldingTableEntry(character, options) != (uint32_t)character + 1)
+            {
+                break;
+            }
+        }
+        
+        // Something other than ASCII case changes, so fold the rest into a separate buffer:
+        if (i < length)
+        {
+            unichar *source = characters;
+            NSUInteger written = i;
+            
+            characters = malloc(capacity * sizeof(unichar));
+            memcpy(characters, source, i * sizeof(unichar));
+            changed = YES;
+            
+            for (; i < length; i++)
+            {
+                unichar character = source[i];
+                uint32_t entry;
+                
+                if (character < 0x80)
+                {
+                    characters[written++] = foldCase && character >= 'A' && character <= 'Z' ? character + ('a' - 'A') : character;
+                    continue;
+                }
+                else if (CFStringIsSurrogateHighCharacter(character) || CFStringIsSurrogateLowCharacter(character) || (foldCase && character == 0x03A3))
+                {
+                    NSString *folded = DejalFoundationFoldedString(string, options);
+                    
+                    free(characters);
+                    written = folded.length;
+                    capacity = MAX(written, 1);
+                    characters = malloc(capacity * sizeof(unichar));
+                    [folded getCharacters:characters range:NSMakeRange(0, written)];
+                    break;
+                }
+                
+                entry = DejalFoldingTableEntry(character, options);
+                
+                if (entry == DEJAL_FOLDING_TABLE_REMOVED)
+                    continue;
+                else if (entry != DEJAL_FOLDING_TABLE_EXPANDED)
+                    characters[written++] = (unichar)(entry - 1);
+                else
+                {
+                    NSString *folded = DejalFoundationFoldedString([NSString stringWithCharacters:&character length:1], options);
+                    NSUInteger foldedLength = folded.length;
+                    
+                    if (written + foldedLength + (length - i - 1) > capacity)
+                    {
+                        capacity = written + foldedLength + (length - i - 1) + 16;
+                        characters = realloc(characters, capacity * sizeof(unichar));
+                    }
+                    
+                    [folded getCharacters:characters + written range:NSMakeRange(0, foldedLength)];
+                    written += foldedLength;
+                }
+            }
+            
+            free(source);
+            count = written;
+        }
+    }
+    
+    if (options & (DejalStringFoldingSpaces | DejalStringFoldingNonLetters | DejalStringFoldingNonAlphanumerics))
+    {
+        static NSCharacterSet *nonLetterSet = nil;
+        static NSCharacterSet *nonAlphanumericSet = nil;
+        static dispatch_once_t onceToken;
+        
+        dispatch_once(&onceToken, ^
+                      {
+                          nonLetterSet = [[NSCharacterSet lowercaseLetterCharacterSet] invertedSet];
+                          nonAlphanumericSet = [[NSCharacterSet alphanumericCharacterSet] invertedSet];
+                      });
+        
+        NSData *nonLetterData = options & DejalStringFoldingNonLetters ? DejalCharacterSetBitmap(nonLetterSet) : nil;
+        NSData *nonAlphanumericData = options & DejalStringFoldingNonAlphanumerics ? DejalCharacterSetBitmap(nonAlphanumericSet) : nil;
+        const uint8_t *nonLetters = nonLetterData.bytes;
+        const uint8_t *nonAlphanumerics = nonAlphanumericData.bytes;
+        BOOL removeSpaces = (options & DejalStringFoldingSpaces) != 0;
+        NSUInteger written = 0;
+        
+        for (NSUInteger i = 0; i < count; i++)
+        {
+            unichar character = characters[i];
+            
+            if ((removeSpaces && character == ' ') || (nonLetters && DejalBitmapContainsCharacter(nonLetters, character)) || (nonAlphanumerics && DejalBitmapContainsCharacter(nonAlphanumerics, character)))
+                continue;
+            
+            characters[written++] = character;
+        }
+        
+        if (written != count)
+            changed = YES;
+        
+        count = written;
+    }
+    
+    NSString *result = changed ? [[NSString alloc] initWithCharacters:characters length:count] : nil;
+    
+    free(characters);
+    
+    return result;
 }
-*/
 
-- (NSComparisonResult)dejal_caseAndSpaceInsensitiveCompare:(NSString *)otherString
+
+// Number of UTF-8 bytes decoded at a time by the streaming text classes:
+#define DEJAL_UTF8_DECODE_CHUNK_LENGTH 4096
+
+
+typedef struct
 {
-    NSString *selfString = [self stringByReplacingOccurrencesOfString:@" " withString:@""];
-    NSString *other = [otherString stringByReplacingOccurrencesOfString:@" " withString:@""];
+    uint8_t bytes[4];
+    NSUInteger length;
+} DejalUTF8DecoderState;
 
-    return [selfString caseInsensitiveCompare:other];
-}
 
 /**
- Returns the receiver with all characters other than digits removed.  Useful to compare two strings without extraneous punctuation etc.
+ Decodes UTF-8 bytes into UTF-16 characters, carrying an incomplete multi-byte sequence at the end over to the next call via the state.  Invalid and overlong sequences are replaced with U+FFFD.  The output must have room for length + 4 characters.  Returns the number of characters decoded.
  
- @author DJS 2008-11.
- @version DJS 2015-11: Added missing "dejal_" prefix.
+ @author DJS 2026-10.
  */
 
-- (NSString *)dejal_digitsOnly;
+static NSUInteger DejalDecodeUTF8(DejalUTF8DecoderState *state, const uint8_t *bytes, NSUInteger length, unichar *output)
 {
-    NSCharacterSet *charSet = [[NSCharacterSet decimalDigitCharacterSet] invertedSet];
+    NSUInteger count = 0;
     
-    return [self dejal_stringByRemovingCharactersInSet:charSet];
+    for (NSUInteger i = 0; i < length; i++)
+    {
+        uint8_t byte = bytes[i];
+        
+        if (state->length)
+        {
+            if ((byte & 0xC0) == 0x80)
+            {
+                state->bytes[state->length++] = byte;
+                
+                uint8_t lead = state->bytes[0];
+                NSUInteger needed = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : 2;
+                
+                if (state->length == needed)
+                {
+                    uint32_t codePoint = lead & (needed == 4 ? 0x07 : needed == 3 ? 0x0F : 0x1F);
+                    
+                    for (NSUInteger j = 1; j < needed; j++)
+                        codePoint = (codePoint << 6) | (state->bytes[j] & 0x3F);
+                    
+                    state->length = 0;
+                    
+                    if ((needed == 3 && codePoint < 0x800) || (needed == 4 && codePoint < 0x10000) || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+                    {
+                        output[count++] = 0xFFFD;
+                    }
+                    else if (codePoint > 0xFFFF)
+                    {
+                        codePoint -= 0x10000;
+                        output[count++] = (unichar)(0xD800 + (codePoint >> 10));
+                        output[count++] = (unichar)(0xDC00 + (codePoint & 0x3FF));
+                    }
+                    else
+                    {
+                        output[count++] = (unichar)codePoint;
+                    }
+                }
+                
+                continue;
+            }
+            
+            // Incomplete sequence; replace it, then handle this byte afresh:
+            state->length = 0;
+            output[count++] = 0xFFFD;
+        }
+        
+        if (byte < 0x80)
+            output[count++] = byte;
+        else if (byte >= 0xC2 && byte <= 0xF4)
+            state->bytes[state->length++] = byte;
+        else
+            output[count++] = 0xFFFD;
+    }
+    
+    return count;
 }
 
 /**
- Returns the receiver with all letter characters converted to lowercase, and all other characters removed.  Useful to compare two strings without extraneous punctuation etc.
+ Returns YES, with a U+FFFD replacement character in the output, if the state has an incomplete sequence at the end of the input; resets the state.
  
- @author DJS 2005-02.
- @version DJS 2005-04: changed to use -stringByRemovingCharactersInSet:; was incorrectly only trimming.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_lowercasedLettersOnly
+static BOOL DejalFinishDecodingUTF8(DejalUTF8DecoderState *state, unichar *output)
 {
-    NSCharacterSet *charSet = [[NSCharacterSet lowercaseLetterCharacterSet] invertedSet];
-    NSString *clean = [[self lowercaseString] dejal_stringByRemovingCharactersInSet:charSet];
+    if (!state->length)
+        return NO;
+    
+    state->length = 0;
+    *output = 0xFFFD;
     
-    return clean;
+    return YES;
 }
 
+
+// Modulus of the legacy checksum:
+#define DEJAL_CHECKSUM_MODULUS 999999999
+
+// Number of characters the legacy checksum copies at a time, when it can't access them directly:
+#define DEJAL_CHECKSUM_CHUNK_LENGTH 2048
+
+
 /**
- Returns the receiver with all letter characters converted to lowercase, and all other characters other than digits removed.  Useful to compare two strings without extraneous punctuation etc.
+ Adds the characters at the location to the legacy checksum of a string of the base length, with the same result as taking the modulus at every character, as -dejal_checksum used to.  Instead, the terms are summed for as many characters at a time as can't overflow, so the modulus is taken rarely, and the sum is a simple loop the compiler can vectorize.
  
- @author DJS 2007-10.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_lowercasedLettersOrDigitsOnly;
+static NSUInteger DejalChecksumCharacters(const unichar *characters, NSUInteger length, NSUInteger location, NSUInteger base, NSUInteger result)
 {
-    NSCharacterSet *charSet = [[NSCharacterSet alphanumericCharacterSet] invertedSet];
-    NSString *clean = [[self lowercaseString] dejal_stringByRemovingCharactersInSet:charSet];
+    NSUInteger maximumTerm;
+    NSUInteger i = 0;
+    
+    // Each term is at most (65535 * (index + 34)) + (732 * index) + (base * (index + 83)), i.e. less than this:
+    if (__builtin_mul_overflow(65535 + 732 + base, location + length + 83, &maximumTerm))
+        maximumTerm = 0;
+    
+    while (i < length)
+    {
+        NSUInteger room = maximumTerm ? (NSUIntegerMax - result) / maximumTerm : 0;
+        
+        if (!room)
+        {
+            NSUInteger index = location + i;
+            
+            result = (result + (characters[i] * (index + 34)) + (732 * index) + (base * (index + 83))) % DEJAL_CHECKSUM_MODULUS;
+            i++;
+            continue;
+        }
+        
+        NSUInteger span = MIN(room, length - i);
+        NSUInteger first = location + i;
+        NSUInteger weighted = 0;
+        
+        for (NSUInteger j = 0; j < span; j++)
+            weighted += characters[i + j] * (first + j + 34);
+        
+        NSUInteger indexSum = span * first + span * (span - 1) / 2;
+        
+        result = (result + weighted + (732 * indexSum) + (base * (indexSum + 83 * span))) % DEJAL_CHECKSUM_MODULUS;
+        i += span;
+    }
     
-    return clean;
+    return result;
 }
 
-/**
- Returns YES if the receiver contains the other string, when only looking at the letter characters, and ignoring case.
- 
- @author DJS 2005-02.
-*/
 
-- (BOOL)dejal_containsStringLetters:(NSString *)otherString
-{
-    return ([[self dejal_lowercasedLettersOnly] containsString:[otherString dejal_lowercasedLettersOnly]]);
-}
+@implementation NSString (Dejal)
 
 /**
- Returns YES if the receiver and the other string are equal when only looking at the letter characters, and ignoring case.
+ Given an integer value, returns the corresponding string.
  
- @author DJS 2005-02.
+ @author DJS 2008-07.
 */
 
-- (BOOL)dejal_isLetterEquivalentToString:(NSString *)otherString
++ (NSString *)dejal_stringWithIntegerValue:(NSInteger)value;
 {
-    return ([[self dejal_lowercasedLettersOnly] isEqualToString:[otherString dejal_lowercasedLettersOnly]]);
+#if TARGET_OS_IPHONE
+    return [self stringWithFormat:@"%ld", (long)value];
+#else
+    return [self stringWithFormat:@"%ld", value];
+#endif
 }
 
 /**
- Returns a string with all characters matching the set removed from the receiver.
+ Given a CGFloat value and the number of decimal places to represent it as, returns the corresponding string.
  
  @author DJS 2005-04.
 */
 
-- (NSString *)dejal_stringByRemovingCharactersInSet:(NSCharacterSet *)set;
++ (NSString *)dejal_stringWithFloatValue:(CGFloat)value places:(NSInteger)places
 {
-    NSMutableString *mutString = [NSMutableString stringWithString:self];
-    
-    [mutString dejal_deleteCharactersInSet:set];
+#if TARGET_OS_IPHONE
+    NSString *format = [self stringWithFormat:@"%%.%ldf", (long)places];
+#else
+    NSString *format = [self stringWithFormat:@"%%.%ldf", places];
+#endif
     
-    return [NSString stringWithString:mutString];
+    return [self stringWithFormat:format, value];
 }
 
 /**
- Returns a string with diacritical marks removed from the receiver.  For example, "expose" with an acute accent will be returned without the accent.
+ Given a CGFloat value, returns the corresponding string, with as many non-zero digits in the decimal portion as appropriate.
  
- @author DJS 2007-04.
+ @author DJS 2013-01.
 */
 
-- (NSString *)dejal_stringByRemovingDiacriticalMarks;
++ (NSString *)dejal_stringWithTruncatedFloatValue:(CGFloat)value;
 {
-    NSMutableString *mutie = [[self decomposedStringWithCanonicalMapping] mutableCopy];
-    NSCharacterSet *nonBaseSet = [NSCharacterSet nonBaseCharacterSet];
-    NSRange range = NSMakeRange([mutie length], 0);
+    NSMutableString *mutie = [[self stringWithFormat:@"%f", value] mutableCopy];
     
-    while (range.location > 0)
-    {
-        range = [mutie rangeOfCharacterFromSet:nonBaseSet options:NSBackwardsSearch range:NSMakeRange(0, range.location)];
-        
-        if (range.length == 0)
-            break;
-        
-        [mutie deleteCharactersInRange:range];
-    }
+    while ([mutie hasSuffix:@"0"])
+        [mutie deleteCharactersInRange:NSMakeRange([mutie length] - 1, 1)];
+    
+    if ([mutie hasSuffix:@"."])
+        [mutie deleteCharactersInRange:NSMakeRange([mutie length] - 1, 1)];
     
     return mutie;
 }
 
-- (NSString *)dejal_stringByRemovingQuotesAndSpaces
+/**
+ Given an NSInteger value, if it is zero, the zero string is returned; if one, the singular string is returned; otherwise the plural string is returned.
+*/
+
++ (NSString *)dejal_stringWithIntegerValue:(NSInteger)value
+                                zero:(NSString *)zero
+                            singular:(NSString *)singular
+                              plural:(NSString *)plural;
+{
+    if (!value && zero)
+        return zero;
+    else if ((value == 1 || value == -1) && singular)
+        return singular;
+    else
+        return plural;
+}
+
+/**
+ Given a CGFloat value, if it is zero, the zero string is returned; if exactly one, the singular string is returned; otherwise the plural string is returned.
+ 
+ @author DJS 2008-04.
+ @version DJS 2014-01: changed to treat -1.0 as singular too.
+*/
+
++ (NSString *)dejal_stringWithFloatValue:(CGFloat)value
+                              zero:(NSString *)zero
+                          singular:(NSString *)singular
+                            plural:(NSString *)plural;
+{
+    if (!value && zero)
+        return zero;
+    else if ((value == 1.0 || value == -1.0) && singular)
+        return singular;
+    else
+        return plural;
+}
+
+/**
+ Given a time interval, returns a string with that interval and appropriate time units.  This might be better as a NSFormatter subclass for time intervals?
+
+ @author DJS 2009-09.
+*/
+
++ (NSString *)dejal_stringWithTimeInterval:(NSTimeInterval)seconds;
+{
+    return [self dejal_stringWithTimeInterval:seconds suffix:nil];
+}
+
+/**
+ Given a time interval and suffix (e.g. "ago"), returns a string with that interval, appropriate time units, and the suffix, e.g. "3.2 minutes ago".  This might be better as a NSFormatter subclass for time intervals?
+ 
+ @author DJS 2009-09.
+*/
+
++ (NSString *)dejal_stringWithTimeInterval:(NSTimeInterval)seconds suffix:(NSString *)suffix;
+{
+    NSString *value;
+    CGFloat minutes = seconds / 60.0;
+    CGFloat hours = minutes / 60.0;
+    CGFloat days = hours / 24.0;
+    CGFloat weeks = days / 7.0;
+    CGFloat months = days / 31.0;
+    CGFloat years = months / 12.0;
+
+    if (years >= 1.0)
+        value = [NSString stringWithFormat:@"%.1f %@", years, [NSString dejal_stringWithFloatValue:years zero:nil singular:@"year" plural:@"years"]];
+    else if (months >= 1.0)
+        value = [NSString stringWithFormat:@"%.1f %@", months, [NSString dejal_stringWithFloatValue:months zero:nil singular:@"month" plural:@"months"]];
+    else if (weeks >= 1.0)
+        value = [NSString stringWithFormat:@"%.1f %@", weeks, [NSString dejal_stringWithFloatValue:weeks zero:nil singular:@"week" plural:@"weeks"]];
+    else if (days >= 1.0)
+        value = [NSString stringWithFormat:@"%.1f %@", days, [NSString dejal_stringWithFloatValue:days zero:nil singular:@"day" plural:@"days"]];
+    else if (hours >= 1.0)
+        value = [NSString stringWithFormat:@"%.1f %@", hours, [NSString dejal_stringWithFloatValue:hours zero:nil singular:@"hour" plural:@"hours"]];
+    else if (minutes >= 1.0)
+        value = [NSString stringWithFormat:@"%.1f %@", minutes, [NSString dejal_stringWithFloatValue:minutes zero:nil singular:@"minute" plural:@"minutes"]];
+    else
+        value = [NSString stringWithFormat:@"%.1f %@", seconds, [NSString dejal_stringWithFloatValue:seconds zero:nil singular:@"second" plural:@"seconds"]];
+    
+    if (suffix.length)
+        value = [value stringByAppendingFormat:@" %@", suffix];
+    
+    return value;
+}
+
+/**
+ Given a time interval and suffix (e.g. "ago"), returns a string with that interval (rounded to the nearest whole number), appropriate time units, and the suffix, e.g. "3 minutes ago".  This might be better as a NSFormatter subclass for time intervals?
+ 
+ @author DJS 2009-09.
+*/
+
++ (NSString *)dejal_stringWithRoundedTimeInterval:(NSTimeInterval)seconds suffix:(NSString *)suffix;
+{
+    NSString *value;
+    CGFloat minutes = seconds / 60.0;
+    CGFloat hours = minutes / 60.0;
+    CGFloat days = hours / 24.0;
+    CGFloat weeks = days / 7.0;
+    CGFloat months = days / 31.0;
+    CGFloat years = months / 12.0;
+    
+    if (years >= 1.0)
+        value = [NSString stringWithFormat:@"%.0f %@", rintf(years), [NSString dejal_stringWithIntegerValue:rintf(years) zero:nil singular:@"year" plural:@"years"]];
+    else if (months >= 1.0)
+        value = [NSString stringWithFormat:@"%.0f %@", rintf(months), [NSString dejal_stringWithIntegerValue:rintf(months) zero:nil singular:@"month" plural:@"months"]];
+    else if (weeks >= 1.0)
+        value = [NSString stringWithFormat:@"%.0f %@", rintf(weeks), [NSString dejal_stringWithIntegerValue:rintf(weeks) zero:nil singular:@"week" plural:@"weeks"]];
+    else if (days >= 1.0)
+        value = [NSString stringWithFormat:@"%.0f %@", rintf(days), [NSString dejal_stringWithIntegerValue:rintf(days) zero:nil singular:@"day" plural:@"days"]];
+    else if (hours >= 1.0)
+        value = [NSString stringWithFormat:@"%.0f %@", rintf(hours), [NSString dejal_stringWithIntegerValue:rintf(hours) zero:nil singular:@"hour" plural:@"hours"]];
+    else if (minutes >= 1.0)
+        value = [NSString stringWithFormat:@"%.0f %@", rintf(minutes), [NSString dejal_stringWithIntegerValue:rintf(minutes) zero:nil singular:@"minute" plural:@"minutes"]];
+    else
+        value = [NSString stringWithFormat:@"%.0f %@", rintf(seconds), [NSString dejal_stringWithIntegerValue:rintf(seconds) zero:nil singular:@"second" plural:@"seconds"]];
+    
+    if (suffix.length)
+        value = [value stringByAppendingFormat:@" %@", suffix];
+    
+    return value;
+}
+
+/**
+ Given an integer value representing a time in seconds, and the appropriate words for minutes and seconds in singular and plural, this returns a string expressing this time interval, e.g. @"1 minute 37 seconds".  Pass nil for the minutes or seconds parameter pairs to exclude those units, e.g. passing nil for secondSingular and secondsPlural will result in just "1 minute".  If both are wanted, and one is zero, it is omitted [if different behavor is desired in the future, add a parameter to indicate that; don't change that functionality].  Similar methods can be added to include the option of hours, etc, as needed.
+ 
+ @author DJS 2003-07.
+*/
+
++ (NSString *)dejal_stringWithSeconds:(NSInteger)seconds
+                 minuteSingular:(NSString *)minuteSingular
+                  minutesPlural:(NSString *)minutesPlural
+                 secondSingular:(NSString *)secondSingular
+                  secondsPlural:(NSString *)secondsPlural
+{
+    NSString *minutesString = nil;
+    NSString *secondsString = nil;
+    NSString *timeString = nil;
+    NSInteger minutes = seconds / 60;
+
+    BOOL wantSeconds = (secondSingular && secondsPlural);
+    BOOL wantMinutes = (minuteSingular && minutesPlural);
+    
+    if (wantMinutes)
+    {
+        seconds = seconds % 60;
+        
+#if TARGET_OS_IPHONE
+        minutesString = [self stringWithFormat:@"%ld %@", (long)minutes,
+            [self dejal_stringWithIntegerValue:minutes zero:nil singular:minuteSingular plural:minutesPlural]];
+#else
+        minutesString = [self stringWithFormat:@"%ld %@", minutes,
+                         [self dejal_stringWithIntegerValue:minutes zero:nil singular:minuteSingular plural:minutesPlural]];
+#endif
+    }
+
+    if (wantSeconds)
+        secondsString = [self stringWithFormat:NSLocalizedString(@"%ld %@", @"Seconds remaining"), (long)seconds,
+            [self dejal_stringWithIntegerValue:seconds zero:nil singular:secondSingular plural:secondsPlural]];
+
+    if (minutes && seconds && wantSeconds && wantMinutes)
+        timeString = [NSString stringWithFormat:@"%@ %@", minutesString, secondsString];
+    else if (minutes || !wantSeconds)
+        timeString = minutesString;
+    else
+        timeString = secondsString;
+    
+    return timeString;
+}
+
+/**
+ Given an NSInteger value, returns it as a string.  If the length of the resulting string is less than minLength, it is padded with the specified padding characters, on the left or right as requested.  [Note: currently the padding is assumed to be a single character, but support for multi-characters could be added in the future.]
+*/
+
++ (NSString *)dejal_stringWithIntegerValue:(NSInteger)value minimumLength:(NSUInteger)minLength paddedWith:(NSString *)padding padLeft:(BOOL)padLeft;
+{
+#if TARGET_OS_IPHONE
+    return [[self stringWithFormat:@"%ld", (long)value] dejal_stringWithMinimumLength:minLength paddedWith:padding padLeft:padLeft];
+#else
+    return [[self stringWithFormat:@"%ld", value] dejal_stringWithMinimumLength:minLength paddedWith:padding padLeft:padLeft];
+#endif
+}
+
+/**
+ Given an NSInteger value, returns it as a string with the specified number of digits.  If there are less digits in the number, it is padded with leading zeroes.  If there are more, it is truncated to that number of digits.  Note that this is equivalent to the somewhat shorter, but less intuitive, +[NSString stringWithFormat:@"%0.4d", value], where the 4 is replaced by the number of digits, except that that approach won't truncate a longer number.
+ 
+ @author DJS 2004-03.
+*/
+
++ (NSString *)dejal_stringWithLeadingZeroesForIntegerValue:(NSInteger)value digits:(NSInteger)digits;
+{
+#if TARGET_OS_IPHONE
+    return [[self stringWithFormat:@"%0.10ld", (long)value] dejal_right:digits];
+#else
+    return [[self stringWithFormat:@"%0.10ld", value] dejal_right:digits];
+#endif
+}
+
+/**
+ Given a value in bytes, returns it as a string with the suffix " bytes", " KB", " MB", or " GB", as appropriate.
+*/
+
++ (NSString *)dejal_stringAsBytesWithInteger:(NSInteger)bytes;
+{
+    NSString *temp;
+    CGFloat kilobyte = 1024.0;
+    CGFloat megabyte = kilobyte * kilobyte;
+    CGFloat gigabyte = megabyte * kilobyte;
+    
+    if (bytes == 0)
+        temp = NSLocalizedStringFromTable(@"Zero KB", @"DejalOpen", @"Zero Kilobytes");
+    else if (bytes >= gigabyte)
+        temp = [self stringWithFormat:NSLocalizedStringFromTable(@"%.1f GB", @"DejalOpen", @"Gigabytes"), bytes / gigabyte];
+    else if (bytes >= megabyte)
+        temp = [self stringWithFormat:NSLocalizedStringFromTable(@"%.1f MB", @"DejalOpen", @"Megabytes"), bytes / megabyte];
+    else if (bytes >= kilobyte)
+        temp = [self stringWithFormat:NSLocalizedStringFromTable(@"%.1f KB", @"DejalOpen", @"Kilobytes"), bytes / kilobyte];
+    else
+        temp = [self stringWithFormat:NSLocalizedStringFromTable(@"%ld bytes", @"DejalOpen", @"Bytes"), (long)bytes];
+
+    return temp;
+}
+
+/**
+ If the keyword is a valid non-empty string, returns a string containing the prefix, keyword, and suffix (the prefix and/or suffix may be nil if desired).  Otherwise, if the alternative is a valid non-empty string, returns that instead.  If both the keyword and alternative are nil, nil is returned, so if you want a valid string, pass @"" for at least the alternative.
+ 
+ @author DJS 2004-03.
+*/
+
++ (NSString *)dejal_stringWithPrefix:(NSString *)prefix keyword:(NSString *)keyword suffix:(NSString *)suffix or:(NSString *)alternative;
+{
+    if (!keyword && !alternative)
+        return nil;
+    
+    NSMutableString *retString = [NSMutableString string];
+    
+    [retString dejal_appendPrefix:prefix keyword:keyword suffix:suffix or:alternative];
+    
+    return retString;
+}
+
+/**
+ Gotta be one of the shortest method names!  If preferred is not nil, that object is returned, otherwise self is returned.  Useful to provide an optional string, e.g. [@"never" or:someDateObject].
+ 
+ @author DJS 2002.
+*/
+
+- (id)dejal_or:(id)preferred;
+{
+    if (preferred)
+        return preferred;
+    else
+        return self;
+}
+
+/**
+ Given a string with two or more alternatives separated by " | ", returns the string at the specified index.  Can be used as a horribly inefficient variation on bool ? str1 : str2, or to get one of several values based on an integer.  Particularly useful with localized strings, since several can be combined into one string.  If the index is greater than the number of alternatives, an empty string is returned.
+ 
+ @author DJS 2010-10.
+*/
+
+- (NSString *)dejal_indexedBy:(NSUInteger)idx;
+{
+    NSArray *alternatives = [self componentsSeparatedByString:@" | "];
+    
+    if (idx < [alternatives count])
+	    return alternatives[idx];
+    else
+        return @"";
+}
+
+/**
+ Returns YES if the string is non-empty, i.e. not nil and not @"".
+ 
+ @author DJS 2005-03.
+*/
+
+- (BOOL)dejal_containsSomething
+{
+    return ([self length] > 0);
+}
+
+/**
+ Returns YES if the subString is within the receiver, otherwise NO.  [Note: can easily extend this to take options, and to take a range; see -rangeOfString:options:range:]
+ 
+ This method has been removed, as NSString has -containsString: on 10.10 and later.
+*/
+
+/*
+- (BOOL)dejal_containsString:(NSString *)subString;
+{
+    NSRange range = [self rangeOfString:subString];
+
+    return range.location != NSNotFound;
+}
+*/
+
+/**
+ Returns YES if the subString is within the receiver, otherwise NO.  The case of both strings is ignored.
+ 
+ @author DJS 2004-12.
+ @version DJS 2015-01: This method has been removed, as NSString has -localizedCaseInsensitiveContainsString: on 10.10 and later..
+*/
+
+/*
+- (BOOL)dejal_containsStringCaseInsensitive:(NSString *)subString;
+{
+    NSRange range = [self rangeOfString:subString options:NSCaseInsensitiveSearch];
+    
+    return range.location != NSNotFound;
+}
+*/
+
+/**
+ Compares the receiver and the other string ignoring case and spaces.
+ 
+ @version DJS 2026-10: changed to remove the spaces via the folding engine, which doesn't copy strings without spaces.
+*/
+
+- (NSComparisonResult)dejal_caseAndSpaceInsensitiveCompare:(NSString *)otherString
+{
+    NSString *selfString = DejalFoldedString(self, DejalStringFoldingSpaces) ?: self;
+    NSString *other = otherString ? DejalFoldedString(otherString, DejalStringFoldingSpaces) ?: otherString : nil;
+
+    return [selfString caseInsensitiveCompare:other];
+}
+
+/**
+ Returns the receiver with all characters other than digits removed.  Useful to compare two strings without extraneous punctuation etc.
+ 
+ @author DJS 2008-11.
+ @version DJS 2015-11: Added missing "dejal_" prefix.
+ */
+
+- (NSString *)dejal_digitsOnly;
+{
+    static NSCharacterSet *charSet = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^
+                  {
+                      charSet = [[NSCharacterSet decimalDigitCharacterSet] invertedSet];
+                  });
+    
+    return [self dejal_stringByRemovingCharactersInSet:charSet];
+}
+
+/**
+ Returns the receiver with all letter characters converted to lowercase, and all other characters removed.  Useful to compare two strings without extraneous punctuation etc.
+ 
+ @author DJS 2005-02.
+ @version DJS 2005-04: changed to use -stringByRemovingCharactersInSet:; was incorrectly only trimming.
+*/
+
+- (NSString *)dejal_lowercasedLettersOnly
+{
+    return [self dejal_stringByFoldingWithOptions:DejalStringFoldingCase | DejalStringFoldingNonLetters];
+}
+
+/**
+ Returns the receiver with all letter characters converted to lowercase, and all other characters other than digits removed.  Useful to compare two strings without extraneous punctuation etc.
+ 
+ @author DJS 2007-10.
+*/
+
+- (NSString *)dejal_lowercasedLettersOrDigitsOnly;
+{
+    return [self dejal_stringByFoldingWithOptions:DejalStringFoldingCase | DejalStringFoldingNonAlphanumerics];
+}
+
+/**
+ Returns YES if the receiver contains the other string, when only looking at the letter characters, and ignoring case.  For repeated comparisons, make the keys once via -dejal_stringByFoldingWithOptions: with DejalStringFoldingCase | DejalStringFoldingNonLetters instead.
+ 
+ @author DJS 2005-02.
+ @version DJS 2026-10: changed to fold each string once via the folding engine, instead of making lowercased copies.
+*/
+
+- (BOOL)dejal_containsStringLetters:(NSString *)otherString
+{
+    DejalStringFoldingOptions options = DejalStringFoldingCase | DejalStringFoldingNonLetters;
+    NSString *letters = DejalFoldedString(self, options) ?: self;
+    NSString *otherLetters = otherString ? DejalFoldedString(otherString, options) ?: otherString : nil;
+    
+    return [letters containsString:otherLetters];
+}
+
+/**
+ Returns YES if the receiver and the other string are equal when only looking at the letter characters, and ignoring case.  For repeated comparisons, make the keys once via -dejal_stringByFoldingWithOptions: with DejalStringFoldingCase | DejalStringFoldingNonLetters instead.
+ 
+ @author DJS 2005-02.
+ @version DJS 2026-10: changed to fold each string once via the folding engine, instead of making lowercased copies, and to skip folding identical strings.
+*/
+
+- (BOOL)dejal_isLetterEquivalentToString:(NSString *)otherString
+{
+    if (!otherString)
+        return NO;
+    else if (self == otherString || [self isEqualToString:otherString])
+        return YES;
+    
+    DejalStringFoldingOptions options = DejalStringFoldingCase | DejalStringFoldingNonLetters;
+    NSString *letters = DejalFoldedString(self, options) ?: self;
+    NSString *otherLetters = DejalFoldedString(otherString, options) ?: otherString;
+    
+    return [letters isEqualToString:otherLetters];
+}
+
+/**
+ Returns a string with all characters matching the set removed from the receiver.
+ 
+ @author DJS 2005-04.
+ @version DJS 2026-10: changed to filter in a single pass without a mutable copy, returning an immutable copy of the receiver (i.e. the receiver itself, if immutable) if nothing is removed.
+*/
+
+- (NSString *)dejal_stringByRemovingCharactersInSet:(NSCharacterSet *)set;
+{
+    return DejalStringByRemovingCharactersInSet(self, set) ?: [self copy];
+}
+
+/**
+ Returns a string with diacritical marks removed from the receiver.  For example, "expose" with an acute accent will be returned without the accent.
+ 
+ @author DJS 2007-04.
+ @version DJS 2026-10: changed to use -dejal_stringByFoldingWithOptions:, instead of deleting the marks one at a time.
+*/
+
+- (NSString *)dejal_stringByRemovingDiacriticalMarks;
+{
+    return [self dejal_stringByFoldingWithOptions:DejalStringFoldingDiacritics];
+}
+
+/**
+ Returns a comparison key for the receiver, folded per the options in a single pass: lowercased, with diacritical marks removed, and/or with spaces, non-letters or non-alphanumerics removed.  Compare keys with -isEqualToString:, -containsString:, -compare:, etc; for repeated comparisons, make the keys once and reuse them.  Returns an immutable copy of the receiver (i.e. the receiver itself, if immutable) if folding doesn't change it.
+ 
+ Case folding matches -lowercaseString, and diacritic folding matches canonical decomposition with the non-base characters removed.  Letters means lowercase letters (after any case folding), as for -dejal_lowercasedLettersOnly.
+ 
+ @param options The folding to apply.
+ @returns The folded string.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSString *)dejal_stringByFoldingWithOptions:(DejalStringFoldingOptions)options;
+{
+    return DejalFoldedString(self, options) ?: [self copy];
+}
+
+/**
+ Returns an array of comparison keys for the array of strings, folded per the options (see -dejal_stringByFoldingWithOptions:), e.g. to build a search index.  Large arrays are folded across multiple threads.
+ 
+ @param strings An array of strings.
+ @param options The folding to apply.
+ @returns An array of folded strings, in the same order.
+ 
+ @author DJS 2026-10.
+ */
+
++ (NSArray *)dejal_stringsByFoldingStrings:(NSArray *)strings withOptions:(DejalStringFoldingOptions)options;
+{
+    NSUInteger count = strings.count;
+    
+    if (count < DEJAL_FOLDING_CONCURRENT_THRESHOLD)
+    {
+        NSMutableArray *keys = [NSMutableArray arrayWithCapacity:count];
+        
+        for (NSString *string in strings)
+            [keys addObject:[string dejal_stringByFoldingWithOptions:options]];
+        
+        return keys;
+    }
+    
+    __strong NSString **keys = (__strong NSString **)calloc(count, sizeof(NSString *));
+    
+    dispatch_apply(count, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i)
+                   {
+                       keys[i] = [strings[i] dejal_stringByFoldingWithOptions:options];
+                   });
+    
+    NSArray *result = [NSArray arrayWithObjects:keys count:count];
+    
+    for (NSUInteger i = 0; i < count; i++)
+        keys[i] = nil;
+    
+    free(keys);
+    
+    return result;
+}
+
+- (NSString *)dejal_stringByRemovingQuotesAndSpaces
+{
+    BOOL insideQuote = NO;
+    NSString *nextChar;
+    NSMutableString *retString = [NSMutableString string];
+    NSUInteger i;
+
+    for (i = 0; i < [self length]; i++)
+    {
+        unichar nChar = [self characterAtIndex:i];
+        nextChar = [NSString stringWithCharacters:&nChar length:1];
+        
+        if ([nextChar isEqual:@"\""])
+        {
+            if (!insideQuote)
+                insideQuote = YES;
+            else
+                insideQuote = NO;
+            
+            continue;
+        }
+        
+        if ([nextChar isEqual:@" "] && insideQuote)
+            [retString appendString:@"&SP&"];
+        else
+            [retString appendString:nextChar];
+    }
+
+    return [NSString stringWithString:retString];
+}
+
+/**
+ If the receiver has the specified prefix, returns a new string without that prefix, otherwise returns the receiver unchanged.
+ 
+ @author DJS 2011-08.
+*/
+
+- (NSString *)dejal_stringByRemovingPrefix:(NSString *)prefix;
+{
+    if ([self hasPrefix:prefix])
+        return [self substringFromIndex:prefix.length];
+    else
+        return self;
+}
+
+/**
+ If the receiver has the specified suffix, returns a new string without that suffix, otherwise returns the receiver unchanged.
+ 
+ @author DJS 2011-08.
+*/
+
+- (NSString *)dejal_stringByRemovingSuffix:(NSString *)suffix;
+{
+    if ([self hasSuffix:suffix])
+        return [self substringToIndex:self.length - suffix.length];
+    else
+        return self;
+}
+
+- (NSString *)dejal_stringByDeletingLeadingSpaces:(BOOL)leading trailingSpaces:(BOOL)trailing
+{
+    NSMutableString *mutString = [NSMutableString stringWithString:self];
+
+    [mutString dejal_deleteLeadingSpaces:leading trailingSpaces:trailing];
+
+    return [NSString stringWithString:mutString];
+}
+
+/**
+ If the length of the receiver is less than minLength, it is padded with the specified padding string, on the left or right as requested.  [Note: currently the padding is assumed to be a single character, but support for multi-characters could be added in the future.]
+ 
+ Note: might want to deprecate this method, since -[NSString stringByPaddingToLength:withString:startingAtIndex:] is available, though that doesn't support padding on the left side.
+ 
+ @author DJS 2010-07 based on earlier code.
+*/
+
+- (NSString *)dejal_stringWithMinimumLength:(NSUInteger)minLength paddedWith:(NSString *)padding padLeft:(BOOL)padLeft;
+{
+    NSString *temp = self;
+    
+    if (!padding)
+        padding = @" ";
+    
+    if ([temp length] < minLength)
+    {
+        NSUInteger shortfall = minLength - [temp length];
+        NSUInteger i;
+        
+        for (i = 0; i < shortfall; i++)
+        {
+            if (padLeft)
+                temp = [padding stringByAppendingString:temp];
+            else
+                temp = [temp stringByAppendingString:padding];
+        }
+    }
+    
+    return temp;
+}
+
+/**
+ Returns an array of strings from the receiver, broken up on spaces to be no more than length characters each.  Supports multiple paragraphs, though assumes they are separated by LFs.  This limitation can be tweaked in the future if important.
+ 
+ @author DJS 2006-10.
+ @version DJS 2026-10: changed to wrap in a single pass via DejalTextScanner, without allocating each word and separator; a word without whitespace after it no longer repeats the previous separator.
+*/
+
+- (NSArray *)dejal_componentsSeparatedByLength:(NSUInteger)length;
+{
+    NSMutableArray *array = [NSMutableArray array];
+    DejalTextScanner *scanner = [[DejalTextScanner alloc] initWithWrapLength:length lineHandler:^(NSString *line)
+                                 {
+                                     [array addObject:line];
+                                 }];
+    
+    [scanner appendString:self];
+    [scanner finish];
+    
+    return array;
+}
+
+/**
+ Given an integer, returns its length as a string.
+ 
+ @author DJS 2008-07.
+*/
+
++ (NSUInteger)dejal_lengthOfInteger:(NSInteger)integer;
+{
+    return [[NSString stringWithFormat:@"%@", @(integer)] length];
+}
+
+/**
+ Returns the length of the receiver as a signed value, to avoid "Comparison between signed and unsigned" warnings.
+ 
+ @author DJS 2010-05.
+*/
+
+- (NSInteger)dejal_signedLength;
+{
+    return (NSInteger)[self length];
+}
+
+/**
+ Returns the number of words in the receiver.
+ 
+ @author DJS 2004-06.
+ @version DJS 2026-10: changed to count in a single pass via DejalTextScanner.
+*/
+
+- (NSInteger)dejal_wordCount
+{
+    DejalTextScanner *scanner = [DejalTextScanner new];
+    
+    [scanner appendString:self];
+    [scanner finish];
+    
+    return (NSInteger)scanner.wordCount;
+}
+
+/**
+ Given a string containing a version number, of the form "1.2.3b4", returns a dictionary with each component separated out, using the keys "Major", "Minor", "Bug", "Kind" and "Stage", respectively.  In addition, key "Version" will contain the original version string, "General" will contain the general release portion, i.e. omitting the "b4" or whatever, and "IsGeneral" is a boolean indicating if it is a general release or not.  Keys are omitted if the corresponding component of the version string is missing.
+ 
+ @author DJS 2004-05.
+*/
+
+- (NSDictionary *)dejal_dictionaryWithVersionComponents
+{
+    NSRange range = [self rangeOfCharacterFromSet:[NSCharacterSet letterCharacterSet]];
+    NSString *general = self;
+    NSString *kind = nil;
+    NSString *stage = nil;
+    
+    if (range.location != NSNotFound)
+    {
+        general = [self substringToIndex:range.location];
+        kind = [self substringWithRange:range];
+        stage = [self substringFromIndex:range.location + range.length];
+    }
+    
+    NSArray *array = [general componentsSeparatedByString:@"."];
+    NSUInteger count = [array count];
+    NSString *major = (count >= 1) ? array[0] : nil;
+    NSString *minor = (count >= 2) ? array[1] : nil;
+    NSString *bug = (count >= 3) ? array[2] : nil;
+    
+    NSMutableDictionary *dict = [NSMutableDictionary dictionary];
+    
+    [dict dejal_setObject:self forKey:@"Version" removeIfNil:NO];
+    [dict dejal_setObject:general forKey:@"General" removeIfNil:NO];
+    dict[@"IsGeneral"] = @(!kind);
+    [dict dejal_setObject:major forKey:@"Major" removeIfNil:NO];
+    [dict dejal_setObject:minor forKey:@"Minor" removeIfNil:NO];
+    [dict dejal_setObject:bug forKey:@"Bug" removeIfNil:NO];
+    [dict dejal_setObject:kind forKey:@"Kind" removeIfNil:NO];
+    [dict dejal_setObject:stage forKey:@"Stage" removeIfNil:NO];
+    
+    return dict;
+}
+
+/**
+ Given a dictionary containing the keys "Major", "Minor", "Bug", "Kind" and "Stage" (some of which may be missing), returns the string representation, e.g. "1.2.3b4".  If the dictionary contains a precomposed "Version" key, it just returns that.
+ 
+ @author DJS 2004-05.
+*/
+
++ (NSString *)dejal_versionWithDictionary:(NSDictionary *)dict
+{
+    NSString *version = dict[@"Version"];
+    
+    if ([version length])
+        return version;
+    
+    NSInteger major = [dict[@"Major"] integerValue];
+    NSInteger minor = [dict[@"Minor"] integerValue];
+    NSInteger bug = [dict[@"Bug"] integerValue];
+    NSString *kind = dict[@"Kind"];
+    NSInteger stage = [dict[@"Stage"] integerValue];
+    
+    return [self dejal_versionWithMajor:major minor:minor bug:bug kind:kind stage:stage];
+}
+
+/**
+ Given values for the components of a version number (any of which may be 0 or nil), returns the string representation, e.g. "1.2.3b4".
+ 
+ @author DJS 2004-05.
+*/
+
++ (NSString *)dejal_versionWithMajor:(NSInteger)major minor:(NSInteger)minor bug:(NSInteger)bug kind:(NSString *)kind stage:(NSInteger)stage
+{
+    NSString *version = nil;
+    
+#if TARGET_OS_IPHONE
+    if (bug)
+        version = [NSString stringWithFormat:@"%ld.%ld.%ld", (long)major, (long)minor, (long)bug];
+    else
+        version = [NSString stringWithFormat:@"%ld.%ld", (long)major, (long)minor];
+    
+    if ([kind length])
+        version = [NSString stringWithFormat:@"%@%@%ld", version, kind, (long)stage];
+#else
+    if (bug)
+        version = [NSString stringWithFormat:@"%ld.%ld.%ld", major, minor, bug];
+    else
+        version = [NSString stringWithFormat:@"%ld.%ld", major, minor];
+    
+    if ([kind length])
+        version = [NSString stringWithFormat:@"%@%@%ld", version, kind, stage];
+#endif
+    
+    return version;
+}
+
+/**
+ Returns the specified number of characters from the beginning of the receiver, or the entire receiver if there aren't that many.  If a negative value is passed, it returns characters from the beginning of the receiver until the absolute value of the passed value before the length of the receiver, (e.g. [@"Hello!" left:-1] returns @"Hello"), or an empty string if there aren't that many.
+ 
+ @author DJS 2004-03.
+ @version DJS 2006-07: changed to support negative lengths.
+*/
+
+- (NSString *)dejal_left:(NSInteger)length
+{
+    if (length < 0)
+    {
+        if (-length < (NSInteger)[self length])
+            return [self substringToIndex:[self length] + length];
+        else
+            return @"";
+    }
+    else
+    {
+        if (length < (NSInteger)[self length])
+            return [self substringToIndex:length];
+        else
+            return self;
+    }
+}
+
+/**
+ Returns the specified number of characters from the end of the receiver, or the entire receiver if there aren't that many.  If a negative value is passed, it returns characters from the end of the receiver until the absolute value of the passed value before the start of the receiver, (e.g. [@"An example" left:-3] returns @"example"), or an empty string if there aren't that many.
+ 
+ @author DJS 2004-03.
+ @version DJS 2006-07: changed to support negative lengths.
+*/
+
+- (NSString *)dejal_right:(NSInteger)length
+{
+    if (length < 0)
+    {
+        NSInteger i = [self length] + length;
+        
+        if (i > 0)
+            return [self substringFromIndex:[self length] - i];
+        else
+            return @"";
+    }
+    else
+    {
+        NSInteger i = [self length] - length;
+        
+        if (i > 0)
+            return [self substringFromIndex:i];
+        else
+            return self;
+    }
+}
+
+/**
+ Returns a substring of the receiver, from the specified position and with the specified length.  If there aren't that many characters from that position, as many as there are are returned; if that position is out of range, an empty string is returned.
+ 
+ @author DJS 2004-05.
+*/
+
+- (NSString *)dejal_from:(NSUInteger)position length:(NSUInteger)length
+{
+    if (position >= [self length])
+        return @"";
+    else
+        return [[self substringFromIndex:position] dejal_left:length];
+}
+
+/**
+ Returns a substring of the receiver, from the start position to the end position, both inclusive.  If either position is out of range, as much of that range as is available is returned.
+ 
+ @author DJS 2004-05.
+*/
+
+- (NSString *)dejal_from:(NSUInteger)startPosition to:(NSUInteger)endPosition
+{
+    if (startPosition > endPosition)
+        return @"";
+    else
+        return [self dejal_from:startPosition length:endPosition - startPosition + 1];
+}
+
+/**
+ Similar to -substringFromIndex:, but takes a string to look for instead of an index.  If the string is within the receiver, the characters from the one after that string to the end are returned.  If it isn't within, the receiver is returned.
+ 
+ @author DJS 2005-03.
+*/
+
+- (NSString *)dejal_substringFromString:(NSString *)string;
+{
+    NSRange range = [self rangeOfString:string];
+    
+    if (range.location == NSNotFound)
+        return self;
+    else
+        return [self substringFromIndex:range.location + range.length];
+}
+
+/**
+ Similar to -substringToIndex:, but takes a string to look for instead of an index.  If the string is within the receiver, the characters from the start up to but excluding the position of that string are returned.  If it isn't within, the receiver is returned.
+ 
+ @author DJS 2005-03.
+*/
+
+- (NSString *)dejal_substringToString:(NSString *)string;
+{
+    NSRange range = [self rangeOfString:string];
+    
+    if (range.location == NSNotFound)
+        return self;
+    else
+        return [self substringToIndex:range.location];
+}
+
+/**
+ Similar to using both -substringFromString: and -substringToString: to return a string from between two others, except if either the startString or endString is not present in the receiver, the defaultString is returned instead.
+ 
+ @author DJS 2012-09.
+ @version DJS 2012-10: changed to use -rangeFromString:toString:.
+*/
+
+- (NSString *)dejal_substringFromString:(NSString *)startString toString:(NSString *)endString defaultString:(NSString *)defaultString;
+{
+    NSRange substringRange = [self dejal_rangeFromString:startString toString:endString];
+    
+    if (substringRange.location == NSNotFound)
+        return defaultString;
+    else
+        return [self substringWithRange:substringRange];
+}
+
+/**
+ Returns the range of the string enclosed by the specified start and end strings, or NSNotFound if either couldn't be found.
+ 
+ @author DJS 2012-10.
+*/
+
+- (NSRange)dejal_rangeFromString:(NSString *)startString toString:(NSString *)endString;
+{
+    return [self dejal_rangeFromString:startString toString:endString inclusive:NO];
+}
+
+/**
+ Returns the range of the string enclosed by the specified start and end strings, or NSNotFound if either couldn't be found.  If inclusive is YES, the range includes the start and end strings, otherwise it is just the text between them.
+ 
+ @author DJS 2012-10.
+ @version DJS 2013-01: changed to add the inclusive option.
+*/
+
+- (NSRange)dejal_rangeFromString:(NSString *)startString toString:(NSString *)endString inclusive:(BOOL)inclusive;
+{
+    NSRange startRange = [self rangeOfString:startString];
+    
+    if (startRange.location == NSNotFound)
+        return startRange;
+    
+    NSInteger substringLocation = startRange.location + startRange.length;
+    NSRange endRange = [self rangeOfString:endString options:0 range:NSMakeRange(substringLocation, self.length - substringLocation)];
+    
+    if (endRange.location == NSNotFound)
+        return endRange;
+    
+    if (inclusive)
+        return NSMakeRange(startRange.location, (endRange.location - startRange.location) + endRange.length);
+    else
+        return NSMakeRange(substringLocation, endRange.location - substringLocation);
+}
+
+/**
+ Returns the receiver with the characters in the reverse order.
+ 
+ @author DJS 2004-01.
+*/
+
+- (NSString *)dejal_reverse
+{
+    NSString *nextChar;
+    NSMutableString *retString = [NSMutableString string];
+    NSInteger i;
+    
+    for (i = [self length] - 1; i >= 0; i--)
+    {
+        unichar nChar = [self characterAtIndex:i];
+        nextChar = [NSString stringWithCharacters:&nChar length:1];
+        
+        [retString appendString:nextChar];
+    }
+    
+    return [NSString stringWithString:retString];
+}
+
+/**
+ Returns a checksum of the receiver, which can be used to compare to other strings.  Similar to -hash, but that can (and has) changed between OS versions.  For identifying duplicates, -dejal_hash64 is much less prone to collisions, and can be computed incrementally.
+ 
+ @author DJS 2011-07.
+ @version DJS 2026-10: changed to work on the characters in bulk, taking the modulus only when needed, with identical results.
+*/
+
+- (NSUInteger)dejal_checksum;
 {
-    BOOL insideQuote = NO;
-    NSString *nextChar;
+    NSUInteger base = [self length];
+    NSUInteger result = base * base;
+    const unichar *direct = CFStringGetCharactersPtr((__bridge CFStringRef)self);
+    unichar buffer[DEJAL_CHECKSUM_CHUNK_LENGTH];
+    
+    for (NSUInteger location = 0; location < base; location += DEJAL_CHECKSUM_CHUNK_LENGTH)
+    {
+        NSUInteger length = MIN(DEJAL_CHECKSUM_CHUNK_LENGTH, base - location);
+        const unichar *characters = direct ? direct + location : buffer;
+        
+        if (!direct)
+            [self getCharacters:buffer range:NSMakeRange(location, length)];
+        
+        result = DejalChecksumCharacters(characters, length, location, base, result);
+    }
+    
+    return result;
+}
+
+/**
+ Returns a 64-bit hash of the receiver's UTF-16 characters, for quickly identifying duplicate text; see -dejal_hash64WithSeed:.
+ 
+ @author DJS 2026-10.
+ */
+
+- (uint64_t)dejal_hash64;
+{
+    return [self dejal_hash64WithSeed:0];
+}
+
+/**
+ Returns a 64-bit hash of the receiver's UTF-16 characters with the seed, via DejalHasher.  Unlike -hash, it's stable across launches and OS versions, so can be stored; and unlike -dejal_checksum, collisions are very unlikely.  Equal to -[NSData dejal_hash64WithSeed:] of the characters as UTF-16 in host byte order, i.e. little-endian on all supported platforms.
+ 
+ @author DJS 2026-10.
+ */
+
+- (uint64_t)dejal_hash64WithSeed:(uint64_t)seed;
+{
+    DejalHasher *hasher = [[DejalHasher alloc] initWithSeed:seed];
+    
+    [hasher appendString:self];
+    
+    return hasher.hashValue;
+}
+
+/**
+ Returns a lightly encrypted rendition of the receiver, for hiding passwords etc.  Decrypt via -unmask, below.
+ 
+ @author DJS 2004-01.
+*/
+
+- (NSString *)dejal_mask
+{
+    if (![self length])
+        return self;
+    
     NSMutableString *retString = [NSMutableString string];
+    NSString *fragment;
+    NSDateComponents *components = [[NSCalendar currentCalendar] components:(NSCalendarUnitDay | NSCalendarUnitMinute | NSCalendarUnitSecond) fromDate:[NSDate date]];
+    NSUInteger randomValue = ([components day] * [components minute]) / ([components second] + 5);
+    unichar character = 0;
     NSUInteger i;
-
+    
     for (i = 0; i < [self length]; i++)
     {
-        unichar nChar = [self characterAtIndex:i];
-        nextChar = [NSString stringWithCharacters:&nChar length:1];
+        character = [self characterAtIndex:i] + 57 + (randomValue * (i + 3));
+        fragment = [NSString stringWithFormat:@"%xO", character];
         
-        if ([nextChar isEqual:@"\""])
+        [retString appendString:fragment];
+    }
+    
+#if TARGET_OS_IPHONE
+    return [NSString stringWithFormat:@"1a7q4%lud39%@", (unsigned long)randomValue, [retString dejal_reverse]];          // Version 1, in case I want to change the algorithm
+#else
+    return [NSString stringWithFormat:@"1a7q4%ldd39%@", randomValue, [retString dejal_reverse]];          // Version 1, in case I want to change the algorithm
+#endif
+}
+
+/**
+ Given a string that was masked via -mask, above, returns the decrypted rendition.  Okay to call with an unmasked string; just returns self in this case.
+ 
+ @author DJS 2004-01.
+*/
+
+- (NSString *)dejal_unmask
+{
+    if (![self length])
+        return self;
+    
+    NSScanner *scanner = [NSScanner scannerWithString:self];
+    NSMutableString *retString = [NSMutableString string];
+    NSString *fragment;
+    unsigned hexInt = 0;
+    unichar character = 0;
+    NSInteger version = 0;
+    NSInteger randomValue = 0;
+    NSInteger i = 0;
+    
+    if (![scanner scanInteger:&version])
+        return self;
+    
+    if (![scanner scanString:@"a7q4" intoString:nil])
+        return self;
+    
+    if (![scanner scanInteger:&randomValue])
+        return self;
+    
+    if (![scanner scanString:@"d39" intoString:nil])
+        return self;
+    
+    NSInteger location = [scanner scanLocation];
+    NSString *remaining = [[self substringFromIndex:location] dejal_reverse];
+    
+    scanner = [NSScanner scannerWithString:remaining];
+    
+    while (![scanner isAtEnd])
+    {
+        if ([scanner scanHexInt:&hexInt])
         {
-            if (!insideQuote)
-                insideQuote = YES;
-            else
-                insideQuote = NO;
+            character = hexInt - (randomValue * (i + 3)) - 57;
+            fragment = [NSString stringWithCharacters:&character length:1];
             
-            continue;
+            [retString appendString:fragment];
         }
         
-        if ([nextChar isEqual:@" "] && insideQuote)
-            [retString appendString:@"&SP&"];
-        else
-            [retString appendString:nextChar];
+        [scanner scanString:@"O" intoString:nil];
+        
+        i++;
+    }
+    
+    return [NSString stringWithString:retString];
+}
+
+/**
+ Convert the receiver to a Base64-encoded edition.
+ 
+ @param encoding The string encoding to use, e.g. NSUTF8StringEncoding.
+ @returns The Base64-encoded edition.
+ 
+ @author DJS 2014-07.
+ @version DJS 2026-10: changed to use the vectorized Base64 encoder.
+ */
+
+- (NSString *)dejal_encodeAsBase64UsingEncoding:(NSStringEncoding)encoding;
+{
+    return [self dejal_encodeAsBase64UsingEncoding:encoding options:0];
+}
+
+/**
+ Convert the receiver to a Base64-encoded edition, with options for the URL-safe alphabet or omitting padding.  The encoded characters are written straight into the returned string, and if the receiver's bytes in the encoding are directly available, they are encoded without converting the string first.
+ 
+ @param encoding The string encoding to use, e.g. NSUTF8StringEncoding.
+ @param options The Base64 options, e.g. DejalBase64URLSafe.
+ @returns The Base64-encoded edition, or nil if the receiver can't be converted to the encoding.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSString *)dejal_encodeAsBase64UsingEncoding:(NSStringEncoding)encoding options:(DejalBase64Options)options;
+{
+    const char *bytes = NULL;
+    
+    if (encoding == NSASCIIStringEncoding || encoding == NSUTF8StringEncoding)
+        bytes = CFStringGetCStringPtr((__bridge CFStringRef)self, kCFStringEncodingASCII);
+    
+    NSData *data;
+    
+    if (bytes)
+        data = [NSData dataWithBytesNoCopy:(void *)bytes length:self.length freeWhenDone:NO];
+    else
+        data = [self dataUsingEncoding:encoding];
+    
+    return [data dejal_base64EncodedStringWithOptions:options];
+}
+
+/**
+ Convert the Base64-encoded receiver to a decoded string.
+ 
+ @param encoding The string encoding to use, e.g. NSUTF8StringEncoding.
+ @returns The decoded string.
+ 
+ @author DJS 2014-07.
+ @version DJS 2026-10: changed to use the vectorized Base64 decoder.
+ */
+
+- (NSString *)dejal_decodeFromBase64UsingEncoding:(NSStringEncoding)encoding;
+{
+    return [self dejal_decodeFromBase64UsingEncoding:encoding options:0];
+}
+
+/**
+ Convert the Base64-encoded receiver to a decoded string, decoding leniently by default (ignoring line breaks and other characters outside the alphabet), or strictly if DejalBase64Strict is passed.  The receiver's characters are decoded directly if they're available, without converting it to data first.
+ 
+ @param encoding The string encoding to use, e.g. NSUTF8StringEncoding.
+ @param options The Base64 options, e.g. DejalBase64Strict.
+ @returns The decoded string, or nil if the receiver can't be decoded.
+ 
+ @author DJS 2026-10.
+ */
+
+- (NSString *)dejal_decodeFromBase64UsingEncoding:(NSStringEncoding)encoding options:(DejalBase64Options)options;
+{
+    NSData *data = [NSData dejal_dataWithBase64String:self options:options];
+    
+    return data ? [[NSString alloc] initWithData:data encoding:encoding] : nil;
+}
+
+/**
+ Returns the receiver encoded with the standard Rot13 algorithm: letter characters rotated halfway around the alphabet, other characters untouched.
+ 
+ @author DJS 2005-03.
+ @version DJS 2009-11: changed to rename the method, as seemed to be calling something else (private OS method?).
+*/ 
+
+- (NSString *)dejal_rotate13
+{
+    NSMutableString *string = [NSMutableString string];
+    NSUInteger i;
+    
+    for (i = 0; i < [self length]; ++i)
+    {
+        unichar character = [self characterAtIndex:i];
+        unichar capital = character & 32;
+        
+        character &= ~capital;
+        character = ((character >= 'A') && (character <= 'z')) ? ((character - 'A' + 13) % 26 + 'A') : character;
+        character |= capital;
+        
+        [string appendFormat:@"%c", character];
+    }
+    
+    return string;
+}
+
+/**
+ Returns a string that is guaranteed to be globally unique, and can be used as a unique identifier.  This variation omits the dashes.  Use [NSUUID UUID].UUIDString directly if dashes are okay.
+ 
+ @author DJS 2013-07.
+ @version DJS 2014-08: changed to use NSUUID.
+*/
+
++ (NSString *)dejal_uuid;
+{
+    return [[NSUUID UUID].UUIDString stringByReplacingOccurrencesOfString:@"-" withString:@""];
+}
+
+/**
+ Convenience method for -mappedFromValue:withDefault: to map a string value to an integer.
+ 
+ @author DJS 2006-09.
+*/
+
+- (NSInteger)dejal_integerMappedFromString:(NSString *)value withDefault:(NSInteger)defaultValue;
+{
+    return [[self dejal_mappedFromValue:value withDefault:@(defaultValue)] integerValue];
+}
+
+/**
+ Convenience method for -mappedFromValue:withDefault: map an integer value to a string.
+ 
+ @author DJS 2006-09.
+*/
+
+- (NSString *)dejal_stringMappedFromInteger:(NSInteger)value withDefault:(NSString *)defaultValue;
+{
+    return [self dejal_mappedFromValue:@(value) withDefault:defaultValue];
+}
+
+/**
+ Given a mapping of the form "foo=bar;blah=beep;x=y" in the receiver and a value (of any type), returns the corresponding value.  For example, with the above mapping and a value of "blah", "beep" is returned.  It works both ways: if "beep" is passed, "blah" is returned.  If a match can't be found an a default value is provided, the default is returned.  There may be an easier or more efficient way to do this, other than big if/else or switch clauses, but this seems to be tidier from a usage point of view: just one line of code to call.  (I considered adding a DejalMapperData class for this, but decided against it for now as I wanted to use it in a Simon plugin, which has class-sharing issues if I ever wanted to use it elsewhere in the app.)
+ 
+ @author DJS 2006-09.
+*/
+
+- (NSString *)dejal_mappedFromValue:(id)value withDefault:(id)defaultValue;
+{
+    NSArray *array = [self componentsSeparatedByString:@";"];
+    NSString *desired = [value description];
+    NSString *result = nil;
+    NSString *mapping = nil;
+    
+    // Scan through the mapping till a match is found:
+    for (mapping in array)
+    {
+    	NSArray *parts = [mapping componentsSeparatedByString:@"="];
+        
+        if ([desired isEqualToString:[parts firstObject]])
+            result = [parts lastObject];
+        else if ([desired isEqualToString:[parts lastObject]])
+            result = [parts firstObject];
     }
-
-    return [NSString stringWithString:retString];
+    
+    // If no result and a default was provided, return a copy of the default converted to a string (makes a copy as -[NSString description] returns self):
+    if (!result && defaultValue)
+        result = [[defaultValue copy] description];
+    
+    return result;
 }
 
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+// Number of bytes a URL output buffer starts with:
+#define DEJAL_URL_BUFFER_MINIMUM_CAPACITY 256
+
+
+typedef NS_OPTIONS(uint8_t, DejalURLCharacterClass)
+{
+    DejalURLCharacterClassUnreserved = 1 << 0,
+    DejalURLCharacterClassHexDigit = 1 << 1
+};
+
+
+typedef NS_ENUM(NSInteger, DejalURLResult)
+{
+    DejalURLResultUnchanged = 0,
+    DejalURLResultChanged,
+    DejalURLResultFailed
+};
+
+
+typedef struct
+{
+    uint8_t *bytes;
+    NSUInteger length;
+    NSUInteger capacity;
+} DejalURLBuffer;
+
+
 /**
- If the receiver has the specified prefix, returns a new string without that prefix, otherwise returns the receiver unchanged.
+ Returns a table of the DejalURLCharacterClass of each byte value: unreserved characters (letters, digits, "-", ".", "_" and "~") are the only ones -dejal_stringByAddingPercentEscapes leaves as is, and hex digits make up percent escapes.  Bytes over 0x7F, i.e. parts of multi-byte UTF-8 sequences, are in neither class.
  
- @author DJS 2011-08.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_stringByRemovingPrefix:(NSString *)prefix;
+static const uint8_t *DejalURLCharacterClasses(void)
 {
-    if ([self hasPrefix:prefix])
-        return [self substringFromIndex:prefix.length];
-    else
-        return self;
+    static uint8_t classes[256];
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^
+                  {
+                      for (NSUInteger character = 0; character < 128; character++)
+                      {
+                          BOOL isDigit = character >= '0' && character <= '9';
+                          BOOL isLetter = (character | 0x20) >= 'a' && (character | 0x20) <= 'z';
+                          
+                          if (isDigit || isLetter || character == '-' || character == '.' || character == '_' || character == '~')
+                              classes[character] |= DejalURLCharacterClassUnreserved;
+                          
+                          if (isDigit || ((character | 0x20) >= 'a' && (character | 0x20) <= 'f'))
+                              classes[character] |= DejalURLCharacterClassHexDigit;
+                      }
+                  });
+    
+    return classes;
 }
 
 /**
- If the receiver has the specified suffix, returns a new string without that suffix, otherwise returns the receiver unchanged.
+ Returns the value of a hex digit byte, which must be one per DejalURLCharacterClasses().
  
- @author DJS 2011-08.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_stringByRemovingSuffix:(NSString *)suffix;
+static inline uint8_t DejalURLHexValue(uint8_t byte)
 {
-    if ([self hasSuffix:suffix])
-        return [self substringToIndex:self.length - suffix.length];
-    else
-        return self;
+    return (uint8_t)(byte <= '9' ? byte - '0' : (byte | 0x20) - 'a' + 10);
 }
 
-- (NSString *)dejal_stringByDeletingLeadingSpaces:(BOOL)leading trailingSpaces:(BOOL)trailing
+/**
+ Makes room in the buffer for the number of additional bytes.
+ 
+ @author DJS 2026-10.
+ */
+
+static inline void DejalURLBufferReserve(DejalURLBuffer *buffer, NSUInteger extra)
 {
-    NSMutableString *mutString = [NSMutableString stringWithString:self];
+    if (buffer->length + extra <= buffer->capacity)
+        return;
+    
+    buffer->capacity = MAX(MAX(buffer->capacity * 2, buffer->length + extra), DEJAL_URL_BUFFER_MINIMUM_CAPACITY);
+    buffer->bytes = realloc(buffer->bytes, buffer->capacity);
+}
 
-    [mutString dejal_deleteLeadingSpaces:leading trailingSpaces:trailing];
+/**
+ Appends bytes to the buffer.
+ 
+ @author DJS 2026-10.
+ */
 
-    return [NSString stringWithString:mutString];
+static inline void DejalURLBufferAppend(DejalURLBuffer *buffer, const uint8_t *bytes, NSUInteger length)
+{
+    DejalURLBufferReserve(buffer, length);
+    memcpy(buffer->bytes + buffer->length, bytes, length);
+    buffer->length += length;
 }
 
 /**
- If the length of the receiver is less than minLength, it is padded with the specified padding string, on the left or right as requested.  [Note: currently the padding is assumed to be a single character, but support for multi-characters could be added in the future.]
+ Returns the string's UTF-8 bytes, setting the length: directly via CFStringGetCStringPtr() if the string stores them (as it does for ASCII strings), otherwise converted into the scratch buffer.  Returns NULL if the string has an unpaired surrogate, which has no UTF-8 form.
  
- Note: might want to deprecate this method, since -[NSString stringByPaddingToLength:withString:startingAtIndex:] is available, though that doesn't support padding on the left side.
+ @author DJS 2026-10.
+ */
+
+static const uint8_t *DejalURLBytes(NSString *string, NSUInteger *length, DejalURLBuffer *scratch)
+{
+    CFStringRef cfString = (__bridge CFStringRef)string;
+    NSUInteger count = string.length;
+    const char *direct = CFStringGetCStringPtr(cfString, kCFStringEncodingUTF8);
+    
+    // A direct pointer is only available for single-byte storage, so the byte count is the character count:
+    if (direct)
+    {
+        *length = count;
+        return (const uint8_t *)direct;
+    }
+    
+    CFIndex used = 0;
+    
+    scratch->length = 0;
+    DejalURLBufferReserve(scratch, count * 3);
+    
+    if ((NSUInteger)CFStringGetBytes(cfString, CFRangeMake(0, (CFIndex)count), kCFStringEncodingUTF8, 0, false, scratch->bytes, (CFIndex)scratch->capacity, &used) < count)
+        return NULL;
+    
+    *length = (NSUInteger)used;
+    
+    return scratch->bytes;
+}
+
+/**
+ Appends the UTF-8 bytes to the output with every byte other than unreserved characters percent-escaped, with uppercase hex digits, as CFURLCreateStringByAddingPercentEscapes() did for -dejal_stringByAddingPercentEscapes.  Returns DejalURLResultUnchanged without appending anything if there's nothing to escape.
  
- @author DJS 2010-07 based on earlier code.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_stringWithMinimumLength:(NSUInteger)minLength paddedWith:(NSString *)padding padLeft:(BOOL)padLeft;
+static DejalURLResult DejalURLAddPercentEscapes(const uint8_t *bytes, NSUInteger length, DejalURLBuffer *output)
 {
-    NSString *temp = self;
+    static const char hexDigits[] = "0123456789ABCDEF";
+    const uint8_t *classes = DejalURLCharacterClasses();
+    NSUInteger i = 0;
     
-    if (!padding)
-        padding = @" ";
+    while (i < length && (classes[bytes[i]] & DejalURLCharacterClassUnreserved))
+        i++;
     
-    if ([temp length] < minLength)
+    if (i == length)
+        return DejalURLResultUnchanged;
+    
+    DejalURLBufferAppend(output, bytes, i);
+    
+    while (i < length)
     {
-        NSUInteger shortfall = minLength - [temp length];
-        NSUInteger i;
+        NSUInteger runStart = i;
         
-        for (i = 0; i < shortfall; i++)
-        {
-            if (padLeft)
-                temp = [padding stringByAppendingString:temp];
-            else
-                temp = [temp stringByAppendingString:padding];
-        }
+        while (i < length && (classes[bytes[i]] & DejalURLCharacterClassUnreserved))
+            i++;
+        
+        DejalURLBufferAppend(output, bytes + runStart, i - runStart);
+        
+        if (i == length)
+            break;
+        
+        uint8_t byte = bytes[i++];
+        uint8_t *escape;
+        
+        DejalURLBufferReserve(output, 3);
+        escape = output->bytes + output->length;
+        escape[0] = '%';
+        escape[1] = (uint8_t)hexDigits[byte >> 4];
+        escape[2] = (uint8_t)hexDigits[byte & 0xF];
+        output->length += 3;
     }
     
-    return temp;
+    return DejalURLResultChanged;
 }
 
 /**
- Returns an array of strings from the receiver, broken up on spaces to be no more than length characters each.  Supports multiple paragraphs, though assumes they are separated by LFs.  This limitation can be tweaked in the future if important.
+ Appends the UTF-8 bytes to the output with percent escapes replaced by the bytes they encode, as CFURLCreateStringByReplacingPercentEscapes() did for -dejal_stringByReplacingPercentEscapes.  Returns DejalURLResultUnchanged without appending anything if there are no escapes, or DejalURLResultFailed if a "%" isn't followed by two hex digits, or a run of escapes isn't valid UTF-8, so the output is always valid UTF-8.
  
- @author DJS 2006-10.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSArray *)dejal_componentsSeparatedByLength:(NSUInteger)length;
+static DejalURLResult DejalURLReplacePercentEscapes(const uint8_t *bytes, NSUInteger length, DejalURLBuffer *output)
 {
-    NSMutableArray *array = [NSMutableArray array];
-    NSArray *paragraphs = [self componentsSeparatedByString:@"\n"];
-    NSString *paragraph;
+    const uint8_t *classes = DejalURLCharacterClasses();
+    NSUInteger start = output->length;
+    NSUInteger i = 0;
+    uint8_t sequence[4];
+    NSUInteger sequenceLength = 0;
+    uint32_t codePoint = 0;
+    uint32_t minimum = 0;
+    NSUInteger pending = 0;
+    BOOL failed = NO;
     
-    for (paragraph in paragraphs)
+    const uint8_t *percent = memchr(bytes, '%', length);
+    
+    if (!percent)
+        return DejalURLResultUnchanged;
+    
+    i = (NSUInteger)(percent - bytes);
+    DejalURLBufferAppend(output, bytes, i);
+    
+    while (i < length && !failed)
     {
-        NSScanner *wordScanner = [NSScanner scannerWithString:paragraph];
-        NSCharacterSet *whiteSpace = [NSCharacterSet whitespaceCharacterSet];
-        NSString *word = nil;
-        NSString *separator = nil;
-        NSMutableString *line = [NSMutableString stringWithCapacity:length];
+        if (bytes[i] != '%')
+        {
+            // An escaped multi-byte sequence can't be completed by an unescaped byte:
+            if (pending)
+            {
+                failed = YES;
+                break;
+            }
+            
+            NSUInteger runStart = i;
+            
+            percent = memchr(bytes + i, '%', length - i);
+            i = percent ? (NSUInteger)(percent - bytes) : length;
+            
+            DejalURLBufferAppend(output, bytes + runStart, i - runStart);
+            continue;
+        }
+        
+        if (i + 2 >= length || !(classes[bytes[i + 1]] & classes[bytes[i + 2]] & DejalURLCharacterClassHexDigit))
+        {
+            failed = YES;
+            break;
+        }
+        
+        uint8_t byte = (uint8_t)((DejalURLHexValue(bytes[i + 1]) << 4) | DejalURLHexValue(bytes[i + 2]));
         
-        [wordScanner setCharactersToBeSkipped:[NSCharacterSet illegalCharacterSet]];
+        i += 3;
         
-        while (![wordScanner isAtEnd])
+        if (pending)
         {
-            [wordScanner scanUpToCharactersFromSet:whiteSpace intoString:&word];
-            [wordScanner scanCharactersFromSet:whiteSpace intoString:&separator];
+            if ((byte & 0xC0) != 0x80)
+            {
+                failed = YES;
+                break;
+            }
+            
+            codePoint = (codePoint << 6) | (byte & 0x3F);
+            sequence[sequenceLength++] = byte;
+            
+            if (--pending)
+                continue;
             
-            if (([line length] + [word length] + [separator length]) <= length)
+            // Reject overlong encodings, surrogates, and code points beyond Unicode:
+            if (codePoint < minimum || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
             {
-                [line appendString:word];
-                [line appendString:separator];
+                failed = YES;
+                break;
             }
-            else
+            
+            DejalURLBufferAppend(output, sequence, sequenceLength);
+        }
+        else if (byte < 0x80)
+        {
+            DejalURLBufferReserve(output, 1);
+            output->bytes[output->length++] = byte;
+        }
+        else
+        {
+            pending = byte >= 0xC2 && byte <= 0xDF ? 1 : byte >= 0xE0 && byte <= 0xEF ? 2 : byte >= 0xF0 && byte <= 0xF4 ? 3 : 0;
+            
+            if (!pending)
             {
-                [array addObject:line];
-                line = [NSMutableString stringWithString:word];
-                [line appendString:separator];
+                failed = YES;
+                break;
             }
+            
+            codePoint = byte & (0x3F >> pending);
+            minimum = pending == 1 ? 0x80 : pending == 2 ? 0x800 : 0x10000;
+            sequence[0] = byte;
+            sequenceLength = 1;
         }
-        
-        [array addObject:line];
     }
     
-    return array;
+    if (failed || pending)
+    {
+        output->length = start;
+        return DejalURLResultFailed;
+    }
+    
+    return DejalURLResultChanged;
+}
+
+/**
+ Returns the index of the first occurrence of the ASCII string in the bytes, or NSNotFound.  ASCII bytes never occur within multi-byte UTF-8 sequences, so this finds the same matches as searching the characters.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSUInteger DejalURLIndexOfASCII(const uint8_t *bytes, NSUInteger length, const char *string)
+{
+    NSUInteger stringLength = strlen(string);
+    
+    for (NSUInteger i = 0; i + stringLength <= length; i++)
+        if (!memcmp(bytes + i, string, stringLength))
+            return i;
+    
+    return NSNotFound;
+}
+
+/**
+ Appends the UTF-8 bytes to the output, cleaned up as a URL as described for -dejal_stringByCleaningURLWithDefaultScheme:, in one pass over the bytes.  The scheme is the UTF-8 default scheme.  Returns DejalURLResultUnchanged without appending anything if they're already clean, i.e. they have a scheme, domain and path.
+ 
+ @author DJS 2026-10.
+ */
+
+static DejalURLResult DejalURLClean(const uint8_t *bytes, NSUInteger length, const char *scheme, BOOL schemeIsFile, DejalURLBuffer *output)
+{
+    if (!length)
+        return DejalURLResultUnchanged;
+    
+    NSUInteger hostStart = DejalURLIndexOfASCII(bytes, length, "://");
+    BOOL hasScheme = hostStart != NSNotFound;
+    
+    if (hasScheme)
+    {
+        hostStart += 3;
+        schemeIsFile = hostStart == 7 && DejalURLIndexOfASCII(bytes, hostStart, "file://") == 0;
+    }
+    else
+    {
+        hostStart = 0;
+    }
+    
+    NSUInteger pathStart = DejalURLIndexOfASCII(bytes + hostStart, length - hostStart, "/");
+    NSUInteger hostLength = pathStart == NSNotFound ? length - hostStart : pathStart;
+    const uint8_t *host = bytes + hostStart;
+    BOOL addTLD = DejalURLIndexOfASCII(host, hostLength, ".") == NSNotFound && !schemeIsFile && DejalURLIndexOfASCII(host, hostLength, "localhost") == NSNotFound;
+    
+    if (hasScheme && pathStart != NSNotFound && !addTLD)
+        return DejalURLResultUnchanged;
+    
+    if (hasScheme)
+        DejalURLBufferAppend(output, bytes, hostStart);
+    else
+        DejalURLBufferAppend(output, (const uint8_t *)scheme, strlen(scheme));
+    
+    DejalURLBufferAppend(output, host, hostLength);
+    
+    if (addTLD)
+        DejalURLBufferAppend(output, (const uint8_t *)".com", 4);
+    
+    if (pathStart == NSNotFound)
+        DejalURLBufferAppend(output, (const uint8_t *)"/", 1);
+    else
+        DejalURLBufferAppend(output, host + hostLength, length - hostStart - hostLength);
+    
+    return DejalURLResultChanged;
+}
+
+/**
+ Applies the URL operation to the UTF-8 bytes of the string, appending the result to the output.  Removing diacritical marks for DejalURLOperationMakeURLSafe only decomposes the string if it has characters outside ASCII.  Fails if the string has an unpaired surrogate, since it has no UTF-8 form.
+ 
+ @author DJS 2026-10.
+ */
+
+static DejalURLResult DejalURLApplyOperation(NSString *string, DejalURLOperation operation, const char *scheme, BOOL schemeIsFile, DejalURLBuffer *scratch, DejalURLBuffer *output)
+{
+    NSString *folded = nil;
+    
+    if (operation == DejalURLOperationMakeURLSafe)
+        folded = DejalFoldedString(string, DejalStringFoldingDiacritics);
+    
+    if (folded)
+        string = folded;
+    
+    NSUInteger length = 0;
+    const uint8_t *bytes = DejalURLBytes(string, &length, scratch);
+    DejalURLResult result;
+    
+    if (!bytes)
+        return DejalURLResultFailed;
+    
+    switch (operation)
+    {
+        case DejalURLOperationReplacePercentEscapes:
+            result = DejalURLReplacePercentEscapes(bytes, length, output);
+            break;
+            
+        case DejalURLOperationClean:
+            result = DejalURLClean(bytes, length, scheme, schemeIsFile, output);
+            break;
+            
+        default:
+            result = DejalURLAddPercentEscapes(bytes, length, output);
+            break;
+    }
+    
+    // Removing diacritical marks changed the string, even if it then didn't need escaping:
+    if (folded && result == DejalURLResultUnchanged)
+    {
+        DejalURLBufferAppend(output, bytes, length);
+        result = DejalURLResultChanged;
+    }
+    
+    return result;
+}
+
+/**
+ Returns the UTF-8 form of the default scheme for cleaning URLs, i.e. the scheme, or "https://" if nil.
+ 
+ @author DJS 2026-10.
+ */
+
+static const char *DejalURLSchemeBytes(NSString *scheme)
+{
+    return (scheme ?: @"https://").UTF8String ?: "";
+}
+
+/**
+ Returns the result of applying the URL operation to the string: an immutable copy of the string (i.e. the string itself, if immutable) if unchanged, or nil if it fails.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSString *DejalURLString(NSString *string, DejalURLOperation operation, NSString *scheme)
+{
+    DejalURLBuffer scratch = {NULL, 0, 0};
+    DejalURLBuffer output = {NULL, 0, 0};
+    DejalURLResult result = DejalURLApplyOperation(string, operation, DejalURLSchemeBytes(scheme), [scheme isEqualToString:@"file://"], &scratch, &output);
+    NSString *applied = nil;
+    
+    free(scratch.bytes);
+    
+    if (result == DejalURLResultUnchanged)
+        applied = [string copy];
+    else if (result == DejalURLResultChanged && output.length)
+        return [[NSString alloc] initWithBytesNoCopy:output.bytes length:output.length encoding:NSUTF8StringEncoding freeWhenDone:YES];
+    else if (result == DejalURLResultChanged)
+        applied = @"";
+    
+    free(output.bytes);
+    
+    return applied;
+}
+
+
+/**
+ Private string class for the ASCII results of +dejal_stringsByApplyingURLOperation:toStrings:defaultScheme:, whose bytes are in a buffer shared by all of the results; each byte is one character.  Each one keeps the whole buffer alive, so copying one (e.g. when stored in a copy property or used as a dictionary key) returns an ordinary string with its own characters, letting the buffer be freed.
+ 
+ @author DJS 2026-10.
+ */
+
+@interface DejalURLArenaString : NSString
+{
+    NSData *_arena;
+    const uint8_t *_bytes;
+    NSUInteger _length;
+}
+
+- (instancetype)initWithArena:(NSData *)arena range:(NSRange)range;
+
+@end
+
+
+@implementation DejalURLArenaString
+
+- (instancetype)initWithArena:(NSData *)arena range:(NSRange)range;
+{
+    if ((self = [super init]))
+    {
+        _arena = arena;
+        _bytes = (const uint8_t *)arena.bytes + range.location;
+        _length = range.length;
+    }
+    
+    return self;
+}
+
+- (NSUInteger)length;
+{
+    return _length;
+}
+
+- (unichar)characterAtIndex:(NSUInteger)idx;
+{
+    if (idx >= _length)
+        [NSException raise:NSRangeException format:@"Index %@ beyond bounds [0 .. %@]", @(idx), @((NSInteger)_length - 1)];
+    
+    return _bytes[idx];
+}
+
+- (void)getCharacters:(unichar *)buffer range:(NSRange)range;
+{
+    if (NSMaxRange(range) > _length)
+        [NSException raise:NSRangeException format:@"Range %@ beyond bounds [0 .. %@]", NSStringFromRange(range), @((NSInteger)_length - 1)];
+    
+    for (NSUInteger i = 0; i < range.length; i++)
+        buffer[i] = _bytes[range.location + i];
+}
+
+- (id)copyWithZone:(NSZone *)zone;
+{
+    return [[NSString allocWithZone:zone] initWithBytes:_bytes length:_length encoding:NSASCIIStringEncoding];
 }
 
+@end
+
+
+@implementation NSString (DejalInternet)
+
 /**
- Given an integer, returns its length as a string.
+ Converts a URL-safe string into a raw format, replacing percent escapes with the characters they encode in UTF-8.  Returns an immutable copy of the receiver (i.e. the receiver itself, if immutable) if there are no escapes, or nil if an escape is malformed or isn't valid UTF-8, or the receiver has an unpaired surrogate.
  
- @author DJS 2008-07.
+ @author DJS 2003-10.
+ @version DJS 2026-10: changed to decode in a single pass over the UTF-8 bytes, instead of wrapping CFURLCreateStringByReplacingPercentEscapes(), with the same results.
 */
 
-+ (NSUInteger)dejal_lengthOfInteger:(NSInteger)integer;
+- (NSString *)dejal_stringByReplacingPercentEscapes
 {
-    return [[NSString stringWithFormat:@"%@", @(integer)] length];
+    return DejalURLString(self, DejalURLOperationReplacePercentEscapes, nil);
 }
 
 /**
- Returns the length of the receiver as a signed value, to avoid "Comparison between signed and unsigned" warnings.
+ Converts a raw string into a URL-safe format, percent-escaping the UTF-8 bytes of every character except letters, digits, "-", ".", "_" and "~".  Returns an immutable copy of the receiver (i.e. the receiver itself, if immutable) if nothing needs escaping, or nil if the receiver has an unpaired surrogate.
  
- @author DJS 2010-05.
+ @author DJS 2003-07.
+ @version DJS 2016-03: Tweaked to do better encoding.
+ @version DJS 2026-10: changed to escape in a single pass over the UTF-8 bytes via a classification table, instead of the deprecated CFURLCreateStringByAddingPercentEscapes(), with the same results.
 */
 
-- (NSInteger)dejal_signedLength;
+- (NSString *)dejal_stringByAddingPercentEscapes
 {
-    return (NSInteger)[self length];
+    return DejalURLString(self, DejalURLOperationAddPercentEscapes, nil);
 }
 
 /**
- Returns the number of words in the receiver.
+ Returns a string based on the receiver with diacritical marks removed and percent escapes added as needed, safe for passing as a URL parameter.
  
- @author DJS 2004-06.
+ @author DJS 2007-04.
+ @version DJS 2026-10: changed to only remove diacritical marks if there are characters outside ASCII, and return the receiver if nothing changes.
 */
 
-- (NSInteger)dejal_wordCount
+- (NSString *)dejal_stringByMakingURLSafe;
 {
-    NSScanner *wordScanner = [NSScanner scannerWithString:self];
-    NSCharacterSet *whiteSpace = [NSCharacterSet whitespaceCharacterSet];
-    NSMutableCharacterSet *tempSet = (NSMutableCharacterSet *)[NSMutableCharacterSet whitespaceAndNewlineCharacterSet];
-    [tempSet formUnionWithCharacterSet:[NSCharacterSet punctuationCharacterSet]];
-    NSCharacterSet *skipSet = [tempSet copy];
-    NSInteger wordCount = 0;
-    
-    [wordScanner setCharactersToBeSkipped:skipSet];
-    
-    while ([wordScanner scanUpToCharactersFromSet:whiteSpace intoString:nil])
-        wordCount++;
-    
-    return wordCount;
+    return DejalURLString(self, DejalURLOperationMakeURLSafe, nil);
 }
 
 /**
- Given a string containing a version number, of the form "1.2.3b4", returns a dictionary with each component separated out, using the keys "Major", "Minor", "Bug", "Kind" and "Stage", respectively.  In addition, key "Version" will contain the original version string, "General" will contain the general release portion, i.e. omitting the "b4" or whatever, and "IsGeneral" is a boolean indicating if it is a general release or not.  Keys are omitted if the corresponding component of the version string is missing.
+ Applies the URL operation to each of the strings, i.e. the equivalent of -dejal_stringByAddingPercentEscapes, -dejal_stringByReplacingPercentEscapes, -dejal_stringByMakingURLSafe or -dejal_stringByCleaningURLWithDefaultScheme: (with the scheme), much faster than calling them separately for large batches.  The changed strings that are plain ASCII share one buffer for their bytes, which is only freed when all of them are, so each such result keeps the whole batch's bytes alive; copy any results that are kept long after the rest are released (copying one returns a standalone string).  Changed strings with other characters get their own storage.  Unchanged strings are returned as is, and ones that fail as NSNull.
  
- @author DJS 2004-05.
-*/
+ @param operation The URL operation to apply.
+ @param strings The strings to apply it to.
+ @param scheme The default scheme for DejalURLOperationClean; nil for "https://".
+ @returns An array of the results, in the same order as the strings.
+ 
+ @author DJS 2026-10.
+ */
 
-- (NSDictionary *)dejal_dictionaryWithVersionComponents
++ (NSArray *)dejal_stringsByApplyingURLOperation:(DejalURLOperation)operation toStrings:(NSArray *)strings defaultScheme:(NSString *)scheme;
 {
-    NSRange range = [self rangeOfCharacterFromSet:[NSCharacterSet letterCharacterSet]];
-    NSString *general = self;
-    NSString *kind = nil;
-    NSString *stage = nil;
+    NSUInteger count = strings.count;
+    DejalURLBuffer scratch = {NULL, 0, 0};
+    DejalURLBuffer arena = {NULL, 0, 0};
+    DejalURLResult *results = malloc(MAX(count, 1) * sizeof(DejalURLResult));
+    NSRange *ranges = malloc(MAX(count, 1) * sizeof(NSRange));
+    const char *schemeBytes = DejalURLSchemeBytes(scheme);
+    BOOL schemeIsFile = [scheme isEqualToString:@"file://"];
+    NSUInteger idx = 0;
     
-    if (range.location != NSNotFound)
+    for (NSString *string in strings)
     {
-        general = [self substringToIndex:range.location];
-        kind = [self substringWithRange:range];
-        stage = [self substringFromIndex:range.location + range.length];
+        NSUInteger start = arena.length;
+        
+        results[idx] = DejalURLApplyOperation(string, operation, schemeBytes, schemeIsFile, &scratch, &arena);
+        ranges[idx] = NSMakeRange(start, arena.length - start);
+        idx++;
     }
     
-    NSArray *array = [general componentsSeparatedByString:@"."];
-    NSUInteger count = [array count];
-    NSString *major = (count >= 1) ? array[0] : nil;
-    NSString *minor = (count >= 2) ? array[1] : nil;
-    NSString *bug = (count >= 3) ? array[2] : nil;
+    free(scratch.bytes);
     
-    NSMutableDictionary *dict = [NSMutableDictionary dictionary];
+    NSData *arenaData = arena.length ? [NSData dataWithBytesNoCopy:arena.bytes length:arena.length freeWhenDone:YES] : nil;
+    const uint8_t *arenaBytes = arenaData.bytes;
+    NSMutableArray *array = [NSMutableArray arrayWithCapacity:count];
     
-    [dict dejal_setObject:self forKey:@"Version" removeIfNil:NO];
-    [dict dejal_setObject:general forKey:@"General" removeIfNil:NO];
-    dict[@"IsGeneral"] = @(!kind);
-    [dict dejal_setObject:major forKey:@"Major" removeIfNil:NO];
-    [dict dejal_setObject:minor forKey:@"Minor" removeIfNil:NO];
-    [dict dejal_setObject:bug forKey:@"Bug" removeIfNil:NO];
-    [dict dejal_setObject:kind forKey:@"Kind" removeIfNil:NO];
-    [dict dejal_setObject:stage forKey:@"Stage" removeIfNil:NO];
+    if (!arenaData)
+        free(arena.bytes);
     
-    return dict;
+    idx = 0;
+    
+    for (NSString *string in strings)
+    {
+        NSRange range = ranges[idx];
+        
+        if (results[idx] == DejalURLResultUnchanged)
+        {
+            [array addObject:[string copy]];
+        }
+        else if (results[idx] == DejalURLResultFailed)
+        {
+            [array addObject:[NSNull null]];
+        }
+        else if (range.length)
+        {
+            BOOL isASCII = YES;
+            
+            for (NSUInteger i = range.location; i < NSMaxRange(range) && isASCII; i++)
+                isASCII = arenaBytes[i] < 0x80;
+            
+            // Results with multi-byte characters get their own storage, so the arena can index bytes as characters:
+            if (isASCII)
+                [array addObject:[[DejalURLArenaString alloc] initWithArena:arenaData range:range]];
+            else
+                [array addObject:[[NSString alloc] initWithBytes:arenaBytes + range.location length:range.length encoding:NSUTF8StringEncoding]];
+        }
+        else
+        {
+            [array addObject:@""];
+        }
+        
+        idx++;
+    }
+    
+    free(results);
+    free(ranges);
+    
+    return array;
 }
 
 /**
- Given a dictionary containing the keys "Major", "Minor", "Bug", "Kind" and "Stage" (some of which may be missing), returns the string representation, e.g. "1.2.3b4".  If the dictionary contains a precomposed "Version" key, it just returns that.
+ Given a string containing HTML tags like "<p>" and "<a href=...>", strips out all such tags, including any incomplete tags at the start of the string (if it is a substring of the source).
  
- @author DJS 2004-05.
+ @author DJS 2006-10.
+ @version DJS 2026-10: changed to use DejalHTMLTextExtractor, which also removes comments and script and style contents, and decodes entities.
 */
 
-+ (NSString *)dejal_versionWithDictionary:(NSDictionary *)dict
+- (NSString *)dejal_stringByStrippingHTML;
 {
-    NSString *version = dict[@"Version"];
-    
-    if ([version length])
-        return version;
+    DejalHTMLTextExtractor *extractor = [DejalHTMLTextExtractor new];
     
-    NSInteger major = [dict[@"Major"] integerValue];
-    NSInteger minor = [dict[@"Minor"] integerValue];
-    NSInteger bug = [dict[@"Bug"] integerValue];
-    NSString *kind = dict[@"Kind"];
-    NSInteger stage = [dict[@"Stage"] integerValue];
+    [extractor appendString:self];
     
-    return [self dejal_versionWithMajor:major minor:minor bug:bug kind:kind stage:stage];
+    return [extractor finish];
 }
 
 /**
- Given values for the components of a version number (any of which may be 0 or nil), returns the string representation, e.g. "1.2.3b4".
+ Given a potential URL, cleans it up to ensure it is valid.  If the receiver is blank, it is returned intact.  It defaults the TLD to ".com" without interfering with the path, and adds the "http://" scheme if needed.  So, for example, "dejal/products" will result in "http://www.dejal.com/products".  To specify a different default scheme, use -stringByCleaningURLWithDefaultScheme: instead.
  
- @author DJS 2004-05.
-*/
+ @author DJS 2003-11.
+ */
 
-+ (NSString *)dejal_versionWithMajor:(NSInteger)major minor:(NSInteger)minor bug:(NSInteger)bug kind:(NSString *)kind stage:(NSInteger)stage
+- (NSString *)dejal_stringByCleaningURL;
 {
-    NSString *version = nil;
-    
-#if TARGET_OS_IPHONE
-    if (bug)
-        version = [NSString stringWithFormat:@"%ld.%ld.%ld", (long)major, (long)minor, (long)bug];
-    else
-        version = [NSString stringWithFormat:@"%ld.%ld", (long)major, (long)minor];
-    
-    if ([kind length])
-        version = [NSString stringWithFormat:@"%@%@%ld", version, kind, (long)stage];
-#else
-    if (bug)
-        version = [NSString stringWithFormat:@"%ld.%ld.%ld", major, minor, bug];
-    else
-        version = [NSString stringWithFormat:@"%ld.%ld", major, minor];
-    
-    if ([kind length])
-        version = [NSString stringWithFormat:@"%@%@%ld", version, kind, stage];
-#endif
-    
-    return version;
+    return [self dejal_stringByCleaningURLWithDefaultScheme:nil];
 }
 
 /**
- Returns the specified number of characters from the beginning of the receiver, or the entire receiver if there aren't that many.  If a negative value is passed, it returns characters from the beginning of the receiver until the absolute value of the passed value before the length of the receiver, (e.g. [@"Hello!" left:-1] returns @"Hello"), or an empty string if there aren't that many.
+ Given a potential URL, cleans it up to ensure it is valid.  If the receiver is blank, it is returned intact.  It defaults the TLD to ".com" without interfering with the path, and adds the specified default scheme if needed.  If the scheme is nil, it defaults to "http://".  So, for example, "dejal/products" will result in "http://www.dejal.com/products".  To use "http://" as the default scheme, you could use -stringByCleaningURL instead.
  
- @author DJS 2004-03.
- @version DJS 2006-07: changed to support negative lengths.
+ @author DJS 2003-11.
+ @version DJS 2004-01: changed to return blank intact.
+ @version DJS 2004-06: changed to support the file:// scheme, which would contain a blank url component.
+ @version DJS 2007-07: changed to support the localhost domain.
+ @version DJS 2019-10: changed to use "https://", and not add "www.".
+ @version DJS 2026-10: changed to clean in a single pass over the UTF-8 bytes, and return the receiver if it's already clean, or nil if it has an unpaired surrogate.
 */
 
-- (NSString *)dejal_left:(NSInteger)length
+- (NSString *)dejal_stringByCleaningURLWithDefaultScheme:(NSString *)scheme;
 {
-    if (length < 0)
-    {
-        if (-length < (NSInteger)[self length])
-            return [self substringToIndex:[self length] + length];
-        else
-            return @"";
-    }
-    else
-    {
-        if (length < (NSInteger)[self length])
-            return [self substringToIndex:length];
-        else
-            return self;
-    }
+    return DejalURLString(self, DejalURLOperationClean, scheme);
 }
 
 /**
- Returns the specified number of characters from the end of the receiver, or the entire receiver if there aren't that many.  If a negative value is passed, it returns characters from the end of the receiver until the absolute value of the passed value before the start of the receiver, (e.g. [@"An example" left:-3] returns @"example"), or an empty string if there aren't that many.
+ Returns a URL representation of the receiver, or nil if it isn't a valid URL.
  
- @author DJS 2004-03.
- @version DJS 2006-07: changed to support negative lengths.
+ @author DJS 2009-10.
 */
 
-- (NSString *)dejal_right:(NSInteger)length
+- (NSURL *)dejal_urlValue;
 {
-    if (length < 0)
-    {
-        NSInteger i = [self length] + length;
-        
-        if (i > 0)
-            return [self substringFromIndex:[self length] - i];
-        else
-            return @"";
-    }
-    else
-    {
-        NSInteger i = [self length] - length;
-        
-        if (i > 0)
-            return [self substringFromIndex:i];
-        else
-            return self;
-    }
+    NSURL *url = nil;
+    
+    if (self.length)
+        url = [NSURL URLWithString:[self dejal_stringByCleaningURL]];
+    
+    return url;
 }
 
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@implementation NSString (DejalFilePath)
+
 /**
- Returns a substring of the receiver, from the specified position and with the specified length.  If there aren't that many characters from that position, as many as there are are returned; if that position is out of range, an empty string is returned.
+ Given a filename (not path), returns it with illegal filename characters removed or replaced.  If the resulting filename is blank, the specified default filename is returned instead.
  
- @author DJS 2004-05.
+ @author DJS 2003-11.
+ @version DJS 2011-04: changed to remove leading dots.
 */
 
-- (NSString *)dejal_from:(NSUInteger)position length:(NSUInteger)length
+- (NSString *)dejal_stringByCleaningFilenameWithDefault:(NSString *)defaultFilename
 {
-    if (position >= [self length])
-        return @"";
+    NSMutableString *mutString = [NSMutableString stringWithString:self];
+    
+    [mutString dejal_deleteLeadingSpaces:YES trailingSpaces:YES];
+    [mutString dejal_replaceAllOccurrencesOf:@"/" with:@"-"];
+    [mutString dejal_replaceAllOccurrencesOf:@":" with:@"-"];
+    
+    while ([mutString hasPrefix:@"."])
+        [mutString deleteCharactersInRange:NSMakeRange(0, 1)];
+    
+    if ([mutString length])
+        return [NSString stringWithString:mutString];
     else
-        return [[self substringFromIndex:position] dejal_left:length];
+        return defaultFilename;
 }
 
 /**
- Returns a substring of the receiver, from the start position to the end position, both inclusive.  If either position is out of range, as much of that range as is available is returned.
+ Same as -stringByAppendingPathComponent:, but the filename is first cleaned via -stringByCleaningFilenameWithDefault:.
  
- @author DJS 2004-05.
+ @author DJS 2003-11.
 */
 
-- (NSString *)dejal_from:(NSUInteger)startPosition to:(NSUInteger)endPosition
+- (NSString *)dejal_stringByAppendingPathComponent:(NSString *)dirtyFilename cleanWithDefault:(NSString *)defaultFilename
 {
-    if (startPosition > endPosition)
-        return @"";
-    else
-        return [self dejal_from:startPosition length:endPosition - startPosition + 1];
+    return [self stringByAppendingPathComponent:[dirtyFilename dejal_stringByCleaningFilenameWithDefault:defaultFilename]];
 }
 
 /**
- Similar to -substringFromIndex:, but takes a string to look for instead of an index.  If the string is within the receiver, the characters from the one after that string to the end are returned.  If it isn't within, the receiver is returned.
+ Returns the filename portion of a path, without any extension.
  
- @author DJS 2005-03.
+ @author DJS 2003-11.
 */
 
-- (NSString *)dejal_substringFromString:(NSString *)string;
+- (NSString *)dejal_lastPathComponentWithoutExtension
 {
-    NSRange range = [self rangeOfString:string];
-    
-    if (range.location == NSNotFound)
-        return self;
-    else
-        return [self substringFromIndex:range.location + range.length];
+    return [[self lastPathComponent] stringByDeletingPathExtension];
 }
 
 /**
- Similar to -substringToIndex:, but takes a string to look for instead of an index.  If the string is within the receiver, the characters from the start up to but excluding the position of that string are returned.  If it isn't within, the receiver is returned.
+ Given a file or directory path, returns the same path with the insertion added to the filename before the extension (if any), e.g. "/path/filename copy.txt".  This is the naming used for backup, copy and unique paths.
  
- @author DJS 2005-03.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_substringToString:(NSString *)string;
+- (NSString *)dejal_stringByInsertingBeforePathExtension:(NSString *)insertion;
 {
-    NSRange range = [self rangeOfString:string];
+    NSString *extension = [self pathExtension];
+    NSString *path = [[self stringByDeletingPathExtension] stringByAppendingString:insertion];
     
-    if (range.location == NSNotFound)
-        return self;
-    else
-        return [self substringToIndex:range.location];
+    if ([extension length])
+        path = [path stringByAppendingPathExtension:extension];
+    
+    return path;
 }
 
 /**
- Similar to using both -substringFromString: and -substringToString: to return a string from between two others, except if either the startString or endString is not present in the receiver, the defaultString is returned instead.
+ Given a file or directory path, returns the same path with the tilde character inserted before the extension (if any), as is conventional for backup files.
  
- @author DJS 2012-09.
- @version DJS 2012-10: changed to use -rangeFromString:toString:.
+ @author DJS 2004-03.
+ @version DJS 2026-10: changed to use -dejal_stringByInsertingBeforePathExtension:.
 */
 
-- (NSString *)dejal_substringFromString:(NSString *)startString toString:(NSString *)endString defaultString:(NSString *)defaultString;
+- (NSString *)dejal_backupFilePath
 {
-    NSRange substringRange = [self dejal_rangeFromString:startString toString:endString];
-    
-    if (substringRange.location == NSNotFound)
-        return defaultString;
-    else
-        return [self substringWithRange:substringRange];
+    return [self dejal_stringByInsertingBeforePathExtension:@"~"];
 }
 
 /**
- Returns the range of the string enclosed by the specified start and end strings, or NSNotFound if either couldn't be found.
+ Given a file or directory path, returns the same path if it is already unique (i.e. no file exists there), or returns that path with a number inserted before the extension to make it unique, if necessary.  See also -uniquePathWithPrefix:, below.
  
- @author DJS 2012-10.
+ @author DJS 2005-01.
 */
 
-- (NSRange)dejal_rangeFromString:(NSString *)startString toString:(NSString *)endString;
+- (NSString *)dejal_uniquePath
 {
-    return [self dejal_rangeFromString:startString toString:endString inclusive:NO];
+    return [self dejal_uniquePathWithPrefix:nil];
 }
 
 /**
- Returns the range of the string enclosed by the specified start and end strings, or NSNotFound if either couldn't be found.  If inclusive is YES, the range includes the start and end strings, otherwise it is just the text between them.
+ Given a file or directory path, returns the same path if it is already unique (i.e. no file exists there), or returns that path with the prefix and/or a number inserted before the extension to make it unique (e.g. "filename copy.txt", "filename copy 2.txt", "filename copy 3.txt", etc), if necessary.  The number is one more than the highest existing one, found by reading the directory once, rather than checking each candidate in turn.  Nothing is created at the path; when several threads or processes may be writing to the same folder, use -[NSFileManager dejal_claimUniquePathForPath:prefix:directory:error:] instead.  See also -uniquePath, above.
  
- @author DJS 2012-10.
- @version DJS 2013-01: changed to add the inclusive option.
+ @author DJS 2005-01.
+ @version DJS 2026-10: changed to use -[NSFileManager dejal_uniquePathForPath:prefix:], instead of checking every candidate.
 */
 
-- (NSRange)dejal_rangeFromString:(NSString *)startString toString:(NSString *)endString inclusive:(BOOL)inclusive;
+- (NSString *)dejal_uniquePathWithPrefix:(NSString *)prefix
 {
-    NSRange startRange = [self rangeOfString:startString];
-    
-    if (startRange.location == NSNotFound)
-        return startRange;
-    
-    NSInteger substringLocation = startRange.location + startRange.length;
-    NSRange endRange = [self rangeOfString:endString options:0 range:NSMakeRange(substringLocation, self.length - substringLocation)];
-    
-    if (endRange.location == NSNotFound)
-        return endRange;
-    
-    if (inclusive)
-        return NSMakeRange(startRange.location, (endRange.location - startRange.location) + endRange.length);
-    else
-        return NSMakeRange(substringLocation, endRange.location - substringLocation);
+    return [[NSFileManager defaultManager] dejal_uniquePathForPath:self prefix:prefix];
 }
 
 /**
- Returns the receiver with the characters in the reverse order.
+ Expands a tilde and/or symbolic link in the path, then checks that all directories in the path already exist.  If any don't, they are created.  The expanded path is returned.
  
- @author DJS 2004-01.
+ @author DJS 2004-03.
 */
 
-- (NSString *)dejal_reverse
+- (NSString *)dejal_validatedDirectoryPath
 {
-    NSString *nextChar;
-    NSMutableString *retString = [NSMutableString string];
-    NSInteger i;
+    NSString *standardized = [self dejal_expandedPath];
+    NSArray *components = [standardized pathComponents];
+    NSString *component;
+    NSString *path = @"";
     
-    for (i = [self length] - 1; i >= 0; i--)
+    for (component in components)
     {
-        unichar nChar = [self characterAtIndex:i];
-        nextChar = [NSString stringWithCharacters:&nChar length:1];
+        path = [path stringByAppendingPathComponent:component];
         
-        [retString appendString:nextChar];
+        if (![[NSFileManager defaultManager] fileExistsAtPath:path])
+            [[NSFileManager defaultManager] createDirectoryAtPath:path withIntermediateDirectories:NO attributes:nil error:NULL];
     }
     
-    return [NSString stringWithString:retString];
+    return path;
 }
 
 /**
- Returns a checksum of the receiver, which can be used to compare to other strings.  Similar to -hash, but that can (and has) changed between OS versions.
+ Similar to -validatedDirectoryPath, above, except the last path component is assumed to be a filename, and so is ignored.
  
- @author DJS 2011-07.
+ @author DJS 2004-03.
 */
 
-- (NSUInteger)dejal_checksum;
+- (NSString *)dejal_validatedFilePath
 {
-    NSUInteger base = [self length];
-    NSUInteger result = base * base;
+    NSString *filename = [self lastPathComponent];
+    NSString *directory = [self stringByDeletingLastPathComponent];
     
-    for (NSUInteger i = 0; i < [self length]; i++)
-    {
-        result = (result + ([self characterAtIndex:i] * (i + 34)) + (732 * i) + (base * (i + 83))) % 999999999;
-//        NSLog(@"i: %d; char: %d; calc: %d; result: %d", i, [self characterAtIndex:i], ([self characterAtIndex:i] * (i + 34)) + (732 * i) + (base * (i + 83)), result);         // log
-    }
+    directory = [directory dejal_validatedDirectoryPath];
     
-//    NSLog(@"checksum of %@ = %d", self, result);         // log
+    NSString *path = [directory stringByAppendingPathComponent:filename];
     
-    return result;
+    return path;
 }
 
 /**
- Returns a lightly encrypted rendition of the receiver, for hiding passwords etc.  Decrypt via -unmask, below.
+ Similar to the Cocoa -stringByStandardizingPath method, but also recognizes and expands the special application bundle indicator, "<APP>".  It can be abbreviated with -abbreviatedPath, below.
  
- @author DJS 2004-01.
+ @author DJS 2005-05.
 */
 
-- (NSString *)dejal_mask
+- (NSString *)dejal_expandedPath
 {
-    if (![self length])
-        return self;
-    
-    NSMutableString *retString = [NSMutableString string];
-    NSString *fragment;
-    NSDateComponents *components = [[NSCalendar currentCalendar] components:(NSCalendarUnitDay | NSCalendarUnitMinute | NSCalendarUnitSecond) fromDate:[NSDate date]];
-    NSUInteger randomValue = ([components day] * [components minute]) / ([components second] + 5);
-    unichar character = 0;
-    NSUInteger i;
-    
-    for (i = 0; i < [self length]; i++)
-    {
-        character = [self characterAtIndex:i] + 57 + (randomValue * (i + 3));
-        fragment = [NSString stringWithFormat:@"%xO", character];
-        
-        [retString appendString:fragment];
-    }
-    
-#if TARGET_OS_IPHONE
-    return [NSString stringWithFormat:@"1a7q4%lud39%@", (unsigned long)randomValue, [retString dejal_reverse]];          // Version 1, in case I want to change the algorithm
-#else
-    return [NSString stringWithFormat:@"1a7q4%ldd39%@", randomValue, [retString dejal_reverse]];          // Version 1, in case I want to change the algorithm
-#endif
+    if ([self hasPrefix:@"<APP>"])
+        return [self stringByReplacingOccurrencesOfString:@"<APP>" withString:[[NSBundle mainBundle] bundlePath]];
+    else
+        return [self stringByStandardizingPath];
 }
 
 /**
- Given a string that was masked via -mask, above, returns the decrypted rendition.  Okay to call with an unmasked string; just returns self in this case.
+ Similar to the Cocoa -stringByAbbreviatingWithTildeInPath method, but also abbreviates a path within the application bundle with the indicator "<APP>".  It can be expanded with -expandedPath, above.
  
- @author DJS 2004-01.
+ @author DJS 2005-05.
 */
 
-- (NSString *)dejal_unmask
+- (NSString *)dejal_abbreviatedPath
 {
-    if (![self length])
-        return self;
-    
-    NSScanner *scanner = [NSScanner scannerWithString:self];
-    NSMutableString *retString = [NSMutableString string];
-    NSString *fragment;
-    unsigned hexInt = 0;
-    unichar character = 0;
-    NSInteger version = 0;
-    NSInteger randomValue = 0;
-    NSInteger i = 0;
-    
-    if (![scanner scanInteger:&version])
-        return self;
-    
-    if (![scanner scanString:@"a7q4" intoString:nil])
-        return self;
-    
-    if (![scanner scanInteger:&randomValue])
-        return self;
-    
-    if (![scanner scanString:@"d39" intoString:nil])
-        return self;
-    
-    NSInteger location = [scanner scanLocation];
-    NSString *remaining = [[self substringFromIndex:location] dejal_reverse];
-    
-    scanner = [NSScanner scannerWithString:remaining];
-    
-    while (![scanner isAtEnd])
-    {
-        if ([scanner scanHexInt:&hexInt])
-        {
-            character = hexInt - (randomValue * (i + 3)) - 57;
-            fragment = [NSString stringWithCharacters:&character length:1];
-            
-            [retString appendString:fragment];
-        }
-        
-        [scanner scanString:@"O" intoString:nil];
-        
-        i++;
-    }
+    NSString *bundlePath = [[NSBundle mainBundle] bundlePath];
     
-    return [NSString stringWithString:retString];
+    if ([self hasPrefix:bundlePath])
+        return [self stringByReplacingOccurrencesOfString:bundlePath withString:@"<APP>"];
+    else
+        return [self stringByAbbreviatingWithTildeInPath];
 }
 
-/**
- Convert the receiver to a Base64-encoded edition.
- 
- @param encoding The string encoding to use, e.g. NSUTF8StringEncoding.
- @returns The Base64-encoded edition.
- 
- @author DJS 2014-07.
- */
+@end
 
-- (NSString *)dejal_encodeAsBase64UsingEncoding:(NSStringEncoding)encoding;
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@implementation NSString (DejalPropertyList)
+
++ (NSString *)dejal_stringWithBoolValue:(BOOL)value;
 {
-    NSData *data = [self dataUsingEncoding:encoding];
-    
-    return [data base64EncodedStringWithOptions:0];
+    return [self dejal_stringWithIntegerValue:value];
 }
 
+@end
+
+
+// ----------------------------------------------------------------------------------------
+#pragma mark -
+// ----------------------------------------------------------------------------------------
+
+
+@implementation NSMutableString (Dejal)
+
 /**
- Convert the Base64-encoded receiver to a decoded string.
- 
- @param encoding The string encoding to use, e.g. NSUTF8StringEncoding.
- @returns The decoded string.
+ Removes from the receiver all characters matching the set.
  
- @author DJS 2014-07.
- */
+ @author DJS 2005-04.
+ @version DJS 2026-10: changed to filter in a single pass and replace the contents once, instead of deleting each character individually; the receiver isn't touched if nothing is removed.
+*/
 
-- (NSString *)dejal_decodeFromBase64UsingEncoding:(NSStringEncoding)encoding;
+- (void)dejal_deleteCharactersInSet:(NSCharacterSet *)set;
 {
-    NSData *data = [[NSData alloc] initWithBase64EncodedString:self options:NSDataBase64DecodingIgnoreUnknownCharacters];
+    NSString *filtered = DejalStringByRemovingCharactersInSet(self, set);
     
-    return [[NSString alloc] initWithData:data encoding:encoding];
+    if (filtered)
+        [self setString:filtered];
 }
 
-/**
- Returns the receiver encoded with the standard Rot13 algorithm: letter characters rotated halfway around the alphabet, other characters untouched.
- 
- @author DJS 2005-03.
- @version DJS 2009-11: changed to rename the method, as seemed to be calling something else (private OS method?).
-*/ 
+- (void)dejal_caseInsensitiveReplaceAllOccurrencesOf:(NSString *)string1 with:(NSString *)string2;
+{
+    [self replaceOccurrencesOfString:string1 withString:string2 options:NSCaseInsensitiveSearch range:NSMakeRange(0, [self length])];
+}
 
-- (NSString *)dejal_rotate13
+- (void)dejal_replaceAllOccurrencesOf:(NSString *)string1 with:(NSString *)string2
 {
-    NSMutableString *string = [NSMutableString string];
-    NSUInteger i;
-    
-    for (i = 0; i < [self length]; ++i)
+    [self replaceOccurrencesOfString:string1 withString:string2 options:0 range:NSMakeRange(0, [self length])];
+}
+
+/*      my old implementation; now replaced by Apple's (introduced in 10.2):
+- (void)replaceAllOccurrencesOf:(NSString *)string1 with:(NSString *)string2
+{
+    BOOL done = NO;
+
+    while (!done)
     {
-        unichar character = [self characterAtIndex:i];
-        unichar capital = character & 32;
-        
-        character &= ~capital;
-        character = ((character >= 'A') && (character <= 'z')) ? ((character - 'A' + 13) % 26 + 'A') : character;
-        character |= capital;
-        
-        [string appendFormat:@"%c", character];
+        NSRange nextPosition = [self rangeOfString:string1];
+
+        if (nextPosition.length > 0)
+            [self replaceCharactersInRange:nextPosition withString:string2];
+        else
+            done = YES;
+    }
+}
+*/
+
+- (void)dejal_deleteLeadingSpaces:(BOOL)leading trailingSpaces:(BOOL)trailing
+{
+    if (leading)
+    {
+        while ([self hasPrefix:@" "])
+            [self deleteCharactersInRange:NSMakeRange(0, 1)];
+    }
+
+    if (trailing)
+    {
+        while ([self hasSuffix:@" "])
+            [self deleteCharactersInRange:NSMakeRange([self length] - 1, 1)];
     }
-    
-    return string;
 }
 
 /**
- Returns a string that is guaranteed to be globally unique, and can be used as a unique identifier.  This variation omits the dashes.  Use [NSUUID UUID].UUIDString directly if dashes are okay.
+ If the string is a valid non-empty string, it is appended to the receiver.  Otherwise, if the alternative is a valid non-empty string, it is appended.  If neither applies, the receiver is not changed.
  
- @author DJS 2013-07.
- @version DJS 2014-08: changed to use NSUUID.
+ @author DJS 2004-03.
 */
 
-+ (NSString *)dejal_uuid;
+- (void)dejal_appendString:(NSString *)string or:(NSString *)alternative;
 {
-    return [[NSUUID UUID].UUIDString stringByReplacingOccurrencesOfString:@"-" withString:@""];
+    if ([string length])
+        [self appendString:string];
+    else if ([alternative length])
+        [self appendString:alternative];
 }
 
 /**
- Convenience method for -mappedFromValue:withDefault: to map a string value to an integer.
+ If the keyword is a valid non-empty string, the prefix and keyword are appended to the receiver (the prefix is only included if the receiver isn't empty, and may be nil if desired).  Otherwise, the receiver is not changed.
  
- @author DJS 2006-09.
+ @author DJS 2010-10.
+ @version DJS 2011-01: changed to call -appendSeparator:prefix:keyword:suffix:or:.
 */
 
-- (NSInteger)dejal_integerMappedFromString:(NSString *)value withDefault:(NSInteger)defaultValue;
+- (void)dejal_appendPrefix:(NSString *)prefix keyword:(NSString *)keyword;
 {
-    return [[self dejal_mappedFromValue:value withDefault:@(defaultValue)] integerValue];
+    [self dejal_appendSeparator:prefix prefix:nil keyword:keyword suffix:nil or:nil];
 }
 
 /**
- Convenience method for -mappedFromValue:withDefault: map an integer value to a string.
+ If the keyword is a valid non-empty string, the prefix, keyword, and suffix are appended to the receiver (the prefix and/or suffix may be nil if desired).  Otherwise, if the alternative is a valid non-empty string, it is appended.  If neither applies, the receiver is not changed.
  
- @author DJS 2006-09.
+ @author DJS 2004-03.
+ @version DJS 2011-01: changed to call -appendSeparator:prefix:keyword:suffix:or:.
 */
 
-- (NSString *)dejal_stringMappedFromInteger:(NSInteger)value withDefault:(NSString *)defaultValue;
+- (void)dejal_appendPrefix:(NSString *)prefix keyword:(NSString *)keyword suffix:(NSString *)suffix or:(NSString *)alternative;
 {
-    return [self dejal_mappedFromValue:@(value) withDefault:defaultValue];
+    [self dejal_appendSeparator:nil prefix:prefix keyword:keyword suffix:suffix or:alternative];
 }
 
 /**
- Given a mapping of the form "foo=bar;blah=beep;x=y" in the receiver and a value (of any type), returns the corresponding value.  For example, with the above mapping and a value of "blah", "beep" is returned.  It works both ways: if "beep" is passed, "blah" is returned.  If a match can't be found an a default value is provided, the default is returned.  There may be an easier or more efficient way to do this, other than big if/else or switch clauses, but this seems to be tidier from a usage point of view: just one line of code to call.  (I considered adding a DejalMapperData class for this, but decided against it for now as I wanted to use it in a Simon plugin, which has class-sharing issues if I ever wanted to use it elsewhere in the app.)
+ If the keyword is a valid non-empty string, the separator, prefix, keyword and suffix are appended to the receiver (the separator, prefix and suffix may be nil if desired).  The separator is only included if the receiver isn't empty.  Otherwise, if the alternative is a valid non-empty string, it is appended.  If neither applies, the receiver is not changed.
  
- @author DJS 2006-09.
+ @author DJS 2011-01.
 */
 
-- (NSString *)dejal_mappedFromValue:(id)value withDefault:(id)defaultValue;
+- (void)dejal_appendSeparator:(NSString *)separator prefix:(NSString *)prefix keyword:(NSString *)keyword suffix:(NSString *)suffix  or:(NSString *)alternative;
 {
-    NSArray *array = [self componentsSeparatedByString:@";"];
-    NSString *desired = [value description];
-    NSString *result = nil;
-    NSString *mapping = nil;
-    
-    // Scan through the mapping till a match is found:
-    for (mapping in array)
+    if (keyword.length)
     {
-    	NSArray *parts = [mapping componentsSeparatedByString:@"="];
+        if (self.length)
+            [self dejal_appendString:separator or:nil];
         
-        if ([desired isEqualToString:[parts firstObject]])
-            result = [parts lastObject];
-        else if ([desired isEqualToString:[parts lastObject]])
-            result = [parts firstObject];
+        [self dejal_appendString:prefix or:nil];
+        [self appendString:keyword];
+        [self dejal_appendString:suffix or:nil];
     }
-    
-    // If no result and a default was provided, return a copy of the default converted to a string (makes a copy as -[NSString description] returns self):
-    if (!result && defaultValue)
-        result = [[defaultValue copy] description];
-    
-    return result;
+    else
+        [self dejal_appendString:alternative or:nil];
 }
 
 @end
@@ -1227,353 +3082,637 @@
 // ----------------------------------------------------------------------------------------
 
 
-@implementation NSString (DejalInternet)
+// Number of characters the HTML text extractor buffers before passing them on:
+#define DEJAL_HTML_OUTPUT_BUFFER_LENGTH 4096
+
+// Number of bytes the HTML text extractor reads from a stream at a time:
+#define DEJAL_HTML_READ_CHUNK_LENGTH 65536
+
+// Maximum length of an entity name or number, excluding the "&" and ";":
+#define DEJAL_HTML_ENTITY_MAX_LENGTH 32
+
+// Maximum length of text held back before the first tag, in case it ends an incomplete leading tag:
+#define DEJAL_HTML_LEADING_TEXT_LIMIT 4096
+
+// Maximum length of a tag name that matters to the extractor ("script" or "style"):
+#define DEJAL_HTML_TAG_NAME_MAX_LENGTH 8
+
+
+typedef NS_ENUM(NSInteger, DejalHTMLState)
+{
+    DejalHTMLStateText = 0,
+    DejalHTMLStateEntity,
+    DejalHTMLStateTag,
+    DejalHTMLStateQuotedAttribute,
+    DejalHTMLStateComment,
+    DejalHTMLStateRawText
+};
+
 
 /**
- An Objective-C wrapper around the Core Foundation function to convert a URL-safe string into a raw format.
+ Returns YES if the lowercased tag name characters equal the name.
  
- @author DJS 2003-10.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_stringByReplacingPercentEscapes
+static BOOL DejalTagNameEquals(const unichar *tagName, const char *name)
+{
+    for (NSUInteger i = 0; name[i]; i++)
+        if (tagName[i] != (unichar)name[i])
+            return NO;
+    
+    return YES;
+}
+
+
+@interface DejalHTMLTextExtractor ()
+
+@property (nonatomic, strong) NSMutableString *text;
+
+@end
+
+
+@implementation DejalHTMLTextExtractor
 {
-    return (__bridge_transfer NSString *)CFURLCreateStringByReplacingPercentEscapes(NULL, (__bridge CFStringRef)self, CFSTR(""));
+    DejalHTMLState _state;
+    BOOL _holdingLeadingText;
+    unichar _output[DEJAL_HTML_OUTPUT_BUFFER_LENGTH];
+    NSUInteger _outputLength;
+    NSMutableString *_leadingText;
+    unichar _entity[DEJAL_HTML_ENTITY_MAX_LENGTH];
+    NSUInteger _entityLength;
+    unichar _tagName[DEJAL_HTML_TAG_NAME_MAX_LENGTH];
+    NSUInteger _tagNameLength;
+    NSUInteger _tagLength;
+    BOOL _tagNameDone;
+    BOOL _isEndTag;
+    unichar _quote;
+    NSUInteger _commentDashes;
+    const char *_rawTextEnd;
+    NSUInteger _rawTextMatch;
+    DejalUTF8DecoderState _utf8State;
 }
 
 /**
- An Objective-C wrapper around the Core Foundation function to convert a raw string into a URL-safe format.
+ Initializes an extractor that collects the text in memory, to be returned by -finish.
  
- @author DJS 2003-07.
- @version DJS 2016-03: Tweaked to do better encoding.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_stringByAddingPercentEscapes
+- (instancetype)init;
 {
-    //WARNING: ignoring deprecation; should fix sometime
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wdeprecated-declarations"
-    return (__bridge_transfer NSString *)CFURLCreateStringByAddingPercentEscapes(NULL, (__bridge CFStringRef)self, NULL, (CFStringRef)@"!*'\"();:@&=+$,/?%#[]% ", kCFStringEncodingUTF8);
-#pragma clang diagnostic pop
+    return [self initWithTextHandler:nil];
 }
 
 /**
- Returns a string based on the receiver with diacritical marks removed and percent escapes added as needed, safe for passing as a URL parameter.
+ Initializes an extractor that passes the text to the handler in pieces as it is extracted, so memory use stays bounded however much HTML is appended.  If the handler is nil, the text is collected in memory instead, to be returned by -finish.
  
- @author DJS 2007-04.
-*/
+ @param textHandler A block to receive each piece of text, or nil.
+ @returns A new extractor.
+ 
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_stringByMakingURLSafe;
+- (instancetype)initWithTextHandler:(void (^)(NSString *text))textHandler;
 {
-    return [[self dejal_stringByRemovingDiacriticalMarks] dejal_stringByAddingPercentEscapes];
+    if ((self = [super init]))
+    {
+        _textHandler = [textHandler copy];
+        _holdingLeadingText = YES;
+        _leadingText = [NSMutableString string];
+        
+        if (!textHandler)
+            self.text = [NSMutableString string];
+    }
+    
+    return self;
 }
 
 /**
- Given a string containing HTML tags like "<p>" and "<a href=...>", strips out all such tags, including any incomplete tags at the start of the string (if it is a substring of the source).
+ Private method to pass the buffered output on to the handler or collected text.
  
- @author DJS 2006-10.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_stringByStrippingHTML;
+- (void)flushOutput;
 {
-    NSMutableString *output = [NSMutableString stringWithCapacity:[self length]];
+    if (!_outputLength)
+        return;
     
-    // Scan through the string:
-    NSScanner *scanner = [NSScanner scannerWithString:self];
+    NSString *piece = [[NSString alloc] initWithCharacters:_output length:_outputLength];
     
-    // NSScanner skips spaces and returns by default, which we don't want, so get it to skip illegal characters instead:
-    [scanner setCharactersToBeSkipped:[NSCharacterSet illegalCharacterSet]];
+    _outputLength = 0;
     
-    while (![scanner isAtEnd])
+    if (_holdingLeadingText)
     {
-        NSString *prefix = @"";
-        
-        // Scan up till a HTML tag and remember for later:
-        [scanner scanUpToString:@"<" intoString:&prefix];
+        [_leadingText appendString:piece];
         
-        // If we found a HTML tag, scan past it:
-        if ([scanner scanString:@"<" intoString:nil] && [scanner scanUpToString:@">" intoString:nil])
-            [scanner scanString:@">" intoString:nil];
-        
-        // Append the stuff before the HTML tag to the output:
-        [output appendString:prefix];
+        // Too long to be the end of a tag, so give up holding it back:
+        if (_leadingText.length > DEJAL_HTML_LEADING_TEXT_LIMIT)
+            [self releaseLeadingTextDiscarding:NO];
     }
+    else if (self.textHandler)
+        self.textHandler(piece);
+    else
+        [self.text appendString:piece];
+}
+
+/**
+ Private method to stop holding back the text before the first tag, either passing it on, or discarding it as the end of an incomplete tag.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)releaseLeadingTextDiscarding:(BOOL)discard;
+{
+    NSString *leadingText = _leadingText;
     
-    NSRange range = [output rangeOfString:@">"];
+    _holdingLeadingText = NO;
+    _leadingText = nil;
     
-    if (range.location != NSNotFound)
-        [output deleteCharactersInRange:NSMakeRange(0, range.location + range.length)];
+    if (discard || !leadingText.length)
+        return;
     
-    return [NSString stringWithString:output];
+    if (self.textHandler)
+        self.textHandler(leadingText);
+    else
+        [self.text appendString:leadingText];
 }
 
 /**
- Given a potential URL, cleans it up to ensure it is valid.  If the receiver is blank, it is returned intact.  It defaults the TLD to ".com" without interfering with the path, and adds the "http://" scheme if needed.  So, for example, "dejal/products" will result in "http://www.dejal.com/products".  To specify a different default scheme, use -stringByCleaningURLWithDefaultScheme: instead.
+ Private method to add a character to the output.
  
- @author DJS 2003-11.
+ @author DJS 2026-10.
  */
 
-- (NSString *)dejal_stringByCleaningURL;
+- (void)emitCharacter:(unichar)character;
 {
-    return [self dejal_stringByCleaningURLWithDefaultScheme:nil];
+    if (_outputLength == DEJAL_HTML_OUTPUT_BUFFER_LENGTH)
+        [self flushOutput];
+    
+    _output[_outputLength++] = character;
 }
 
 /**
- Given a potential URL, cleans it up to ensure it is valid.  If the receiver is blank, it is returned intact.  It defaults the TLD to ".com" without interfering with the path, and adds the specified default scheme if needed.  If the scheme is nil, it defaults to "http://".  So, for example, "dejal/products" will result in "http://www.dejal.com/products".  To use "http://" as the default scheme, you could use -stringByCleaningURL instead.
+ Private method to add a run of characters to the output, copying as many at a time as the buffer has room for.
  
- @author DJS 2003-11.
- @version DJS 2004-01: changed to return blank intact.
- @version DJS 2004-06: changed to support the file:// scheme, which would contain a blank url component.
- @version DJS 2007-07: changed to support the localhost domain.
- @version DJS 2019-10: changed to use "https://", and not add "www.".
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_stringByCleaningURLWithDefaultScheme:(NSString *)scheme;
+- (void)emitCharacters:(const unichar *)characters length:(NSUInteger)length;
 {
-    if (![self length])
-        return self;
-    
-    NSString *url = self;
-    NSString *path = @"/";
-    NSRange range = [url rangeOfString:@"://"];
-    
-    if (range.location != NSNotFound)
-    {
-        scheme = [url substringToIndex:range.location + range.length];
-        url = [url substringFromIndex:range.location + range.length];
-    }
-    
-    range = [url rangeOfString:@"/"];
-    
-    if (range.location != NSNotFound)
-    {
-        path = [url substringFromIndex:range.location];
-        url = [url substringToIndex:range.location];
-    }
-    
-    if (![url containsString:@"."] && ![scheme isEqualToString:@"file://"] && ![url containsString:@"localhost"])
-        url = [NSString stringWithFormat:@"%@.com", url];
-    
-    if (!scheme)
+    while (length)
     {
-        scheme = @"https://";
+        if (_outputLength == DEJAL_HTML_OUTPUT_BUFFER_LENGTH)
+            [self flushOutput];
+        
+        NSUInteger count = MIN(length, DEJAL_HTML_OUTPUT_BUFFER_LENGTH - _outputLength);
+        
+        memcpy(_output + _outputLength, characters, count * sizeof(unichar));
+        _outputLength += count;
+        characters += count;
+        length -= count;
     }
-    
-    url = [NSString stringWithFormat:@"%@%@%@", scheme, url, path];
-    
-    return url;
 }
 
 /**
- Returns a URL representation of the receiver, or nil if it isn't a valid URL.
+ Private method to add a Unicode code point to the output, as a surrogate pair if necessary.
  
- @author DJS 2009-10.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSURL *)dejal_urlValue;
+- (void)emitCodePoint:(uint32_t)codePoint;
 {
-    NSURL *url = nil;
+    if (codePoint == 0 || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+        codePoint = 0xFFFD;
     
-    if (self.length)
-        url = [NSURL URLWithString:[self dejal_stringByCleaningURL]];
-    
-    return url;
+    if (codePoint > 0xFFFF)
+    {
+        codePoint -= 0x10000;
+        [self emitCharacter:(unichar)(0xD800 + (codePoint >> 10))];
+        [self emitCharacter:(unichar)(0xDC00 + (codePoint & 0x3FF))];
+    }
+    else
+    {
+        [self emitCharacter:(unichar)codePoint];
+    }
 }
 
-@end
-
-
-// ----------------------------------------------------------------------------------------
-#pragma mark -
-// ----------------------------------------------------------------------------------------
-
-
-@implementation NSString (DejalFilePath)
-
 /**
- Given a filename (not path), returns it with illegal filename characters removed or replaced.  If the resulting filename is blank, the specified default filename is returned instead.
+ Private method to decode the collected entity, returning its code point, or zero if it isn't a known or valid entity.
  
- @author DJS 2003-11.
- @version DJS 2011-04: changed to remove leading dots.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_stringByCleaningFilenameWithDefault:(NSString *)defaultFilename
+- (uint32_t)entityCodePoint;
 {
-    NSMutableString *mutString = [NSMutableString stringWithString:self];
+    if (!_entityLength)
+        return 0;
     
-    [mutString dejal_deleteLeadingSpaces:YES trailingSpaces:YES];
-    [mutString dejal_replaceAllOccurrencesOf:@"/" with:@"-"];
-    [mutString dejal_replaceAllOccurrencesOf:@":" with:@"-"];
+    if (_entity[0] == '#')
+    {
+        BOOL hex = _entityLength > 1 && (_entity[1] == 'x' || _entity[1] == 'X');
+        NSUInteger start = hex ? 2 : 1;
+        uint32_t value = 0;
+        
+        if (start >= _entityLength)
+            return 0;
+        
+        for (NSUInteger i = start; i < _entityLength; i++)
+        {
+            unichar character = _entity[i];
+            uint32_t digit;
+            
+            if (character >= '0' && character <= '9')
+                digit = character - '0';
+            else if (hex && character >= 'a' && character <= 'f')
+                digit = character - 'a' + 10;
+            else if (hex && character >= 'A' && character <= 'F')
+                digit = character - 'A' + 10;
+            else
+                return 0;
+            
+            value = value * (hex ? 16 : 10) + digit;
+            
+            if (value > 0x10FFFF)
+                value = 0x110000;
+        }
+        
+        return value ?: 0xFFFD;
+    }
     
-    while ([mutString hasPrefix:@"."])
-        [mutString deleteCharactersInRange:NSMakeRange(0, 1)];
+    static NSDictionary *namedEntities = nil;
+    static dispatch_once_t onceToken;
     
-    if ([mutString length])
-        return [NSString stringWithString:mutString];
-    else
-        return defaultFilename;
+    dispatch_once(&onceToken, ^
+                  {
+                      namedEntities = @{@"amp" : @'&', @"lt" : @'<', @"gt" : @'>', @"quot" : @'"', @"apos" : @'\'', @"nbsp" : @0xA0,
+                                        @"copy" : @0xA9, @"reg" : @0xAE, @"trade" : @0x2122, @"hellip" : @0x2026, @"mdash" : @0x2014, @"ndash" : @0x2013,
+                                        @"lsquo" : @0x2018, @"rsquo" : @0x2019, @"ldquo" : @0x201C, @"rdquo" : @0x201D, @"bull" : @0x2022, @"middot" : @0xB7,
+                                        @"laquo" : @0xAB, @"raquo" : @0xBB, @"euro" : @0x20AC, @"pound" : @0xA3, @"yen" : @0xA5, @"cent" : @0xA2,
+                                        @"deg" : @0xB0, @"times" : @0xD7, @"divide" : @0xF7, @"shy" : @0xAD, @"sect" : @0xA7, @"para" : @0xB6};
+                  });
+    
+    NSString *name = [[NSString alloc] initWithCharacters:_entity length:_entityLength];
+    
+    return [namedEntities[name] unsignedIntValue];
 }
 
 /**
- Same as -stringByAppendingPathComponent:, but the filename is first cleaned via -stringByCleaningFilenameWithDefault:.
+ Private method to output an entity that couldn't be decoded as is.
  
- @author DJS 2003-11.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_stringByAppendingPathComponent:(NSString *)dirtyFilename cleanWithDefault:(NSString *)defaultFilename
+- (void)emitLiteralEntity;
 {
-    return [self stringByAppendingPathComponent:[dirtyFilename dejal_stringByCleaningFilenameWithDefault:defaultFilename]];
+    [self emitCharacter:'&'];
+    
+    for (NSUInteger i = 0; i < _entityLength; i++)
+        [self emitCharacter:_entity[i]];
 }
 
 /**
- Returns the filename portion of a path, without any extension.
+ Private method to begin a tag, having just seen a "<".
  
- @author DJS 2003-11.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_lastPathComponentWithoutExtension
+- (void)beginTag;
 {
-    return [[self lastPathComponent] stringByDeletingPathExtension];
+    _state = DejalHTMLStateTag;
+    _tagNameLength = 0;
+    _tagLength = 0;
+    _tagNameDone = NO;
+    _isEndTag = NO;
+    
+    if (_holdingLeadingText)
+    {
+        [self flushOutput];
+        [self releaseLeadingTextDiscarding:NO];
+    }
 }
 
 /**
- Given a file or directory path, returns the same path with the tilde character inserted before the extension (if any), as is conventional for backup files.
+ Private method to end a tag, having just seen its ">".  Opening script and style tags switch to skipping their contents.
  
- @author DJS 2004-03.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_backupFilePath
+- (void)endTag;
 {
-    NSString *extension = [self pathExtension];
-    NSString *previous = [self stringByDeletingPathExtension];
-    NSString *path = [previous stringByAppendingString:@"~"];
+    _state = DejalHTMLStateText;
     
-    if ([extension length])
-        path = [path stringByAppendingPathExtension:extension];
+    if (_isEndTag)
+        return;
     
-    return path;
+    if (_tagNameLength == 6 && DejalTagNameEquals(_tagName, "script"))
+        _rawTextEnd = "</script";
+    else if (_tagNameLength == 5 && DejalTagNameEquals(_tagName, "style"))
+        _rawTextEnd = "</style";
+    else
+        return;
+    
+    _state = DejalHTMLStateRawText;
+    _rawTextMatch = 0;
 }
 
 /**
- Given a file or directory path, returns the same path if it is already unique (i.e. no file exists there), or returns that path with a number inserted before the extension to make it unique, if necessary.  See also -uniquePathWithPrefix:, below.
+ Appends UTF-16 characters of HTML.  The characters can be split anywhere, e.g. in the middle of a tag or entity.
  
- @author DJS 2005-01.
-*/
+ The state machine runs inline over the buffer, without a message per character: runs of plain text are copied to the output in bulk, and quoted attribute values and script or style contents are skipped up to the next character that could matter.  Messages are only sent at tag and entity boundaries.
+ 
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_uniquePath
+- (void)appendCharacters:(const unichar *)characters length:(NSUInteger)length;
 {
-    return [self dejal_uniquePathWithPrefix:nil];
+    NSUInteger i = 0;
+    
+    while (i < length)
+    {
+        unichar character = characters[i];
+        
+        switch (_state)
+        {
+            case DejalHTMLStateText:
+                if (character == '<')
+                {
+                    [self beginTag];
+                }
+                else if (character == '&')
+                {
+                    _state = DejalHTMLStateEntity;
+                    _entityLength = 0;
+                }
+                else if (character == '>' && _holdingLeadingText)
+                {
+                    // The text so far is the end of an incomplete tag at the start, so discard it:
+                    _outputLength = 0;
+                    [self releaseLeadingTextDiscarding:YES];
+                }
+                else
+                {
+                    NSUInteger end = i + 1;
+                    
+                    while (end < length && (character = characters[end]) != '<' && character != '&' && (character != '>' || !_holdingLeadingText))
+                        end++;
+                    
+                    [self emitCharacters:characters + i length:end - i];
+                    i = end;
+                    continue;
+                }
+                break;
+                
+            case DejalHTMLStateEntity:
+                if (character == ';')
+                {
+                    uint32_t codePoint = [self entityCodePoint];
+                    
+                    if (codePoint)
+                    {
+                        [self emitCodePoint:codePoint];
+                    }
+                    else
+                    {
+                        [self emitLiteralEntity];
+                        [self emitCharacter:';'];
+                    }
+                    
+                    _state = DejalHTMLStateText;
+                }
+                else if (_entityLength < DEJAL_HTML_ENTITY_MAX_LENGTH && ((character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || (character >= '0' && character <= '9') || character == '#'))
+                {
+                    _entity[_entityLength++] = character;
+                }
+                else
+                {
+                    // Not part of an entity, so process the character again as text:
+                    [self emitLiteralEntity];
+                    _state = DejalHTMLStateText;
+                    continue;
+                }
+                break;
+                
+            case DejalHTMLStateTag:
+                _tagLength++;
+                
+                // Track progress through a "<!--" comment opener:
+                if (_tagLength <= 3)
+                {
+                    if (_tagLength == 1)
+                        _commentDashes = character == '!' ? 1 : 0;
+                    else if (_commentDashes == _tagLength - 1 && character == '-')
+                        _commentDashes = _tagLength;
+                    else
+                        _commentDashes = 0;
+                    
+                    if (_commentDashes == 3)
+                    {
+                        _state = DejalHTMLStateComment;
+                        _commentDashes = 0;
+                        break;
+                    }
+                }
+                
+                if (character == '>')
+                {
+                    [self endTag];
+                }
+                else if (character == '"' || character == '\'')
+                {
+                    _quote = character;
+                    _tagNameDone = YES;
+                    _state = DejalHTMLStateQuotedAttribute;
+                }
+                else if (_tagLength == 1 && character == '/')
+                {
+                    _isEndTag = YES;
+                }
+                else if (!_tagNameDone && ((character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || (character >= '0' && character <= '9')))
+                {
+                    if (_tagNameLength < DEJAL_HTML_TAG_NAME_MAX_LENGTH)
+                        _tagName[_tagNameLength] = character >= 'A' && character <= 'Z' ? character + ('a' - 'A') : character;
+                    
+                    _tagNameLength++;
+                }
+                else if (!(_tagLength == 1 && character == '!'))
+                {
+                    _tagNameDone = YES;
+                }
+                break;
+                
+            case DejalHTMLStateQuotedAttribute:
+                while (i < length && characters[i] != _quote)
+                    i++;
+                
+                if (i < length)
+                    _state = DejalHTMLStateTag;
+                break;
+                
+            case DejalHTMLStateComment:
+                if (character == '>' && _commentDashes >= 2)
+                    _state = DejalHTMLStateText;
+                else if (character == '-')
+                    _commentDashes++;
+                else
+                    _commentDashes = 0;
+                break;
+                
+            case DejalHTMLStateRawText:
+            {
+                // Nothing can end the element before the next "<":
+                if (!_rawTextMatch && character != '<')
+                {
+                    while (i < length && characters[i] != '<')
+                        i++;
+                    
+                    continue;
+                }
+                
+                unichar expected = (unichar)_rawTextEnd[_rawTextMatch];
+                unichar lowered = character >= 'A' && character <= 'Z' ? character + ('a' - 'A') : character;
+                
+                if (lowered == expected)
+                {
+                    _rawTextMatch++;
+                    
+                    if (!_rawTextEnd[_rawTextMatch])
+                    {
+                        // Found the end tag; skip the rest of it like any other tag:
+                        _state = DejalHTMLStateTag;
+                        _tagNameLength = 0;
+                        _tagLength = 2;
+                        _tagNameDone = YES;
+                        _isEndTag = YES;
+                    }
+                }
+                else
+                {
+                    _rawTextMatch = character == '<' ? 1 : 0;
+                }
+                break;
+            }
+        }
+        
+        i++;
+    }
 }
 
 /**
- Given a file or directory path, returns the same path if it is already unique (i.e. no file exists there), or returns that path with the prefix and/or a number inserted before the extension to make it unique (e.g. "filename copy.txt", "filename copy 2.txt", "filename copy 3.txt", etc), if necessary.  See also -uniquePath, above.
+ Appends a string of HTML, directly from its characters if the string can provide them, otherwise a chunk at a time.
  
- @author DJS 2005-01.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_uniquePathWithPrefix:(NSString *)prefix
+- (void)appendString:(NSString *)string;
 {
-    if (![[NSFileManager defaultManager] fileExistsAtPath:self])
-        return self;
+    NSUInteger length = string.length;
+    const unichar *direct = CFStringGetCharactersPtr((__bridge CFStringRef)string);
     
-    NSString *path = nil;
-    NSString *extension = [self pathExtension];
-    NSString *previous = [self stringByDeletingPathExtension];
-    BOOL usePrefix = [prefix length];
-    NSUInteger i = !usePrefix;
+    if (direct)
+    {
+        [self appendCharacters:direct length:length];
+        return;
+    }
     
-    do
+    unichar buffer[DEJAL_HTML_OUTPUT_BUFFER_LENGTH];
+    
+    for (NSUInteger location = 0; location < length; location += DEJAL_HTML_OUTPUT_BUFFER_LENGTH)
     {
-        i++;
-        path = previous;
-        
-        if (usePrefix)
-            path = [path stringByAppendingFormat:@" %@", prefix];
-        
-        if (i > 1)
-#if TARGET_OS_IPHONE
-            path = [path stringByAppendingFormat:@" %lu", (unsigned long)i];
-#else
-            path = [path stringByAppendingFormat:@" %ld", i];
-#endif
+        NSRange range = NSMakeRange(location, MIN(DEJAL_HTML_OUTPUT_BUFFER_LENGTH, length - location));
         
-        if ([extension length])
-            path = [path stringByAppendingPathExtension:extension];
+        [string getCharacters:buffer range:range];
+        [self appendCharacters:buffer length:range.length];
     }
-    while ([[NSFileManager defaultManager] fileExistsAtPath:path]);
-    
-    return path;
 }
 
 /**
- Expands a tilde and/or symbolic link in the path, then checks that all directories in the path already exist.  If any don't, they are created.  The expanded path is returned.
+ Appends UTF-8 bytes of HTML.  The bytes can be split anywhere, including in the middle of a multi-byte character, which is completed by the next call.  Invalid sequences are replaced with U+FFFD.
  
- @author DJS 2004-03.
-*/
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_validatedDirectoryPath
+- (void)appendUTF8Bytes:(const uint8_t *)bytes length:(NSUInteger)length;
 {
-    NSString *standardized = [self dejal_expandedPath];
-    NSArray *components = [standardized pathComponents];
-    NSString *component;
-    NSString *path = @"";
+    unichar characters[DEJAL_UTF8_DECODE_CHUNK_LENGTH + 4];
     
-    for (component in components)
+    for (NSUInteger location = 0; location < length; location += DEJAL_UTF8_DECODE_CHUNK_LENGTH)
     {
-        path = [path stringByAppendingPathComponent:component];
+        NSUInteger count = DejalDecodeUTF8(&_utf8State, bytes + location, MIN(DEJAL_UTF8_DECODE_CHUNK_LENGTH, length - location), characters);
         
-        if (![[NSFileManager defaultManager] fileExistsAtPath:path])
-            [[NSFileManager defaultManager] createDirectoryAtPath:path withIntermediateDirectories:NO attributes:nil error:NULL];
+        [self appendCharacters:characters length:count];
     }
-    
-    return path;
 }
 
 /**
- Similar to -validatedDirectoryPath, above, except the last path component is assumed to be a filename, and so is ignored.
+ Reads UTF-8 HTML from the stream in fixed-size chunks until the end, opening it if needed.  Memory use is bounded by the chunk size (plus the collected text, if there is no handler).
  
- @author DJS 2004-03.
-*/
+ @returns YES if the stream was read to the end, or NO if it had an error.
+ 
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_validatedFilePath
+- (BOOL)appendContentsOfStream:(NSInputStream *)stream;
 {
-    NSString *filename = [self lastPathComponent];
-    NSString *directory = [self stringByDeletingLastPathComponent];
+    uint8_t *buffer = malloc(DEJAL_HTML_READ_CHUNK_LENGTH);
+    NSInteger bytesRead;
     
-    directory = [directory dejal_validatedDirectoryPath];
+    if (stream.streamStatus == NSStreamStatusNotOpen)
+        [stream open];
     
-    NSString *path = [directory stringByAppendingPathComponent:filename];
+    while ((bytesRead = [stream read:buffer maxLength:DEJAL_HTML_READ_CHUNK_LENGTH]) > 0)
+        [self appendUTF8Bytes:buffer length:(NSUInteger)bytesRead];
     
-    return path;
+    free(buffer);
+    
+    return bytesRead == 0;
 }
 
 /**
- Similar to the Cocoa -stringByStandardizingPath method, but also recognizes and expands the special application bundle indicator, "<APP>".  It can be abbreviated with -abbreviatedPath, below.
+ Reads a UTF-8 HTML file in fixed-size chunks.
  
- @author DJS 2005-05.
-*/
+ @returns YES if the file was read, or NO if it couldn't be.
+ 
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_expandedPath
+- (BOOL)appendContentsOfFile:(NSString *)path;
 {
-    if ([self hasPrefix:@"<APP>"])
-        return [self stringByReplacingOccurrencesOfString:@"<APP>" withString:[[NSBundle mainBundle] bundlePath]];
-    else
-        return [self stringByStandardizingPath];
+    NSInputStream *stream = [NSInputStream inputStreamWithFileAtPath:path];
+    BOOL result = [self appendContentsOfStream:stream];
+    
+    [stream close];
+    
+    return stream && result;
 }
 
 /**
- Similar to the Cocoa -stringByAbbreviatingWithTildeInPath method, but also abbreviates a path within the application bundle with the indicator "<APP>".  It can be expanded with -expandedPath, above.
+ Finishes extracting: an incomplete entity at the end is output as is, while an incomplete tag, comment or script or style element is dropped.
  
- @author DJS 2005-05.
-*/
+ @returns The extracted text, if there is no handler, or nil if there is.
+ 
+ @author DJS 2026-10.
+ */
 
-- (NSString *)dejal_abbreviatedPath
+- (NSString *)finish;
 {
-    NSString *bundlePath = [[NSBundle mainBundle] bundlePath];
+    unichar replacement;
     
-    if ([self hasPrefix:bundlePath])
-        return [self stringByReplacingOccurrencesOfString:bundlePath withString:@"<APP>"];
-    else
-        return [self stringByAbbreviatingWithTildeInPath];
+    if (DejalFinishDecodingUTF8(&_utf8State, &replacement))
+        [self appendCharacters:&replacement length:1];
+    
+    if (_state == DejalHTMLStateEntity)
+        [self emitLiteralEntity];
+    
+    _state = DejalHTMLStateText;
+    
+    [self flushOutput];
+    
+    if (_holdingLeadingText)
+        [self releaseLeadingTextDiscarding:NO];
+    
+    return self.text ? [self.text copy] : nil;
 }
 
 @end
@@ -1584,141 +3723,360 @@
 // ----------------------------------------------------------------------------------------
 
 
-@implementation NSString (DejalPropertyList)
+// Number of characters of a string the text scanner copies at a time, when it can't access them directly:
+#define DEJAL_TEXT_STRING_CHUNK_LENGTH 4096
 
-+ (NSString *)dejal_stringWithBoolValue:(BOOL)value;
+// Number of bytes the text scanner reads from a stream at a time:
+#define DEJAL_TEXT_READ_CHUNK_LENGTH 65536
+
+
+typedef NS_OPTIONS(uint8_t, DejalTextClass)
 {
-    return [self dejal_stringWithIntegerValue:value];
-}
+    DejalTextClassWhitespace = 1 << 0,
+    DejalTextClassSkipped = 1 << 1,
+    DejalTextClassLineFeed = 1 << 2,
+    DejalTextClassBreak = DejalTextClassWhitespace | DejalTextClassLineFeed
+};
 
-@end
 
+/**
+ Returns a table of the DejalTextClass of each unichar value, built once: whitespace ends words and separates tokens for wrapping, skipped characters (whitespace, newlines and punctuation) don't start words, and LF separates paragraphs.
+ 
+ @author DJS 2026-10.
+ */
 
-// ----------------------------------------------------------------------------------------
-#pragma mark -
-// ----------------------------------------------------------------------------------------
+static const uint8_t *DejalTextClassTable(void)
+{
+    static uint8_t *table = NULL;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^
+                  {
+                      NSMutableCharacterSet *skippedSet = [NSMutableCharacterSet whitespaceAndNewlineCharacterSet];
+                      
+                      [skippedSet formUnionWithCharacterSet:[NSCharacterSet punctuationCharacterSet]];
+                      
+                      const uint8_t *whitespaceBitmap = DejalCharacterSetBitmap([NSCharacterSet whitespaceCharacterSet]).bytes;
+                      const uint8_t *skippedBitmap = DejalCharacterSetBitmap(skippedSet).bytes;
+                      
+                      table = calloc(65536, sizeof(uint8_t));
+                      
+                      for (NSUInteger character = 0; character < 65536; character++)
+                      {
+                          if (DejalBitmapContainsCharacter(whitespaceBitmap, (unichar)character))
+                              table[character] |= DejalTextClassWhitespace;
+                          
+                          if (DejalBitmapContainsCharacter(skippedBitmap, (unichar)character))
+                              table[character] |= DejalTextClassSkipped;
+                      }
+                      
+                      table['\n'] |= DejalTextClassLineFeed;
+                  });
+    
+    return table;
+}
+
+/**
+ Returns the index of the first whitespace or LF character at or after the index, or the length if there isn't one.  Printable ASCII characters can't be either, so runs of them are skipped four at a time: a 64-bit word is skipped if no character has bits above 0x7F, and each plus 0x5F carries into bit 7, i.e. each is above 0x20.
+ 
+ @author DJS 2026-10.
+ */
+
+static NSUInteger DejalIndexOfTextBreak(const unichar *characters, NSUInteger index, NSUInteger length, const uint8_t *classes)
+{
+    while (index < length)
+    {
+        if (index + 4 <= length)
+        {
+            uint64_t word;
+            
+            memcpy(&word, characters + index, sizeof(word));
+            
+            if (!(word & 0xFF80FF80FF80FF80ULL) && ((word + 0x005F005F005F005FULL) & 0x0080008000800080ULL) == 0x0080008000800080ULL)
+            {
+                index += 4;
+                continue;
+            }
+        }
+        
+        if (classes[characters[index]] & DejalTextClassBreak)
+            break;
+        
+        index++;
+    }
+    
+    return index;
+}
 
 
-@implementation NSMutableString (Dejal)
+@implementation DejalTextScanner
+{
+    const uint8_t *_classes;
+    BOOL _inWord;
+    BOOL _inSeparator;
+    NSMutableData *_line;
+    NSMutableData *_token;
+    DejalUTF8DecoderState _utf8State;
+}
 
 /**
- Removes from the receiver all characters matching the set.
+ Initializes a scanner that just counts characters, words and paragraphs.
  
- @author DJS 2005-04.
-*/
+ @author DJS 2026-10.
+ */
 
-- (void)dejal_deleteCharactersInSet:(NSCharacterSet *)set;
+- (instancetype)init;
 {
-    NSInteger i;
-    
-    for (i = [self length] - 1; i >= 0; i--)
+    return [self initWithWrapLength:NSUIntegerMax lineHandler:nil];
+}
+
+/**
+ Initializes a scanner that counts characters, words and paragraphs, and if there is a line handler, wraps the text to lines no more than the wrap length, broken after whitespace, and passes each line to the handler.  Paragraphs are separated by LFs, which are not included in the lines.  Words longer than the wrap length are not broken, so are on lines of their own.  Pass NSUIntegerMax as the wrap length to split the text into paragraphs without wrapping.
+ 
+ Only the current line and word are buffered, so memory use stays bounded however much text is appended, as long as the lines are.
+ 
+ @param wrapLength The maximum length of lines passed to the handler.
+ @param lineHandler A block to receive each line, or nil to just count.
+ @returns A new scanner.
+ 
+ @author DJS 2026-10.
+ */
+
+- (instancetype)initWithWrapLength:(NSUInteger)wrapLength lineHandler:(void (^)(NSString *line))lineHandler;
+{
+    if ((self = [super init]))
     {
-        unichar nChar = [self characterAtIndex:i];
+        _wrapLength = wrapLength;
+        _lineHandler = [lineHandler copy];
+        _classes = DejalTextClassTable();
+        _paragraphCount = 1;
         
-        if ([set characterIsMember:nChar])
-            [self deleteCharactersInRange:NSMakeRange(i, 1)];
+        if (lineHandler)
+        {
+            _line = [NSMutableData data];
+            _token = [NSMutableData data];
+        }
     }
+    
+    return self;
 }
 
-- (void)dejal_caseInsensitiveReplaceAllOccurrencesOf:(NSString *)string1 with:(NSString *)string2;
+/**
+ Private method to add the current token, i.e. a word and the whitespace after it, to the current line, or if it doesn't fit, pass the line on and start a new one with the token.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)endToken;
 {
-    [self replaceOccurrencesOfString:string1 withString:string2 options:NSCaseInsensitiveSearch range:NSMakeRange(0, [self length])];
+    NSUInteger tokenLength = _token.length / sizeof(unichar);
+    
+    _inSeparator = NO;
+    
+    if (!tokenLength)
+        return;
+    
+    if (_line.length / sizeof(unichar) + tokenLength <= self.wrapLength)
+    {
+        [_line appendData:_token];
+    }
+    else
+    {
+        [self endLine];
+        [_line setData:_token];
+    }
+    
+    _token.length = 0;
 }
 
-- (void)dejal_replaceAllOccurrencesOf:(NSString *)string1 with:(NSString *)string2
+/**
+ Private method to pass the current line on to the handler.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)endLine;
 {
-    [self replaceOccurrencesOfString:string1 withString:string2 options:0 range:NSMakeRange(0, [self length])];
+    NSString *line = [[NSString alloc] initWithCharacters:_line.bytes length:_line.length / sizeof(unichar)];
+    
+    _line.length = 0;
+    
+    self.lineHandler(line);
 }
 
-/*      my old implementation; now replaced by Apple's (introduced in 10.2):
-- (void)replaceAllOccurrencesOf:(NSString *)string1 with:(NSString *)string2
-{
-    BOOL done = NO;
+/**
+ Appends UTF-16 characters of text, classifying them in a single pass.  Runs of characters that don't affect the word count or wrapping are skipped without looking at each, and are copied to the current word in one go when wrapping.  The characters can be split anywhere.
+ 
+ @author DJS 2026-10.
+ */
 
-    while (!done)
+- (void)appendCharacters:(const unichar *)characters length:(NSUInteger)length;
+{
+    const uint8_t *classes = _classes;
+    BOOL wrapping = _token != nil;
+    NSUInteger index = 0;
+    
+    _characterCount += length;
+    
+    while (index < length)
     {
-        NSRange nextPosition = [self rangeOfString:string1];
-
-        if (nextPosition.length > 0)
-            [self replaceCharactersInRange:nextPosition withString:string2];
+        DejalTextClass class = classes[characters[index]];
+        NSUInteger end;
+        
+        if (class & DejalTextClassWhitespace)
+        {
+            for (end = index + 1; end < length && (classes[characters[end]] & DejalTextClassWhitespace); end++)
+                ;
+            
+            _inWord = NO;
+            _inSeparator = YES;
+        }
+        else if (class & DejalTextClassLineFeed)
+        {
+            _paragraphCount++;
+            
+            if (wrapping)
+            {
+                [self endToken];
+                [self endLine];
+            }
+            
+            index++;
+            continue;
+        }
         else
-            done = YES;
+        {
+            if (_inSeparator && wrapping)
+                [self endToken];
+            
+            _inSeparator = NO;
+            
+            // Like NSScanner skipping punctuation and newlines, then scanning up to whitespace:
+            for (end = index; !_inWord && end < length && !(classes[characters[end]] & DejalTextClassBreak); end++)
+            {
+                if (!(classes[characters[end]] & DejalTextClassSkipped))
+                {
+                    _inWord = YES;
+                    _wordCount++;
+                }
+            }
+            
+            end = DejalIndexOfTextBreak(characters, end, length, classes);
+        }
+        
+        if (wrapping)
+            [_token appendBytes:characters + index length:(end - index) * sizeof(unichar)];
+        
+        index = end;
     }
 }
-*/
 
-- (void)dejal_deleteLeadingSpaces:(BOOL)leading trailingSpaces:(BOOL)trailing
+/**
+ Appends a string of text, scanning its characters directly if they are available, otherwise a chunk at a time.
+ 
+ @author DJS 2026-10.
+ */
+
+- (void)appendString:(NSString *)string;
 {
-    if (leading)
+    NSUInteger length = string.length;
+    const unichar *characters = CFStringGetCharactersPtr((__bridge CFStringRef)string);
+    
+    if (characters)
     {
-        while ([self hasPrefix:@" "])
-            [self deleteCharactersInRange:NSMakeRange(0, 1)];
+        [self appendCharacters:characters length:length];
+        return;
     }
-
-    if (trailing)
+    
+    unichar buffer[DEJAL_TEXT_STRING_CHUNK_LENGTH];
+    
+    for (NSUInteger location = 0; location < length; location += DEJAL_TEXT_STRING_CHUNK_LENGTH)
     {
-        while ([self hasSuffix:@" "])
-            [self deleteCharactersInRange:NSMakeRange([self length] - 1, 1)];
+        NSRange range = NSMakeRange(location, MIN(DEJAL_TEXT_STRING_CHUNK_LENGTH, length - location));
+        
+        [string getCharacters:buffer range:range];
+        [self appendCharacters:buffer length:range.length];
     }
 }
 
 /**
- If the string is a valid non-empty string, it is appended to the receiver.  Otherwise, if the alternative is a valid non-empty string, it is appended.  If neither applies, the receiver is not changed.
+ Appends UTF-8 bytes of text.  The bytes can be split anywhere, including in the middle of a multi-byte character, which is completed by the next call.  Invalid sequences are replaced with U+FFFD.
  
- @author DJS 2004-03.
-*/
+ @author DJS 2026-10.
+ */
 
-- (void)dejal_appendString:(NSString *)string or:(NSString *)alternative;
+- (void)appendUTF8Bytes:(const uint8_t *)bytes length:(NSUInteger)length;
 {
-    if ([string length])
-        [self appendString:string];
-    else if ([alternative length])
-        [self appendString:alternative];
+    unichar characters[DEJAL_UTF8_DECODE_CHUNK_LENGTH + 4];
+    
+    for (NSUInteger location = 0; location < length; location += DEJAL_UTF8_DECODE_CHUNK_LENGTH)
+    {
+        NSUInteger count = DejalDecodeUTF8(&_utf8State, bytes + location, MIN(DEJAL_UTF8_DECODE_CHUNK_LENGTH, length - location), characters);
+        
+        [self appendCharacters:characters length:count];
+    }
 }
 
 /**
- If the keyword is a valid non-empty string, the prefix and keyword are appended to the receiver (the prefix is only included if the receiver isn't empty, and may be nil if desired).  Otherwise, the receiver is not changed.
+ Reads UTF-8 text from the stream in fixed-size chunks until the end, opening it if needed.  Memory use is bounded by the chunk size plus the current line.
  
- @author DJS 2010-10.
- @version DJS 2011-01: changed to call -appendSeparator:prefix:keyword:suffix:or:.
-*/
+ @returns YES if the stream was read to the end, or NO if it had an error.
+ 
+ @author DJS 2026-10.
+ */
 
-- (void)dejal_appendPrefix:(NSString *)prefix keyword:(NSString *)keyword;
+- (BOOL)appendContentsOfStream:(NSInputStream *)stream;
 {
-    [self dejal_appendSeparator:prefix prefix:nil keyword:keyword suffix:nil or:nil];
+    uint8_t *buffer = malloc(DEJAL_TEXT_READ_CHUNK_LENGTH);
+    NSInteger bytesRead;
+    
+    if (stream.streamStatus == NSStreamStatusNotOpen)
+        [stream open];
+    
+    while ((bytesRead = [stream read:buffer maxLength:DEJAL_TEXT_READ_CHUNK_LENGTH]) > 0)
+        [self appendUTF8Bytes:buffer length:(NSUInteger)bytesRead];
+    
+    free(buffer);
+    
+    return bytesRead == 0;
 }
 
 /**
- If the keyword is a valid non-empty string, the prefix, keyword, and suffix are appended to the receiver (the prefix and/or suffix may be nil if desired).  Otherwise, if the alternative is a valid non-empty string, it is appended.  If neither applies, the receiver is not changed.
+ Reads a UTF-8 text file in fixed-size chunks.
  
- @author DJS 2004-03.
- @version DJS 2011-01: changed to call -appendSeparator:prefix:keyword:suffix:or:.
-*/
+ @returns YES if the file was read, or NO if it couldn't be.
+ 
+ @author DJS 2026-10.
+ */
 
-- (void)dejal_appendPrefix:(NSString *)prefix keyword:(NSString *)keyword suffix:(NSString *)suffix or:(NSString *)alternative;
+- (BOOL)appendContentsOfFile:(NSString *)path;
 {
-    [self dejal_appendSeparator:nil prefix:prefix keyword:keyword suffix:suffix or:alternative];
+    NSInputStream *stream = [NSInputStream inputStreamWithFileAtPath:path];
+    BOOL result = [self appendContentsOfStream:stream];
+    
+    [stream close];
+    
+    return stream && result;
 }
 
 /**
- If the keyword is a valid non-empty string, the separator, prefix, keyword and suffix are appended to the receiver (the separator, prefix and suffix may be nil if desired).  The separator is only included if the receiver isn't empty.  Otherwise, if the alternative is a valid non-empty string, it is appended.  If neither applies, the receiver is not changed.
+ Finishes scanning: the last line is passed to the handler, if any, even if empty, as is each empty paragraph.  The counts are complete after this.
  
- @author DJS 2011-01.
-*/
+ @author DJS 2026-10.
+ */
 
-- (void)dejal_appendSeparator:(NSString *)separator prefix:(NSString *)prefix keyword:(NSString *)keyword suffix:(NSString *)suffix  or:(NSString *)alternative;
+- (void)finish;
 {
-    if (keyword.length)
+    unichar replacement;
+    
+    if (DejalFinishDecodingUTF8(&_utf8State, &replacement))
+        [self appendCharacters:&replacement length:1];
+    
+    if (_token)
     {
-        if (self.length)
-            [self dejal_appendString:separator or:nil];
-        
-        [self dejal_appendString:prefix or:nil];
-        [self appendString:keyword];
-        [self dejal_appendString:suffix or:nil];
+        [self endToken];
+        [self endLine];
     }
-    else
-        [self dejal_appendString:alternative or:nil];
 }
 
 @end
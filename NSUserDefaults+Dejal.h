@@ -36,6 +36,7 @@
 - (void)dejal_setObject:(id)anObject forKey:(id)aKey removeIfNil:(BOOL)removeIfNil;
 
 - (id)dejal_sanitizeObject:(id)object;
+- (id)dejal_sanitizeObject:(id)object replacedPaths:(NSArray **)replacedPaths;
 - (void)dejal_setArbitraryObject:(id)object forKey:(NSString *)key;
 
 - (NSInteger)dejal_incrementIntegerForKey:(NSString *)defaultName;
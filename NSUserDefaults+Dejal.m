@@ -32,6 +32,119 @@
 #import "NSDictionary+Dejal.h"
 
 
+/**
+ Returns YES if the object is a property list leaf value, i.e. a string, number, date or data.
+ 
+ @author DJS 2026-10.
+ */
+
+static inline BOOL DejalIsPropertyListLeaf(id object)
+{
+    return [object isKindOfClass:[NSString class]] || [object isKindOfClass:[NSNumber class]] || [object isKindOfClass:[NSDate class]] || [object isKindOfClass:[NSData class]];
+}
+
+/**
+ Returns YES if the object and everything in it would be left unchanged by -dejal_sanitizeObject:.  Walks the tree without allocating anything.
+ 
+ @author DJS 2026-10.
+ */
+
+static BOOL DejalIsSanitized(id object)
+{
+    if ([object isKindOfClass:[NSArray class]])
+    {
+        for (id item in object)
+            if (!DejalIsSanitized(item))
+                return NO;
+        
+        return YES;
+    }
+    else if ([object isKindOfClass:[NSDictionary class]])
+    {
+        for (id key in object)
+            if (!DejalIsSanitized([object objectForKey:key]))
+                return NO;
+        
+        return YES;
+    }
+    else
+    {
+        return DejalIsPropertyListLeaf(object);
+    }
+}
+
+/**
+ Returns the sanitized object, copying only the arrays and dictionaries on the path to a value that needs replacing, and returning the others (and the object itself, if nothing in it needs replacing) as is.  If replacedPaths is not nil, the path to each replaced value (an array of dictionary keys and array indexes) is added to it; path is the path to the object.
+ 
+ @author DJS 2026-10.
+ */
+
+static id DejalSanitizedObject(id object, NSMutableArray *path, NSMutableArray *replacedPaths)
+{
+    if ([object isKindOfClass:[NSArray class]])
+    {
+        NSMutableArray *result = nil;
+        NSUInteger idx = 0;
+        
+        for (id item in object)
+        {
+            if (path)
+                [path addObject:@(idx)];
+            
+            id sanitizedItem = DejalSanitizedObject(item, path, replacedPaths);
+            
+            [path removeLastObject];
+            
+            if (sanitizedItem != item && !result)
+            {
+                result = [NSMutableArray arrayWithCapacity:[object count]];
+                [result addObjectsFromArray:[object subarrayWithRange:NSMakeRange(0, idx)]];
+            }
+            
+            [result addObject:sanitizedItem];
+            idx++;
+        }
+        
+        return result ?: object;
+    }
+    else if ([object isKindOfClass:[NSDictionary class]])
+    {
+        NSMutableDictionary *result = nil;
+        
+        for (id key in object)
+        {
+            id item = [object objectForKey:key];
+            
+            [path addObject:key];
+            
+            id sanitizedItem = DejalSanitizedObject(item, path, replacedPaths);
+            
+            [path removeLastObject];
+            
+            if (sanitizedItem != item)
+            {
+                if (!result)
+                    result = [object mutableCopy];
+                
+                result[key] = sanitizedItem;
+            }
+        }
+        
+        return result ?: object;
+    }
+    else if (DejalIsPropertyListLeaf(object))
+    {
+        return object;
+    }
+    else
+    {
+        [replacedPaths addObject:[path copy]];
+        
+        return [object description];
+    }
+}
+
+
 @implementation NSUserDefaults (Dejal)
 
 /**
@@ -85,37 +198,43 @@
  @returns An object or collection with only property list objects.
  
  @author DJS 2015-01.
+ @version DJS 2026-10: changed to use -dejal_sanitizeObject:replacedPaths:, which returns the object as is if it is already safe.
  */
 
 - (id)dejal_sanitizeObject:(id)object;
 {
-    if ([object isKindOfClass:[NSArray class]])
-    {
-        NSMutableArray *result = [NSMutableArray array];
-        
-        for (id item in object)
-        {
-            [result addObject:[self dejal_sanitizeObject:item]];
-        }
-        
-        object = result;
-    }
-    else if ([object isKindOfClass:[NSDictionary class]])
+    return [self dejal_sanitizeObject:object replacedPaths:nil];
+}
+
+/**
+ Given an arbitrary object, makes it safe to store in user defaults, as for -dejal_sanitizeObject:, optionally reporting what was replaced.
+ 
+ First checks the whole tree without allocating anything; if everything is already a property list object, the object is returned untouched.  Otherwise only the arrays and dictionaries containing (at any depth) a value that needs replacing are copied; the rest are shared with the original.
+ 
+ @param object An arbitrary object or collection.
+ @param replacedPaths If not NULL, set to an array with the path to each replaced value, as an array of the dictionary keys and array indexes (as NSNumbers) leading to it; an empty path means the object itself was replaced.  Set to an empty array if nothing was replaced.
+ @returns An object or collection with only property list objects.
+ 
+ @author DJS 2026-10.
+ */
+
+- (id)dejal_sanitizeObject:(id)object replacedPaths:(NSArray **)replacedPaths;
+{
+    if (!object || DejalIsSanitized(object))
     {
-        NSMutableDictionary *result = [NSMutableDictionary dictionary];
-        
-        [object enumerateKeysAndObjectsUsingBlock:^(id key, id obj, BOOL *stop)
-         {
-             [result setObject:[self dejal_sanitizeObject:obj] forKey:key];
-         }];
+        if (replacedPaths)
+            *replacedPaths = @[];
         
-        object = result;
-    }
-    else if (![object isKindOfClass:[NSString class]] && ![object isKindOfClass:[NSNumber class]] && ![object isKindOfClass:[NSDate class]] && ![object isKindOfClass:[NSData class]])
-    {
-        object = [object description];
+        return object;
     }
     
+    NSMutableArray *paths = replacedPaths ? [NSMutableArray array] : nil;
+    
+    object = DejalSanitizedObject(object, paths ? [NSMutableArray array] : nil, paths);
+    
+    if (replacedPaths)
+        *replacedPaths = paths;
+    
     return object;
 }
 